@@ -0,0 +1,598 @@
+/*
+ABOUT:
+
+   One allocator interface shared by stb_image, stb_image_write, stb_truetype
+   and the stb_truetype_stream cache addon:
+
+     struct Allocator { alloc, resize, free, user };
+
+   `resize` grows or shrinks a block in place and returns false when it
+   cannot; Realloc() then falls back to alloc + copy + free. Every library
+   allocates through GetAllocator(): the calling thread's ScopedAllocator if
+   one is active, else the process-wide SetAllocator() one, else the default
+   (libc, or OS pages when freestanding).
+
+   Implementations:
+     BumpArena      - caller memory, free is a no-op (the last block is rolled
+                      back), Reset() drops everything at once
+     SlabAllocator  - size-class free lists carved from upstream chunks; one
+                      per thread, no locking
+     StatsAllocator - forwards to an upstream allocator and counts calls,
+                      live/peak/total bytes
+
+   BlockAlloc/BlockRealloc/BlockFree are malloc/realloc/free drop-ins over
+   GetAllocator() for call sites that do not keep sizes: a small prefix
+   records the size and the owning allocator, so a block is always freed by
+   the allocator that made it.
+
+BUILDING:
+
+   Hosted builds use malloc/free (_aligned_malloc/_aligned_free on MSVC).
+   #define STB_ALLOCATOR_FREESTANDING (implied by STBIW_FREESTANDING and
+   STBTT_FREESTANDING) to use VirtualAlloc or mmap instead. #define STB_ALLOCATOR_THREAD_LOCAL to empty when the target has
+   no TLS; ScopedAllocator then becomes process-wide.
+
+   All translation units of a program must agree on the freestanding choice.
+*/
+#pragma once
+// ------------------- Freestanding-friendly Includes -------------------------
+#include <stddef.h> // size_t
+#include <stdint.h> // uint8_t, uintptr_t
+
+#if !defined(STB_ALLOCATOR_FREESTANDING) && \
+    (defined(STBIW_FREESTANDING) || defined(STBTT_FREESTANDING))
+#   define STB_ALLOCATOR_FREESTANDING
+#endif
+
+#ifdef STB_ALLOCATOR_FREESTANDING
+#   if defined(_WIN32)
+#       ifndef WIN32_LEAN_AND_MEAN
+#          define WIN32_LEAN_AND_MEAN
+#       endif
+#       include <windows.h>
+#   else
+#       include <sys/mman.h>
+#   endif
+#else
+#   include <stdlib.h> // malloc, free, posix_memalign
+#   include <string.h> // memcpy
+#   if defined(_MSC_VER)
+#       include <malloc.h> // _aligned_malloc
+#   endif
+#endif
+
+#ifndef STB_ALLOCATOR_THREAD_LOCAL
+#   define STB_ALLOCATOR_THREAD_LOCAL thread_local
+#endif
+
+namespace stb {
+
+// All function pointers must be set. `alloc` returns nullptr on failure and
+// is never asked for 0 bytes; `align` is a power of two. `free` is never
+// passed nullptr.
+struct Allocator {
+    void* (*alloc)(void* user, size_t size, size_t align);
+    bool  (*resize)(void* user, void* ptr, size_t old_size, size_t new_size);
+    void  (*free)(void* user, void* ptr);
+    void* user;
+};
+
+// What malloc guarantees on every supported target (8 on 32-bit MSVC).
+static const size_t DEFAULT_ALIGN = 2 * sizeof(void*);
+
+// ============================================================================
+// ============================ Helpers =======================================
+// ============================================================================
+
+namespace detail {
+
+inline size_t align_up_(size_t v, size_t a) noexcept {
+    return (v + a - 1) & ~(a - 1);
+}
+
+inline void copy_bytes_(void* dst, const void* src, size_t n) noexcept {
+#ifdef STB_ALLOCATOR_FREESTANDING
+    uint8_t* d = (uint8_t*)dst;
+    const uint8_t* s = (const uint8_t*)src;
+    while (n--) *d++ = *s++;
+#else
+    memcpy(dst, src, n);
+#endif
+}
+
+// 16 bytes in front of a block, used by the size-tracking allocators below.
+// `offset` is the distance from the upstream block to the user pointer.
+static const size_t PREFIX_BYTES = 16;
+struct Prefix {
+    size_t   size;
+    uint32_t offset;
+    uint32_t tag;
+};
+
+inline Prefix* prefix_(void* p) noexcept {
+    return (Prefix*)((uint8_t*)p - PREFIX_BYTES);
+}
+
+} // namespace detail
+
+inline void* Alloc(const Allocator& a, size_t size, size_t align = DEFAULT_ALIGN) noexcept {
+    return a.alloc(a.user, size ? size : 1, align < DEFAULT_ALIGN ? DEFAULT_ALIGN : align);
+}
+
+inline bool Resize(const Allocator& a, void* p, size_t old_size, size_t new_size) noexcept {
+    return p && new_size && a.resize(a.user, p, old_size, new_size);
+}
+
+inline void Free(const Allocator& a, void* p) noexcept {
+    if (p) a.free(a.user, p);
+}
+
+// Resize in place when the allocator can, else move. On failure `p` is
+// left untouched.
+inline void* Realloc(const Allocator& a, void* p, size_t old_size, size_t new_size,
+                            size_t align = DEFAULT_ALIGN) noexcept {
+    if (!p) return Alloc(a, new_size, align);
+    if (Resize(a, p, old_size, new_size)) return p;
+    void* q = Alloc(a, new_size, align);
+    if (!q) return nullptr;
+    detail::copy_bytes_(q, p, old_size < new_size ? old_size : new_size);
+    a.free(a.user, p);
+    return q;
+}
+
+// ============================================================================
+// ======================= Default / process allocator ========================
+// ============================================================================
+
+namespace detail {
+
+#ifdef STB_ALLOCATOR_FREESTANDING
+// Whole pages per block. The mapping size sits at the page start and the user
+// pointer is `align` (at least 16) bytes in, so the page start is found again
+// by rounding down; alignments above 2048 are not supported.
+static const size_t PAGE_BYTES = 4096;
+
+inline void* os_alloc_(void* user, size_t size, size_t align) noexcept {
+    (void)user;
+    if (align > PAGE_BYTES / 2) return nullptr;
+    const size_t head = align < PREFIX_BYTES ? PREFIX_BYTES : align;
+    if (size > (size_t)-1 - head - PAGE_BYTES) return nullptr;
+    const size_t total = align_up_(size + head, PAGE_BYTES);
+#if defined(_WIN32)
+    void* base = VirtualAlloc(nullptr, total, MEM_COMMIT | MEM_RESERVE, PAGE_READWRITE);
+    if (!base) return nullptr;
+#else
+    void* base = mmap(nullptr, total, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (base == MAP_FAILED) return nullptr;
+#endif
+    *(size_t*)base = total;
+    return (uint8_t*)base + head;
+}
+
+inline uint8_t* os_base_(void* p) noexcept {
+    return (uint8_t*)((uintptr_t)p & ~(uintptr_t)(PAGE_BYTES - 1));
+}
+
+inline bool os_resize_(void* user, void* p, size_t old_size, size_t new_size) noexcept {
+    (void)user; (void)old_size;
+    uint8_t* base = os_base_(p);
+    const size_t head = (size_t)((uint8_t*)p - base);
+    return new_size <= *(size_t*)base - head;
+}
+
+inline void os_free_(void* user, void* p) noexcept {
+    (void)user;
+    uint8_t* base = os_base_(p);
+#if defined(_WIN32)
+    VirtualFree(base, 0, MEM_RELEASE);
+#else
+    munmap(base, *(size_t*)base);
+#endif
+}
+#else
+inline void* os_alloc_(void* user, size_t size, size_t align) noexcept {
+    (void)user;
+#if defined(_MSC_VER)
+    return _aligned_malloc(size, align);
+#else
+    if (align <= DEFAULT_ALIGN) return malloc(size);
+    void* p = nullptr;
+    return posix_memalign(&p, align, size) == 0 ? p : nullptr;
+#endif
+}
+
+// libc cannot promise an in-place grow; shrinking keeps the block.
+inline bool os_resize_(void* user, void* p, size_t old_size, size_t new_size) noexcept {
+    (void)user; (void)p;
+    return new_size <= old_size;
+}
+
+inline void os_free_(void* user, void* p) noexcept {
+    (void)user;
+#if defined(_MSC_VER)
+    _aligned_free(p);
+#else
+    free(p);
+#endif
+}
+#endif // STB_ALLOCATOR_FREESTANDING
+
+inline const Allocator*& process_allocator_() noexcept {
+    static const Allocator* a = nullptr;
+    return a;
+}
+
+inline const Allocator*& thread_allocator_() noexcept {
+    static STB_ALLOCATOR_THREAD_LOCAL const Allocator* a = nullptr;
+    return a;
+}
+
+} // namespace detail
+
+// libc (hosted) or OS pages (freestanding).
+inline const Allocator& DefaultAllocator() noexcept {
+    static const Allocator a = { detail::os_alloc_, detail::os_resize_, detail::os_free_, nullptr };
+    return a;
+}
+
+// Process-wide allocator for every library; nullptr restores the default.
+// Not synchronized: set it before other threads allocate. `a` must outlive
+// every block allocated through it.
+inline void SetAllocator(const Allocator* a) noexcept {
+    detail::process_allocator_() = a;
+}
+
+inline const Allocator& GetAllocator() noexcept {
+    if (const Allocator* t = detail::thread_allocator_()) return *t;
+    if (const Allocator* p = detail::process_allocator_()) return *p;
+    return DefaultAllocator();
+}
+
+// Routes the calling thread's allocations to `a` until destruction; nullptr
+// keeps the current one. Scopes nest.
+struct ScopedAllocator {
+    explicit ScopedAllocator(const Allocator* a) noexcept : _prev(detail::thread_allocator_()) {
+        if (a) detail::thread_allocator_() = a;
+    }
+    ~ScopedAllocator() noexcept { detail::thread_allocator_() = _prev; }
+
+    ScopedAllocator(const ScopedAllocator&) = delete;
+    ScopedAllocator& operator=(const ScopedAllocator&) = delete;
+
+private:
+    const Allocator* _prev{};
+};
+
+// ============================================================================
+// ============================ Size-tracked blocks ===========================
+// ============================================================================
+
+// malloc/realloc/free over GetAllocator(). A 16-byte header keeps the owning
+// allocator and the size, so BlockFree may run under a different scope.
+namespace detail {
+struct BlockHeader {
+    const Allocator* owner;
+    size_t size;
+};
+
+inline BlockHeader* block_header_(const void* p) noexcept {
+    return (BlockHeader*)((uint8_t*)p - PREFIX_BYTES);
+}
+} // namespace detail
+
+inline void* BlockAlloc(size_t size) noexcept {
+    const Allocator& a = GetAllocator();
+    if (size > (size_t)-1 - detail::PREFIX_BYTES) return nullptr;
+    uint8_t* base = (uint8_t*)Alloc(a, size + detail::PREFIX_BYTES, detail::PREFIX_BYTES);
+    if (!base) return nullptr;
+    detail::BlockHeader* h = (detail::BlockHeader*)base;
+    h->owner = &a;
+    h->size = size;
+    return base + detail::PREFIX_BYTES;
+}
+
+inline size_t BlockSize(const void* p) noexcept {
+    return p ? detail::block_header_(p)->size : 0;
+}
+
+inline void BlockFree(void* p) noexcept {
+    if (!p) return;
+    const Allocator& a = *detail::block_header_(p)->owner;
+    a.free(a.user, (uint8_t*)p - detail::PREFIX_BYTES);
+}
+
+// BlockRealloc(p, 0) frees and returns nullptr.
+inline void* BlockRealloc(void* p, size_t new_size) noexcept {
+    if (!p) return BlockAlloc(new_size);
+    if (!new_size) { BlockFree(p); return nullptr; }
+    if (new_size > (size_t)-1 - detail::PREFIX_BYTES) return nullptr;
+    const detail::BlockHeader* h = detail::block_header_(p);
+    const Allocator& a = *h->owner;
+    uint8_t* base = (uint8_t*)Realloc(a, (uint8_t*)p - detail::PREFIX_BYTES,
+                                      h->size + detail::PREFIX_BYTES,
+                                      new_size + detail::PREFIX_BYTES, detail::PREFIX_BYTES);
+    if (!base) return nullptr;
+    ((detail::BlockHeader*)base)->size = new_size;
+    return base + detail::PREFIX_BYTES;
+}
+
+// ============================================================================
+// ============================== BumpArena ===================================
+// ============================================================================
+
+// Linear allocator over caller memory. Only the most recent block can grow in
+// place or be given back; everything else is reclaimed by Reset().
+struct BumpArena {
+    explicit BumpArena() noexcept = default;
+    explicit BumpArena(void* mem, size_t bytes) noexcept { Init(mem, bytes); }
+
+    BumpArena(const BumpArena&) = delete;
+    BumpArena& operator=(const BumpArena&) = delete;
+
+    inline void Init(void* mem, size_t bytes) noexcept {
+        _begin = _top = (uint8_t*)mem;
+        _end = mem ? _begin + bytes : nullptr;
+        _last = nullptr;
+        _peak = 0;
+    }
+
+    inline void Reset() noexcept {
+        _top = _begin;
+        _last = nullptr;
+    }
+
+    inline size_t Used() const noexcept { return (size_t)(_top - _begin); }
+    inline size_t Peak() const noexcept { return _peak; }
+    inline size_t Capacity() const noexcept { return (size_t)(_end - _begin); }
+
+    // The arena must stay in place while the returned allocator is in use.
+    inline Allocator AsAllocator() noexcept {
+        Allocator a = { alloc_, resize_, free_, this };
+        return a;
+    }
+
+private:
+    static inline void* alloc_(void* user, size_t size, size_t align) noexcept {
+        BumpArena& b = *(BumpArena*)user;
+        const uintptr_t top = (uintptr_t)b._top;
+        uint8_t* p = b._top + (detail::align_up_(top, align) - top);
+        if (p < b._top || p > b._end || size > (size_t)(b._end - p)) return nullptr;
+        b._last = p;
+        b._top = p + size;
+        if (b.Used() > b._peak) b._peak = b.Used();
+        return p;
+    }
+
+    static inline bool resize_(void* user, void* ptr, size_t old_size, size_t new_size) noexcept {
+        BumpArena& b = *(BumpArena*)user;
+        if (ptr != b._last) return new_size <= old_size;
+        if (new_size > (size_t)(b._end - b._last)) return false;
+        b._top = b._last + new_size;
+        if (b.Used() > b._peak) b._peak = b.Used();
+        return true;
+    }
+
+    static inline void free_(void* user, void* ptr) noexcept {
+        BumpArena& b = *(BumpArena*)user;
+        if (ptr != b._last) return;
+        b._top = b._last;
+        b._last = nullptr;
+    }
+
+    uint8_t* _begin{};
+    uint8_t* _top{};
+    uint8_t* _end{};
+    uint8_t* _last{};
+    size_t _peak{};
+};
+
+// ============================================================================
+// ============================ SlabAllocator =================================
+// ============================================================================
+
+// Power-of-two size classes from 16 to 2048 bytes, each with a free list fed
+// from `chunk_bytes` chunks of the upstream allocator. Larger or more aligned
+// requests go straight upstream. Unsynchronized: give each thread its own
+// slab (e.g. under a ScopedAllocator) and free blocks on the thread that made
+// them. Chunks return upstream only in Release() / the destructor.
+struct SlabAllocator {
+    static const uint32_t CLASS_COUNT = 8;
+    static const size_t MIN_CLASS_BYTES = 16;
+    static const size_t MAX_CLASS_BYTES = MIN_CLASS_BYTES << (CLASS_COUNT - 1);
+
+    explicit SlabAllocator(const Allocator& upstream = DefaultAllocator(),
+                           size_t chunk_bytes = 64 * 1024) noexcept
+        : _upstream(upstream) {
+        const size_t min_chunk = detail::PREFIX_BYTES * 2 + MAX_CLASS_BYTES;
+        _chunk_bytes = chunk_bytes < min_chunk ? min_chunk : chunk_bytes;
+    }
+    ~SlabAllocator() noexcept { Release(); }
+
+    SlabAllocator(const SlabAllocator&) = delete;
+    SlabAllocator& operator=(const SlabAllocator&) = delete;
+
+    // Frees every chunk; blocks still held by callers become invalid.
+    inline void Release() noexcept {
+        while (_chunks) {
+            Chunk* next = _chunks->next;
+            Free(_upstream, _chunks);
+            _chunks = next;
+        }
+        for (uint32_t c = 0; c < CLASS_COUNT; ++c) _free_list[c] = nullptr;
+        _cursor = _cursor_end = nullptr;
+    }
+
+    inline Allocator AsAllocator() noexcept {
+        Allocator a = { alloc_, resize_, free_, this };
+        return a;
+    }
+
+private:
+    struct Chunk { Chunk* next; };
+    struct FreeBlock { FreeBlock* next; };
+    static const uint32_t LARGE = 0xffffffffu;
+
+    static inline uint32_t class_of_(size_t size) noexcept {
+        uint32_t c = 0;
+        while ((MIN_CLASS_BYTES << c) < size) ++c;
+        return c;
+    }
+
+    inline uint8_t* carve_(uint32_t c) noexcept {
+        const size_t block = detail::PREFIX_BYTES + (MIN_CLASS_BYTES << c);
+        if (!_cursor || (size_t)(_cursor_end - _cursor) < block) {
+            uint8_t* mem = (uint8_t*)Alloc(_upstream, _chunk_bytes, detail::PREFIX_BYTES);
+            if (!mem) return nullptr;
+            ((Chunk*)mem)->next = _chunks;
+            _chunks = (Chunk*)mem;
+            _cursor = mem + detail::PREFIX_BYTES;
+            _cursor_end = mem + _chunk_bytes;
+        }
+        uint8_t* p = _cursor + detail::PREFIX_BYTES;
+        _cursor += block;
+        return p;
+    }
+
+    static inline void* alloc_(void* user, size_t size, size_t align) noexcept {
+        SlabAllocator& s = *(SlabAllocator*)user;
+        uint8_t* p = nullptr;
+        if (size <= MAX_CLASS_BYTES && align <= detail::PREFIX_BYTES) {
+            const uint32_t c = class_of_(size);
+            if (FreeBlock* f = s._free_list[c]) {
+                s._free_list[c] = f->next;
+                p = (uint8_t*)f;
+            } else {
+                p = s.carve_(c);
+                if (!p) return nullptr;
+            }
+            detail::prefix_(p)->tag = c;
+        } else {
+            const size_t head = align < detail::PREFIX_BYTES ? detail::PREFIX_BYTES : align;
+            if (size > (size_t)-1 - head) return nullptr;
+            uint8_t* base = (uint8_t*)Alloc(s._upstream, size + head, head);
+            if (!base) return nullptr;
+            p = base + head;
+            detail::prefix_(p)->tag = LARGE;
+            detail::prefix_(p)->offset = (uint32_t)head;
+        }
+        detail::prefix_(p)->size = size;
+        return p;
+    }
+
+    static inline bool resize_(void* user, void* ptr, size_t old_size, size_t new_size) noexcept {
+        SlabAllocator& s = *(SlabAllocator*)user;
+        detail::Prefix* h = detail::prefix_(ptr);
+        if (h->tag != LARGE) return new_size <= (MIN_CLASS_BYTES << h->tag);
+        const size_t head = h->offset;
+        if (new_size > (size_t)-1 - head) return false;
+        if (!Resize(s._upstream, (uint8_t*)ptr - head, old_size + head, new_size + head)) return false;
+        h->size = new_size;
+        return true;
+    }
+
+    static inline void free_(void* user, void* ptr) noexcept {
+        SlabAllocator& s = *(SlabAllocator*)user;
+        const detail::Prefix* h = detail::prefix_(ptr);
+        if (h->tag == LARGE) {
+            s._upstream.free(s._upstream.user, (uint8_t*)ptr - h->offset);
+            return;
+        }
+        FreeBlock* f = (FreeBlock*)ptr;
+        f->next = s._free_list[h->tag];
+        s._free_list[h->tag] = f;
+    }
+
+    Allocator _upstream{};
+    size_t _chunk_bytes{};
+    Chunk* _chunks{};
+    uint8_t* _cursor{};
+    uint8_t* _cursor_end{};
+    FreeBlock* _free_list[CLASS_COUNT]{};
+};
+
+// ============================================================================
+// ============================ StatsAllocator ================================
+// ============================================================================
+
+struct AllocStats {
+    size_t alloc_count{};
+    size_t free_count{};
+    size_t resize_count{};   // successful in-place resizes
+    size_t failed_count{};   // failed allocations
+    size_t live_bytes{};
+    size_t peak_bytes{};
+    size_t total_bytes{};    // sum of all allocation sizes
+};
+
+// Counts traffic to `upstream`. Each block carries a prefix with its size.
+// Unsynchronized, like SlabAllocator.
+struct StatsAllocator {
+    explicit StatsAllocator(const Allocator& upstream = DefaultAllocator()) noexcept
+        : _upstream(upstream) {}
+
+    StatsAllocator(const StatsAllocator&) = delete;
+    StatsAllocator& operator=(const StatsAllocator&) = delete;
+
+    inline const AllocStats& Stats() const noexcept { return _stats; }
+
+    // Clears the counters; live bytes carry over as the new peak base.
+    inline void ResetStats() noexcept {
+        const size_t live = _stats.live_bytes;
+        _stats = AllocStats{};
+        _stats.live_bytes = _stats.peak_bytes = live;
+    }
+
+    inline Allocator AsAllocator() noexcept {
+        Allocator a = { alloc_, resize_, free_, this };
+        return a;
+    }
+
+private:
+    inline void grow_(size_t bytes) noexcept {
+        _stats.live_bytes += bytes;
+        if (_stats.live_bytes > _stats.peak_bytes) _stats.peak_bytes = _stats.live_bytes;
+    }
+
+    static inline void* alloc_(void* user, size_t size, size_t align) noexcept {
+        StatsAllocator& s = *(StatsAllocator*)user;
+        const size_t head = align < detail::PREFIX_BYTES ? detail::PREFIX_BYTES : align;
+        uint8_t* base = size <= (size_t)-1 - head ? (uint8_t*)Alloc(s._upstream, size + head, head) : nullptr;
+        if (!base) {
+            ++s._stats.failed_count;
+            return nullptr;
+        }
+        uint8_t* p = base + head;
+        detail::prefix_(p)->size = size;
+        detail::prefix_(p)->offset = (uint32_t)head;
+        ++s._stats.alloc_count;
+        s._stats.total_bytes += size;
+        s.grow_(size);
+        return p;
+    }
+
+    static inline bool resize_(void* user, void* ptr, size_t old_size, size_t new_size) noexcept {
+        StatsAllocator& s = *(StatsAllocator*)user;
+        detail::Prefix* h = detail::prefix_(ptr);
+        const size_t head = h->offset;
+        if (new_size > (size_t)-1 - head) return false;
+        if (!Resize(s._upstream, (uint8_t*)ptr - head, old_size + head, new_size + head)) return false;
+        ++s._stats.resize_count;
+        s._stats.live_bytes -= h->size;
+        s.grow_(new_size);
+        h->size = new_size;
+        return true;
+    }
+
+    static inline void free_(void* user, void* ptr) noexcept {
+        StatsAllocator& s = *(StatsAllocator*)user;
+        const detail::Prefix* h = detail::prefix_(ptr);
+        ++s._stats.free_count;
+        s._stats.live_bytes -= h->size;
+        s._upstream.free(s._upstream.user, (uint8_t*)ptr - h->offset);
+    }
+
+    Allocator _upstream{};
+    AllocStats _stats{};
+};
+
+} // namespace stb
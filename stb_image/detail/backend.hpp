@@ -35,6 +35,14 @@ struct ImageBackend {
         return stbi::detail::InternalImageBackend::LoadF32FromMemory(bytes, byte_count, x, y, comp, req_comp);
     }
 
+    static inline bool LoadJpegRowsU8FromMemory(const uint8_t* bytes, int byte_count,
+                                                int* x, int* y, int* comp, int req_comp, int scale_shift,
+                                                void (*sink)(void* user, int y, const uint8_t* row),
+                                                void* user) noexcept {
+        return stbi::detail::InternalImageBackend::LoadJpegRowsU8FromMemory(bytes, byte_count, x, y, comp,
+                                                                            req_comp, scale_shift, sink, user);
+    }
+
     static inline void ImageFree(void* p) noexcept {
         stbi::detail::InternalImageBackend::ImageFree(p);
     }
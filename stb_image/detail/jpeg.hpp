@@ -83,6 +83,13 @@ typedef struct
    int scan_n, order[4];
    int restart_interval, todo;
 
+// DCT scaling: components are stored at 1/(1 << scale_shift), 0..3
+   int scale_shift;
+// when set, load_jpeg_image hands each output row to row_sink instead of
+// building the whole image
+   void (*row_sink)(void *user, int y, const uc *row);
+   void *row_user;
+
 // kernels
    void (*idct_block_kernel)(uc *out, int out_stride, short data[64]);
    void (*YCbCr_to_RGB_kernel)(uc *out, const uc *y, const uc *pcb, const uc *pcr, int count, int step);
@@ -1035,6 +1042,33 @@ static void jpeg_reset(jpeg *j) noexcept
    // since we don't even allow 1<<30 pixels
 }
 
+// idct one dequantized block into component n at block (bx,by); with DCT
+// scaling the 8x8 result is reduced to (8 >> scale_shift) square
+static void jpeg_store_block(jpeg *z, int n, int bx, int by, short data[64]) noexcept
+{
+   int s = z->scale_shift, bs = 8 >> s, stride = z->comp[n].w2;
+   uc *out = z->comp[n].data + stride*by*bs + bx*bs;
+   if (s == 0) {
+      z->idct_block_kernel(out, stride, data);
+   } else if (s == 3) {
+      // a 1x1 block is just the DC term
+      *out = clamp(((data[0] + 4) >> 3) + 128);
+   } else {
+      int x,y,u,v;
+      STBI_SIMD_ALIGN(uc, tmp[64]);
+      z->idct_block_kernel(tmp, 8, data);
+      for (y=0; y < bs; ++y) {
+         for (x=0; x < bs; ++x) {
+            int sum = 0;
+            for (v=0; v < (1 << s); ++v)
+               for (u=0; u < (1 << s); ++u)
+                  sum += tmp[((y << s) + v)*8 + (x << s) + u];
+            out[y*stride + x] = (uc) ((sum + (1 << (2*s-1))) >> (2*s));
+         }
+      }
+   }
+}
+
 static int parse_entropy_coded_data(jpeg *z) noexcept
 {
    jpeg_reset(z);
@@ -1053,7 +1087,7 @@ static int parse_entropy_coded_data(jpeg *z) noexcept
             for (i=0; i < w; ++i) {
                int ha = z->comp[n].ha;
                if (!jpeg_decode_block(z, data, z->huff_dc+z->comp[n].hd, z->huff_ac+ha, z->fast_ac[ha], n, z->dequant[z->comp[n].tq])) return 0;
-               z->idct_block_kernel(z->comp[n].data+z->comp[n].w2*j*8+i*8, z->comp[n].w2, data);
+               jpeg_store_block(z, n, i, j, data);
                // every data block is an MCU, so countdown the restart interval
                if (--z->todo <= 0) {
                   if (z->code_bits < 24) grow_buffer_unsafe(z);
@@ -1077,11 +1111,11 @@ static int parse_entropy_coded_data(jpeg *z) noexcept
                   // by the basic H and V specified for the component
                   for (y=0; y < z->comp[n].v; ++y) {
                      for (x=0; x < z->comp[n].h; ++x) {
-                        int x2 = (i*z->comp[n].h + x)*8;
-                        int y2 = (j*z->comp[n].v + y)*8;
+                        int x2 = i*z->comp[n].h + x;
+                        int y2 = j*z->comp[n].v + y;
                         int ha = z->comp[n].ha;
                         if (!jpeg_decode_block(z, data, z->huff_dc+z->comp[n].hd, z->huff_ac+ha, z->fast_ac[ha], n, z->dequant[z->comp[n].tq])) return 0;
-                        z->idct_block_kernel(z->comp[n].data+z->comp[n].w2*y2+x2, z->comp[n].w2, data);
+                        jpeg_store_block(z, n, x2, y2, data);
                      }
                   }
                }
@@ -1178,7 +1212,7 @@ static void jpeg_finish(jpeg *z) noexcept
             for (i=0; i < w; ++i) {
                short *data = z->comp[n].coeff + 64 * (i + j * z->comp[n].coeff_w);
                jpeg_dequantize(data, z->dequant[z->comp[n].tq]);
-               z->idct_block_kernel(z->comp[n].data+z->comp[n].w2*j*8+i*8, z->comp[n].w2, data);
+               jpeg_store_block(z, n, i, j, data);
             }
          }
       }
@@ -1417,9 +1451,10 @@ static int process_frame_header(jpeg *z, int scan) noexcept
       // discard the extra data until colorspace conversion
       //
       // mcu_x, mcu_y: <=17 bits; comp[i].h and .v are <=4 (checked earlier)
-      // so these muls can't overflow with 32-bit ints (which we require)
-      z->comp[i].w2 = z->mcu_x * z->comp[i].h * 8;
-      z->comp[i].h2 = z->mcu_y * z->comp[i].v * 8;
+      // so these muls can't overflow with 32-bit ints (which we require).
+      // with DCT scaling every block is stored as (8 >> scale_shift) square
+      z->comp[i].w2 = z->mcu_x * z->comp[i].h * (8 >> z->scale_shift);
+      z->comp[i].h2 = z->mcu_y * z->comp[i].v * (8 >> z->scale_shift);
       z->comp[i].coeff = 0;
       z->comp[i].raw_coeff = 0;
       z->comp[i].linebuf = NULL;
@@ -1429,10 +1464,10 @@ static int process_frame_header(jpeg *z, int scan) noexcept
       // align blocks for idct using mmx/sse
       z->comp[i].data = (uc*) (((size_t) z->comp[i].raw_data + 15) & ~15);
       if (z->progressive) {
-         // w2, h2 are multiples of 8 (see above)
-         z->comp[i].coeff_w = z->comp[i].w2 / 8;
-         z->comp[i].coeff_h = z->comp[i].h2 / 8;
-         z->comp[i].raw_coeff = malloc_mad3(z->comp[i].w2, z->comp[i].h2, sizeof(short), 15);
+         // coefficients are always full 8x8 blocks
+         z->comp[i].coeff_w = z->mcu_x * z->comp[i].h;
+         z->comp[i].coeff_h = z->mcu_y * z->comp[i].v;
+         z->comp[i].raw_coeff = malloc_mad3(z->comp[i].coeff_w * 8, z->comp[i].coeff_h * 8, sizeof(short), 15);
          if (z->comp[i].raw_coeff == NULL)
             return free_jpeg_components(z, i+1, err("outofmem", "Out of memory"));
          z->comp[i].coeff = (short*) (((size_t) z->comp[i].raw_coeff + 15) & ~15);
@@ -1954,6 +1989,7 @@ static uc blinn_8x8(uc x, uc y) noexcept
 static uc *load_jpeg_image(jpeg *z, int *out_x, int *out_y, int *comp, int req_comp) noexcept
 {
    int n, decode_n, is_rgb;
+   uint32 ox, oy; // output size, after DCT scaling
    z->s->n = 0; // make cleanup_jpeg safe
 
    // validate req_comp
@@ -1962,6 +1998,9 @@ static uc *load_jpeg_image(jpeg *z, int *out_x, int *out_y, int *comp, int req_c
    // load a jpeg image from whichever source, but leave in YCbCr format
    if (!decode_jpeg_image(z)) { cleanup_jpeg(z); return NULL; }
 
+   ox = (z->s->x + (1u << z->scale_shift) - 1) >> z->scale_shift;
+   oy = (z->s->y + (1u << z->scale_shift) - 1) >> z->scale_shift;
+
    // determine actual number of components to generate
    n = req_comp ? req_comp : z->s->n >= 3 ? 3 : 1;
 
@@ -1990,13 +2029,13 @@ static uc *load_jpeg_image(jpeg *z, int *out_x, int *out_y, int *comp, int req_c
 
          // allocate line buffer big enough for upsampling off the edges
          // with upsample factor of 4
-         z->comp[k].linebuf = (uc *) malloc(z->s->x + 3);
+         z->comp[k].linebuf = (uc *) malloc(ox + 3);
          if (!z->comp[k].linebuf) { cleanup_jpeg(z); return errpuc("outofmem", "Out of memory"); }
 
          r->hs      = z->h_max / z->comp[k].h;
          r->vs      = z->v_max / z->comp[k].v;
          r->ystep   = r->vs >> 1;
-         r->w_lores = (z->s->x + r->hs-1) / r->hs;
+         r->w_lores = (ox + r->hs-1) / r->hs;
          r->ypos    = 0;
          r->line0   = r->line1 = z->comp[k].data;
 
@@ -2007,13 +2046,14 @@ static uc *load_jpeg_image(jpeg *z, int *out_x, int *out_y, int *comp, int req_c
          else                               r->resample = resample_row_generic;
       }
 
-      // can't error after this so, this is safe
-      output = (uc *) malloc_mad3(n, z->s->x, z->s->y, 1);
+      // can't error after this so, this is safe. a row sink only needs
+      // the one row it is handed
+      output = (uc *) malloc_mad3(n, ox, z->row_sink ? 1 : oy, 1);
       if (!output) { cleanup_jpeg(z); return errpuc("outofmem", "Out of memory"); }
 
       // now go ahead and resample
-      for (j=0; j < z->s->y; ++j) {
-         uc *out = output + n * z->s->x * j;
+      for (j=0; j < oy; ++j) {
+         uc *out = z->row_sink ? output : output + n * ox * j;
          for (k=0; k < decode_n; ++k) {
             resample *r = &res_comp[k];
             int y_bot = r->ystep >= (r->vs >> 1);
@@ -2024,7 +2064,7 @@ static uc *load_jpeg_image(jpeg *z, int *out_x, int *out_y, int *comp, int req_c
             if (++r->ystep >= r->vs) {
                r->ystep = 0;
                r->line0 = r->line1;
-               if (++r->ypos < z->comp[k].y)
+               if (++r->ypos < (z->comp[k].y + (1 << z->scale_shift) - 1) >> z->scale_shift)
                   r->line1 += z->comp[k].w2;
             }
          }
@@ -2032,7 +2072,7 @@ static uc *load_jpeg_image(jpeg *z, int *out_x, int *out_y, int *comp, int req_c
             uc *y = coutput[0];
             if (z->s->n == 3) {
                if (is_rgb) {
-                  for (i=0; i < z->s->x; ++i) {
+                  for (i=0; i < ox; ++i) {
                      out[0] = y[i];
                      out[1] = coutput[1][i];
                      out[2] = coutput[2][i];
@@ -2040,11 +2080,11 @@ static uc *load_jpeg_image(jpeg *z, int *out_x, int *out_y, int *comp, int req_c
                      out += n;
                   }
                } else {
-                  z->YCbCr_to_RGB_kernel(out, y, coutput[1], coutput[2], z->s->x, n);
+                  z->YCbCr_to_RGB_kernel(out, y, coutput[1], coutput[2], ox, n);
                }
             } else if (z->s->n == 4) {
                if (z->app14_color_transform == 0) { // CMYK
-                  for (i=0; i < z->s->x; ++i) {
+                  for (i=0; i < ox; ++i) {
                      uc m = coutput[3][i];
                      out[0] = blinn_8x8(coutput[0][i], m);
                      out[1] = blinn_8x8(coutput[1][i], m);
@@ -2053,8 +2093,8 @@ static uc *load_jpeg_image(jpeg *z, int *out_x, int *out_y, int *comp, int req_c
                      out += n;
                   }
                } else if (z->app14_color_transform == 2) { // YCCK
-                  z->YCbCr_to_RGB_kernel(out, y, coutput[1], coutput[2], z->s->x, n);
-                  for (i=0; i < z->s->x; ++i) {
+                  z->YCbCr_to_RGB_kernel(out, y, coutput[1], coutput[2], ox, n);
+                  for (i=0; i < ox; ++i) {
                      uc m = coutput[3][i];
                      out[0] = blinn_8x8(255 - out[0], m);
                      out[1] = blinn_8x8(255 - out[1], m);
@@ -2062,10 +2102,10 @@ static uc *load_jpeg_image(jpeg *z, int *out_x, int *out_y, int *comp, int req_c
                      out += n;
                   }
                } else { // YCbCr + alpha?  Ignore the fourth channel for now
-                  z->YCbCr_to_RGB_kernel(out, y, coutput[1], coutput[2], z->s->x, n);
+                  z->YCbCr_to_RGB_kernel(out, y, coutput[1], coutput[2], ox, n);
                }
             } else
-               for (i=0; i < z->s->x; ++i) {
+               for (i=0; i < ox; ++i) {
                   out[0] = out[1] = out[2] = y[i];
                   out[3] = 255; // not used if n==3
                   out += n;
@@ -2073,16 +2113,16 @@ static uc *load_jpeg_image(jpeg *z, int *out_x, int *out_y, int *comp, int req_c
          } else {
             if (is_rgb) {
                if (n == 1)
-                  for (i=0; i < z->s->x; ++i)
+                  for (i=0; i < ox; ++i)
                      *out++ = compute_y(coutput[0][i], coutput[1][i], coutput[2][i]);
                else {
-                  for (i=0; i < z->s->x; ++i, out += 2) {
+                  for (i=0; i < ox; ++i, out += 2) {
                      out[0] = compute_y(coutput[0][i], coutput[1][i], coutput[2][i]);
                      out[1] = 255;
                   }
                }
             } else if (z->s->n == 4 && z->app14_color_transform == 0) {
-               for (i=0; i < z->s->x; ++i) {
+               for (i=0; i < ox; ++i) {
                   uc m = coutput[3][i];
                   uc r = blinn_8x8(coutput[0][i], m);
                   uc g = blinn_8x8(coutput[1][i], m);
@@ -2092,7 +2132,7 @@ static uc *load_jpeg_image(jpeg *z, int *out_x, int *out_y, int *comp, int req_c
                   out += n;
                }
             } else if (z->s->n == 4 && z->app14_color_transform == 2) {
-               for (i=0; i < z->s->x; ++i) {
+               for (i=0; i < ox; ++i) {
                   out[0] = blinn_8x8(255 - coutput[0][i], coutput[3][i]);
                   out[1] = 255;
                   out += n;
@@ -2100,15 +2140,16 @@ static uc *load_jpeg_image(jpeg *z, int *out_x, int *out_y, int *comp, int req_c
             } else {
                uc *y = coutput[0];
                if (n == 1)
-                  for (i=0; i < z->s->x; ++i) out[i] = y[i];
+                  for (i=0; i < ox; ++i) out[i] = y[i];
                else
-                  for (i=0; i < z->s->x; ++i) { *out++ = y[i]; *out++ = 255; }
+                  for (i=0; i < ox; ++i) { *out++ = y[i]; *out++ = 255; }
             }
          }
+         if (z->row_sink) z->row_sink(z->row_user, (int) j, output);
       }
       cleanup_jpeg(z);
-      *out_x = z->s->x;
-      *out_y = z->s->y;
+      *out_x = ox;
+      *out_y = oy;
       if (comp) *comp = z->s->n >= 3 ? 3 : 1; // report original components, not output
       return output;
    }
@@ -2128,6 +2169,26 @@ static void *jpeg_load(context *s, int *x, int *y, int *comp, int req_comp, resu
    return result;
 }
 
+// decodes at 1/(1 << scale_shift) size, 0..3, handing each row of req_comp
+// samples to sink(user, y, row) as it is converted; the returned row buffer
+// is the caller's to free
+static void *jpeg_load_rows(context *s, int *x, int *y, int *comp, int req_comp, int scale_shift,
+                            void (*sink)(void *user, int y, const uc *row), void *user) noexcept
+{
+   unsigned char* result;
+   jpeg* j = (jpeg*) malloc(sizeof(jpeg));
+   if (!j) return errpuc("outofmem", "Out of memory");
+   memset(j, 0, sizeof(jpeg));
+   j->s = s;
+   j->scale_shift = scale_shift;
+   j->row_sink = sink;
+   j->row_user = user;
+   setup_jpeg(j);
+   result = load_jpeg_image(j, x,y,comp,req_comp);
+   free(j);
+   return result;
+}
+
 static int jpeg_test(context *s) noexcept
 {
    int r;
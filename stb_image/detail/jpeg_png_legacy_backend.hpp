@@ -6,12 +6,25 @@
 #include <stdlib.h>
 #include <string.h>
 
+#include "../../stb_allocator/stb_allocator.hpp"
+
 // We intentionally disable SIMD in this legacy backend path to keep
 // freestanding builds deterministic and avoid platform-specific intrinsics.
 #ifndef STBI_NO_SIMD
 #define STBI_NO_SIMD
 #endif
 
+namespace stbi { namespace detail {
+
+// Decoder allocations go through stb::GetAllocator(). These hide the libc
+// functions for all of stbi::detail, including the codecs and `core`.
+inline void* malloc(size_t size) noexcept { return stb::BlockAlloc(size); }
+inline void* realloc(void* p, size_t size) noexcept { return stb::BlockRealloc(p, size); }
+inline void free(void* p) noexcept { stb::BlockFree(p); }
+
+} // namespace detail
+} // namespace stbi
+
 namespace stbi { namespace detail { namespace core {
 
 typedef unsigned char uc;
@@ -79,7 +92,7 @@ inline float* errpf(const char* primary, const char* secondary) noexcept {
 }
 
 inline void* realloc_sized(void* p, size_t old_size, size_t new_size) noexcept {
-    (void)old_size;
+    (void)old_size; // the block header already knows it
     return realloc(p, new_size);
 }
 
@@ -548,6 +561,21 @@ struct JpegLegacyBackend {
         return nullptr;
     }
 
+    static inline bool LoadRowsU8(const uint8_t* bytes, int byte_count,
+                                  int* x, int* y, int* comp, int req_comp, int scale_shift,
+                                  void (*sink)(void* user, int y, const uint8_t* row), void* user) noexcept {
+        (void)bytes;
+        (void)byte_count;
+        (void)x;
+        (void)y;
+        (void)comp;
+        (void)req_comp;
+        (void)scale_shift;
+        (void)sink;
+        (void)user;
+        return false;
+    }
+
     static inline const char* FailureReason() noexcept {
         return "";
     }
@@ -570,6 +598,19 @@ struct JpegLegacyBackend {
         return core::jpeg_load(&s, x, y, comp, req_comp, &ri);
     }
 
+    // Decodes at 1/(1 << scale_shift) size and hands each u8 row to `sink`
+    // as it is colour converted; no whole-image buffer is built.
+    static inline bool LoadRowsU8(const uint8_t* bytes, int byte_count,
+                                  int* x, int* y, int* comp, int req_comp, int scale_shift,
+                                  void (*sink)(void* user, int y, const uint8_t* row), void* user) noexcept {
+        core::context s{};
+        core::start_mem(&s, (const core::uc*)bytes, byte_count);
+        void* row = core::jpeg_load_rows(&s, x, y, comp, req_comp, scale_shift, sink, user);
+        if (!row) return false;
+        free(row);
+        return true;
+    }
+
     static inline void* LoadU16(const uint8_t* bytes, int byte_count,
                                 int* x, int* y, int* comp, int req_comp) noexcept {
         const int out_comp = req_comp ? req_comp : 0;
@@ -653,6 +653,24 @@ public:
         }
     }
 
+    // JPEG only: decodes at 1/(1 << scale_shift) size, 0..3, and hands each
+    // u8 row to sink(user, y, row) instead of returning the image.
+    static inline bool LoadJpegRowsU8FromMemory(const uint8_t* bytes, int byte_count,
+                                                int* x, int* y, int* comp, int req_comp, int scale_shift,
+                                                void (*sink)(void* user, int y, const uint8_t* row),
+                                                void* user) noexcept {
+        SetError("");
+        if (Detect(bytes, byte_count) != FormatTag::Jpeg) {
+            SetError("not a JPEG");
+            return false;
+        }
+        if (!JpegLegacyBackend::LoadRowsU8(bytes, byte_count, x, y, comp, req_comp, scale_shift, sink, user)) {
+            SetErrorOr(JpegLegacyBackend::FailureReason(), "JPEG decode failed");
+            return false;
+        }
+        return true;
+    }
+
     static inline void ImageFree(void* p) noexcept {
         free(p);
     }
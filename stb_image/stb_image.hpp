@@ -5,6 +5,7 @@
 #include <stdint.h>
 #include <string.h>
 
+#include "../stb_allocator/stb_allocator.hpp"
 #include "detail/backend.hpp"
 
 namespace stbi {
@@ -32,6 +33,11 @@ struct DecodeOptions {
     uint8_t desired_channels{};
     SampleType sample_type{ SampleType::U8 };
     bool flip_vertically{};
+    // JPEG only: decode at 1/(1 << jpeg_scale_log2) size (0..3) by reducing
+    // each 8x8 block at IDCT time. Other formats ignore it.
+    uint8_t jpeg_scale_log2{};
+    // Working memory for Plan and Decode; nullptr uses stb::GetAllocator().
+    const stb::Allocator* allocator{};
 };
 
 struct ImagePlan {
@@ -43,10 +49,16 @@ struct ImagePlan {
     uint8_t channels_in_file{};
     uint8_t output_channels{};
     uint8_t source_bits_per_channel{};
+    uint8_t jpeg_scale_log2{};
     size_t pixel_bytes{};
     size_t scratch_bytes{};
+    const stb::Allocator* allocator{};  // from DecodeOptions
 };
 
+// Receives decoded row `y` (plan.width * plan.output_channels samples of
+// plan.sample_type); `row` is only valid during the call.
+using RowSink = void (*)(void* user, uint32_t y, const void* row);
+
 struct BatchPlanSummary {
     uint32_t image_count{};
     uint32_t max_width{};
@@ -206,6 +218,8 @@ static inline bool plan_impl(Format required,
                              ImagePlan& out_plan) noexcept {
     if (!bytes || byte_count == 0) return false;
     if (options.desired_channels > 4) return false;
+    stb::ScopedAllocator scope(options.allocator);
+    if (options.jpeg_scale_log2 > 3) return false;
 
     int len = 0;
     if (!to_int_len(byte_count, len)) return false;
@@ -220,6 +234,10 @@ static inline bool plan_impl(Format required,
     const uint8_t out_comp = options.desired_channels ? options.desired_channels : (uint8_t)comp;
     if (out_comp == 0 || out_comp > 4) return false;
 
+    const uint8_t scale = fmt == Format::Jpeg ? options.jpeg_scale_log2 : (uint8_t)0;
+    x = (int)(((uint32_t)x + (1u << scale) - 1u) >> scale);
+    y = (int)(((uint32_t)y + (1u << scale) - 1u) >> scale);
+
     size_t pix_bytes = 0;
     if (!pixel_bytes((uint32_t)x, (uint32_t)y, out_comp, options.sample_type, pix_bytes)) return false;
 
@@ -239,11 +257,65 @@ static inline bool plan_impl(Format required,
     out_plan.channels_in_file = (uint8_t)comp;
     out_plan.output_channels = out_comp;
     out_plan.source_bits_per_channel = src_bits;
+    out_plan.jpeg_scale_log2 = scale;
     out_plan.pixel_bytes = pix_bytes;
     out_plan.scratch_bytes = 0;
+    out_plan.allocator = options.allocator;
+    // JPEG rows are converted from u8 one at a time for DecodeRows.
+    if (fmt == Format::Jpeg && options.sample_type != SampleType::U8) {
+        if (!row_bytes(out_plan, out_plan.scratch_bytes)) return false;
+    }
     return true;
 }
 
+static inline void convert_row_u8(const uint8_t* src, size_t count, SampleType type, void* dst) noexcept {
+    if (type == SampleType::U8) {
+        memcpy(dst, src, count);
+    } else if (type == SampleType::U16) {
+        uint16_t* d = (uint16_t*)dst;
+        for (size_t i = 0; i < count; ++i) d[i] = (uint16_t)((uint16_t(src[i]) << 8) | uint16_t(src[i]));
+    } else {
+        float* d = (float*)dst;
+        for (size_t i = 0; i < count; ++i) d[i] = (float)src[i] / 255.0f;
+    }
+}
+
+// Where the JPEG row decoder puts each row: into `pixels` (whole image) or
+// through `row` to `sink`.
+struct JpegRowTarget {
+    const ImagePlan* plan{};
+    uint8_t* pixels{};
+    size_t stride{};
+    void* row{};
+    RowSink sink{};
+    void* user{};
+};
+
+static inline void jpeg_row(void* user, int y, const uint8_t* row) noexcept {
+    const JpegRowTarget& t = *(const JpegRowTarget*)user;
+    const size_t count = (size_t)t.plan->width * t.plan->output_channels;
+    if (t.pixels) {
+        const uint32_t dy = t.plan->flip_vertically ? t.plan->height - 1u - (uint32_t)y : (uint32_t)y;
+        convert_row_u8(row, count, t.plan->sample_type, t.pixels + (size_t)dy * t.stride);
+    } else if (t.plan->sample_type == SampleType::U8) {
+        t.sink(t.user, (uint32_t)y, row);
+    } else {
+        convert_row_u8(row, count, t.plan->sample_type, t.row);
+        t.sink(t.user, (uint32_t)y, t.row);
+    }
+}
+
+static inline bool decode_jpeg_rows(const uint8_t* bytes, int len, const ImagePlan& plan,
+                                    JpegRowTarget& target) noexcept {
+    target.plan = &plan;
+    int x = 0, y = 0, comp = 0;
+    if (!core::ImageBackend::LoadJpegRowsU8FromMemory(bytes, len, &x, &y, &comp, (int)plan.output_channels,
+                                                      (int)plan.jpeg_scale_log2, jpeg_row, &target)) {
+        return false;
+    }
+    return (uint32_t)x == plan.width && (uint32_t)y == plan.height && (uint8_t)comp == plan.channels_in_file;
+}
+
 static inline bool decode_impl(Format required,
                                const uint8_t* bytes,
                                size_t byte_count,
@@ -264,6 +336,13 @@ static inline bool decode_impl(Format required,
     int len = 0;
     if (!to_int_len(byte_count, len)) return false;
 
+    stb::ScopedAllocator scope(plan.allocator);
+    if (plan.format == Format::Jpeg && plan.jpeg_scale_log2) {
+        JpegRowTarget target;
+        target.pixels = (uint8_t*)out_pixels;
+        return row_bytes(plan, target.stride) && decode_jpeg_rows(bytes, len, plan, target);
+    }
+
     int x = 0, y = 0, comp = 0;
     void* decoded = nullptr;
     if (plan.sample_type == SampleType::U8) {
@@ -296,6 +375,55 @@ static inline bool decode_impl(Format required,
     return true;
 }
 
+static inline bool decode_rows_impl(const uint8_t* bytes,
+                                    size_t byte_count,
+                                    const ImagePlan& plan,
+                                    void* scratch_mem,
+                                    size_t scratch_bytes,
+                                    RowSink sink,
+                                    void* user) noexcept {
+    if (!bytes || byte_count == 0 || !sink) return false;
+    if (plan.format == Format::Unknown || plan.flip_vertically) return false;
+    if (plan.output_channels == 0 || plan.output_channels > 4) return false;
+    if (plan.scratch_bytes && (!scratch_mem || scratch_bytes < plan.scratch_bytes)) return false;
+
+    int len = 0;
+    if (!to_int_len(byte_count, len)) return false;
+
+    stb::ScopedAllocator scope(plan.allocator);
+    if (plan.format == Format::Jpeg) {
+        JpegRowTarget target;
+        target.row = scratch_mem;
+        target.sink = sink;
+        target.user = user;
+        return decode_jpeg_rows(bytes, len, plan, target);
+    }
+
+    // Other decoders produce the whole image; hand it out row by row.
+    int x = 0, y = 0, comp = 0;
+    void* decoded = nullptr;
+    if (plan.sample_type == SampleType::U8) {
+        decoded = core::ImageBackend::LoadU8FromMemory(bytes, len, &x, &y, &comp, (int)plan.output_channels);
+    } else if (plan.sample_type == SampleType::U16) {
+        decoded = core::ImageBackend::LoadU16FromMemory(bytes, len, &x, &y, &comp, (int)plan.output_channels);
+    } else {
+        decoded = core::ImageBackend::LoadF32FromMemory(bytes, len, &x, &y, &comp, (int)plan.output_channels);
+    }
+    if (!decoded) return false;
+
+    size_t stride = 0;
+    const bool ok = (x > 0 && y > 0 &&
+                     (uint32_t)x == plan.width &&
+                     (uint32_t)y == plan.height &&
+                     (uint8_t)comp == plan.channels_in_file &&
+                     row_bytes(plan, stride));
+    if (ok) {
+        for (uint32_t r = 0; r < plan.height; ++r) sink(user, r, (const uint8_t*)decoded + (size_t)r * stride);
+    }
+    core::ImageBackend::ImageFree(decoded);
+    return ok;
+}
+
 } // namespace detail
 
 static inline size_t sample_bytes(SampleType type) noexcept {
@@ -310,6 +438,19 @@ inline const char* failure_reason() noexcept {
     return detail::core::ImageBackend::FailureReason();
 }
 
+// Largest jpeg_scale_log2 that keeps a JPEG at least min_width x min_height,
+// for a plan made without scaling. 0 for other formats.
+inline uint8_t JpegScaleFor(const ImagePlan& plan, uint32_t min_width, uint32_t min_height) noexcept {
+    if (plan.format != Format::Jpeg || plan.jpeg_scale_log2) return 0;
+    uint8_t s = 0;
+    while (s < 3) {
+        const uint32_t d = 2u << s;
+        if ((plan.width + d - 1u) / d < min_width || (plan.height + d - 1u) / d < min_height) break;
+        ++s;
+    }
+    return s;
+}
+
 inline bool Plan(const uint8_t* bytes, size_t byte_count, const DecodeOptions& options, ImagePlan& out_plan) noexcept {
     return detail::plan_impl(Format::Unknown, bytes, byte_count, options, out_plan);
 }
@@ -346,6 +487,15 @@ inline bool Decode(const uint8_t* bytes, size_t byte_count, const ImagePlan& pla
                    void* out_pixels, size_t out_bytes) noexcept {
     return detail::decode_impl(Format::Unknown, bytes, byte_count, plan, scratch_mem, scratch_bytes, out_pixels, out_bytes);
 }
+// Hands the image to sink(user, y, row) top to bottom instead of writing
+// it out. JPEG rows come straight from colour conversion, so no full-size
+// interleaved image is ever built; other formats decode whole first.
+// `scratch_mem` needs plan.scratch_bytes; flip_vertically is not supported.
+inline bool DecodeRows(const uint8_t* bytes, size_t byte_count, const ImagePlan& plan,
+                       void* scratch_mem, size_t scratch_bytes,
+                       RowSink sink, void* user) noexcept {
+    return detail::decode_rows_impl(bytes, byte_count, plan, scratch_mem, scratch_bytes, sink, user);
+}
 inline bool DecodePng(const uint8_t* bytes, size_t byte_count, const ImagePlan& plan,
                       void* scratch_mem, size_t scratch_bytes,
                       void* out_pixels, size_t out_bytes) noexcept {
@@ -415,6 +565,11 @@ struct Decoder {
                        void* out_pixels, size_t out_bytes) const noexcept {
         return stbi::Decode(_bytes, _byte_count, plan, scratch_mem, scratch_bytes, out_pixels, out_bytes);
     }
+    inline bool DecodeRows(const ImagePlan& plan,
+                           void* scratch_mem, size_t scratch_bytes,
+                           RowSink sink, void* user) const noexcept {
+        return stbi::DecodeRows(_bytes, _byte_count, plan, scratch_mem, scratch_bytes, sink, user);
+    }
 
     inline bool PlanPng(const DecodeOptions& options, ImagePlan& out_plan) const noexcept { return stbi::PlanPng(_bytes, _byte_count, options, out_plan); }
     inline bool PlanBmp(const DecodeOptions& options, ImagePlan& out_plan) const noexcept { return stbi::PlanBmp(_bytes, _byte_count, options, out_plan); }
@@ -0,0 +1,2346 @@
+/*
+MIT License
+Copyright (c) 2017 Sean Barrett
+Copyright (c) 2025 setbe
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+of the Software, and to permit persons to whom the Software is furnished to do
+so, subject to the following conditions:
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+
+ABOUT:
+
+   Separable image resampler with a two-step, caller-memory workflow:
+
+     1. Plan(): precompute polyphase contributor tables (first input sample
+        and weights per output phase) for both axes into `plan_mem`.
+     2. Resize(): horizontal pass into a ring of float rows, vertical pass
+        out of the ring, encode to the output sample type. All working
+        memory is the caller's `scratch` (see ScratchBytes()).
+
+   No malloc, no libm, no STL. Pixels are interleaved, 1..4 channels, and
+   every channel has the same sample type (u8, u16, f32 or f16). Rows are
+   addressed by a byte stride, which may be larger than the row or negative.
+
+BUILDING:
+
+   You can #define STBIR_FREESTANDING; the header never pulls in libc, so
+   it is accepted for symmetry with the other headers and changes nothing.
+*/
+#pragma once
+// ------------------- Freestanding-friendly Includes -------------------------
+#include <stddef.h> // size_t, ptrdiff_t
+#include <stdint.h> // uint32_t
+
+// SIMD kernels. SSE2 is the x86 baseline, AVX2 is picked at runtime, NEON is
+// used whenever the target has it. #define STBIR_NO_SIMD for scalar only, or
+// STBIR_NO_AVX2 to keep AVX2 code out of the binary.
+#if !defined(STBIR_NO_SIMD)
+#   if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#       define STBIR_SSE2 1
+#       include <emmintrin.h>
+#       if !defined(STBIR_NO_AVX2) && (defined(__GNUC__) || defined(__clang__) || defined(_MSC_VER))
+#           define STBIR_AVX2 1
+#           include <immintrin.h>
+#           if defined(_MSC_VER) && !defined(__clang__)
+#               include <intrin.h> // __cpuid, _xgetbv
+#               define STBIR_AVX2_FN
+#           else
+#               include <cpuid.h>
+#               define STBIR_AVX2_FN __attribute__((target("avx2")))
+#           endif
+#       endif
+#   elif defined(__ARM_NEON) || defined(__ARM_NEON__) || defined(_M_ARM64)
+#       define STBIR_NEON 1
+#       include <arm_neon.h>
+#   endif
+#endif // STBIR_NO_SIMD
+
+namespace stbir {
+// Reconstruction kernel. Downscaling stretches the kernel by the ratio.
+// Box:        area average, radius 0.5
+// Triangle:   linear, radius 1
+// Cubic:      cubic B-spline (B=1, C=0), radius 2, smooth but soft
+// Mitchell:   Mitchell-Netravali (B=1/3, C=1/3), radius 2
+// CatmullRom: Catmull-Rom (B=0, C=1/2), radius 2, interpolating
+// Lanczos3:   windowed sinc, radius 3
+// Kaiser:     Kaiser-windowed sinc (alpha 4), radius 3, less ringing than
+//             Lanczos3; the usual choice for mip chains
+enum class Filter : uint8_t { Box, Triangle, Cubic, Mitchell, CatmullRom, Lanczos3, Kaiser };
+// How samples outside the image are read.
+// Clamp:   repeat the edge sample
+// Reflect: mirror without repeating the edge (-1 -> 1)
+// Wrap:    tile the image
+// Zero:    transparent black
+enum class Edge : uint8_t { Clamp, Reflect, Wrap, Zero };
+// Channel storage. Integer samples map [0, max] to [0, 1]; floats are passed
+// through unclamped.
+enum class Sample : uint8_t { U8, U16, F32, F16 };
+
+// Transfer function of the color channels. SRGB samples are linearized on
+// input and re-encoded on output; the alpha channel is always linear.
+enum class Color : uint8_t { Linear, SRGB };
+// Alpha handling; alpha is the last channel (2 or 4 channels).
+// None:          every channel is filtered on its own
+// Straight:      colors are premultiplied by alpha on input and divided by it
+//                on output, so transparent pixels do not bleed color
+// Premultiplied: data is already premultiplied and stays so
+enum class Alpha : uint8_t { None, Straight, Premultiplied };
+// Kernel set. Auto picks the best one the CPU runs; an explicit request falls
+// back to the best available one below it. SIMD output matches Scalar within
+// 1e-5 per float sample (summation order differs), i.e. at most one step
+// for U8/U16.
+enum class Isa : uint8_t { Auto, Scalar, SSE2, AVX2, NEON };
+
+// Bytes per channel sample.
+static inline uint32_t sample_bytes(Sample s) noexcept {
+    return s == Sample::U8 ? 1u : (s == Sample::F32 ? 4u : 2u);
+}
+
+struct ResizeInput {
+    uint32_t in_w = 0, in_h = 0;
+    uint32_t out_w = 0, out_h = 0;
+    uint32_t channels = 4;          // 1..4, interleaved
+    Sample   in_type = Sample::U8;
+    Sample   out_type = Sample::U8;
+    Filter   filter_x = Filter::CatmullRom;
+    Filter   filter_y = Filter::CatmullRom;
+    Edge     edge_x = Edge::Clamp;
+    Edge     edge_y = Edge::Clamp;
+    Color    color = Color::Linear;
+    Alpha    alpha = Alpha::None;
+    Isa      isa = Isa::Auto;
+};
+
+// Contributor table for one axis. Output sample o reads `taps` input samples
+// starting at First(o) with Weights(o). The weights repeat every `phases`
+// outputs (out / gcd(in, out)), while the first sample advances by `step`.
+struct AxisPlan {
+    uint32_t in_size = 0, out_size = 0;
+    uint32_t taps = 0;        // weights per output, zero padded to the widest phase
+    uint32_t phases = 0;
+    uint32_t step = 0;        // input samples per phase period (in / gcd)
+    uint32_t pad_lo = 0;      // samples read before 0
+    uint32_t pad_hi = 0;      // samples read at or after in_size
+    Filter   filter = Filter::Box;
+    Edge     edge = Edge::Clamp;
+    const int32_t* first = nullptr;   // [phases]
+    const float*   weights = nullptr; // [phases * taps], each row sums to 1
+
+    int32_t First(uint32_t o) const noexcept {
+        return first[o % phases] + (int32_t)((o / phases) * step);
+    }
+    const float* Weights(uint32_t o) const noexcept {
+        return weights + (size_t)(o % phases) * taps;
+    }
+};
+
+// Integer weights for the u8 fixed-point path. Plan() fills this when both
+// axes are Box or Triangle downscales by a whole factor of 1..4, which make
+// every output use the same small-integer contributor row per axis. The sum
+// of wy[k] * (sum of wx[j] * u8) is exact, and the output is that sum divided
+// by `den` with round-half-up.
+struct FixedPlan {
+    bool     on = false;
+    bool     narrow = false;  // every sum fits 16 bits; divide by mul/shift
+    uint16_t wx[8] = {}, wy[8] = {};
+    uint32_t den = 0;         // (sum of wx) * (sum of wy)
+    uint16_t mul = 0;         // v / den == (v * mul) >> (16 + shift); 0: den is 2^shift or divide
+    uint8_t  shift = 0;
+};
+
+struct ResizePlan {
+    AxisPlan x, y;
+    uint32_t channels = 0;
+    Sample   in_type = Sample::U8;
+    Sample   out_type = Sample::U8;
+    Color    color = Color::Linear;
+    Alpha    alpha = Alpha::None;
+    Isa      isa = Isa::Scalar;     // resolved, never Auto
+    const float* srgb_lut = nullptr; // [256] u8 sRGB -> linear, U8 + SRGB input only
+    // Horizontal weights expanded per channel for the SIMD kernels:
+    // xw[phase * xw_stride + k * channels + c] = x.Weights(phase)[k], zero
+    // padded to xw_stride. Null for Scalar.
+    const float* xw = nullptr;
+    uint32_t xw_stride = 0;
+    FixedPlan fixed;                // u8 Box / Triangle N:1 fast path
+    size_t   scratch_bytes = 0;
+};
+
+// ============================================================================
+//
+//   MATH
+//
+// ============================================================================
+static inline float fabs_(float v) noexcept { return v < 0.f ? -v : v; }
+
+static inline double floor_(double v) noexcept {
+    const double t = (double)(int64_t)v;
+    return t > v ? t - 1.0 : t;
+}
+static inline double ceil_(double v) noexcept {
+    const double t = (double)(int64_t)v;
+    return t < v ? t + 1.0 : t;
+}
+
+// sin(pi * x) for any x: reduce to r in [-0.5, 0.5], odd Taylor series, |err| < 1e-7.
+static inline float sin_pi_(float x) noexcept {
+    const double n = floor_((double)x + 0.5);
+    const float r = (float)((double)x - n);
+    const float a = 3.14159265358979f * r;
+    const float a2 = a * a;
+    const float s = a * (1.f + a2 * (-1.f / 6.f + a2 * (1.f / 120.f + a2 * (-1.f / 5040.f +
+                    a2 * (1.f / 362880.f - a2 * (1.f / 39916800.f))))));
+    return ((int64_t)n & 1) ? -s : s;
+}
+
+static inline uint32_t gcd_(uint32_t a, uint32_t b) noexcept {
+    while (b) { const uint32_t t = a % b; a = b; b = t; }
+    return a;
+}
+
+static inline uint16_t half_from_float(float f) noexcept {
+    uint32_t x = 0;
+    const uint8_t* src = (const uint8_t*)&f;
+    uint8_t* dst = (uint8_t*)&x;
+    for (int i = 0; i < 4; ++i) dst[i] = src[i];
+
+    const uint32_t sign = (x >> 16) & 0x8000u;
+    const uint32_t e = (x >> 23) & 0xFFu;
+    uint32_t m = x & 0x7FFFFFu;
+    if (e == 0xFFu) return (uint16_t)(sign | 0x7C00u | (m ? 0x200u : 0u)); // inf / nan
+    const int32_t he = (int32_t)e - 127 + 15;
+    if (he >= 31) return (uint16_t)(sign | 0x7C00u);                        // overflow: inf
+    if (he <= 0) {                                                           // subnormal / zero
+        if (he < -10) return (uint16_t)sign;
+        m |= 0x800000u;
+        const uint32_t shift = (uint32_t)(14 - he);
+        uint32_t hm = m >> shift;
+        const uint32_t rem = m & ((1u << shift) - 1u), half = 1u << (shift - 1u);
+        if (rem > half || (rem == half && (hm & 1u))) ++hm;
+        return (uint16_t)(sign | hm);
+    }
+    uint32_t h = sign | ((uint32_t)he << 10) | (m >> 13);
+    const uint32_t rem = m & 0x1FFFu;
+    if (rem > 0x1000u || (rem == 0x1000u && (h & 1u))) ++h; // carry may round up to inf
+    return (uint16_t)h;
+}
+static inline float float_from_half(uint16_t h) noexcept {
+    const uint32_t sign = (uint32_t)(h & 0x8000u) << 16;
+    uint32_t e = (h >> 10) & 0x1Fu;
+    uint32_t m = h & 0x3FFu;
+    uint32_t x;
+    if (e == 0x1Fu) x = sign | 0x7F800000u | (m << 13);
+    else if (e) x = sign | ((e + 112u) << 23) | (m << 13);
+    else if (!m) x = sign;
+    else { // subnormal: normalize
+        e = 113u;
+        while (!(m & 0x400u)) { m <<= 1; --e; }
+        x = sign | (e << 23) | ((m & 0x3FFu) << 13);
+    }
+    float f = 0.f;
+    const uint8_t* src = (const uint8_t*)&x;
+    uint8_t* dst = (uint8_t*)&f;
+    for (int i = 0; i < 4; ++i) dst[i] = src[i];
+    return f;
+}
+
+// ============================================================================
+//
+//   COLOR
+//
+// ============================================================================
+static inline uint32_t bits_of_(float f) noexcept {
+    uint32_t u = 0;
+    const uint8_t* src = (const uint8_t*)&f;
+    uint8_t* dst = (uint8_t*)&u;
+    for (int i = 0; i < 4; ++i) dst[i] = src[i];
+    return u;
+}
+static inline float float_of_(uint32_t u) noexcept {
+    float f = 0.f;
+    const uint8_t* src = (const uint8_t*)&u;
+    uint8_t* dst = (uint8_t*)&f;
+    for (int i = 0; i < 4; ++i) dst[i] = src[i];
+    return f;
+}
+
+// log2 for x > 0: exponent plus ln(m) = 2 atanh((m-1)/(m+1)) with m in
+// [0.707, 1.414), |err| < 1e-7. The SIMD versions below do the same float
+// operations in the same order.
+static inline float log2_(float x) noexcept {
+    const uint32_t u = bits_of_(x);
+    float e = (float)((int32_t)((u >> 23) & 0xFFu) - 127);
+    float m = float_of_((u & 0x7FFFFFu) | 0x3F800000u);
+    if (m > 1.41421356f) { m = m * 0.5f; e = e + 1.f; }
+    const float t = (m - 1.f) / (m + 1.f), t2 = t * t;
+    const float ln = 2.f * t * (1.f + t2 * (1.f / 3.f + t2 * (1.f / 5.f + t2 * (1.f / 7.f + t2 * (1.f / 9.f)))));
+    return e + ln * 1.44269504f;
+}
+
+// 2^p for p in [-126, 127]: 2^round(p) times a Taylor series of e^(f ln 2),
+// |f| <= 0.5, rel err < 1e-8.
+static inline float exp2_(float p) noexcept {
+    p = p > -126.f ? (p < 127.f ? p : 127.f) : -126.f;
+    const float h = p + 0.5f;
+    int32_t n = (int32_t)h;
+    if ((float)n > h) --n;                     // floor
+    const float a = (p - (float)n) * 0.693147181f;
+    const float e = 1.f + a * (1.f + a * (1.f / 2.f + a * (1.f / 6.f + a * (1.f / 24.f +
+                    a * (1.f / 120.f + a * (1.f / 720.f + a * (1.f / 5040.f)))))));
+    return e * float_of_((uint32_t)(n + 127) << 23);
+}
+
+static inline float srgb_to_linear(float c) noexcept {
+    if (c <= 0.04045f) return c * (1.f / 12.92f);
+    return exp2_(2.4f * log2_((c + 0.055f) * (1.f / 1.055f)));
+}
+static inline float linear_to_srgb(float l) noexcept {
+    if (l <= 0.0031308f) return l * 12.92f;
+    return 1.055f * exp2_((1.f / 2.4f) * log2_(l)) - 0.055f;
+}
+
+// ============================================================================
+//
+//   CPU
+//
+// ============================================================================
+#if STBIR_AVX2
+// AVX2 and OS support for the YMM state.
+static inline bool cpu_has_avx2_() noexcept {
+#   if defined(_MSC_VER) && !defined(__clang__)
+    int r[4];
+    __cpuid(r, 0);
+    if (r[0] < 7) return false;
+    __cpuid(r, 1);
+    if (!(r[2] & (1 << 27)) || !(r[2] & (1 << 28))) return false; // OSXSAVE, AVX
+    if ((_xgetbv(0) & 6) != 6) return false;
+    __cpuidex(r, 7, 0);
+    return (r[1] & (1 << 5)) != 0;
+#   else
+    unsigned a = 0, b = 0, c = 0, d = 0;
+    if (!__get_cpuid(0, &a, &b, &c, &d) || a < 7) return false;
+    __cpuid(1, a, b, c, d);
+    if (!(c & (1u << 27)) || !(c & (1u << 28))) return false;      // OSXSAVE, AVX
+    unsigned lo = 0, hi = 0;
+    __asm__ volatile("xgetbv" : "=a"(lo), "=d"(hi) : "c"(0));
+    if ((lo & 6u) != 6u) return false;
+    __cpuid_count(7, 0, a, b, c, d);
+    return (b & (1u << 5)) != 0;
+#   endif
+}
+#endif
+
+static inline Isa detect_isa_() noexcept {
+#if STBIR_NEON
+    return Isa::NEON;
+#elif STBIR_SSE2
+#   if STBIR_AVX2
+    if (cpu_has_avx2_()) return Isa::AVX2;
+#   endif
+    return Isa::SSE2;
+#else
+    return Isa::Scalar;
+#endif
+}
+
+static inline Isa resolve_isa_(Isa want) noexcept {
+    const Isa best = detect_isa_();
+    if (want == Isa::Auto) return best;
+    if (want == best || want == Isa::Scalar) return want;
+    if (want == Isa::AVX2 && best == Isa::SSE2) return Isa::SSE2;
+    if (want == Isa::SSE2 && best == Isa::AVX2) return Isa::SSE2;
+    return Isa::Scalar;
+}
+
+// Floats per lane group of a kernel; 0 for Scalar.
+static inline uint32_t isa_width_(Isa isa) noexcept {
+    return isa == Isa::AVX2 ? 8u : (isa == Isa::Scalar || isa == Isa::Auto ? 0u : 4u);
+}
+
+// Floats per expanded horizontal weight row: taps * channels rounded up to
+// whole lcm(channels, vw) blocks, so every block maps lanes to the same channels.
+static constexpr uint32_t xw_stride_(uint32_t ch, uint32_t taps, uint32_t vw) noexcept {
+    return (taps * ch + (ch == 3 ? 3 * vw : vw) - 1) / (ch == 3 ? 3 * vw : vw) * (ch == 3 ? 3 * vw : vw);
+}
+
+// ============================================================================
+//
+//   KERNELS
+//
+// ============================================================================
+static inline float filter_radius(Filter f) noexcept {
+    switch (f) {
+    case Filter::Box:      return 0.5f;
+    case Filter::Triangle: return 1.f;
+    case Filter::Lanczos3: return 3.f;
+    case Filter::Kaiser:   return 3.f;
+    default:               return 2.f;
+    }
+}
+
+// Mitchell-Netravali family, |x| < 2.
+static inline float cubic_bc_(float x, float b, float c) noexcept {
+    x = fabs_(x);
+    const float x2 = x * x, x3 = x2 * x;
+    if (x < 1.f)
+        return ((12.f - 9.f * b - 6.f * c) * x3 + (-18.f + 12.f * b + 6.f * c) * x2 + (6.f - 2.f * b)) * (1.f / 6.f);
+    if (x < 2.f)
+        return ((-b - 6.f * c) * x3 + (6.f * b + 30.f * c) * x2 + (-12.f * b - 48.f * c) * x + (8.f * b + 24.f * c)) * (1.f / 6.f);
+    return 0.f;
+}
+
+static inline float sinc_(float x) noexcept {
+    if (fabs_(x) < 1e-6f) return 1.f;
+    return sin_pi_(x) / (3.14159265358979f * x);
+}
+
+// Modified Bessel function I0(z), from zz = z * z (power series, converges
+// fast for the small arguments the Kaiser window uses).
+static inline float bessel_i0_(float zz) noexcept {
+    const float q = zz * 0.25f;
+    float sum = 1.f, term = 1.f;
+    for (int k = 1; k < 32 && term > sum * 1e-9f; ++k) {
+        term *= q / (float)(k * k);
+        sum += term;
+    }
+    return sum;
+}
+
+// Kaiser window over radius 3: I0(a * sqrt(1 - t^2)) / I0(a), a = 4.
+static inline float kaiser_(float x) noexcept {
+    const float t = x * (1.f / 3.f);
+    if (fabs_(t) >= 1.f) return 0.f;
+    const float alpha = 4.f;
+    return bessel_i0_(alpha * alpha * (1.f - t * t)) / bessel_i0_(alpha * alpha);
+}
+
+// Kernel value at distance x, in filter units (radius filter_radius(f)).
+// Box is handled by coverage in axis_phase_ and never reaches here.
+static inline float filter_eval(Filter f, float x) noexcept {
+    switch (f) {
+    case Filter::Triangle:   { const float a = fabs_(x); return a < 1.f ? 1.f - a : 0.f; }
+    case Filter::Cubic:      return cubic_bc_(x, 1.f, 0.f);
+    case Filter::Mitchell:   return cubic_bc_(x, 1.f / 3.f, 1.f / 3.f);
+    case Filter::CatmullRom: return cubic_bc_(x, 0.f, 0.5f);
+    case Filter::Lanczos3:   return fabs_(x) < 3.f ? sinc_(x) * sinc_(x * (1.f / 3.f)) : 0.f;
+    case Filter::Kaiser:     return sinc_(x) * kaiser_(x);
+    default:                 return fabs_(x) < 0.5f ? 1.f : 0.f;
+    }
+}
+
+// ============================================================================
+//
+//   CONTRIBUTORS
+//
+// ============================================================================
+// Input sample `n` (possibly outside [0, size)) after the edge rule;
+// -1 means "reads as zero".
+static inline int32_t edge_index(int32_t n, int32_t size, Edge e) noexcept {
+    if (n >= 0 && n < size) return n;
+    switch (e) {
+    case Edge::Zero:  return -1;
+    case Edge::Wrap:  { const int32_t m = n % size; return m < 0 ? m + size : m; }
+    case Edge::Reflect: {
+        if (size == 1) return 0;
+        const int32_t period = 2 * (size - 1);
+        int32_t m = n % period;
+        if (m < 0) m += period;
+        return m < size ? m : period - m;
+    }
+    default: return n < 0 ? 0 : size - 1;
+    }
+}
+
+// Weights for output `o` of one axis. Writes up to `cap` normalized weights
+// into `w` (if non-null), trimmed to the first/last nonzero tap. Returns the
+// tap count, 0 if `cap` is too small.
+static uint32_t axis_phase_(uint32_t in, uint32_t out, Filter f, uint32_t o,
+                            float* w, uint32_t cap, int32_t& first) noexcept {
+    const double ratio = (double)in / (double)out;         // input samples per output
+    const double center = ((double)o + 0.5) * ratio - 0.5;
+    const double stretch = ratio > 1.0 ? ratio : 1.0;
+    const double radius = (double)filter_radius(f) * stretch;
+    // Box takes input pixel coverage [i-0.5, i+0.5] so its reach is half a sample wider.
+    const double reach = f == Filter::Box ? radius + 0.5 : radius;
+    const int32_t lo = (int32_t)floor_(center - reach) + 1;
+    const int32_t hi = (int32_t)ceil_(center + reach) - 1;
+
+    int32_t nz_lo = hi + 1, nz_hi = lo - 1;
+    float sum = 0.f;
+    for (int32_t i = lo; i <= hi; ++i) {
+        float v;
+        if (f == Filter::Box) {
+            const double a = (double)i - 0.5 > center - radius ? (double)i - 0.5 : center - radius;
+            const double b = (double)i + 0.5 < center + radius ? (double)i + 0.5 : center + radius;
+            v = b > a ? (float)(b - a) : 0.f;
+        } else {
+            v = filter_eval(f, (float)(((double)i - center) / stretch));
+        }
+        if (v != 0.f) {
+            if (i < nz_lo) nz_lo = i;
+            nz_hi = i;
+        }
+        sum += v;
+        if (w && i - lo < (int32_t)cap) w[i - lo] = v;
+    }
+    if (nz_lo > nz_hi) { nz_lo = (int32_t)floor_(center + 0.5); nz_hi = nz_lo; } // degenerate: nearest
+    const uint32_t n = (uint32_t)(nz_hi - nz_lo + 1);
+    first = nz_lo;
+    if (!w) return n;
+    if (n > cap || (uint32_t)(hi - lo + 1) > cap) return 0;
+
+    const float inv = sum != 0.f ? 1.f / sum : 1.f;
+    const uint32_t shift = (uint32_t)(nz_lo - lo);
+    if (sum == 0.f) { w[0] = 1.f; for (uint32_t k = 1; k < cap; ++k) w[k] = 0.f; return n; }
+    for (uint32_t k = 0; k < n; ++k) w[k] = w[k + shift] * inv;
+    for (uint32_t k = n; k < cap; ++k) w[k] = 0.f;
+    return n;
+}
+
+static inline size_t align_up_(size_t v, size_t a) noexcept { return (v + (a - 1)) & ~(a - 1); }
+
+// Taps and phase count of one axis, without storing anything.
+static inline bool axis_measure_(uint32_t in, uint32_t out, Filter f,
+                                 uint32_t& taps, uint32_t& phases) noexcept {
+    if (!in || !out) return false;
+    phases = out / gcd_(in, out);
+    taps = 0;
+    for (uint32_t o = 0; o < phases; ++o) {
+        int32_t first = 0;
+        const uint32_t n = axis_phase_(in, out, f, o, nullptr, 0, first);
+        if (n > taps) taps = n;
+    }
+    return taps != 0;
+}
+
+static inline size_t axis_bytes_(uint32_t taps, uint32_t phases) noexcept {
+    return align_up_((size_t)phases * sizeof(int32_t), 16) + (size_t)phases * taps * sizeof(float);
+}
+
+// Upper bound on the untrimmed tap span of any output, i.e. the room
+// axis_phase_ needs before trimming.
+static inline uint32_t axis_span_(uint32_t in, uint32_t out, Filter f) noexcept {
+    const double ratio = (double)in / (double)out;
+    const double stretch = ratio > 1.0 ? ratio : 1.0;
+    double reach = (double)filter_radius(f) * stretch;
+    if (f == Filter::Box) reach += 0.5;
+    return (uint32_t)ceil_(2.0 * reach) + 2u;
+}
+
+// Fills `ax` from memory at `mem` (axis_bytes_ bytes). `tmp` holds
+// axis_span_ floats.
+static bool axis_build_(uint32_t in, uint32_t out, Filter f, Edge e,
+                        uint32_t taps, uint32_t phases,
+                        uint8_t* mem, float* tmp, uint32_t tmp_cap,
+                        AxisPlan& ax) noexcept {
+    int32_t* first = (int32_t*)mem;
+    float* weights = (float*)(mem + align_up_((size_t)phases * sizeof(int32_t), 16));
+    for (uint32_t o = 0; o < phases; ++o) {
+        int32_t f0 = 0;
+        const uint32_t n = axis_phase_(in, out, f, o, tmp, tmp_cap, f0);
+        if (!n || n > taps) return false;
+        first[o] = f0;
+        float* w = weights + (size_t)o * taps;
+        for (uint32_t k = 0; k < taps; ++k) w[k] = k < n ? tmp[k] : 0.f;
+    }
+    ax.in_size = in;
+    ax.out_size = out;
+    ax.taps = taps;
+    ax.phases = phases;
+    ax.step = in / gcd_(in, out);
+    ax.filter = f;
+    ax.edge = e;
+    ax.first = first;
+    ax.weights = weights;
+
+    // First(o + phases) == First(o) + step, so the lowest read is in the first
+    // period and the highest in the last.
+    int32_t lo = first[0], hi = 0;
+    for (uint32_t o = 0; o < phases; ++o) {
+        if (first[o] < lo) lo = first[o];
+        const int32_t end = ax.First(out - phases + o) + (int32_t)taps;
+        if (o == 0 || end > hi) hi = end;
+    }
+    ax.pad_lo = lo < 0 ? (uint32_t)-lo : 0u;
+    ax.pad_hi = hi > (int32_t)in ? (uint32_t)(hi - (int32_t)in) : 0u;
+    return true;
+}
+
+// ============================================================================
+//
+//   PLAN
+//
+// ============================================================================
+static inline bool input_ok_(const ResizeInput& in) noexcept {
+    return in.in_w && in.in_h && in.out_w && in.out_h &&
+           in.channels >= 1 && in.channels <= 4 &&
+           (in.alpha == Alpha::None || in.channels == 2 || in.channels == 4) &&
+           in.in_w < 0x40000000u && in.in_h < 0x40000000u &&
+           in.out_w < 0x40000000u && in.out_h < 0x40000000u;
+}
+
+struct PlanLayout {
+    uint32_t tx = 0, px = 0, ty = 0, py = 0; // taps / phases per axis
+    uint32_t span = 0;                       // axis_phase_ temporary floats
+    uint32_t xw_stride = 0;
+    Isa      isa = Isa::Scalar;
+    size_t   y_off = 0, xw_off = 0, lut_off = 0, tmp_off = 0, bytes = 0;
+    bool     lut = false;
+};
+
+// u8 sRGB input is linearized through a table, unless premultiplied (then
+// the color has to be divided by alpha before the transfer function).
+static inline bool wants_srgb_lut_(const ResizeInput& in) noexcept {
+    return in.in_type == Sample::U8 && in.color == Color::SRGB && in.alpha != Alpha::Premultiplied;
+}
+
+static inline bool plan_layout_(const ResizeInput& in, PlanLayout& l) noexcept {
+    if (!input_ok_(in)) return false;
+    if (!axis_measure_(in.in_w, in.out_w, in.filter_x, l.tx, l.px)) return false;
+    if (!axis_measure_(in.in_h, in.out_h, in.filter_y, l.ty, l.py)) return false;
+    const uint32_t sx = axis_span_(in.in_w, in.out_w, in.filter_x);
+    const uint32_t sy = axis_span_(in.in_h, in.out_h, in.filter_y);
+    l.span = sx > sy ? sx : sy;
+    l.isa = resolve_isa_(in.isa);
+    const uint32_t vw = isa_width_(l.isa);
+    l.xw_stride = vw ? xw_stride_(in.channels, l.tx, vw) : 0u;
+    l.y_off = align_up_(axis_bytes_(l.tx, l.px), 16);
+    l.xw_off = l.y_off + align_up_(axis_bytes_(l.ty, l.py), 16);
+    l.lut = wants_srgb_lut_(in);
+    l.lut_off = l.xw_off + align_up_((size_t)l.px * l.xw_stride * sizeof(float), 16);
+    l.tmp_off = l.lut_off + (l.lut ? 256u * sizeof(float) : 0u);
+    l.bytes = l.tmp_off + (size_t)l.span * sizeof(float);
+    return true;
+}
+
+// Integer form of one axis: a single phase advancing by 1..4 samples, with
+// weights that are multiples of 1/den for some den <= 64 (Box N:1 gives 1/N,
+// Triangle 2:1 gives {1,3,3,1}/8).
+static bool fixed_axis_(const AxisPlan& ax, uint16_t* w, uint32_t& den) noexcept {
+    if (ax.filter != Filter::Box && ax.filter != Filter::Triangle) return false;
+    if (ax.phases != 1 || ax.step > 4 || ax.taps > 8) return false;
+    for (uint32_t d = 1; d <= 64; ++d) {
+        uint32_t sum = 0;
+        uint32_t k = 0;
+        for (; k < ax.taps; ++k) {
+            const float v = ax.weights[k] * (float)d;
+            const uint32_t q = (uint32_t)(v + 0.5f);
+            if (fabs_(v - (float)q) > 1e-3f) break;
+            w[k] = (uint16_t)q;
+            sum += q;
+        }
+        if (k == ax.taps && sum == d) {
+            for (; k < 8; ++k) w[k] = 0;
+            den = d;
+            return true;
+        }
+    }
+    return false;
+}
+
+// Picks the rounding divide for f.den. Powers of two shift; otherwise a
+// 16-bit reciprocal is searched and checked against every sum the u8 path
+// can produce. `narrow` tells whether every sum fits 16-bit lanes.
+static void fixed_divisor_(FixedPlan& f) noexcept {
+    const uint32_t d = f.den, top = 255u * d + d / 2u;
+    f.mul = 0;
+    f.shift = 0;
+    if (!(d & (d - 1u))) {
+        while ((1u << f.shift) < d) ++f.shift;
+        f.narrow = 255u * d <= 0xFFFFu;
+        return;
+    }
+    f.narrow = false;
+    if (top > 0xFFFFu) return;
+    for (uint32_t l = 0; l < 16; ++l) {
+        const uint32_t m = (uint32_t)(((1ull << (16 + l)) + d - 1u) / d);
+        if (m > 0xFFFFu) break;
+        uint32_t v = 0;
+        while (v <= top && ((v * m) >> (16 + l)) == v / d) ++v;
+        if (v > top) {
+            f.mul = (uint16_t)m;
+            f.shift = (uint8_t)l;
+            f.narrow = true;
+            return;
+        }
+    }
+}
+
+// The fixed-point path covers u8 to u8 without a color or alpha stage.
+static inline void fixed_plan_(const ResizePlan& p, FixedPlan& f) noexcept {
+    f = FixedPlan();
+    if (p.in_type != Sample::U8 || p.out_type != Sample::U8) return;
+    if (p.color != Color::Linear || p.alpha == Alpha::Straight) return;
+    uint32_t dx = 0, dy = 0;
+    if (!fixed_axis_(p.x, f.wx, dx) || !fixed_axis_(p.y, f.wy, dy)) return;
+    f.den = dx * dy;
+    fixed_divisor_(f);
+    f.on = true;
+}
+
+// Bytes Plan() needs for the contributor tables. 0 on invalid input.
+inline size_t PlanBytes(const ResizeInput& in) noexcept {
+    PlanLayout l;
+    return plan_layout_(in, l) ? l.bytes : 0;
+}
+
+// Elements read past the padded input row by the expanded SIMD weights.
+static inline uint32_t row_slack_(const ResizePlan& p) noexcept {
+    return p.xw_stride ? p.xw_stride - p.x.taps * p.channels : 0u;
+}
+
+// Exact scratch bytes Resize() needs for `plan`:
+// ring of `y.taps` horizontally filtered rows, their row tags and pointers,
+// one decoded input row with edge padding and one output accumulation row.
+static inline size_t scratch_layout_(const ResizePlan& p, size_t* ring, size_t* tags,
+                                     size_t* rows, size_t* row, size_t* acc) noexcept {
+    const size_t ch = p.channels;
+    const size_t row_n = ((size_t)p.x.in_size + p.x.pad_lo + p.x.pad_hi) * ch + row_slack_(p);
+    const size_t ring_b = align_up_((size_t)p.y.taps * p.x.out_size * ch * sizeof(float), 16);
+    const size_t tags_b = align_up_((size_t)p.y.taps * sizeof(int32_t), 16);
+    const size_t rows_b = align_up_((size_t)p.y.taps * sizeof(float*), 16);
+    const size_t row_b  = align_up_(row_n * sizeof(float), 16);
+    const size_t acc_b  = align_up_((size_t)p.x.out_size * ch * sizeof(float), 16);
+    size_t at = 0;
+    if (ring) *ring = at;
+    at += ring_b;
+    if (tags) *tags = at;
+    at += tags_b;
+    if (rows) *rows = at;
+    at += rows_b;
+    if (row) *row = at;
+    at += row_b;
+    if (acc) *acc = at;
+    at += acc_b;
+    return at;
+}
+
+inline size_t ScratchBytes(const ResizePlan& plan) noexcept { return plan.scratch_bytes; }
+
+// Builds both contributor tables in `plan_mem`. The plan keeps pointers
+// into `plan_mem`, which must outlive it.
+inline bool Plan(const ResizeInput& in, void* plan_mem, size_t plan_bytes, ResizePlan& out) noexcept {
+    PlanLayout l;
+    if (!plan_layout_(in, l) || !plan_mem || plan_bytes < l.bytes) return false;
+
+    uint8_t* base = (uint8_t*)plan_mem;
+    float* tmp = (float*)(base + l.tmp_off);
+    ResizePlan p;
+    if (!axis_build_(in.in_w, in.out_w, in.filter_x, in.edge_x, l.tx, l.px, base, tmp, l.span, p.x)) return false;
+    if (!axis_build_(in.in_h, in.out_h, in.filter_y, in.edge_y, l.ty, l.py, base + l.y_off, tmp, l.span, p.y)) return false;
+    p.channels = in.channels;
+    p.in_type = in.in_type;
+    p.out_type = in.out_type;
+    p.color = in.color;
+    p.alpha = in.alpha;
+    p.isa = l.isa;
+    if (l.lut) {
+        float* lut = (float*)(base + l.lut_off);
+        for (uint32_t i = 0; i < 256; ++i) lut[i] = srgb_to_linear((float)i * (1.f / 255.f));
+        p.srgb_lut = lut;
+    }
+    if (l.xw_stride) {
+        float* xw = (float*)(base + l.xw_off);
+        for (uint32_t ph = 0; ph < l.px; ++ph) {
+            const float* w = p.x.Weights(ph);
+            float* d = xw + (size_t)ph * l.xw_stride;
+            for (uint32_t i = 0; i < l.xw_stride; ++i)
+                d[i] = i < l.tx * in.channels ? w[i / in.channels] : 0.f;
+        }
+        p.xw = xw;
+        p.xw_stride = l.xw_stride;
+    }
+    fixed_plan_(p, p.fixed);
+    p.scratch_bytes = scratch_layout_(p, nullptr, nullptr, nullptr, nullptr, nullptr);
+    out = p;
+    return true;
+}
+
+// ============================================================================
+//
+//   RESIZE
+//
+// ============================================================================
+static void decode_samples_(const void* src, Sample t, uint32_t count, float* dst) noexcept {
+    switch (t) {
+    case Sample::U8: {
+        const uint8_t* s = (const uint8_t*)src;
+        for (uint32_t i = 0; i < count; ++i) dst[i] = (float)s[i] * (1.f / 255.f);
+    } break;
+    case Sample::U16: {
+        const uint16_t* s = (const uint16_t*)src;
+        for (uint32_t i = 0; i < count; ++i) dst[i] = (float)s[i] * (1.f / 65535.f);
+    } break;
+    case Sample::F32: {
+        const float* s = (const float*)src;
+        for (uint32_t i = 0; i < count; ++i) dst[i] = s[i];
+    } break;
+    case Sample::F16: {
+        const uint16_t* s = (const uint16_t*)src;
+        for (uint32_t i = 0; i < count; ++i) dst[i] = float_from_half(s[i]);
+    } break;
+    }
+}
+
+// Channel index of alpha, or `channels` when there is none.
+static inline uint32_t alpha_index_(const ResizePlan& p) noexcept {
+    return p.alpha == Alpha::None ? p.channels : p.channels - 1u;
+}
+
+// Input stage: samples to linear floats, premultiplied when alpha is Straight.
+static void decode_row_(const ResizePlan& p, const void* src, uint32_t pixels, float* dst) noexcept {
+    const uint32_t ch = p.channels, ai = alpha_index_(p), count = pixels * ch;
+    if (p.srgb_lut) {
+        const uint8_t* s = (const uint8_t*)src;
+        for (uint32_t i = 0; i < count; i += ch)
+            for (uint32_t c = 0; c < ch; ++c)
+                dst[i + c] = c == ai ? (float)s[i + c] * (1.f / 255.f) : p.srgb_lut[s[i + c]];
+    } else {
+        decode_samples_(src, p.in_type, count, dst);
+        if (p.color == Color::SRGB) {
+            const bool premul = p.alpha == Alpha::Premultiplied;
+            for (uint32_t i = 0; i < count; i += ch) {
+                const float a = ai < ch ? dst[i + ai] : 1.f;
+                for (uint32_t c = 0; c < ch; ++c) {
+                    if (c == ai) continue;
+                    if (!premul) dst[i + c] = srgb_to_linear(dst[i + c]);
+                    else dst[i + c] = a > 0.f ? srgb_to_linear(dst[i + c] / a) * a : 0.f;
+                }
+            }
+        }
+    }
+    if (p.alpha == Alpha::Straight) {
+        for (uint32_t i = 0; i < count; i += ch) {
+            const float a = dst[i + ai];
+            for (uint32_t c = 0; c < ai; ++c) dst[i + c] *= a;
+        }
+    }
+}
+
+#if STBIR_SSE2
+static inline __m128 log2_sse2_(__m128 x) noexcept {
+    const __m128i u = _mm_castps_si128(x);
+    __m128 e = _mm_cvtepi32_ps(_mm_sub_epi32(_mm_and_si128(_mm_srli_epi32(u, 23), _mm_set1_epi32(0xFF)), _mm_set1_epi32(127)));
+    __m128 m = _mm_castsi128_ps(_mm_or_si128(_mm_and_si128(u, _mm_set1_epi32(0x7FFFFF)), _mm_set1_epi32(0x3F800000)));
+    const __m128 big = _mm_cmpgt_ps(m, _mm_set1_ps(1.41421356f));
+    m = _mm_or_ps(_mm_and_ps(big, _mm_mul_ps(m, _mm_set1_ps(0.5f))), _mm_andnot_ps(big, m));
+    e = _mm_add_ps(e, _mm_and_ps(big, _mm_set1_ps(1.f)));
+    const __m128 one = _mm_set1_ps(1.f);
+    const __m128 t = _mm_div_ps(_mm_sub_ps(m, one), _mm_add_ps(m, one)), t2 = _mm_mul_ps(t, t);
+    __m128 q = _mm_add_ps(_mm_set1_ps(1.f / 7.f), _mm_mul_ps(t2, _mm_set1_ps(1.f / 9.f)));
+    q = _mm_add_ps(_mm_set1_ps(1.f / 5.f), _mm_mul_ps(t2, q));
+    q = _mm_add_ps(_mm_set1_ps(1.f / 3.f), _mm_mul_ps(t2, q));
+    q = _mm_add_ps(one, _mm_mul_ps(t2, q));
+    const __m128 ln = _mm_mul_ps(_mm_mul_ps(_mm_set1_ps(2.f), t), q);
+    return _mm_add_ps(e, _mm_mul_ps(ln, _mm_set1_ps(1.44269504f)));
+}
+
+static inline __m128 exp2_sse2_(__m128 p) noexcept {
+    p = _mm_max_ps(_mm_min_ps(p, _mm_set1_ps(127.f)), _mm_set1_ps(-126.f));
+    const __m128 h = _mm_add_ps(p, _mm_set1_ps(0.5f));
+    __m128i n = _mm_cvttps_epi32(h);
+    n = _mm_add_epi32(n, _mm_castps_si128(_mm_cmpgt_ps(_mm_cvtepi32_ps(n), h))); // floor: -1 where t > h
+    const __m128 a = _mm_mul_ps(_mm_sub_ps(p, _mm_cvtepi32_ps(n)), _mm_set1_ps(0.693147181f));
+    __m128 e = _mm_add_ps(_mm_set1_ps(1.f / 720.f), _mm_mul_ps(a, _mm_set1_ps(1.f / 5040.f)));
+    e = _mm_add_ps(_mm_set1_ps(1.f / 120.f), _mm_mul_ps(a, e));
+    e = _mm_add_ps(_mm_set1_ps(1.f / 24.f), _mm_mul_ps(a, e));
+    e = _mm_add_ps(_mm_set1_ps(1.f / 6.f), _mm_mul_ps(a, e));
+    e = _mm_add_ps(_mm_set1_ps(1.f / 2.f), _mm_mul_ps(a, e));
+    e = _mm_add_ps(_mm_set1_ps(1.f), _mm_mul_ps(a, e));
+    e = _mm_add_ps(_mm_set1_ps(1.f), _mm_mul_ps(a, e));
+    const __m128 scale = _mm_castsi128_ps(_mm_slli_epi32(_mm_add_epi32(n, _mm_set1_epi32(127)), 23));
+    return _mm_mul_ps(e, scale);
+}
+
+// linear_to_srgb on four lanes, lanes set in `keep` pass through (alpha).
+static inline __m128 linear_to_srgb_sse2_(__m128 l, __m128 keep) noexcept {
+    const __m128 lo = _mm_mul_ps(l, _mm_set1_ps(12.92f));
+    const __m128 pw = exp2_sse2_(_mm_mul_ps(_mm_set1_ps(1.f / 2.4f), log2_sse2_(l)));
+    const __m128 hi = _mm_sub_ps(_mm_mul_ps(_mm_set1_ps(1.055f), pw), _mm_set1_ps(0.055f));
+    const __m128 lin = _mm_cmple_ps(l, _mm_set1_ps(0.0031308f));
+    const __m128 v = _mm_or_ps(_mm_and_ps(lin, lo), _mm_andnot_ps(lin, hi));
+    return _mm_or_ps(_mm_and_ps(keep, l), _mm_andnot_ps(keep, v));
+}
+#endif
+
+// Output stage before quantization, in place: divide out Straight alpha and
+// re-encode sRGB colors.
+static void finish_row_(const ResizePlan& p, float* v, uint32_t pixels) noexcept {
+    const uint32_t ch = p.channels, ai = alpha_index_(p), count = pixels * ch;
+    if (p.alpha == Alpha::Straight) {
+        for (uint32_t i = 0; i < count; i += ch) {
+            const float a = v[i + ai];
+            const float inv = a > 1e-9f ? 1.f / a : 0.f;
+            for (uint32_t c = 0; c < ai; ++c) v[i + c] *= inv;
+        }
+    }
+    if (p.color != Color::SRGB) return;
+    if (p.alpha == Alpha::Premultiplied) {
+        for (uint32_t i = 0; i < count; i += ch) {
+            const float a = v[i + ai];
+            for (uint32_t c = 0; c < ai; ++c)
+                v[i + c] = a > 0.f ? linear_to_srgb(v[i + c] / a) * a : 0.f;
+        }
+        return;
+    }
+    uint32_t i = 0;
+#if STBIR_SSE2
+    if (p.isa == Isa::SSE2 || p.isa == Isa::AVX2) {
+        // with alpha (2 or 4 channels) every 4 lanes start on channel 0,
+        // so one pass-through mask fits the whole row
+        const uint32_t m = ai < ch ? (ch == 4 ? 0x8u : 0xAu) : 0u;
+        const __m128 keep = _mm_castsi128_ps(_mm_set_epi32(m & 8u ? -1 : 0, m & 4u ? -1 : 0,
+                                                           m & 2u ? -1 : 0, m & 1u ? -1 : 0));
+        for (; i + 4 <= count; i += 4)
+            _mm_storeu_ps(v + i, linear_to_srgb_sse2_(_mm_loadu_ps(v + i), keep));
+    }
+#endif
+    for (; i < count; ++i)
+        if (i % ch != ai) v[i] = linear_to_srgb(v[i]);
+}
+
+static inline uint8_t encode_u8_(float v) noexcept {
+    v = v > 0.f ? (v < 1.f ? v : 1.f) : 0.f;   // also maps NaN to 0
+    return (uint8_t)(v * 255.f + 0.5f);
+}
+
+#if STBIR_SSE2
+// Same rounding as encode_u8_; max(NaN, 0) is 0 as well.
+static void encode_u8_sse2_(const float* src, uint32_t count, uint8_t* d) noexcept {
+    const __m128 zero = _mm_setzero_ps(), one = _mm_set1_ps(1.f);
+    const __m128 k255 = _mm_set1_ps(255.f), half = _mm_set1_ps(0.5f);
+    uint32_t i = 0;
+    for (; i + 16 <= count; i += 16) {
+        __m128i q[4];
+        for (int j = 0; j < 4; ++j) {
+            __m128 v = _mm_min_ps(_mm_max_ps(_mm_loadu_ps(src + i + 4 * j), zero), one);
+            q[j] = _mm_cvttps_epi32(_mm_add_ps(_mm_mul_ps(v, k255), half));
+        }
+        const __m128i lo = _mm_packs_epi32(q[0], q[1]), hi = _mm_packs_epi32(q[2], q[3]);
+        _mm_storeu_si128((__m128i*)(d + i), _mm_packus_epi16(lo, hi));
+    }
+    for (; i < count; ++i) d[i] = encode_u8_(src[i]);
+}
+#endif
+
+static void encode_samples_(Isa isa, const float* src, uint32_t count, Sample t, void* dst) noexcept {
+    switch (t) {
+    case Sample::U8: {
+        uint8_t* d = (uint8_t*)dst;
+#if STBIR_SSE2
+        if (isa != Isa::Scalar) { encode_u8_sse2_(src, count, d); break; }
+#endif
+        (void)isa;
+        for (uint32_t i = 0; i < count; ++i) d[i] = encode_u8_(src[i]);
+    } break;
+    case Sample::U16: {
+        uint16_t* d = (uint16_t*)dst;
+        for (uint32_t i = 0; i < count; ++i) {
+            float v = src[i];
+            v = v > 0.f ? (v < 1.f ? v : 1.f) : 0.f;
+            d[i] = (uint16_t)(v * 65535.f + 0.5f);
+        }
+    } break;
+    case Sample::F32: {
+        float* d = (float*)dst;
+        for (uint32_t i = 0; i < count; ++i) d[i] = src[i];
+    } break;
+    case Sample::F16: {
+        uint16_t* d = (uint16_t*)dst;
+        for (uint32_t i = 0; i < count; ++i) d[i] = half_from_float(src[i]);
+    } break;
+    }
+}
+
+// Output stage: `src` (scratch, modified in place) to output samples.
+static void encode_row_(const ResizePlan& p, float* src, uint32_t pixels, void* dst) noexcept {
+    finish_row_(p, src, pixels);
+    encode_samples_(p.isa, src, pixels * p.channels, p.out_type, dst);
+}
+
+// u8 input stays u8 through the horizontal pass on SIMD kernels, which
+// widen to float in registers instead of decoding the row first. sRGB and
+// Straight alpha need the float input stage.
+static inline bool fused_u8_(const ResizePlan& p) noexcept {
+    return p.in_type == Sample::U8 && p.xw != nullptr &&
+           p.color == Color::Linear && p.alpha != Alpha::Straight;
+}
+
+// Fills the edge padding around an already decoded row body and zeroes the
+// SIMD slack after it.
+template <class T>
+static void pad_row_(const ResizePlan& p, T* body) noexcept {
+    const uint32_t ch = p.channels;
+    const AxisPlan& ax = p.x;
+    const int32_t n = (int32_t)ax.in_size;
+    for (int32_t i = -(int32_t)ax.pad_lo; i < 0; ++i) {
+        const int32_t s = edge_index(i, n, ax.edge);
+        for (uint32_t c = 0; c < ch; ++c) body[i * (int32_t)ch + (int32_t)c] = s < 0 ? (T)0 : body[s * (int32_t)ch + (int32_t)c];
+    }
+    for (int32_t i = n; i < n + (int32_t)ax.pad_hi; ++i) {
+        const int32_t s = edge_index(i, n, ax.edge);
+        for (uint32_t c = 0; c < ch; ++c) body[i * (int32_t)ch + (int32_t)c] = s < 0 ? (T)0 : body[s * (int32_t)ch + (int32_t)c];
+    }
+    T* slack = body + (size_t)(ax.in_size + ax.pad_hi) * ch;
+    for (uint32_t i = 0, e = row_slack_(p); i < e; ++i) slack[i] = (T)0;
+}
+
+// Loads input row `src_row` into `row` (in_size + pads samples, plus slack):
+// as u8 when fused_u8_, as float otherwise.
+static void load_row_(const ResizePlan& p, const uint8_t* src_row, void* row) noexcept {
+    const uint32_t ch = p.channels;
+    if (fused_u8_(p)) {
+        uint8_t* body = (uint8_t*)row + (size_t)p.x.pad_lo * ch;
+        for (uint32_t i = 0, e = p.x.in_size * ch; i < e; ++i) body[i] = src_row[i];
+        pad_row_(p, body);
+    } else {
+        float* body = (float*)row + (size_t)p.x.pad_lo * ch;
+        decode_row_(p, src_row, p.x.in_size, body);
+        pad_row_(p, body);
+    }
+}
+
+// Walks the outputs of one axis without a division per sample.
+struct PhaseWalk {
+    const AxisPlan& ax;
+    uint32_t phase = 0;
+    int32_t  base = 0;
+    explicit PhaseWalk(const AxisPlan& a) noexcept : ax(a) {}
+    int32_t First() const noexcept { return ax.first[phase] + base; }
+    void Next() noexcept {
+        if (++phase == ax.phases) { phase = 0; base += (int32_t)ax.step; }
+    }
+};
+
+template <uint32_t CH>
+static void horizontal_ch_(const AxisPlan& ax, const float* body, float* out) noexcept {
+    const uint32_t taps = ax.taps;
+    PhaseWalk pw(ax);
+    for (uint32_t o = 0; o < ax.out_size; ++o, pw.Next()) {
+        const float* s = body + (ptrdiff_t)pw.First() * CH;
+        const float* w = ax.weights + (size_t)pw.phase * taps;
+        float acc[CH];
+        for (uint32_t c = 0; c < CH; ++c) acc[c] = 0.f;
+        for (uint32_t k = 0; k < taps; ++k)
+            for (uint32_t c = 0; c < CH; ++c) acc[c] += w[k] * s[k * CH + c];
+        for (uint32_t c = 0; c < CH; ++c) out[o * CH + c] = acc[c];
+    }
+}
+
+static inline uint32_t load_u32_(const uint8_t* p) noexcept {
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+#if STBIR_SSE2
+struct Sse2Ops {
+    typedef __m128 V;
+    static V zero() noexcept { return _mm_setzero_ps(); }
+    static V set1(float v) noexcept { return _mm_set1_ps(v); }
+    static V load(const float* p) noexcept { return _mm_loadu_ps(p); }
+    static V load(const uint8_t* p) noexcept {
+        const __m128i z = _mm_setzero_si128();
+        const __m128i b = _mm_cvtsi32_si128((int)load_u32_(p));
+        return _mm_cvtepi32_ps(_mm_unpacklo_epi16(_mm_unpacklo_epi8(b, z), z));
+    }
+    static V madd(V acc, V a, V b) noexcept { return _mm_add_ps(acc, _mm_mul_ps(a, b)); }
+    static void store(float* p, V v) noexcept { _mm_storeu_ps(p, v); }
+};
+#endif
+#if STBIR_NEON
+struct NeonOps {
+    typedef float32x4_t V;
+    static V zero() noexcept { return vdupq_n_f32(0.f); }
+    static V set1(float v) noexcept { return vdupq_n_f32(v); }
+    static V load(const float* p) noexcept { return vld1q_f32(p); }
+    static V load(const uint8_t* p) noexcept {
+        const uint16x8_t h = vmovl_u8(vcreate_u8((uint64_t)load_u32_(p)));
+        return vcvtq_f32_u32(vmovl_u16(vget_low_u16(h)));
+    }
+    static V madd(V acc, V a, V b) noexcept { return vaddq_f32(acc, vmulq_f32(a, b)); }
+    static void store(float* p, V v) noexcept { vst1q_f32(p, v); }
+};
+#endif
+
+// Sums lanes t[0..L) that belong to each channel into out[0..CH).
+template <uint32_t CH, uint32_t L>
+static inline void reduce_lanes_(const float* t, float scale, float* out) noexcept {
+    for (uint32_t c = 0; c < CH; ++c) {
+        float sum = 0.f;
+        for (uint32_t i = c; i < L; i += CH) sum += t[i];
+        out[c] = sum * scale;
+    }
+}
+
+// Horizontal pass on 4-wide vectors: expanded weights times the source
+// samples, one lcm(CH, 4) block at a time. TAPS != 0 fixes the block count
+// at compile time. Src is float or (fused) u8.
+template <class O, uint32_t CH, uint32_t TAPS, class Src>
+static void h_kernel_(const ResizePlan& p, const Src* body, float* out) noexcept {
+    const uint32_t L = CH == 3 ? 12u : 4u;
+    const uint32_t NACC = L / 4u;
+    const uint32_t nb = (TAPS ? xw_stride_(CH, TAPS, 4) : p.xw_stride) / 4u;
+    const float scale = sizeof(Src) == 1 ? 1.f / 255.f : 1.f;
+    PhaseWalk pw(p.x);
+    for (uint32_t o = 0; o < p.x.out_size; ++o, pw.Next()) {
+        const Src* s = body + (ptrdiff_t)pw.First() * CH;
+        const float* w = p.xw + (size_t)pw.phase * p.xw_stride;
+        typename O::V acc[NACC];
+        for (uint32_t a = 0; a < NACC; ++a) acc[a] = O::zero();
+        for (uint32_t b = 0; b < nb; ++b)
+            acc[b % NACC] = O::madd(acc[b % NACC], O::load(w + 4 * b), O::load(s + 4 * b));
+        if (CH == 4) { // one pixel per vector, no lane reduction
+            O::store(out + (size_t)o * 4, O::madd(O::zero(), acc[0], O::set1(scale)));
+            continue;
+        }
+        float t[L];
+        for (uint32_t a = 0; a < NACC; ++a) O::store(t + 4 * a, acc[a]);
+        reduce_lanes_<CH, L>(t, scale, out + (size_t)o * CH);
+    }
+}
+
+// acc = sum_k w[k] * rows[k], two vectors per step.
+template <class O>
+static void v_kernel_(const float* const* rows, const float* w, uint32_t taps,
+                      uint32_t n, float* out) noexcept {
+    uint32_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        typename O::V a0 = O::zero(), a1 = O::zero();
+        for (uint32_t k = 0; k < taps; ++k) {
+            const typename O::V wk = O::set1(w[k]);
+            a0 = O::madd(a0, wk, O::load(rows[k] + i));
+            a1 = O::madd(a1, wk, O::load(rows[k] + i + 4));
+        }
+        O::store(out + i, a0);
+        O::store(out + i + 4, a1);
+    }
+    for (; i < n; ++i) {
+        float a = 0.f;
+        for (uint32_t k = 0; k < taps; ++k) a += w[k] * rows[k][i];
+        out[i] = a;
+    }
+}
+
+#if STBIR_AVX2
+STBIR_AVX2_FN static inline __m256 avx2_load_(const float* p) noexcept { return _mm256_loadu_ps(p); }
+STBIR_AVX2_FN static inline __m256 avx2_load_(const uint8_t* p) noexcept {
+    const __m128i b = _mm_loadl_epi64((const __m128i*)p);
+    return _mm256_cvtepi32_ps(_mm256_cvtepu8_epi32(b));
+}
+
+// h_kernel_ on 8-wide vectors, blocks of lcm(CH, 8).
+template <uint32_t CH, uint32_t TAPS, class Src>
+STBIR_AVX2_FN static void h_kernel_avx2_(const ResizePlan& p, const Src* body, float* out) noexcept {
+    const uint32_t L = CH == 3 ? 24u : 8u;
+    const uint32_t NACC = L / 8u;
+    const uint32_t nb = (TAPS ? xw_stride_(CH, TAPS, 8) : p.xw_stride) / 8u;
+    const float scale = sizeof(Src) == 1 ? 1.f / 255.f : 1.f;
+    PhaseWalk pw(p.x);
+    for (uint32_t o = 0; o < p.x.out_size; ++o, pw.Next()) {
+        const Src* s = body + (ptrdiff_t)pw.First() * CH;
+        const float* w = p.xw + (size_t)pw.phase * p.xw_stride;
+        __m256 acc[NACC];
+        for (uint32_t a = 0; a < NACC; ++a) acc[a] = _mm256_setzero_ps();
+        for (uint32_t b = 0; b < nb; ++b)
+            acc[b % NACC] = _mm256_add_ps(acc[b % NACC], _mm256_mul_ps(avx2_load_(w + 8 * b), avx2_load_(s + 8 * b)));
+        if (CH != 3) { // fold the halves; each half maps lanes to channels alike
+            const __m128 h = _mm_add_ps(_mm256_castps256_ps128(acc[0]), _mm256_extractf128_ps(acc[0], 1));
+            if (CH == 4) {
+                _mm_storeu_ps(out + (size_t)o * 4, _mm_mul_ps(h, _mm_set1_ps(scale)));
+            } else {
+                float t[4];
+                _mm_storeu_ps(t, h);
+                reduce_lanes_<CH, 4>(t, scale, out + (size_t)o * CH);
+            }
+            continue;
+        }
+        float t[L];
+        for (uint32_t a = 0; a < NACC; ++a) _mm256_storeu_ps(t + 8 * a, acc[a]);
+        reduce_lanes_<CH, L>(t, scale, out + (size_t)o * CH);
+    }
+}
+
+STBIR_AVX2_FN static void v_kernel_avx2_(const float* const* rows, const float* w, uint32_t taps,
+                                         uint32_t n, float* out) noexcept {
+    uint32_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+        __m256 a0 = _mm256_setzero_ps(), a1 = _mm256_setzero_ps();
+        for (uint32_t k = 0; k < taps; ++k) {
+            const __m256 wk = _mm256_set1_ps(w[k]);
+            a0 = _mm256_add_ps(a0, _mm256_mul_ps(wk, _mm256_loadu_ps(rows[k] + i)));
+            a1 = _mm256_add_ps(a1, _mm256_mul_ps(wk, _mm256_loadu_ps(rows[k] + i + 8)));
+        }
+        _mm256_storeu_ps(out + i, a0);
+        _mm256_storeu_ps(out + i + 8, a1);
+    }
+    for (; i < n; ++i) {
+        float a = 0.f;
+        for (uint32_t k = 0; k < taps; ++k) a += w[k] * rows[k][i];
+        out[i] = a;
+    }
+}
+#endif
+
+// Kernel families for the tap/channel dispatch below.
+#if STBIR_SSE2
+struct Sse2Family {
+    template <uint32_t CH, uint32_t TAPS, class Src>
+    static void Run(const ResizePlan& p, const Src* b, float* o) noexcept { h_kernel_<Sse2Ops, CH, TAPS>(p, b, o); }
+};
+#endif
+#if STBIR_AVX2
+struct Avx2Family {
+    template <uint32_t CH, uint32_t TAPS, class Src>
+    static void Run(const ResizePlan& p, const Src* b, float* o) noexcept { h_kernel_avx2_<CH, TAPS>(p, b, o); }
+};
+#endif
+#if STBIR_NEON
+struct NeonFamily {
+    template <uint32_t CH, uint32_t TAPS, class Src>
+    static void Run(const ResizePlan& p, const Src* b, float* o) noexcept { h_kernel_<NeonOps, CH, TAPS>(p, b, o); }
+};
+#endif
+
+// Fixed block counts for the common 2/4/6/8-tap contributor widths.
+template <class F, uint32_t CH, class Src>
+static void h_taps_(const ResizePlan& p, const Src* body, float* out) noexcept {
+    switch (p.x.taps) {
+    case 2:  F::template Run<CH, 2>(p, body, out); break;
+    case 4:  F::template Run<CH, 4>(p, body, out); break;
+    case 6:  F::template Run<CH, 6>(p, body, out); break;
+    case 8:  F::template Run<CH, 8>(p, body, out); break;
+    default: F::template Run<CH, 0>(p, body, out); break;
+    }
+}
+
+template <class F, class Src>
+static void h_simd_(const ResizePlan& p, const Src* body, float* out) noexcept {
+    switch (p.channels) {
+    case 1:  h_taps_<F, 1>(p, body, out); break;
+    case 2:  h_taps_<F, 2>(p, body, out); break;
+    case 3:  h_taps_<F, 3>(p, body, out); break;
+    default: h_taps_<F, 4>(p, body, out); break;
+    }
+}
+
+template <class F>
+static void h_family_(const ResizePlan& p, const void* body, float* out) noexcept {
+    if (fused_u8_(p)) h_simd_<F>(p, (const uint8_t*)body, out);
+    else              h_simd_<F>(p, (const float*)body, out);
+}
+
+// One horizontally filtered row from the padded row load_row_ produced.
+static void horizontal_(const ResizePlan& p, const void* row, float* out) noexcept {
+    const size_t lead = (size_t)p.x.pad_lo * p.channels * (fused_u8_(p) ? 1u : sizeof(float));
+    const void* body = (const uint8_t*)row + lead;
+    switch (p.isa) {
+#if STBIR_SSE2
+    case Isa::SSE2: h_family_<Sse2Family>(p, body, out); return;
+#endif
+#if STBIR_AVX2
+    case Isa::AVX2: h_family_<Avx2Family>(p, body, out); return;
+#endif
+#if STBIR_NEON
+    case Isa::NEON: h_family_<NeonFamily>(p, body, out); return;
+#endif
+    default: break;
+    }
+    const float* f = (const float*)body;
+    switch (p.channels) {
+    case 1:  horizontal_ch_<1>(p.x, f, out); break;
+    case 2:  horizontal_ch_<2>(p.x, f, out); break;
+    case 3:  horizontal_ch_<3>(p.x, f, out); break;
+    default: horizontal_ch_<4>(p.x, f, out); break;
+    }
+}
+
+// out = sum_k w[k] * rows[k], `n` floats per row. Same summation order on
+// every kernel, so the vertical pass itself matches Scalar bit for bit.
+static void vertical_(Isa isa, const float* const* rows, const float* w, uint32_t taps,
+                      uint32_t n, float* out) noexcept {
+    switch (isa) {
+#if STBIR_SSE2
+    case Isa::SSE2: v_kernel_<Sse2Ops>(rows, w, taps, n, out); return;
+#endif
+#if STBIR_AVX2
+    case Isa::AVX2: v_kernel_avx2_(rows, w, taps, n, out); return;
+#endif
+#if STBIR_NEON
+    case Isa::NEON: v_kernel_<NeonOps>(rows, w, taps, n, out); return;
+#endif
+    default: break;
+    }
+    for (uint32_t i = 0; i < n; ++i) out[i] = 0.f;
+    for (uint32_t k = 0; k < taps; ++k) {
+        const float wk = w[k];
+        const float* r = rows[k];
+        for (uint32_t i = 0; i < n; ++i) out[i] += wk * r[i];
+    }
+}
+
+// u8 fixed-point path (FixedPlan), vertical pass first: the y weights sum
+// the input rows of one output row into a u16 row (at most 64 * 255), which
+// is edge padded and reduced by the x weights, then divided by den with
+// round-half-up. Input rows are read in place and the horizontal pass runs
+// once per output row, so no ring is needed.
+
+// out[i] = sum_k wy[k] * rows[k][i]; null rows (Zero edge) add nothing.
+static void fixed_v_(const ResizePlan& p, const uint8_t* const* rows, uint32_t n, uint16_t* out) noexcept {
+    const uint16_t* w = p.fixed.wy;
+    const uint32_t taps = p.y.taps;
+    uint32_t i = 0;
+#if STBIR_SSE2
+    if (p.isa == Isa::SSE2 || p.isa == Isa::AVX2) {
+        const __m128i z = _mm_setzero_si128();
+        for (; i + 16 <= n; i += 16) {
+            __m128i lo = z, hi = z;
+            for (uint32_t k = 0; k < taps; ++k) {
+                if (!rows[k]) continue;
+                const __m128i v = _mm_loadu_si128((const __m128i*)(rows[k] + i));
+                const __m128i wk = _mm_set1_epi16((short)w[k]);
+                lo = _mm_add_epi16(lo, _mm_mullo_epi16(_mm_unpacklo_epi8(v, z), wk));
+                hi = _mm_add_epi16(hi, _mm_mullo_epi16(_mm_unpackhi_epi8(v, z), wk));
+            }
+            _mm_storeu_si128((__m128i*)(out + i), lo);
+            _mm_storeu_si128((__m128i*)(out + i + 8), hi);
+        }
+    }
+#endif
+    for (; i < n; ++i) {
+        uint32_t acc = 0;
+        for (uint32_t k = 0; k < taps; ++k)
+            if (rows[k]) acc += (uint32_t)w[k] * rows[k][i];
+        out[i] = (uint16_t)acc;
+    }
+}
+
+static inline uint8_t fixed_div_(const FixedPlan& f, uint32_t v) noexcept {
+    v += f.den / 2u;
+    if (f.mul) return (uint8_t)((v * f.mul) >> (16 + f.shift));
+    if (!(f.den & (f.den - 1u))) return (uint8_t)(v >> f.shift);
+    return (uint8_t)(v / f.den);
+}
+
+template <uint32_t CH>
+static void fixed_h_ch_(const ResizePlan& p, const uint16_t* body, uint8_t* out) noexcept {
+    const uint16_t* w = p.fixed.wx;
+    const uint32_t taps = p.x.taps, step = p.x.step;
+    const uint16_t* s = body + (ptrdiff_t)p.x.first[0] * CH;
+    for (uint32_t o = 0; o < p.x.out_size; ++o, s += step * CH) {
+        uint32_t acc[CH];
+        for (uint32_t c = 0; c < CH; ++c) acc[c] = 0;
+        for (uint32_t k = 0; k < taps; ++k)
+            for (uint32_t c = 0; c < CH; ++c) acc[c] += (uint32_t)w[k] * s[k * CH + c];
+        for (uint32_t c = 0; c < CH; ++c) out[o * CH + c] = fixed_div_(p.fixed, acc[c]);
+    }
+}
+
+#if STBIR_SSE2
+static inline void store_u32_(uint8_t* p, uint32_t v) noexcept {
+    p[0] = (uint8_t)v; p[1] = (uint8_t)(v >> 8); p[2] = (uint8_t)(v >> 16); p[3] = (uint8_t)(v >> 24);
+}
+
+// fixed_div_ on eight 16-bit sums; narrow plans only.
+static inline __m128i fixed_div_sse2_(const FixedPlan& f, __m128i v) noexcept {
+    if (f.mul) {
+        v = _mm_mulhi_epu16(_mm_add_epi16(v, _mm_set1_epi16((short)(f.den / 2u))), _mm_set1_epi16((short)f.mul));
+        return _mm_srl_epi16(v, _mm_cvtsi32_si128(f.shift));
+    }
+    if (!f.shift) return v;
+    // (v + 2^(s-1)) >> s as avg(v >> (s-1), 0), which cannot overflow
+    return _mm_avg_epu16(_mm_srl_epi16(v, _mm_cvtsi32_si128(f.shift - 1)), _mm_setzero_si128());
+}
+
+// Sums of horizontally adjacent pixels for 1, 2 or 4 channels: `lo` / `hi`
+// hold 16 consecutive u16 samples (below 32768), the result their 8 pair sums.
+template <uint32_t CH>
+static inline __m128i pair_sums_sse2_(__m128i lo, __m128i hi) noexcept {
+    if (CH == 1) {
+        const __m128i one = _mm_set1_epi16(1);
+        return _mm_packs_epi32(_mm_madd_epi16(lo, one), _mm_madd_epi16(hi, one));
+    }
+    if (CH == 2) {
+        const __m128i a = _mm_unpacklo_epi64(_mm_shuffle_epi32(lo, _MM_SHUFFLE(2, 0, 2, 0)), _mm_shuffle_epi32(hi, _MM_SHUFFLE(2, 0, 2, 0)));
+        const __m128i b = _mm_unpacklo_epi64(_mm_shuffle_epi32(lo, _MM_SHUFFLE(3, 1, 3, 1)), _mm_shuffle_epi32(hi, _MM_SHUFFLE(3, 1, 3, 1)));
+        return _mm_add_epi16(a, b);
+    }
+    return _mm_add_epi16(_mm_unpacklo_epi64(lo, hi), _mm_unpackhi_epi64(lo, hi));
+}
+
+static inline __m128i load16_(const uint16_t* p) noexcept { return _mm_loadu_si128((const __m128i*)p); }
+
+// Box 2:1 on 1, 2 or 4 channels: pair sums, 16 outputs per step.
+template <uint32_t CH>
+static void fixed_h_box2_sse2_(const ResizePlan& p, const uint16_t* body, uint8_t* out) noexcept {
+    const FixedPlan& f = p.fixed;
+    const uint32_t n = p.x.out_size * CH;
+    uint32_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+        const uint16_t* s = body + 2 * i;
+        const __m128i a = fixed_div_sse2_(f, pair_sums_sse2_<CH>(load16_(s), load16_(s + 8)));
+        const __m128i b = fixed_div_sse2_(f, pair_sums_sse2_<CH>(load16_(s + 16), load16_(s + 24)));
+        _mm_storeu_si128((__m128i*)(out + i), _mm_packus_epi16(a, b));
+    }
+    for (; i < n; ++i) {
+        const uint32_t o = i / CH, c = i - o * CH;
+        out[i] = fixed_div_(f, (uint32_t)body[(2 * o) * CH + c] + body[(2 * o + 1) * CH + c]);
+    }
+}
+
+// 1 channel, box 4:1: pair sums twice, 8 outputs per step.
+static void fixed_h1_box4_sse2_(const ResizePlan& p, const uint16_t* body, uint8_t* out) noexcept {
+    const FixedPlan& f = p.fixed;
+    const uint32_t n = p.x.out_size;
+    const __m128i one = _mm_set1_epi16(1);
+    uint32_t o = 0;
+    for (; o + 8 <= n; o += 8) {
+        const uint16_t* s = body + 4 * o;
+        __m128i q[2];
+        for (uint32_t h = 0; h < 2; ++h) {
+            const __m128 a = _mm_castsi128_ps(_mm_madd_epi16(load16_(s + 16 * h), one));
+            const __m128 b = _mm_castsi128_ps(_mm_madd_epi16(load16_(s + 16 * h + 8), one));
+            q[h] = _mm_add_epi32(_mm_castps_si128(_mm_shuffle_ps(a, b, _MM_SHUFFLE(2, 0, 2, 0))),
+                                 _mm_castps_si128(_mm_shuffle_ps(a, b, _MM_SHUFFLE(3, 1, 3, 1))));
+        }
+        const __m128i r = fixed_div_sse2_(f, _mm_packs_epi32(q[0], q[1]));
+        _mm_storel_epi64((__m128i*)(out + o), _mm_packus_epi16(r, r));
+    }
+    for (; o < n; ++o) {
+        const uint16_t* s = body + 4 * o;
+        out[o] = fixed_div_(f, (uint32_t)s[0] + s[1] + s[2] + s[3]);
+    }
+}
+
+// 1 channel, any row: each output is one madd of eight samples against the
+// zero-padded weights, four outputs reduced together. Handles sums past 16
+// bits for power-of-two den.
+static void fixed_h1_madd_sse2_(const ResizePlan& p, const uint16_t* body, uint32_t body_n, uint8_t* out) noexcept {
+    const FixedPlan& f = p.fixed;
+    const uint32_t step = p.x.step, n = p.x.out_size;
+    const int32_t f0 = p.x.first[0];
+    const __m128i w = _mm_loadu_si128((const __m128i*)f.wx);
+    const __m128i half = _mm_set1_epi32((int)(f.den / 2u)), sh = _mm_cvtsi32_si128(f.shift);
+    const bool pow2 = !(f.den & (f.den - 1u));
+    uint32_t o = 0;
+    for (; o + 4 <= n && f0 + (int32_t)((o + 3) * step) + 8 <= (int32_t)body_n; o += 4) {
+        const uint16_t* s = body + f0 + (ptrdiff_t)(o * step);
+        const __m128i a = _mm_madd_epi16(load16_(s), w);
+        const __m128i b = _mm_madd_epi16(load16_(s + step), w);
+        const __m128i c = _mm_madd_epi16(load16_(s + 2 * step), w);
+        const __m128i d = _mm_madd_epi16(load16_(s + 3 * step), w);
+        const __m128i ab = _mm_add_epi32(_mm_unpacklo_epi32(a, b), _mm_unpackhi_epi32(a, b));
+        const __m128i cd = _mm_add_epi32(_mm_unpacklo_epi32(c, d), _mm_unpackhi_epi32(c, d));
+        __m128i v = _mm_add_epi32(_mm_unpacklo_epi64(ab, cd), _mm_unpackhi_epi64(ab, cd));
+        if (pow2) {
+            v = _mm_srl_epi32(_mm_add_epi32(v, half), sh);
+            v = _mm_packs_epi32(v, v);
+        } else {
+            // narrow: bias into i16 range for the pack, then back to u16
+            const __m128i bias = _mm_set1_epi32(0x8000);
+            v = _mm_add_epi16(_mm_packs_epi32(_mm_sub_epi32(v, bias), _mm_sub_epi32(v, bias)), _mm_set1_epi16(-0x8000));
+            v = fixed_div_sse2_(f, v);
+        }
+        store_u32_(out + o, (uint32_t)_mm_cvtsi128_si32(_mm_packus_epi16(v, v)));
+    }
+    for (const uint16_t* s = body + f0 + (ptrdiff_t)(o * step); o < n; ++o, s += step) {
+        uint32_t acc = 0;
+        for (uint32_t k = 0; k < p.x.taps; ++k) acc += (uint32_t)f.wx[k] * s[k];
+        out[o] = fixed_div_(f, acc);
+    }
+}
+
+// 3 or 4 channels: two output pixels per vector, four u16 lanes per pixel.
+// For 3 channels lane 3 is junk; its output byte is overwritten by the next
+// pixel, so the last output is left to the scalar tail.
+template <uint32_t CH>
+static void fixed_h_px_sse2_(const ResizePlan& p, const uint16_t* body, uint8_t* out) noexcept {
+    const FixedPlan& f = p.fixed;
+    const uint32_t taps = p.x.taps, step = p.x.step, n = p.x.out_size;
+    const uint32_t simd_n = CH == 3 ? n - 1 : n;
+    __m128i w[8];
+    for (uint32_t k = 0; k < taps; ++k) w[k] = _mm_set1_epi16((short)f.wx[k]);
+    const uint16_t* s = body + (ptrdiff_t)p.x.first[0] * CH;
+    uint32_t o = 0;
+    for (; o + 2 <= simd_n; o += 2, s += 2 * CH * step) {
+        __m128i acc = _mm_setzero_si128();
+        for (uint32_t k = 0; k < taps; ++k) {
+            const __m128i a = _mm_loadl_epi64((const __m128i*)(s + CH * k));
+            const __m128i b = _mm_loadl_epi64((const __m128i*)(s + CH * (k + step)));
+            acc = _mm_add_epi16(acc, _mm_mullo_epi16(_mm_unpacklo_epi64(a, b), w[k]));
+        }
+        const __m128i r = fixed_div_sse2_(f, acc);
+        const __m128i px = _mm_packus_epi16(r, r);
+        if (CH == 4) {
+            _mm_storel_epi64((__m128i*)(out + (size_t)o * 4), px);
+        } else {
+            store_u32_(out + (size_t)o * 3, (uint32_t)_mm_cvtsi128_si32(px));
+            store_u32_(out + (size_t)o * 3 + 3, (uint32_t)_mm_cvtsi128_si32(_mm_srli_epi64(px, 32)));
+        }
+    }
+    for (; o < n; ++o, s += CH * step)
+        for (uint32_t c = 0; c < CH; ++c) {
+            uint32_t acc = 0;
+            for (uint32_t k = 0; k < taps; ++k) acc += (uint32_t)f.wx[k] * s[CH * k + c];
+            out[o * CH + c] = fixed_div_(f, acc);
+        }
+}
+
+// fixed_h_px_sse2_ for sums past 16 bits (Triangle 4:1 on both axes, den a
+// power of two): two taps per madd into 32-bit lanes, one pixel per vector.
+template <uint32_t CH>
+static void fixed_h_px_wide_sse2_(const ResizePlan& p, const uint16_t* body, uint8_t* out) noexcept {
+    const FixedPlan& f = p.fixed;
+    const uint32_t taps = p.x.taps, step = p.x.step, n = p.x.out_size;
+    const uint32_t simd_n = CH == 3 ? n - 1 : n;
+    const __m128i z = _mm_setzero_si128();
+    const __m128i half = _mm_set1_epi32((int)(f.den / 2u)), sh = _mm_cvtsi32_si128(f.shift);
+    __m128i w[4];
+    for (uint32_t k = 0; k < taps; k += 2)
+        w[k / 2] = _mm_set1_epi32((int)(f.wx[k] | (uint32_t)f.wx[k + 1] << 16));
+    const uint16_t* s = body + (ptrdiff_t)p.x.first[0] * CH;
+    uint32_t o = 0;
+    for (; o < simd_n; ++o, s += CH * step) {
+        __m128i acc = z;
+        for (uint32_t k = 0; k < taps; k += 2) {
+            const __m128i a = _mm_loadl_epi64((const __m128i*)(s + CH * k));
+            const __m128i b = k + 1 < taps ? _mm_loadl_epi64((const __m128i*)(s + CH * (k + 1))) : z;
+            acc = _mm_add_epi32(acc, _mm_madd_epi16(_mm_unpacklo_epi16(a, b), w[k / 2]));
+        }
+        acc = _mm_srl_epi32(_mm_add_epi32(acc, half), sh);
+        acc = _mm_packs_epi32(acc, acc);
+        store_u32_(out + (size_t)o * CH, (uint32_t)_mm_cvtsi128_si32(_mm_packus_epi16(acc, acc)));
+    }
+    for (; o < n; ++o, s += CH * step)
+        for (uint32_t c = 0; c < CH; ++c) {
+            uint32_t acc = 0;
+            for (uint32_t k = 0; k < taps; ++k) acc += (uint32_t)f.wx[k] * s[CH * k + c];
+            out[o * CH + c] = fixed_div_(f, acc);
+        }
+}
+#endif
+
+static inline bool fixed_box2_(const AxisPlan& ax) noexcept {
+    return ax.taps == 2 && ax.step == 2 && ax.first[0] == 0;
+}
+
+// Horizontal pass and divide: u16 sums at `body` (padded, `body_n` readable
+// samples) to one u8 output row.
+static void fixed_h_(const ResizePlan& p, const uint16_t* body, uint32_t body_n, uint8_t* out) noexcept {
+#if STBIR_SSE2
+    if (p.isa == Isa::SSE2 || p.isa == Isa::AVX2) {
+        const FixedPlan& f = p.fixed;
+        const AxisPlan& ax = p.x;
+        if (f.narrow) {
+            const bool box2 = fixed_box2_(ax);
+            switch (p.channels) {
+            case 1:
+                if (box2) { fixed_h_box2_sse2_<1>(p, body, out); return; }
+                if (ax.taps == 4 && ax.step == 4 && ax.first[0] == 0) { fixed_h1_box4_sse2_(p, body, out); return; }
+                fixed_h1_madd_sse2_(p, body, body_n, out);
+                return;
+            case 2:
+                if (box2) { fixed_h_box2_sse2_<2>(p, body, out); return; }
+                break;
+            case 3:
+                fixed_h_px_sse2_<3>(p, body, out);
+                return;
+            default:
+                if (box2) fixed_h_box2_sse2_<4>(p, body, out);
+                else      fixed_h_px_sse2_<4>(p, body, out);
+                return;
+            }
+        } else if (!(f.den & (f.den - 1u)) && p.channels != 2) {
+            switch (p.channels) {
+            case 1:  fixed_h1_madd_sse2_(p, body, body_n, out); break;
+            case 3:  fixed_h_px_wide_sse2_<3>(p, body, out); break;
+            default: fixed_h_px_wide_sse2_<4>(p, body, out); break;
+            }
+            return;
+        }
+    }
+#endif
+    (void)body_n;
+    switch (p.channels) {
+    case 1:  fixed_h_ch_<1>(p, body, out); break;
+    case 2:  fixed_h_ch_<2>(p, body, out); break;
+    case 3:  fixed_h_ch_<3>(p, body, out); break;
+    default: fixed_h_ch_<4>(p, body, out); break;
+    }
+}
+
+#if STBIR_SSE2
+// Box 2:1 along y with x 1:1, straight from two input rows: the 2-tap mean
+// (a + b + 1) >> 1 is exactly _mm_avg_epu8.
+static void fixed_avg_rows_sse2_(const uint8_t* a, const uint8_t* b, uint32_t n, uint8_t* out) noexcept {
+    uint32_t i = 0;
+    for (; i + 16 <= n; i += 16)
+        _mm_storeu_si128((__m128i*)(out + i), _mm_avg_epu8(_mm_loadu_si128((const __m128i*)(a + i)),
+                                                           _mm_loadu_si128((const __m128i*)(b + i))));
+    for (; i < n; ++i) out[i] = (uint8_t)((a[i] + b[i] + 1) >> 1);
+}
+
+// Box 2:1 on both axes (4 taps), straight from two input rows: the 2x2 sums
+// s <= 1020 round as avg(s >> 1, 0) == (s + 2) >> 2.
+template <uint32_t CH>
+static void fixed_box2x2_rows_sse2_(const uint8_t* a, const uint8_t* b, uint32_t n, uint8_t* out) noexcept {
+    const __m128i z = _mm_setzero_si128();
+    uint32_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+        __m128i r[2];
+        for (uint32_t h = 0; h < 2; ++h) {
+            const __m128i va = _mm_loadu_si128((const __m128i*)(a + 2 * i + 16 * h));
+            const __m128i vb = _mm_loadu_si128((const __m128i*)(b + 2 * i + 16 * h));
+            const __m128i lo = _mm_add_epi16(_mm_unpacklo_epi8(va, z), _mm_unpacklo_epi8(vb, z));
+            const __m128i hi = _mm_add_epi16(_mm_unpackhi_epi8(va, z), _mm_unpackhi_epi8(vb, z));
+            r[h] = _mm_avg_epu16(_mm_srli_epi16(pair_sums_sse2_<CH>(lo, hi), 1), z);
+        }
+        _mm_storeu_si128((__m128i*)(out + i), _mm_packus_epi16(r[0], r[1]));
+    }
+    for (; i < n; ++i) {
+        const uint32_t o = i / CH, c = i - o * CH, x0 = (2 * o) * CH + c, x1 = x0 + CH;
+        out[i] = (uint8_t)((a[x0] + a[x1] + b[x0] + b[x1] + 2u) >> 2);
+    }
+}
+
+// Runs the 2-tap / 4-tap box kernels above when they apply.
+static bool fixed_box2_rows_(const ResizePlan& p, uint32_t out_y0, uint32_t out_y1,
+                             const uint8_t* in, ptrdiff_t in_stride,
+                             uint8_t* out, ptrdiff_t out_stride) noexcept {
+    if ((p.isa != Isa::SSE2 && p.isa != Isa::AVX2) || !fixed_box2_(p.y)) return false;
+    const bool copy_x = p.x.taps == 1 && p.x.step == 1;
+    if (!copy_x && (!fixed_box2_(p.x) || p.channels == 3)) return false;
+    const uint32_t n = p.x.out_size * p.channels;
+    for (uint32_t oy = out_y0; oy < out_y1; ++oy) {
+        const uint8_t* a = in + (ptrdiff_t)(2 * oy) * in_stride;
+        uint8_t* o = out + (ptrdiff_t)oy * out_stride;
+        if (copy_x) { fixed_avg_rows_sse2_(a, a + in_stride, n, o); continue; }
+        switch (p.channels) {
+        case 1:  fixed_box2x2_rows_sse2_<1>(a, a + in_stride, n, o); break;
+        case 2:  fixed_box2x2_rows_sse2_<2>(a, a + in_stride, n, o); break;
+        default: fixed_box2x2_rows_sse2_<4>(a, a + in_stride, n, o); break;
+        }
+    }
+    return true;
+}
+#endif
+
+// ResizeRows on the fixed-point path. Uses the row pointers and the input
+// row of the float layout: one padded u16 row fits in the float row.
+static void fixed_rows_(const ResizePlan& plan, uint32_t out_y0, uint32_t out_y1,
+                        const void* in, ptrdiff_t in_stride,
+                        void* out, ptrdiff_t out_stride, uint8_t* mem) noexcept {
+#if STBIR_SSE2
+    if (fixed_box2_rows_(plan, out_y0, out_y1, (const uint8_t*)in, in_stride, (uint8_t*)out, out_stride)) return;
+#endif
+    size_t rows_off = 0, row_off = 0;
+    scratch_layout_(plan, nullptr, nullptr, &rows_off, &row_off, nullptr);
+    const uint8_t** rows = (const uint8_t**)(mem + rows_off);
+    const AxisPlan& ax = plan.x;
+    const AxisPlan& ay = plan.y;
+    const uint32_t ch = plan.channels;
+    uint16_t* body = (uint16_t*)(mem + row_off) + (size_t)ax.pad_lo * ch;
+    const uint32_t body_n = (ax.in_size + ax.pad_hi) * ch;
+    const int32_t in_h = (int32_t)ay.in_size;
+    for (uint32_t oy = out_y0; oy < out_y1; ++oy) {
+        const int32_t f0 = ay.First(oy);
+        for (uint32_t k = 0; k < ay.taps; ++k) {
+            const int32_t sy = edge_index(f0 + (int32_t)k, in_h, ay.edge);
+            rows[k] = sy < 0 ? nullptr : (const uint8_t*)in + (ptrdiff_t)sy * in_stride;
+        }
+        fixed_v_(plan, rows, ax.in_size * ch, body);
+        pad_row_(plan, body);
+        fixed_h_(plan, body, body_n, (uint8_t*)out + (ptrdiff_t)oy * out_stride);
+    }
+}
+
+// Runs both passes for output rows [out_y0, out_y1). `in` / `out` are the
+// whole images; `in_stride` / `out_stride` are bytes between rows and may be
+// negative. `scratch` must hold ScratchBytes(plan) bytes. Rows depend only
+// on the plan, never on the range, so any partition of the output gives the
+// same pixels.
+inline bool ResizeRows(const ResizePlan& plan, uint32_t out_y0, uint32_t out_y1,
+                       const void* in, ptrdiff_t in_stride,
+                       void* out, ptrdiff_t out_stride,
+                       void* scratch, size_t scratch_bytes) noexcept {
+    if (!plan.channels || !plan.x.weights || !plan.y.weights || !in || !out) return false;
+    if (!scratch || scratch_bytes < plan.scratch_bytes) return false;
+    if (out_y0 > out_y1 || out_y1 > plan.y.out_size) return false;
+    if (plan.fixed.on) {
+        fixed_rows_(plan, out_y0, out_y1, in, in_stride, out, out_stride, (uint8_t*)scratch);
+        return true;
+    }
+
+    size_t ring_off = 0, tags_off = 0, rows_off = 0, row_off = 0, acc_off = 0;
+    scratch_layout_(plan, &ring_off, &tags_off, &rows_off, &row_off, &acc_off);
+    uint8_t* mem = (uint8_t*)scratch;
+    float* ring = (float*)(mem + ring_off);
+    int32_t* tags = (int32_t*)(mem + tags_off);
+    const float** rows = (const float**)(mem + rows_off);
+    void* row = mem + row_off;
+    float* acc = (float*)(mem + acc_off);
+
+    const AxisPlan& ay = plan.y;
+    const uint32_t cap = ay.taps;
+    const uint32_t width = plan.x.out_size * plan.channels;
+    const int32_t in_h = (int32_t)ay.in_size;
+    // Every tag is below the first virtual row read, so the ring starts empty.
+    for (uint32_t k = 0; k < cap; ++k) tags[k] = INT32_MIN;
+
+    // Ring slots are keyed by virtual row (before the edge rule), so a window
+    // is always `taps` consecutive keys and never collides with itself.
+    PhaseWalk pw(ay);
+    pw.phase = out_y0 % ay.phases;
+    pw.base = (int32_t)((out_y0 / ay.phases) * ay.step);
+    for (uint32_t oy = out_y0; oy < out_y1; ++oy, pw.Next()) {
+        const int32_t f0 = pw.First();
+        for (uint32_t k = 0; k < cap; ++k) {
+            const int32_t v = f0 + (int32_t)k;
+            int32_t slot = v % (int32_t)cap;
+            if (slot < 0) slot += (int32_t)cap;
+            float* dst = ring + (size_t)slot * width;
+            rows[k] = dst;
+            if (tags[slot] == v) continue;
+            const int32_t sy = edge_index(v, in_h, ay.edge);
+            if (sy < 0) {
+                for (uint32_t i = 0; i < width; ++i) dst[i] = 0.f;
+            } else {
+                load_row_(plan, (const uint8_t*)in + (ptrdiff_t)sy * in_stride, row);
+                horizontal_(plan, row, dst);
+            }
+            tags[slot] = v;
+        }
+        vertical_(plan.isa, rows, ay.weights + (size_t)pw.phase * cap, cap, width, acc);
+        encode_row_(plan, acc, plan.x.out_size, (uint8_t*)out + (ptrdiff_t)oy * out_stride);
+    }
+    return true;
+}
+
+// Runs both passes over the whole image.
+inline bool Resize(const ResizePlan& plan,
+                   const void* in, ptrdiff_t in_stride,
+                   void* out, ptrdiff_t out_stride,
+                   void* scratch, size_t scratch_bytes) noexcept {
+    return ResizeRows(plan, 0, plan.y.out_size, in, in_stride, out, out_stride, scratch, scratch_bytes);
+}
+
+// ============================================================================
+//
+//   SPLITS
+//
+// ============================================================================
+// One independent band of output rows and the input rows it reads.
+// [in_y0, in_y1) is the contributor window clamped to the image; Reflect and
+// Wrap edges may also read mirrored / wrapped rows outside it.
+struct RowSplit {
+    uint32_t out_y0 = 0, out_y1 = 0;
+    uint32_t in_y0 = 0, in_y1 = 0;
+};
+
+// Per-split scratch stride: ScratchBytes plus the band's status byte,
+// rounded to a cache line, so splits never share one.
+static inline size_t split_stride_(const ResizePlan& plan) noexcept {
+    return align_up_(plan.scratch_bytes + 1, 64);
+}
+
+// Scratch for `splits` concurrent bands.
+inline size_t SplitScratchBytes(const ResizePlan& plan, uint32_t splits) noexcept {
+    return split_stride_(plan) * splits;
+}
+
+// Cuts the output rows into at most `max_splits` bands of near-equal height
+// (never empty). Returns the band count.
+inline uint32_t SplitRows(const ResizePlan& plan, uint32_t max_splits, RowSplit* out) noexcept {
+    const uint32_t h = plan.y.out_size;
+    if (!h || !max_splits || !out) return 0;
+    const uint32_t n = max_splits < h ? max_splits : h;
+    const int32_t in_h = (int32_t)plan.y.in_size;
+    for (uint32_t i = 0; i < n; ++i) {
+        RowSplit s;
+        s.out_y0 = (uint32_t)((uint64_t)h * i / n);
+        s.out_y1 = (uint32_t)((uint64_t)h * (i + 1) / n);
+        int32_t lo = plan.y.First(s.out_y0);
+        int32_t hi = plan.y.First(s.out_y1 - 1) + (int32_t)plan.y.taps;
+        lo = lo < 0 ? 0 : (lo > in_h ? in_h : lo);
+        hi = hi < lo ? lo : (hi > in_h ? in_h : hi);
+        s.in_y0 = (uint32_t)lo;
+        s.in_y1 = (uint32_t)hi;
+        out[i] = s;
+    }
+    return n;
+}
+
+// Resizes with the output cut into `splits` bands (see SplitRows), one
+// ResizeRows per band, each with its own slice of `scratch`
+// (SplitScratchBytes(plan, splits)). `parallel_for(count, job)` must call
+// job(i) once for every i in [0, count), on any threads, and return when all
+// are done. Output is identical for any split count. False if any band
+// failed or never ran.
+template <class ParallelFor>
+inline bool ResizeSplit(const ResizePlan& plan, uint32_t splits,
+                        const void* in, ptrdiff_t in_stride,
+                        void* out, ptrdiff_t out_stride,
+                        void* scratch, size_t scratch_bytes,
+                        ParallelFor&& parallel_for) noexcept {
+    if (!plan.channels || !in || !out || !scratch) return false;
+    if (splits > plan.y.out_size) splits = plan.y.out_size;
+    if (!splits || scratch_bytes < SplitScratchBytes(plan, splits)) return false;
+    const size_t stride = split_stride_(plan);
+    const uint32_t h = plan.y.out_size;
+    // Each band sets the status byte after its own scratch; parallel_for
+    // returning is the only synchronization needed to read them.
+    uint8_t* mem = (uint8_t*)scratch;
+    for (uint32_t i = 0; i < splits; ++i) mem[stride * i + plan.scratch_bytes] = 0;
+    auto job = [&](uint32_t i) {
+        const uint32_t y0 = (uint32_t)((uint64_t)h * i / splits);
+        const uint32_t y1 = (uint32_t)((uint64_t)h * (i + 1) / splits);
+        uint8_t* band = mem + stride * i;
+        band[plan.scratch_bytes] = ResizeRows(plan, y0, y1, in, in_stride, out, out_stride,
+                                              band, plan.scratch_bytes) ? 1 : 0;
+    };
+    parallel_for(splits, job);
+    for (uint32_t i = 0; i < splits; ++i)
+        if (!mem[stride * i + plan.scratch_bytes]) return false;
+    return true;
+}
+
+// ============================================================================
+//
+//   STREAM
+//
+// ============================================================================
+// ResizeStream memory: the ResizeRows scratch, then a zero row for Zero
+// edges, one encoded output row for sink mode and, on the fixed-point path,
+// a ring of `y.taps` raw u8 input rows (that path filters vertically first).
+static inline size_t stream_layout_(const ResizePlan& p, size_t* zero, size_t* out_row, size_t* in_ring) noexcept {
+    const size_t width = (size_t)p.x.out_size * p.channels;
+    size_t at = align_up_(p.scratch_bytes, 16);
+    if (zero) *zero = at;
+    at += align_up_(width * sizeof(float), 16);
+    if (out_row) *out_row = at;
+    at += align_up_(width * sample_bytes(p.out_type), 16);
+    if (in_ring) *in_ring = at;
+    if (p.fixed.on) at += align_up_((size_t)p.y.taps * p.x.in_size * p.channels, 16);
+    return at;
+}
+
+// Exact scratch bytes ResizeStream needs for `plan`; independent of the
+// input height.
+inline size_t StreamBytes(const ResizePlan& plan) noexcept {
+    return stream_layout_(plan, nullptr, nullptr, nullptr);
+}
+
+// Push-mode resize for input rows that arrive one at a time, top to bottom,
+// e.g. from stbi::DecodeRows. Each pushed row is filtered into a ring of
+// `y.taps` rows, and every output row whose vertical window is complete is
+// emitted right away, so the full input image never has to exist. Plans on
+// the u8 fixed-point path keep the raw input rows instead and run the same
+// kernels as ResizeRows. Pixels match Resize() exactly. Wrap is not supported on the y axis: its first
+// output rows would need the last input rows.
+struct ResizeStream {
+    using RowSink = void (*)(void* user, uint32_t y, const void* row);
+
+    // Output rows go to `out`, the whole output image.
+    bool Begin(const ResizePlan& plan, void* out, ptrdiff_t out_stride,
+               void* scratch, size_t scratch_bytes) noexcept {
+        if (!out) return false;
+        _out = (uint8_t*)out;
+        _out_stride = out_stride;
+        _sink = nullptr;
+        return begin_(plan, scratch, scratch_bytes);
+    }
+
+    // Output rows go to sink(user, y, row); `row` lives in scratch and is
+    // only valid during the call.
+    bool Begin(const ResizePlan& plan, RowSink sink, void* user,
+               void* scratch, size_t scratch_bytes) noexcept {
+        if (!sink) return false;
+        _out = nullptr;
+        _sink = sink;
+        _user = user;
+        return begin_(plan, scratch, scratch_bytes);
+    }
+
+    // Feeds input row RowsIn(), x.in_size pixels of the plan's input type,
+    // and emits the output rows it completes. False once every input row
+    // is in, or before Begin().
+    bool PushRow(const void* row) noexcept {
+        if (!_plan || !row || _in_y >= _plan->y.in_size) return false;
+        const ResizePlan& p = *_plan;
+        const uint32_t slot = _in_y % p.y.taps;
+        if (p.fixed.on) {
+            const uint32_t n = p.x.in_size * p.channels;
+            uint8_t* dst = _in_ring + (size_t)slot * n;
+            for (uint32_t i = 0; i < n; ++i) dst[i] = ((const uint8_t*)row)[i];
+        } else {
+            load_row_(p, (const uint8_t*)row, _row);
+            horizontal_(p, _row, _ring + (size_t)slot * _width);
+        }
+        _tags[slot] = (int32_t)_in_y;
+        ++_in_y;
+        return emit_();
+    }
+
+    uint32_t RowsIn() const noexcept { return _in_y; }
+    uint32_t RowsOut() const noexcept { return _out_y; }
+    bool Done() const noexcept { return _plan && _out_y == _plan->y.out_size; }
+
+private:
+    bool begin_(const ResizePlan& plan, void* scratch, size_t scratch_bytes) noexcept {
+        _plan = nullptr;
+        if (!plan.channels || !plan.x.weights || !plan.y.weights) return false;
+        if (plan.y.edge == Edge::Wrap) return false;
+        size_t zero_off = 0, out_off = 0, in_ring_off = 0;
+        if (!scratch || scratch_bytes < stream_layout_(plan, &zero_off, &out_off, &in_ring_off)) return false;
+
+        size_t ring_off = 0, tags_off = 0, rows_off = 0, row_off = 0, acc_off = 0;
+        scratch_layout_(plan, &ring_off, &tags_off, &rows_off, &row_off, &acc_off);
+        uint8_t* mem = (uint8_t*)scratch;
+        _ring = (float*)(mem + ring_off);
+        _tags = (int32_t*)(mem + tags_off);
+        _rows = (const float**)(mem + rows_off);
+        _row = mem + row_off;
+        _acc = (float*)(mem + acc_off);
+        _zero = (float*)(mem + zero_off);
+        _out_row = mem + out_off;
+        _in_ring = mem + in_ring_off;
+        _width = plan.x.out_size * plan.channels;
+        for (uint32_t k = 0; k < plan.y.taps; ++k) _tags[k] = -1;
+        for (uint32_t i = 0; i < _width; ++i) _zero[i] = 0.f;
+        _phase = 0;
+        _base = 0;
+        _in_y = 0;
+        _out_y = 0;
+        _plan = &plan;
+        return true;
+    }
+
+    // Emits output rows while their windows are in the ring. A window spans
+    // at most `taps` distinct input rows, and windows advance with the
+    // input, so no row still needed has been overwritten; the tags check it.
+    bool emit_() noexcept {
+        const ResizePlan& p = *_plan;
+        const AxisPlan& ay = p.y;
+        const int32_t in_h = (int32_t)ay.in_size;
+        while (_out_y < ay.out_size) {
+            const int32_t f0 = ay.first[_phase] + _base;
+            int32_t hi = -1;
+            for (uint32_t k = 0; k < ay.taps; ++k) {
+                const int32_t sy = edge_index(f0 + (int32_t)k, in_h, ay.edge);
+                if (sy > hi) hi = sy;
+            }
+            if (hi >= (int32_t)_in_y) return true;
+            // the fixed-point path keeps u8 row pointers in the same slots
+            const uint8_t** rows8 = (const uint8_t**)(void*)_rows;
+            const size_t in_n = (size_t)p.x.in_size * p.channels;
+            for (uint32_t k = 0; k < ay.taps; ++k) {
+                const int32_t sy = edge_index(f0 + (int32_t)k, in_h, ay.edge);
+                const uint32_t slot = (uint32_t)sy % ay.taps;
+                if (sy >= 0 && _tags[slot] != sy) return false;
+                if (p.fixed.on) rows8[k] = sy < 0 ? nullptr : _in_ring + slot * in_n;
+                else            _rows[k] = sy < 0 ? _zero : _ring + (size_t)slot * _width;
+            }
+            uint8_t* dst = _out ? _out + (ptrdiff_t)_out_y * _out_stride : (uint8_t*)_out_row;
+            if (p.fixed.on) {
+                // fixed_rows_ without the 2:1 box shortcuts, which give the same sums
+                const uint32_t ch = p.channels;
+                uint16_t* body = (uint16_t*)_row + (size_t)p.x.pad_lo * ch;
+                fixed_v_(p, rows8, p.x.in_size * ch, body);
+                pad_row_(p, body);
+                fixed_h_(p, body, (p.x.in_size + p.x.pad_hi) * ch, dst);
+            } else {
+                vertical_(p.isa, _rows, ay.weights + (size_t)_phase * ay.taps, ay.taps, _width, _acc);
+                encode_row_(p, _acc, p.x.out_size, dst);
+            }
+            if (!_out) _sink(_user, _out_y, _out_row);
+            ++_out_y;
+            if (++_phase == ay.phases) { _phase = 0; _base += (int32_t)ay.step; }
+        }
+        return true;
+    }
+
+    const ResizePlan* _plan{};
+    float* _ring{};
+    int32_t* _tags{};
+    const float** _rows{};
+    void* _row{};
+    float* _acc{};
+    float* _zero{};
+    void* _out_row{};
+    uint8_t* _in_ring{};
+    uint8_t* _out{};
+    ptrdiff_t _out_stride{};
+    RowSink _sink{};
+    void* _user{};
+    uint32_t _width{};
+    uint32_t _phase{};
+    int32_t _base{};
+    uint32_t _in_y{};
+    uint32_t _out_y{};
+};
+
+// ============================================================================
+//
+//   MIPS
+//
+// ============================================================================
+// Mip chain request. Level k is max(1, width >> k) x max(1, height >> k),
+// down to 1x1 or `max_levels` levels. Every level has the base's channels,
+// sample type, color and alpha mode.
+struct MipInput {
+    uint32_t width = 0, height = 0;
+    uint32_t channels = 4;          // 1..4, interleaved
+    Sample   type = Sample::U8;
+    Filter   filter = Filter::Box;  // Box or Kaiser are the usual choices
+    Edge     edge = Edge::Clamp;    // Clamp or Reflect
+    Color    color = Color::Linear;
+    Alpha    alpha = Alpha::None;
+    // > 0 keeps the fraction of pixels with alpha >= alpha_cutoff the same on
+    // every level (alpha-tested foliage, fences), by rescaling each level's
+    // alpha. Needs an alpha channel (2 or 4 channels), not Premultiplied.
+    float    alpha_cutoff = 0.f;
+    uint32_t max_levels = 0;        // 0: full chain
+    Isa      isa = Isa::Auto;
+};
+
+// One level inside the chain buffer; rows are `stride` bytes apart.
+struct MipLevel {
+    uint32_t width = 0, height = 0;
+    size_t   offset = 0, stride = 0, bytes = 0;
+};
+
+// Level layout plus one resize step per level: step[k] builds level k + 1
+// from level k. Step 0 reads the base's samples; later steps read the linear,
+// premultiplied float rows of the step before, so the chain is decoded once
+// and rounded only where it is stored.
+struct MipPlan {
+    MipLevel   level[32];
+    uint32_t   count = 0;
+    size_t     chain_bytes = 0;   // every level, level 0 (the base) first
+    size_t     scratch_bytes = 0;
+    float      alpha_cutoff = 0.f;
+    ResizePlan step[31];
+};
+
+static inline bool mip_input_ok_(const MipInput& in) noexcept {
+    if (!in.width || !in.height || in.width >= 0x40000000u || in.height >= 0x40000000u) return false;
+    if (in.channels < 1 || in.channels > 4) return false;
+    if (in.alpha != Alpha::None && in.channels != 2 && in.channels != 4) return false;
+    if (in.edge == Edge::Wrap || in.edge == Edge::Zero) return false;
+    if (in.alpha_cutoff > 0.f && ((in.channels != 2 && in.channels != 4) || in.alpha == Alpha::Premultiplied))
+        return false;
+    return true;
+}
+
+static inline uint32_t mip_count_(const MipInput& in) noexcept {
+    uint32_t n = 1;
+    while ((in.width >> n) || (in.height >> n)) ++n;
+    return in.max_levels && in.max_levels < n ? in.max_levels : n;
+}
+
+static inline uint32_t mip_size_(uint32_t d, uint32_t k) noexcept {
+    return d >> k ? d >> k : 1u;
+}
+
+// ResizeInput of step k (level k -> level k + 1).
+static inline ResizeInput mip_step_(const MipInput& in, uint32_t k) noexcept {
+    ResizeInput r;
+    r.in_w = mip_size_(in.width, k);
+    r.in_h = mip_size_(in.height, k);
+    r.out_w = mip_size_(in.width, k + 1);
+    r.out_h = mip_size_(in.height, k + 1);
+    r.channels = in.channels;
+    r.in_type = k ? Sample::F32 : in.type;
+    r.out_type = in.type;
+    r.filter_x = r.filter_y = in.filter;
+    r.edge_x = r.edge_y = in.edge;
+    r.color = k ? Color::Linear : in.color;
+    r.alpha = k ? Alpha::None : in.alpha;
+    r.isa = in.isa;
+    return r;
+}
+
+// Bytes PlanMips() needs for the contributor tables of every step. 0 on
+// invalid input; a 1x1 base needs no steps and no bytes.
+inline size_t MipPlanBytes(const MipInput& in) noexcept {
+    if (!mip_input_ok_(in)) return 0;
+    size_t at = 0;
+    for (uint32_t k = 0; k + 1 < mip_count_(in); ++k) at += align_up_(PlanBytes(mip_step_(in, k)), 16);
+    return at;
+}
+
+// Lays out the chain and plans every step in `plan_mem`, which must outlive
+// the plan. Levels are packed in order at 16-byte aligned offsets.
+inline bool PlanMips(const MipInput& in, void* plan_mem, size_t plan_bytes, MipPlan& out) noexcept {
+    if (!mip_input_ok_(in) || plan_bytes < MipPlanBytes(in)) return false;
+    const uint32_t n = mip_count_(in);
+    if (n > 1 && !plan_mem) return false;
+    const size_t px = (size_t)in.channels * sample_bytes(in.type);
+    size_t at = 0, mem = 0, scratch = 0;
+    for (uint32_t k = 0; k < n; ++k) {
+        MipLevel& l = out.level[k];
+        l.width = mip_size_(in.width, k);
+        l.height = mip_size_(in.height, k);
+        l.stride = l.width * px;
+        l.bytes = l.stride * l.height;
+        l.offset = at;
+        at = align_up_(at + l.bytes, 16);
+        if (k + 1 == n) break;
+        const ResizeInput r = mip_step_(in, k);
+        const size_t b = PlanBytes(r);
+        if (!Plan(r, (uint8_t*)plan_mem + mem, b, out.step[k])) return false;
+        // steps hand float rows down the chain: never the u8 fixed-point path
+        out.step[k].fixed = FixedPlan();
+        mem += align_up_(b, 16);
+        scratch += align_up_(ScratchBytes(out.step[k]), 64);
+    }
+    out.count = n;
+    out.chain_bytes = at;
+    out.scratch_bytes = scratch;
+    out.alpha_cutoff = in.alpha_cutoff;
+    return true;
+}
+
+inline size_t MipScratchBytes(const MipPlan& plan) noexcept { return plan.scratch_bytes; }
+
+// 2:1 box along x on float rows, the Box fast path for even widths:
+// out = (in[2o] + in[2o + 1]) * 0.5 per channel, the same value the 2-tap
+// contributor rows give.
+static void halve_row_(Isa isa, uint32_t ch, const float* in, uint32_t out_w, float* out) noexcept {
+    const uint32_t n = out_w * ch;
+    uint32_t i = 0;
+#if STBIR_SSE2
+    if (isa == Isa::SSE2 || isa == Isa::AVX2) {
+        const __m128 h = _mm_set1_ps(0.5f);
+        if (ch == 4) {
+            for (; i < n; i += 4)
+                _mm_storeu_ps(out + i, _mm_mul_ps(_mm_add_ps(_mm_loadu_ps(in + 2 * i), _mm_loadu_ps(in + 2 * i + 4)), h));
+        } else if (ch == 1) {
+            for (; i + 4 <= n; i += 4) {
+                const __m128 a = _mm_loadu_ps(in + 2 * i), b = _mm_loadu_ps(in + 2 * i + 4);
+                const __m128 even = _mm_shuffle_ps(a, b, _MM_SHUFFLE(2, 0, 2, 0));
+                const __m128 odd = _mm_shuffle_ps(a, b, _MM_SHUFFLE(3, 1, 3, 1));
+                _mm_storeu_ps(out + i, _mm_mul_ps(_mm_add_ps(even, odd), h));
+            }
+        }
+    }
+#endif
+#if STBIR_NEON
+    if (isa == Isa::NEON) {
+        const float32x4_t h = vdupq_n_f32(0.5f);
+        if (ch == 4) {
+            for (; i < n; i += 4)
+                vst1q_f32(out + i, vmulq_f32(vaddq_f32(vld1q_f32(in + 2 * i), vld1q_f32(in + 2 * i + 4)), h));
+        } else if (ch == 1) {
+            for (; i + 4 <= n; i += 4) {
+                const float32x4x2_t v = vld2q_f32(in + 2 * i);
+                vst1q_f32(out + i, vmulq_f32(vaddq_f32(v.val[0], v.val[1]), h));
+            }
+        }
+    }
+#endif
+    (void)isa;
+    for (; i < n; ++i) {
+        const uint32_t o = i / ch, c = i - o * ch;
+        out[i] = (in[(2 * o) * ch + c] + in[(2 * o + 1) * ch + c]) * 0.5f;
+    }
+}
+
+// Ring state of one step while the chain is built, like ResizeStream.
+struct MipCursor {
+    float* ring = nullptr;
+    int32_t* tags = nullptr;
+    const float** rows = nullptr;
+    void* row = nullptr;
+    float* acc = nullptr;
+    uint32_t width = 0;   // floats per filtered row
+    uint32_t phase = 0;
+    int32_t  base = 0;
+    uint32_t in_y = 0, out_y = 0;
+    bool     halve = false;
+};
+
+// Feeds row `src` of level k into step k and emits every level k + 1 row it
+// completes: first into step k + 1, then encoded into the chain. Each output
+// row goes down the chain while it is still in cache, so the base is read
+// once for all levels.
+static bool mip_push_(const MipPlan& m, MipCursor* cur, uint8_t* chain, uint32_t k, const void* src) noexcept {
+    const ResizePlan& p = m.step[k];
+    MipCursor& c = cur[k];
+    const AxisPlan& ay = p.y;
+    const uint32_t slot = c.in_y % ay.taps;
+    float* dst = c.ring + (size_t)slot * c.width;
+    if (c.halve) {
+        const float* f = (const float*)src;
+        if (k == 0) {
+            decode_row_(p, src, p.x.in_size, (float*)c.row);
+            f = (const float*)c.row;
+        }
+        halve_row_(p.isa, p.channels, f, p.x.out_size, dst);
+    } else {
+        load_row_(p, (const uint8_t*)src, c.row);
+        horizontal_(p, c.row, dst);
+    }
+    c.tags[slot] = (int32_t)c.in_y;
+    ++c.in_y;
+
+    const int32_t in_h = (int32_t)ay.in_size;
+    const MipLevel& next = m.level[k + 1];
+    while (c.out_y < ay.out_size) {
+        const int32_t f0 = ay.first[c.phase] + c.base;
+        int32_t hi = -1;
+        for (uint32_t t = 0; t < ay.taps; ++t) {
+            const int32_t sy = edge_index(f0 + (int32_t)t, in_h, ay.edge);
+            if (sy > hi) hi = sy;
+        }
+        if (hi >= (int32_t)c.in_y) return true;
+        for (uint32_t t = 0; t < ay.taps; ++t) {
+            const int32_t sy = edge_index(f0 + (int32_t)t, in_h, ay.edge);
+            const uint32_t s = (uint32_t)sy % ay.taps;
+            if (c.tags[s] != sy) return false;
+            c.rows[t] = c.ring + (size_t)s * c.width;
+        }
+        vertical_(p.isa, c.rows, ay.weights + (size_t)c.phase * ay.taps, ay.taps, c.width, c.acc);
+        if (k + 2 < m.count && !mip_push_(m, cur, chain, k + 1, c.acc)) return false;
+        encode_row_(m.step[0], c.acc, next.width, chain + next.offset + (size_t)c.out_y * next.stride);
+        ++c.out_y;
+        if (++c.phase == ay.phases) { c.phase = 0; c.base += (int32_t)ay.step; }
+    }
+    return true;
+}
+
+static inline float mip_alpha_(Sample t, const uint8_t* px, uint32_t ai) noexcept {
+    float a = 0.f;
+    decode_samples_(px + (size_t)ai * sample_bytes(t), t, 1, &a);
+    return a;
+}
+
+// Pixels of a level whose alpha is at least `ref`.
+static uint64_t mip_coverage_(const MipPlan& m, const uint8_t* chain, uint32_t k, float ref) noexcept {
+    const ResizePlan& p = m.step[0];
+    const MipLevel& l = m.level[k];
+    const uint32_t ai = p.channels - 1u, px = p.channels * sample_bytes(p.out_type);
+    uint64_t n = 0;
+    for (uint32_t y = 0; y < l.height; ++y) {
+        const uint8_t* r = chain + l.offset + (size_t)y * l.stride;
+        for (uint32_t x = 0; x < l.width; ++x) n += mip_alpha_(p.out_type, r + (size_t)x * px, ai) >= ref;
+    }
+    return n;
+}
+
+// Scales the alpha of level k so its coverage at the cutoff matches the
+// base's: bisects the alpha value `ref` that as many pixels reach, then maps
+// ref to the cutoff. Quantized alpha can only hit some coverages; the bracket
+// end closer to the target wins.
+static void mip_keep_coverage_(const MipPlan& m, uint8_t* chain, uint32_t k, double coverage) noexcept {
+    const ResizePlan& p = m.step[0];
+    const MipLevel& l = m.level[k];
+    const double want = coverage * l.width * l.height;
+    float lo = 0.f, hi = 1.f;
+    for (int i = 0; i < 16; ++i) {
+        const float mid = 0.5f * (lo + hi);
+        if ((double)mip_coverage_(m, chain, k, mid) > want) lo = mid;
+        else hi = mid;
+    }
+    const double above = (double)mip_coverage_(m, chain, k, lo) - want;
+    const double below = want - (double)mip_coverage_(m, chain, k, hi);
+    const float ref = above < below ? lo : hi;
+    const float scale = m.alpha_cutoff / (ref > 1e-6f ? ref : 1e-6f);
+    const uint32_t ai = p.channels - 1u, sb = sample_bytes(p.out_type), px = p.channels * sb;
+    for (uint32_t y = 0; y < l.height; ++y) {
+        uint8_t* r = chain + l.offset + (size_t)y * l.stride;
+        for (uint32_t x = 0; x < l.width; ++x) {
+            float a = mip_alpha_(p.out_type, r + (size_t)x * px, ai) * scale;
+            a = a < 1.f ? a : 1.f;
+            encode_samples_(Isa::Scalar, &a, 1, p.out_type, r + (size_t)x * px + (size_t)ai * sb);
+        }
+    }
+}
+
+// Builds levels 1.. of the chain from level 0, which the caller has stored
+// at plan.level[0].offset (e.g. decoded straight into `chain`). One pass over
+// the base rows drives every step; `scratch` (MipScratchBytes) holds one
+// ring per step. Box levels whose width halves exactly use a dedicated 2:1
+// horizontal kernel. Pixels match running Resize level after level on float
+// data; with U8/U16 chains each level is rounded only once, from the float
+// level above it. Steps always take the float path, so a U8 level 1 can be
+// one off from a u8 Resize() whose plan uses the fixed-point kernels.
+inline bool GenerateMips(const MipPlan& plan, void* chain, size_t chain_bytes,
+                         void* scratch, size_t scratch_bytes) noexcept {
+    if (!plan.count || !chain || chain_bytes < plan.chain_bytes) return false;
+    if (plan.count == 1) return true;
+    if (!scratch || scratch_bytes < plan.scratch_bytes) return false;
+
+    MipCursor cur[31];
+    uint8_t* mem = (uint8_t*)scratch;
+    for (uint32_t k = 0; k + 1 < plan.count; ++k) {
+        const ResizePlan& p = plan.step[k];
+        if (!p.channels || !p.x.weights || !p.y.weights) return false;
+        size_t ring = 0, tags = 0, rows = 0, row = 0, acc = 0;
+        scratch_layout_(p, &ring, &tags, &rows, &row, &acc);
+        MipCursor& c = cur[k];
+        c.ring = (float*)(mem + ring);
+        c.tags = (int32_t*)(mem + tags);
+        c.rows = (const float**)(mem + rows);
+        c.row = mem + row;
+        c.acc = (float*)(mem + acc);
+        c.width = p.x.out_size * p.channels;
+        c.halve = p.x.filter == Filter::Box && p.x.in_size == 2 * p.x.out_size;
+        for (uint32_t t = 0; t < p.y.taps; ++t) c.tags[t] = -1;
+        mem += align_up_(p.scratch_bytes, 64);
+    }
+
+    uint8_t* base = (uint8_t*)chain;
+    const MipLevel& l0 = plan.level[0];
+    const bool coverage = plan.alpha_cutoff > 0.f;
+    const uint32_t ai = plan.step[0].channels - 1u;
+    const uint32_t px = plan.step[0].channels * sample_bytes(plan.step[0].in_type);
+    uint64_t covered = 0;
+    for (uint32_t y = 0; y < l0.height; ++y) {
+        const uint8_t* row = base + l0.offset + (size_t)y * l0.stride;
+        if (coverage)
+            for (uint32_t x = 0; x < l0.width; ++x)
+                covered += mip_alpha_(plan.step[0].in_type, row + (size_t)x * px, ai) >= plan.alpha_cutoff;
+        if (!mip_push_(plan, cur, base, 0, row)) return false;
+    }
+    if (coverage) {
+        const double c0 = (double)covered / ((double)l0.width * l0.height);
+        for (uint32_t k = 1; k < plan.count; ++k) mip_keep_coverage_(plan, base, k, c0);
+    }
+    return true;
+}
+
+} // namespace stbir
+
+// ------------------- Optional std::thread parallel-for ----------------------
+// #define STBIR_STD_THREADS for stbir::StdThreads, a parallel_for for
+// ResizeSplit that runs one std::thread per job (the caller's thread takes
+// job 0). Off by default: the core header stays free of the C++ runtime.
+#if defined(STBIR_STD_THREADS)
+#include <thread>
+#include <vector>
+namespace stbir {
+struct StdThreads {
+    template <class Job>
+    void operator()(uint32_t count, Job& job) const {
+        std::vector<std::thread> pool;
+        pool.reserve(count ? count - 1 : 0);
+        for (uint32_t i = 1; i < count; ++i) pool.emplace_back([&job, i] { job(i); });
+        if (count) job(0);
+        for (std::thread& t : pool) t.join();
+    }
+};
+} // namespace stbir
+#endif // STBIR_STD_THREADS
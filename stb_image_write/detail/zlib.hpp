@@ -336,7 +336,7 @@ namespace zlib {
                 for (std::uint32_t j = 0; j < data_len;) {
 
                     const std::uint32_t blocklen =
-                        data_len-j > 32767 ? data_len-j : 32767;
+                        data_len-j > 32767 ? 32767 : data_len-j;
 
                     const std::uint8_t bfinal =
                         static_cast<std::uint8_t>(data_len-j == blocklen);
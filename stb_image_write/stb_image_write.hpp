@@ -36,13 +36,14 @@ BUILDING:
 
    You can #define STBIW_assert(x) before the #include to avoid using assert.h.
    You can #define STBIW_malloc(), STBIW_realloc(), and STBIW_free() to replace
-   malloc,realloc,free.
+   stb::BlockAlloc, BlockRealloc and BlockFree, which allocate through
+   stb::GetAllocator() (see stb_allocator/stb_allocator.hpp).
    You can #define STBIW_memmove() to replace memmove()
    You can #define STBIW_zlib_compress to use a custom zlib-style compress function
    for PNG compression (instead of the builtin one), it must have the following signature:
    unsigned char * my_compress(unsigned char *data, int data_len, int *out_len, int quality);
-   The returned data will be freed with STBIW_free() (free() by default),
-   so it must be heap allocated with STBIW_malloc() (malloc() by default),
+   The returned data will be freed with STBIW_free() (stb::BlockFree() by default),
+   so it must be allocated with STBIW_malloc() (stb::BlockAlloc() by default),
 
    You can define STBIW_FREESTANDING to not use stdio.h at all.
 
@@ -620,8 +621,9 @@ namespace stbiw {
         std::uint8_t* filt = reinterpret_cast<std::uint8_t*>(STBIW_malloc(filt_size, nullptr));
         if (!filt) return false;
 
+        // filtered row, then scratch for trying the other filters
         signed char* line = reinterpret_cast<signed char*>(
-            STBIW_malloc(static_cast<std::size_t>(row_bytes), nullptr));
+            STBIW_malloc(static_cast<std::size_t>(row_bytes) * 2u, nullptr));
         if (!line) {
             STBIW_free(filt);
             return false;
@@ -634,27 +636,25 @@ namespace stbiw {
             const std::uint8_t* cur =
                 pixels + (std::size_t)src_row * (std::size_t)stride_in_bytes;
 
+            // previously written row
+            const std::uint8_t* prev = (j > 0)
+                ? pixels + (std::size_t)(_flip_vertically_on_write ? src_row + 1 : src_row - 1) * (std::size_t)stride_in_bytes
+                : nullptr;
+
             int chosen = 0;
 
             if (force_filter >= 0) {
                 chosen = force_filter;
                 png_apply_filter(
-                    static_cast<PngFilter>(chosen), cur,
-                    j>0 ? pixels + static_cast<std::size_t>(src_row-1) * stride_in_bytes
-                        : nullptr,
+                    static_cast<PngFilter>(chosen), cur, prev,
                     row_bytes, comp,
                     reinterpret_cast<std::uint8_t*>(line)
                 );
             }
             else {
-                const std::uint8_t* prev =
-                    (j > 0)
-                    ? (pixels + static_cast<std::size_t>((_flip_vertically_on_write ? y-j : j) - 1) * stride_in_bytes)
-                    : nullptr;
-
-                chosen = png_choose_best_filter(cur, prev ? prev:nullptr,
+                chosen = png_choose_best_filter(cur, prev,
                     row_bytes, comp,
-                    reinterpret_cast<std::uint8_t*>(line),
+                    reinterpret_cast<std::uint8_t*>(line) + row_bytes,
                     reinterpret_cast<std::uint8_t*>(line)
                 );
             }
@@ -115,12 +115,6 @@ SOFTWARE.
 #   include <stdlib.h>
 #   include <string.h>
 
-    // Default to malloc/free
-#   ifndef STBTT_malloc
-#      define STBTT_malloc(x,u)  ((void)(u), malloc(x))
-#      define STBTT_free(x,u)    ((void)(u), free(x))
-#   endif
-
 #   ifndef STBTT_strlen
 #      define STBTT_strlen(x)    strlen(x)
 #   endif
@@ -131,6 +125,13 @@ SOFTWARE.
 #   endif
 #endif // ifndef STBTT_FREESTANDING
 
+// Default to stb::GetAllocator() (libc, or OS pages when freestanding)
+#ifndef STBTT_malloc
+#   include "../stb_allocator/stb_allocator.hpp"
+#   define STBTT_malloc(x,u)  ((void)(u), stb::BlockAlloc(x))
+#   define STBTT_free(x,u)    ((void)(u), stb::BlockFree(x))
+#endif
+
 
 #include "detail/enums.hpp"
 #include "detail/cff_parser.hpp"
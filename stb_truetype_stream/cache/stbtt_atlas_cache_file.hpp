@@ -0,0 +1,191 @@
+#pragma once
+// Optional HOSTED addon for `stb_truetype_stream.hpp`: file-backed atlas cache.
+//
+// The core header only (de)serializes cache images in caller memory
+// (AtlasCacheBytes / WriteAtlasCache / LoadAtlasCache). This addon adds the
+// OS side: mmap the cache file on hit, Plan + Build + write on miss.
+//
+// Writes go to a per-process temp file that is renamed over `path`, so
+// readers never observe a partially written cache.
+//
+// Uses stdio and OS mapping APIs; not for freestanding builds. Heap memory
+// for the miss path comes from stb::GetAllocator().
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(_WIN32)
+#   ifndef WIN32_LEAN_AND_MEAN
+#      define WIN32_LEAN_AND_MEAN
+#   endif
+#   include <windows.h>
+#else
+#   include <fcntl.h>
+#   include <sys/mman.h>
+#   include <sys/stat.h>
+#   include <unistd.h>
+#endif
+
+#include "../../stb_allocator/stb_allocator.hpp"
+#include "../stb_truetype_stream.hpp"
+
+namespace stbtt_cache {
+
+struct MappedAtlas {
+    stbtt_stream::FontPlan plan{};   // read-only view (no scratch)
+    const uint8_t* atlas{};
+    uint32_t stride_bytes{};
+    bool from_cache{};               // true: file hit, false: rebuilt
+
+    // ---- internal ----
+    void*  _view{};                  // mapped file view (hit)
+    size_t _view_bytes{};
+    void*  _heap{};                  // serialized image (miss)
+#if defined(_WIN32)
+    HANDLE _file{ INVALID_HANDLE_VALUE };
+    HANDLE _mapping{};
+#endif
+};
+
+namespace internal {
+
+static inline bool map_file(const char* path, MappedAtlas& m) noexcept {
+#if defined(_WIN32)
+    HANDLE f = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+                           FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (f == INVALID_HANDLE_VALUE) return false;
+    LARGE_INTEGER sz{};
+    if (!GetFileSizeEx(f, &sz) || sz.QuadPart <= 0) { CloseHandle(f); return false; }
+    HANDLE map = CreateFileMappingA(f, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (!map) { CloseHandle(f); return false; }
+    void* view = MapViewOfFile(map, FILE_MAP_READ, 0, 0, 0);
+    if (!view) { CloseHandle(map); CloseHandle(f); return false; }
+    m._file = f;
+    m._mapping = map;
+    m._view = view;
+    m._view_bytes = (size_t)sz.QuadPart;
+    return true;
+#else
+    const int fd = open(path, O_RDONLY);
+    if (fd < 0) return false;
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size <= 0) { close(fd); return false; }
+    void* view = mmap(nullptr, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd); // mapping keeps its own reference
+    if (view == MAP_FAILED) return false;
+    m._view = view;
+    m._view_bytes = (size_t)st.st_size;
+    return true;
+#endif
+}
+
+static inline void unmap_file(MappedAtlas& m) noexcept {
+    if (!m._view) return;
+#if defined(_WIN32)
+    UnmapViewOfFile(m._view);
+    if (m._mapping) CloseHandle(m._mapping);
+    if (m._file != INVALID_HANDLE_VALUE) CloseHandle(m._file);
+    m._mapping = nullptr;
+    m._file = INVALID_HANDLE_VALUE;
+#else
+    munmap(m._view, m._view_bytes);
+#endif
+    m._view = nullptr;
+    m._view_bytes = 0;
+}
+
+// write to "<path>.<pid>.tmp", flush to disk, then rename over `path`
+static inline bool write_atomic(const char* path, const void* data, size_t bytes) noexcept {
+    char tmp[1024];
+#if defined(_WIN32)
+    const unsigned long pid = (unsigned long)GetCurrentProcessId();
+#else
+    const unsigned long pid = (unsigned long)getpid();
+#endif
+    const int n = snprintf(tmp, sizeof(tmp), "%s.%lu.tmp", path, pid);
+    if (n <= 0 || (size_t)n >= sizeof(tmp)) return false;
+
+    FILE* f = fopen(tmp, "wb");
+    if (!f) return false;
+    bool ok = fwrite(data, 1, bytes, f) == bytes;
+    ok = (fflush(f) == 0) && ok;
+#if !defined(_WIN32)
+    ok = (fsync(fileno(f)) == 0) && ok;
+#endif
+    ok = (fclose(f) == 0) && ok;
+    if (!ok) { remove(tmp); return false; }
+
+#if defined(_WIN32)
+    ok = MoveFileExA(tmp, path, MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH) != 0;
+#else
+    ok = rename(tmp, path) == 0;
+#endif
+    if (!ok) remove(tmp);
+    return ok;
+}
+
+} // namespace internal
+
+static inline void Release(MappedAtlas& m) noexcept {
+    internal::unmap_file(m);
+    stb::BlockFree(m._heap);
+    m = MappedAtlas{};
+}
+
+// Maps `path` when its key matches (font bytes, mode, pixel height, spread,
+// codepoint sequence). On a miss runs Plan + Build, writes the cache and
+// serves the result from memory. A failed write is not an error: the atlas
+// is still returned, only the next launch rebuilds again.
+static inline bool LoadOrBuild(stbtt_stream::Font& font,
+                               const stbtt_stream::PlanInput& in,
+                               const char* path,
+                               MappedAtlas& out) noexcept {
+    out = MappedAtlas{};
+    const stbtt_stream::AtlasCacheKey key = stbtt_stream::MakeAtlasCacheKey(font, in);
+
+    // ---- hit ----
+    if (path && internal::map_file(path, out)) {
+        if (stbtt_stream::LoadAtlasCache(out._view, out._view_bytes, key,
+                                         out.plan, out.atlas, out.stride_bytes)) {
+            out.from_cache = true;
+            return true;
+        }
+        internal::unmap_file(out);
+    }
+
+    // ---- miss: Plan + Build ----
+    const size_t plan_bytes = font.PlanBytes(in);
+    if (!plan_bytes) return false;
+    void* plan_mem = stb::BlockAlloc(plan_bytes);
+    if (!plan_mem) return false;
+
+    stbtt_stream::FontPlan plan{};
+    if (!font.Plan(in, plan_mem, plan_bytes, plan)) { stb::BlockFree(plan_mem); return false; }
+
+    const uint32_t stride = stbtt_stream::AtlasStrideBytes(plan);
+    const size_t atlas_bytes = stbtt_stream::AtlasPageBytes(plan, stride) * plan.page_count;
+    uint8_t* atlas = (uint8_t*)stb::BlockAlloc(atlas_bytes);
+    if (atlas) memset(atlas, 0, atlas_bytes);
+    const size_t cache_bytes = stbtt_stream::AtlasCacheBytes(plan);
+    void* image = cache_bytes ? stb::BlockAlloc(cache_bytes) : nullptr;
+
+    bool ok = atlas && image
+           && font.Build(plan, atlas, stride)
+           && stbtt_stream::WriteAtlasCache(plan, key, atlas, stride, image, cache_bytes);
+    stb::BlockFree(atlas);
+    stb::BlockFree(plan_mem);
+    if (!ok) { stb::BlockFree(image); return false; }
+
+    if (path) internal::write_atomic(path, image, cache_bytes);
+
+    out._heap = image;
+    if (!stbtt_stream::LoadAtlasCache(image, cache_bytes, key, out.plan, out.atlas, out.stride_bytes)) {
+        Release(out);
+        return false;
+    }
+    out.from_cache = false;
+    return true;
+}
+
+} // namespace stbtt_cache
@@ -54,29 +54,31 @@ namespace stbtt_codepoints {
     // ========================================================================
     // PASS 1: PLAN GLYPH COUNT
     // ========================================================================
+    // Ranges are intersected with the font's cmap segments/groups
+    // (FontT::ForEachMappedCodepoint), so a CJK block costs O(segments + hits)
+    // instead of one cmap search per codepoint.
+
+    struct CountSink {
+        uint32_t count;
+        inline void operator()(uint32_t, int) noexcept { ++count; }
+    };
 
     template<class FontT>
     static inline uint32_t PlanGlyphs(const FontT& font, Script script) noexcept {
         const internal::ScriptDescriptor& d = GetScriptDescriptor(script);
-        uint32_t count = 0;
+        CountSink sink{ 0u };
 
         // ranges
-        for (uint32_t i = 0; i < d.range_count; ++i) {
-            internal::Codepoint cp = d.ranges[i].first;
-            internal::Codepoint end = d.ranges[i].last;
-            for (; cp <= end; ++cp) {
-                if (font.FindGlyphIndex(cp))
-                    ++count;
-            }
-        }
+        for (uint32_t i = 0; i < d.range_count; ++i)
+            font.ForEachMappedCodepoint(d.ranges[i].first, d.ranges[i].last, sink);
 
         // singles
         for (uint32_t i = 0; i < d.singles_count; ++i) {
             if (font.FindGlyphIndex(d.singles[i]))
-                ++count;
+                ++sink.count;
         }
 
-        return count;
+        return sink.count;
     }
 
     // 0 scripts => 0 glyphs
@@ -99,17 +101,9 @@ namespace stbtt_codepoints {
     static inline void CollectGlyphs(const FontT& font, SinkT& sink, Script script) noexcept {
         const internal::ScriptDescriptor& d = GetScriptDescriptor(script);
 
-        // ranges
-        for (uint32_t i = 0; i < d.range_count; ++i) {
-            internal::Codepoint cp = d.ranges[i].first;
-            internal::Codepoint end = d.ranges[i].last;
-
-            for (; cp <= end; ++cp) {
-                int g = font.FindGlyphIndex(cp);
-                if (g)
-                    sink(cp, g); // call back
-            }
-        }
+        // ranges: sink(cp, g) per mapped codepoint, ascending
+        for (uint32_t i = 0; i < d.range_count; ++i)
+            font.ForEachMappedCodepoint(d.ranges[i].first, d.ranges[i].last, sink);
 
         // singles
         for (uint32_t i = 0; i < d.singles_count; ++i) {
@@ -127,7 +121,35 @@ namespace stbtt_codepoints {
     // Build: N scripts => call each
     template<class FontT, class SinkT, class... Scripts>
     static inline void CollectGlyphs(const FontT& font, SinkT& sink, Script s0, Scripts... rest) noexcept {
-        CollectGlyphs(font, s0, sink);
+        CollectGlyphs(font, sink, s0);
         CollectGlyphs(font, sink, rest...);
     }
+
+    // ========================================================================
+    // CACHE: codepoint + glyph index lists in caller memory
+    // ========================================================================
+    // Feed both arrays to PlanInput (codepoints + glyph_indices) and the
+    // planning passes reuse the glyph indices instead of searching the cmap again.
+    // Font::GetGlyphPlanInfos caches the per-glyph bbox / point counts as well.
+    //
+    //   const uint32_t n = PlanGlyphs(font, scripts...);
+    //   CodepointListSink list{ cps, gids, n, 0 };   // caller arrays of n entries
+    //   CollectGlyphs(font, list, scripts...);
+    //   font.GetGlyphPlanInfos(gids, list.count, infos); // optional
+    //   in.codepoints = cps; in.glyph_indices = gids; in.glyph_infos = infos;
+    //   in.codepoint_count = list.count;
+
+    struct CodepointListSink {
+        uint32_t* codepoints;
+        uint16_t* glyph_indices;  // optional
+        uint32_t  cap;
+        uint32_t  count;
+
+        inline void operator()(uint32_t cp, int g) noexcept {
+            if (count >= cap) return;
+            codepoints[count] = cp;
+            if (glyph_indices) glyph_indices[count] = (uint16_t)g;
+            ++count;
+        }
+    };
 } // namespace stbtt_codepoints
\ No newline at end of file
@@ -34,6 +34,9 @@ SOFTWARE.
 // ------------------- Freestanding-friendly Includes -------------------------
 #include <stddef.h> // size_t
 #include <stdint.h> // uint32_t
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#   include <emmintrin.h> // StreamDF finalize
+#endif
 
 #ifndef assert
 #   define assert
@@ -47,8 +50,38 @@ SOFTWARE.
 #   define STBTT_STREAM_VISIT_CAP 512
 #endif // STBTT_STREAM_VISIT_CAP
 
+// Pixels per distance-field tile. Larger cells are processed in tiles of
+// at most this many pixels, so per-pixel scratch never exceeds it.
+#ifndef STBTT_STREAM_TILE_AREA
+#   define STBTT_STREAM_TILE_AREA (64 * 64)
+#endif // STBTT_STREAM_TILE_AREA
+
+// Profiling hooks around the StreamDF stages, called once per tile with a
+// stbtt_stream::DfStage (Distance, Sign, Finalize). Empty by default.
+#ifndef STBTT_STREAM_STAGE_BEGIN
+#   define STBTT_STREAM_STAGE_BEGIN(stage)
+#endif
+#ifndef STBTT_STREAM_STAGE_END
+#   define STBTT_STREAM_STAGE_END(stage)
+#endif
+
+// Fonts in one MultiFont fallback chain (GlyphPlan::font is a uint8_t).
+#ifndef STBTT_STREAM_MAX_FONTS
+#   define STBTT_STREAM_MAX_FONTS 8
+#endif // STBTT_STREAM_MAX_FONTS
+
 namespace stbtt_stream {
 enum class DfMode : uint8_t { SDF=1, MSDF=3, MTSDF=4 };
+// StreamDF stages, for STBTT_STREAM_STAGE_BEGIN/END
+enum class DfStage : uint8_t { Distance, Sign, Finalize };
+// Skyline: bottom-left skyline, power-of-two side (default).
+// MaxRects: best-short-side-fit free rectangles, smallest side that fits (multiple of 4).
+enum class PackMode : uint8_t { Skyline, MaxRects };
+// Raw: 8 bits per channel, row-major pixels (default).
+// BC:  4x4 blocks written directly by Build: a channel pair as BC5, a lone channel
+//      as BC4 (SDF: R, MSDF: RG + B, MTSDF: RG + BA). Cells start on block
+//      boundaries and are padded to whole blocks, so no block spans two glyphs.
+enum class AtlasFormat : uint8_t { Raw, BC };
 enum : uint8_t { EDGE_R, EDGE_G, EDGE_B };
 
 // some of the values for the IDs are below; for more see the truetype spec:
@@ -86,16 +119,13 @@ static inline void skyline_init(Skyline& s, uint16_t width, SkylineNode* nodes,
     s.nodes[0] = SkylineNode{ 0, 0, width };
 }
 static inline void skyline_merge(Skyline& s) noexcept {
-    for (int i = 0; i < s.node_count - 1; ) {
-        if (s.nodes[i].y == s.nodes[i + 1].y) {
-            s.nodes[i].w = (uint16_t)(s.nodes[i].w + s.nodes[i + 1].w);
-            for (int j = i + 1; j < s.node_count - 1; ++j) s.nodes[j] = s.nodes[j + 1];
-            --s.node_count;
-        }
-        else {
-            ++i;
-        }
+    // single compaction pass over neighbours with equal height
+    int n = 0;
+    for (int i = 1; i < s.node_count; ++i) {
+        if (s.nodes[i].y == s.nodes[n].y) s.nodes[n].w = (uint16_t)(s.nodes[n].w + s.nodes[i].w);
+        else                              s.nodes[++n] = s.nodes[i];
     }
+    if (s.node_count) s.node_count = n + 1;
 }
 // returns y if fits, else 0xFFFF
 static inline uint16_t skyline_fit(const Skyline& s, int idx, uint16_t rw, uint16_t rh) noexcept {
@@ -118,20 +148,36 @@ static inline uint16_t skyline_fit(const Skyline& s, int idx, uint16_t rw, uint1
     }
     return y;
 }
+// Same placement as trying skyline_fit at every node (lowest y, then narrowest
+// node, first wins), but the scan stops as soon as a candidate can no longer win:
+// nodes are sorted by x, and a window whose running max passes the best y is dropped.
 static inline bool skyline_insert(Skyline& s, uint16_t rw, uint16_t rh, uint16_t& out_x, uint16_t& out_y) noexcept {
     int best_idx = -1;
     uint16_t best_y = 0xFFFF;
     uint16_t best_w = 0xFFFF;
 
+    const SkylineNode* nodes = s.nodes;
     for (int i = 0; i < s.node_count; ++i) {
-        uint16_t y = skyline_fit(s, i, rw, rh);
-        if (y == 0xFFFF)
-            continue;
+        if ((uint32_t)nodes[i].x + rw > s.width) break; // every later node starts further right
+        if (nodes[i].y > best_y) continue;
+
+        uint16_t y = nodes[i].y;
+        uint32_t width_left = rw;
+        bool fits = true;
+        for (int j = i; ; ++j) {
+            if (j >= s.node_count) { fits = false; break; }
+            if (nodes[j].y > y) y = nodes[j].y;
+            if (y > best_y || (uint32_t)y + rh > s.width) { fits = false; break; }
+            if (nodes[j].w >= width_left) break;
+            width_left -= nodes[j].w;
+        }
+        if (!fits) continue;
+
         // heuristic: minimal y, then minimal width
-        if (y < best_y || (y == best_y && s.nodes[i].w < best_w)) {
+        if (y < best_y || nodes[i].w < best_w) {
             best_y = y;
             best_idx = i;
-            best_w = s.nodes[i].w;
+            best_w = nodes[i].w;
         }
     }
     if (best_idx < 0) return false;
@@ -148,38 +194,144 @@ static inline bool skyline_insert(Skyline& s, uint16_t rw, uint16_t rh, uint16_t
     newn.y = (uint16_t)(best_y + rh);
     newn.w = rw;
 
-    // insert node at best_idx
-    for (int i = s.node_count; i > best_idx; --i) s.nodes[i] = s.nodes[i - 1];
+    // nodes fully covered by the new one, then trim the first partially covered
+    const uint32_t end_x = (uint32_t)out_x + rw;
+    int covered = 0;
+    while (best_idx + covered < s.node_count &&
+           (uint32_t)s.nodes[best_idx + covered].x + s.nodes[best_idx + covered].w <= end_x)
+        ++covered;
+
+    if (covered == 0) {
+        // new node is narrower than the node it sits on: insert before it
+        for (int i = s.node_count; i > best_idx; --i) s.nodes[i] = s.nodes[i - 1];
+        ++s.node_count;
+    }
+    else if (covered > 1) {
+        // one memmove for the whole covered run
+        const int gap = covered - 1;
+        for (int i = best_idx + 1; i + gap < s.node_count; ++i) s.nodes[i] = s.nodes[i + gap];
+        s.node_count -= gap;
+    }
     s.nodes[best_idx] = newn;
-    ++s.node_count;
-
-    // shrink/erase covered nodes to the right
-    for (int i = best_idx + 1; i < s.node_count; ) {
-        SkylineNode& n = s.nodes[i];
-        uint16_t prev_x = s.nodes[i - 1].x;
-        uint16_t prev_w = s.nodes[i - 1].w;
-        uint16_t end_x = (uint16_t)(prev_x + prev_w);
 
+    if (best_idx + 1 < s.node_count) {
+        SkylineNode& n = s.nodes[best_idx + 1];
         if (n.x < end_x) {
-            uint16_t shrink = (uint16_t)(end_x - n.x);
-            if (shrink >= n.w) {
-                // remove node i
-                for (int j = i; j < s.node_count - 1; ++j) s.nodes[j] = s.nodes[j + 1];
-                --s.node_count;
-                continue;
-            }
-            else {
-                n.x = end_x;
-                n.w = (uint16_t)(n.w - shrink);
-            }
+            n.w = (uint16_t)(n.w - (end_x - n.x));
+            n.x = (uint16_t)end_x;
         }
-        break;
     }
 
     skyline_merge(s);
     return true;
 }
 
+// MaxRects, best-short-side-fit (no rotation: cells map 1:1 to glyph UVs).
+// Free rectangles live in caller memory; running out of them fails the insert.
+struct MaxRectsRect {
+    uint16_t x, y, w, h;
+};
+struct MaxRects {
+    MaxRectsRect* free;
+    int free_count;
+    int free_cap;
+    uint16_t width;  // atlas side
+};
+// free rects kept per packed glyph: usually ~1-2, worst cases stay well below this
+static constexpr uint32_t maxrects_cap(uint32_t glyph_count) noexcept { return 8u * glyph_count + 64u; }
+
+static inline void maxrects_init(MaxRects& m, uint16_t width, MaxRectsRect* storage, int cap) noexcept {
+    m.free = storage;
+    m.free_cap = cap;
+    m.width = width;
+    m.free_count = 1;
+    m.free[0] = MaxRectsRect{ 0, 0, width, width };
+}
+static inline bool maxrects_contains_(const MaxRectsRect& a, const MaxRectsRect& b) noexcept {
+    return b.x >= a.x && b.y >= a.y &&
+           (uint32_t)b.x + b.w <= (uint32_t)a.x + a.w &&
+           (uint32_t)b.y + b.h <= (uint32_t)a.y + a.h;
+}
+static inline bool maxrects_insert(MaxRects& m, uint16_t rw, uint16_t rh, uint16_t& out_x, uint16_t& out_y) noexcept {
+    int best = -1;
+    uint32_t best_short = 0xFFFFFFFFu, best_long = 0xFFFFFFFFu;
+    for (int i = 0; i < m.free_count; ++i) {
+        const MaxRectsRect& f = m.free[i];
+        if (f.w < rw || f.h < rh) continue;
+        const uint32_t dw = (uint32_t)(f.w - rw), dh = (uint32_t)(f.h - rh);
+        const uint32_t ss = dw < dh ? dw : dh;
+        const uint32_t ls = dw < dh ? dh : dw;
+        if (ss < best_short || (ss == best_short && ls < best_long)) {
+            best = i; best_short = ss; best_long = ls;
+        }
+    }
+    if (best < 0) return false;
+
+    const MaxRectsRect u{ m.free[best].x, m.free[best].y, rw, rh };
+    out_x = u.x;
+    out_y = u.y;
+    const uint32_t ux1 = (uint32_t)u.x + u.w, uy1 = (uint32_t)u.y + u.h;
+
+    // split every free rect the placed cell overlaps; pieces are appended after `old_count`
+    const int old_count = m.free_count;
+    for (int i = 0; i < old_count; ++i) {
+        const MaxRectsRect f = m.free[i];
+        const uint32_t fx1 = (uint32_t)f.x + f.w, fy1 = (uint32_t)f.y + f.h;
+        if (u.x >= fx1 || ux1 <= f.x || u.y >= fy1 || uy1 <= f.y) continue;
+
+        MaxRectsRect parts[4];
+        int pn = 0;
+        if (u.y > f.y) parts[pn++] = MaxRectsRect{ f.x, f.y, f.w, (uint16_t)(u.y - f.y) };
+        if (uy1 < fy1) parts[pn++] = MaxRectsRect{ f.x, (uint16_t)uy1, f.w, (uint16_t)(fy1 - uy1) };
+        if (u.x > f.x) parts[pn++] = MaxRectsRect{ f.x, f.y, (uint16_t)(u.x - f.x), f.h };
+        if (ux1 < fx1) parts[pn++] = MaxRectsRect{ (uint16_t)ux1, f.y, (uint16_t)(fx1 - ux1), f.h };
+
+        if (m.free_count + pn > m.free_cap) return false;
+        for (int k = 0; k < pn; ++k) m.free[m.free_count++] = parts[k];
+        m.free[i].w = 0; // dead, compacted below
+    }
+
+    // prune: a new piece can only be contained in another piece or in a surviving old rect
+    // (old rects never sit inside new pieces: those are sub-rects of already pruned ones)
+    for (int i = old_count; i < m.free_count; ++i) {
+        if (!m.free[i].w) continue;
+        for (int j = 0; j < m.free_count; ++j) {
+            if (j == i || !m.free[j].w) continue;
+            if (maxrects_contains_(m.free[j], m.free[i])) { m.free[i].w = 0; break; }
+        }
+    }
+    int n = 0;
+    for (int i = 0; i < m.free_count; ++i)
+        if (m.free[i].w) m.free[n++] = m.free[i];
+    m.free_count = n;
+    return true;
+}
+
+// One packer over the caller's pack region (skyline nodes or MaxRects free rects).
+struct AtlasPacker {
+    PackMode mode;
+    void*    mem;
+    size_t   bytes;
+    Skyline  sky;
+    MaxRects mr;
+
+    inline void init(uint16_t side) noexcept {
+        if (mode == PackMode::MaxRects)
+            maxrects_init(mr, side, (MaxRectsRect*)mem, (int)(bytes / sizeof(MaxRectsRect)));
+        else
+            skyline_init(sky, side, (SkylineNode*)mem, (int)(bytes / sizeof(SkylineNode)));
+    }
+    inline bool insert(uint16_t rw, uint16_t rh, uint16_t& x, uint16_t& y) noexcept {
+        return mode == PackMode::MaxRects ? maxrects_insert(mr, rw, rh, x, y)
+                                          : skyline_insert(sky, rw, rh, x, y);
+    }
+};
+static inline size_t pack_region_bytes(uint32_t glyph_count, PackMode mode) noexcept {
+    return mode == PackMode::MaxRects
+        ? (size_t)maxrects_cap(glyph_count) * sizeof(MaxRectsRect)
+        : (size_t)(2u * glyph_count + 16u) * sizeof(SkylineNode); // skyline needs ~2*N+16 nodes
+}
+
 struct PlanResult {
     bool ok;
     uint32_t planned;
@@ -196,6 +348,7 @@ struct GlyphHorMetrics {
 struct GlyphRect {
     uint16_t x, y;   // in atlas pixels
     uint16_t w, h;   // in atlas pixels (no padding)
+    uint16_t page;   // atlas page (texture array layer)
 };
 struct GlyphPlan {
     uint32_t codepoint;
@@ -206,10 +359,12 @@ struct GlyphPlan {
 
     GlyphRect rect;     // packed placement
     uint16_t num_points;// for scratch validation (simple glyph)
+    uint8_t  font;      // MultiFont: index into the font list (0 for Font::Plan)
 }; // struct GlyphPlan
 struct GlyphPlanInfo {
     int16_t x_min, y_min, x_max, y_max;
     uint16_t max_points_in_tree; // max num_points among simple subglyphs
+    uint16_t glyph_index;        // the glyph described (0 for GetFontPlanInfo)
     bool is_empty;
 }; // struct GlyphPlanInfo
 
@@ -231,12 +386,15 @@ struct GlyphScratch {
     // Acts as a recursion / cycle guard.
     static constexpr uint16_t VISIT_CAP = STBTT_STREAM_VISIT_CAP;
 
+    // Maximum pixels per distance-field tile (bounds the per-pixel buffers).
+    static constexpr uint32_t TILE_AREA = STBTT_STREAM_TILE_AREA;
+
     // Per-point data (sized by max_points)
     uint8_t* flags;   // On/off-curve flags
     int16_t* px;      // X coordinates (font units)
     int16_t* py;      // Y coordinates (font units)
 
-    // Per-pixel data (sized by max_area)
+    // Per-pixel data (sized by scratch_tile_area(max_area))
     uint16_t* min_d2;  // Minimum squared distance accumulator
     uint8_t* inside; // Inside/outside classification mask
     float* xs;     // X-intersections for scanline tests
@@ -245,45 +403,253 @@ struct GlyphScratch {
     uint16_t* visit;  // Stack / set of visited glyph indices
     uint16_t  visit_n;
 };
+// per-pixel scratch covers one tile, never more than the largest cell
+static constexpr uint32_t scratch_tile_area(uint32_t max_area) noexcept {
+    return max_area < GlyphScratch::TILE_AREA ? max_area : GlyphScratch::TILE_AREA;
+}
 static inline uint16_t* scratch_d2_r(const GlyphScratch& s) noexcept { return s.min_d2; }
-static inline uint16_t* scratch_d2_g(const GlyphScratch& s, uint32_t max_area) noexcept { return s.min_d2 + max_area; }
-static inline uint16_t* scratch_d2_b(const GlyphScratch& s, uint32_t max_area) noexcept { return s.min_d2 + max_area * 2; }
-static inline uint16_t* scratch_d2_a(const GlyphScratch& s, uint32_t max_area) noexcept { return s.min_d2 + max_area * 3; }
+static inline uint16_t* scratch_d2_g(const GlyphScratch& s, uint32_t max_area) noexcept { return s.min_d2 + scratch_tile_area(max_area); }
+static inline uint16_t* scratch_d2_b(const GlyphScratch& s, uint32_t max_area) noexcept { return s.min_d2 + scratch_tile_area(max_area) * 2; }
+static inline uint16_t* scratch_d2_a(const GlyphScratch& s, uint32_t max_area) noexcept { return s.min_d2 + scratch_tile_area(max_area) * 3; }
 // fill as form all the fields
 struct PlanInput {
     DfMode   mode;
-    uint16_t pixel_height;   // <=64
+    uint16_t pixel_height;   // cells above STBTT_STREAM_TILE_AREA pixels are tiled
     float    spread_px;
     // codepoints source:
     const uint32_t* codepoints;
     uint32_t        codepoint_count;
+    // optional, parallel to codepoints (e.g. from stbtt_codepoints::CodepointListSink):
+    // glyph index per codepoint, so PlanBytes/Plan skip the cmap lookups. 0 = unmapped.
+    const uint16_t* glyph_indices;
+    // optional, parallel to glyph_indices (Font::GetGlyphPlanInfos): bbox and point
+    // counts, so PlanBytes/Plan skip the glyf headers too. Needs glyph_indices;
+    // an entry whose glyph_index differs from glyph_indices[i] is re-read from glyf.
+    const GlyphPlanInfo* glyph_infos;
+    // 0: one power-of-two square (grows up to 32768).
+    // N: same, but once the square would exceed N the glyphs are split over
+    //    several N x N pages instead (texture array). At most 32768.
+    uint16_t        max_page_side;   // BC: must be a multiple of 4
+    PackMode        pack_mode;
+    AtlasFormat     format;
 };
 // A "view" onto one user-provided memory block.
 // User never allocates glyphs/nodes/scratch separately.
 struct FontPlan {
     // user-facing parameters (filled by Plan)
     DfMode     mode{};
+    AtlasFormat format{};
     uint16_t   pixel_height{};
     float      scale{};       // pixels per font unit
     float      spread_fu{};   // spread in font units
 
     // results (filled by Plan)
-    uint16_t   atlas_side{};  // square side in pixels (no padding)
-    uint32_t   glyph_count{};
+    uint16_t   atlas_side{};  // square page side in pixels (no padding)
+    uint16_t   page_count{};  // pages of atlas_side x atlas_side
+    uint32_t   glyph_count{};      // unique glyphs (one cell each)
+    uint32_t   codepoint_count{};  // mapped codepoints (several may share a glyph)
     uint16_t   max_points{};
     uint32_t   max_area{};
 
+    // codepoint -> its glyph cell (binary search), nullptr if not planned
+    inline const GlyphPlan* Find(uint32_t codepoint) const noexcept;
+
     // ---- internal pointers into the same plan memory block ----
     void*  _mem{};
     size_t _mem_bytes{};
 
     GlyphPlan*   _glyphs{};
+    uint32_t*    _map_cp{};    // [codepoint_count] ascending codepoints
+    uint32_t*    _map_slot{};  // [codepoint_count] index into _glyphs
     SkylineNode* _nodes{};
     uint32_t     _node_cap{};
 
     void* _scratch_mem{};
     size_t     _scratch_bytes{};
+    uint8_t* _stage{};        // BC: one block-padded cell, encoded after StreamDF
+    size_t   _stage_bytes{};
+};
+inline const GlyphPlan* FontPlan::Find(uint32_t codepoint) const noexcept {
+    if (!_map_cp || !_map_slot || !_glyphs) return nullptr;
+    uint32_t lo = 0, hi = codepoint_count;
+    while (lo < hi) {
+        const uint32_t mid = lo + ((hi - lo) >> 1);
+        if (_map_cp[mid] < codepoint) lo = mid + 1;
+        else hi = mid;
+    }
+    if (lo == codepoint_count || _map_cp[lo] != codepoint) return nullptr;
+    return _map_slot[lo] < glyph_count ? &_glyphs[_map_slot[lo]] : nullptr;
+}
+// Build output layout, per page:
+//   Raw: atlas_side rows of `stride` bytes.
+//   BC:  one block plane per channel pair, back to back. `stride` is the pitch of
+//        one channel's block row (8 bytes per BC4 block), so a BC5 plane's block
+//        rows are 2 * stride apart and the page is atlas_side/4 * channels * stride.
+static inline uint32_t AtlasStrideBytes(const FontPlan& plan) noexcept {
+    return plan.format == AtlasFormat::BC ? (uint32_t)(plan.atlas_side >> 2) * 8u
+                                          : (uint32_t)plan.atlas_side * (uint32_t)plan.mode;
+}
+static inline size_t AtlasPageBytes(const FontPlan& plan, uint32_t stride_bytes) noexcept {
+    return plan.format == AtlasFormat::BC
+        ? (size_t)(plan.atlas_side >> 2) * (uint32_t)plan.mode * stride_bytes
+        : (size_t)plan.atlas_side * stride_bytes;
+}
+// IEEE binary16 <-> binary32, round to nearest even (GPU vertex/storage formats).
+static inline uint16_t half_from_float(float f) noexcept {
+    uint32_t x = 0;
+    const uint8_t* src = (const uint8_t*)&f;
+    uint8_t* dst = (uint8_t*)&x;
+    for (int i = 0; i < 4; ++i) dst[i] = src[i];
+
+    const uint32_t sign = (x >> 16) & 0x8000u;
+    const uint32_t e = (x >> 23) & 0xFFu;
+    uint32_t m = x & 0x7FFFFFu;
+    if (e == 0xFFu) return (uint16_t)(sign | 0x7C00u | (m ? 0x200u : 0u)); // inf / nan
+    const int32_t he = (int32_t)e - 127 + 15;
+    if (he >= 31) return (uint16_t)(sign | 0x7C00u);                        // overflow: inf
+    if (he <= 0) {                                                           // subnormal / zero
+        if (he < -10) return (uint16_t)sign;
+        m |= 0x800000u;
+        const uint32_t shift = (uint32_t)(14 - he);
+        uint32_t hm = m >> shift;
+        const uint32_t rem = m & ((1u << shift) - 1u), half = 1u << (shift - 1u);
+        if (rem > half || (rem == half && (hm & 1u))) ++hm;
+        return (uint16_t)(sign | hm);
+    }
+    uint32_t h = sign | ((uint32_t)he << 10) | (m >> 13);
+    const uint32_t rem = m & 0x1FFFu;
+    if (rem > 0x1000u || (rem == 0x1000u && (h & 1u))) ++h; // carry may round up to inf
+    return (uint16_t)h;
+}
+static inline float float_from_half(uint16_t h) noexcept {
+    const uint32_t sign = (uint32_t)(h & 0x8000u) << 16;
+    uint32_t e = (h >> 10) & 0x1Fu;
+    uint32_t m = h & 0x3FFu;
+    uint32_t x;
+    if (e == 0x1Fu) x = sign | 0x7F800000u | (m << 13);
+    else if (e) x = sign | ((e + 112u) << 23) | (m << 13);
+    else if (!m) x = sign;
+    else { // subnormal: normalize
+        e = 113u;
+        while (!(m & 0x400u)) { m <<= 1; --e; }
+        x = sign | (e << 23) | ((m & 0x3FFu) << 13);
+    }
+    float f = 0.f;
+    const uint8_t* src = (const uint8_t*)&x;
+    uint8_t* dst = (uint8_t*)&f;
+    for (int i = 0; i < 4; ++i) dst[i] = src[i];
+    return f;
+}
+
+// Per-glyph render data for a built atlas, one contiguous block in caller memory:
+// memcpy [mem, mem + bytes) into one GPU buffer and bind the arrays by Offset().
+// Structure of arrays indexed by slot (FontPlan::_glyphs order).
+// Units: UVs are unorm16 texel edges (x / atlas_side); bounds and metrics are
+// float16 in ems, where pixel_height == 1 (so any render size is one multiply).
+struct GlyphMetricsTable {
+    static constexpr uint16_t NO_SLOT = 0xFFFF;
+
+    uint32_t glyph_count{};
+    uint32_t top_count{};   // level 1 entries: codepoints < top_count * 256
+    uint32_t page_count{};  // level 2 pages of 256 slots
+    uint16_t atlas_side{};
+
+    // codepoint -> slot: pages[top[cp >> 8] * 256 + (cp & 255)]; NO_SLOT in either level = absent
+    uint16_t* top{};
+    uint16_t* pages{};
+
+    uint16_t* u0{};  uint16_t* v0{};   // unorm16, cell top-left (atlas y down)
+    uint16_t* u1{};  uint16_t* v1{};   // unorm16, cell bottom-right
+    uint16_t* layer{};                 // atlas page
+    uint16_t* plane_l{}; uint16_t* plane_b{}; // float16 quad bounds around the pen (y up)
+    uint16_t* plane_r{}; uint16_t* plane_t{};
+    uint16_t* advance{};               // float16
+    uint16_t* bearing{};               // float16 left side bearing
+
+    void*  mem{};
+    size_t bytes{};
+
+    inline uint32_t Slot(uint32_t codepoint) const noexcept {
+        const uint32_t t = codepoint >> 8;
+        if (t >= top_count || top[t] == NO_SLOT) return NO_SLOT;
+        return pages[(uint32_t)top[t] * 256u + (codepoint & 255u)];
+    }
+    inline size_t Offset(const void* array) const noexcept {
+        return (size_t)((const uint8_t*)array - (const uint8_t*)mem);
+    }
 };
+
+// packed cell extent: BC rounds up to whole 4x4 blocks
+static constexpr uint16_t pack_dim(uint16_t v, AtlasFormat format) noexcept {
+    return format == AtlasFormat::BC ? (uint16_t)((v + 3u) & ~3u) : v;
+}
+
+// One BC4 (unorm) block from 16 samples `step` bytes apart, rows `pitch` apart.
+// Endpoints are the block min/max (8-level mode); each sample takes the nearest level.
+// Fixed trip counts and no branches in the index loop, so it vectorizes.
+static inline void bc4_encode_block(const uint8_t* src, uint32_t step, uint32_t pitch,
+                                    uint8_t* out) noexcept {
+    uint32_t v[16];
+    for (uint32_t y = 0; y < 4; ++y)
+        for (uint32_t x = 0; x < 4; ++x) v[y*4 + x] = src[y*pitch + x*step];
+    uint32_t lo = v[0], hi = v[0];
+    for (uint32_t i = 1; i < 16; ++i) {
+        lo = v[i] < lo ? v[i] : lo;
+        hi = v[i] > hi ? v[i] : hi;
+    }
+    out[0] = (uint8_t)hi; // red0 > red1 selects the 8-level palette
+    out[1] = (uint8_t)lo;
+
+    uint64_t bits = 0;
+    if (hi > lo) {
+        // t = round(7 * (v - lo) / range) via a reciprocal; exact here because
+        // the numerator stays below 2^12 and the denominator below 2^9
+        const uint32_t range = hi - lo;
+        const uint32_t m = ((1u << 21) + 2u*range - 1u) / (2u*range);
+        uint32_t idx[16];
+        for (uint32_t i = 0; i < 16; ++i) {
+            const uint32_t t = (((v[i] - lo) * 14u + range) * m) >> 21;
+            const uint32_t k = (8u - t) & 7u;  // level t (0 = lo .. 7 = hi) -> palette slot
+            idx[i] = k ^ (uint32_t)(k < 2u);   // slot 0 is hi, slot 1 is lo
+        }
+        for (uint32_t i = 0; i < 16; ++i) bits |= (uint64_t)idx[i] << (3u*i);
+    }
+    for (uint32_t i = 0; i < 6; ++i) out[2 + i] = (uint8_t)(bits >> (8u*i));
+}
+// Repeats the last column/row of a w x h cell into its block padding,
+// so padded texels never widen a block's endpoint range.
+static inline void bc_pad_cell(uint8_t* px, uint32_t stride, uint32_t w, uint32_t h,
+                               uint32_t comp) noexcept {
+    if (!w || !h) return;
+    const uint32_t w4 = (w + 3u) & ~3u, h4 = (h + 3u) & ~3u;
+    for (uint32_t y = 0; y < h; ++y) {
+        uint8_t* row = px + (size_t)y * stride;
+        for (uint32_t x = w; x < w4; ++x)
+            for (uint32_t c = 0; c < comp; ++c) row[x*comp + c] = row[(w-1)*comp + c];
+    }
+    const uint8_t* last = px + (size_t)(h - 1) * stride;
+    for (uint32_t y = h; y < h4; ++y) {
+        uint8_t* row = px + (size_t)y * stride;
+        for (uint32_t x = 0; x < w4 * comp; ++x) row[x] = last[x];
+    }
+}
+// Encodes a padded cell (bw x bh blocks) into block (bx0, by0) of a BC page.
+static inline void bc_encode_cell(const uint8_t* px, uint32_t cell_stride, uint32_t comp,
+                                  uint32_t bw, uint32_t bh, uint8_t* page, uint16_t atlas_side,
+                                  uint32_t bx0, uint32_t by0, uint32_t stride_bytes) noexcept {
+    for (uint32_t ch0 = 0; ch0 < comp; ch0 += 2) {
+        const uint32_t nch = comp - ch0 < 2u ? 1u : 2u; // BC4 or BC5 plane
+        uint8_t* plane = page + (size_t)(atlas_side >> 2) * stride_bytes * ch0;
+        const size_t pitch = (size_t)stride_bytes * nch;
+        for (uint32_t by = 0; by < bh; ++by) {
+            uint8_t* out = plane + (by0 + by) * pitch + (size_t)bx0 * 8u * nch;
+            const uint8_t* src = px + (size_t)by * 4u * cell_stride + ch0;
+            for (uint32_t bx = 0; bx < bw; ++bx, out += 8u * nch, src += 4u * comp)
+                for (uint32_t c = 0; c < nch; ++c)
+                    bc4_encode_block(src + c, comp, cell_stride, out + 8u * c);
+        }
+    }
+}
 // Very small bump allocator for "plan_mem" block.
 struct MemArena {
     uint8_t* base;
@@ -300,6 +666,7 @@ static constexpr size_t align_up(size_t v, size_t a) noexcept { return (v + (a -
 static inline size_t glyph_scratch_bytes(uint16_t max_points,
                                          uint32_t max_area,
                                          DfMode mode) noexcept {
+    max_area = scratch_tile_area(max_area);
     size_t off = 0;
 
     off = align_up(off, 16); off += max_points * sizeof(uint8_t);  // flags
@@ -332,6 +699,7 @@ static inline GlyphScratch bind_glyph_scratch(void* mem, uint16_t max_points,
         off += bytes;
         return r;
     };
+    max_area = scratch_tile_area(max_area);
     GlyphScratch s{};
     s.flags = (uint8_t*)take((size_t)max_points * sizeof(uint8_t), 16);
     s.px    = (int16_t*)take((size_t)max_points * sizeof(int16_t), 16);
@@ -346,18 +714,62 @@ static inline GlyphScratch bind_glyph_scratch(void* mem, uint16_t max_points,
     return s;
 }
 
-// helper: bytes for plan block (glyphs + nodes + scratch)
-static inline size_t plan_block_bytes(uint32_t glyph_count, uint32_t node_cap,
-                                      uint16_t max_points,  uint32_t max_area, DfMode mode) noexcept {
+// helper: bytes for plan block (glyphs + map + pack region + scratch)
+static inline size_t plan_block_bytes(uint32_t glyph_count, size_t pack_bytes,
+                                      uint16_t max_points,  uint32_t max_area, DfMode mode,
+                                      size_t stage_bytes) noexcept {
     size_t off = 0;
     auto aup = [](size_t v, size_t a) noexcept { return (v + (a-1)) & ~(a-1); };
     off = aup(off, 16); off += (size_t)glyph_count * sizeof(GlyphPlan); // glyphs
     off = aup(off, 16); off += (size_t)glyph_count * sizeof(uint32_t);  // sorted glyphs
-    off = aup(off, 16); off += (size_t)node_cap * sizeof(SkylineNode);  // skyline
+    off = aup(off, 16); off += (size_t)glyph_count * sizeof(uint32_t);  // codepoint map: codepoints
+    off = aup(off, 16); off += (size_t)glyph_count * sizeof(uint32_t);  // codepoint map: slots
+    off = aup(off, 16); off += pack_bytes;                               // skyline / free rects
     const size_t scratch_bytes = glyph_scratch_bytes(max_points, max_area, mode);
     off = aup(off, 16); off += scratch_bytes;
+    off = aup(off, 16); off += stage_bytes;                              // BC cell staging
     return aup(off, 16);
 }
+// Sorts 0..n-1 by key(k), ascending, stable (LSD radix over 8-bit digits).
+// `tmp` must hold `n` entries; Plan lends it the skyline node storage, unused until packing.
+template<class KeyF>
+static inline void radix_sort_order_(KeyF key, uint32_t* order, uint32_t* tmp,
+                                     uint32_t n) noexcept {
+    for (uint32_t i = 0; i < n; ++i) order[i] = i;
+    if (n < 2) return;
+
+    uint32_t* src = order;
+    uint32_t* dst = tmp;
+    for (uint32_t shift = 0; shift < 32; shift += 8) {
+        uint32_t count[256];
+        for (uint32_t b = 0; b < 256; ++b) count[b] = 0;
+        for (uint32_t i = 0; i < n; ++i) ++count[(key(src[i]) >> shift) & 0xFFu];
+
+        // all keys share this digit -> pass would be an identity copy
+        if (count[(key(src[0]) >> shift) & 0xFFu] == n) continue;
+
+        uint32_t sum = 0;
+        for (uint32_t b = 0; b < 256; ++b) { const uint32_t c = count[b]; count[b] = sum; sum += c; }
+        for (uint32_t i = 0; i < n; ++i) {
+            const uint32_t k = src[i];
+            dst[count[(key(k) >> shift) & 0xFFu]++] = k;
+        }
+        uint32_t* t = src; src = dst; dst = t;
+    }
+    if (src != order)
+        for (uint32_t i = 0; i < n; ++i) order[i] = src[i];
+}
+// Sorts glyph indices by rect key (h << 16 | w), descending, stable.
+// Radix on the inverted key: ascending ~key == descending key,
+// and stability keeps equal keys in input order (same layout as the old insertion sort).
+static inline void radix_sort_order_hw_desc(const GlyphPlan* glyphs,
+                                            uint32_t* order, uint32_t* tmp,
+                                            uint32_t n) noexcept {
+    radix_sort_order_([glyphs](uint32_t k) noexcept -> uint32_t {
+        const GlyphRect& r = glyphs[k].rect;
+        return ~((uint32_t)r.h * 65536u + (uint32_t)r.w); // h major, w minor
+    }, order, tmp, n);
+}
 struct Xform {
     // [ m00 m01 dx ]
     // [ m10 m11 dy ]
@@ -417,6 +829,44 @@ static inline float sqrt(float x) noexcept {
         r = 0.5f*(r + x/r);
     return r;
 }
+// Finalize: packed squared distance (d2 / 65535 of spread^2) -> 0..127 code,
+// (int)(sqrt(d2 / 65535) * 127 + .5), in place. The SSE2 path runs the same
+// IEEE float ops as sqrt() above, 8 values at a time, so codes are bit-identical.
+static inline uint16_t df_code_u16(uint16_t d2) noexcept {
+    return (uint16_t)(int)(sqrt((float)d2 * (1.f / 65535.f)) * 127.f + .5f);
+}
+static inline void df_codes_u16(uint16_t* d2, uint32_t n) noexcept {
+    uint32_t i = 0;
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+    const __m128i zero = _mm_setzero_si128();
+    const __m128 k_norm = _mm_set1_ps(1.f / 65535.f);
+    const __m128 k_half = _mm_set1_ps(0.5f);
+    const __m128 k_127 = _mm_set1_ps(127.f);
+    const __m128 k_one = _mm_set1_ps(1.f);
+    for (; i + 8 <= n; i += 8) {
+        const __m128i v = _mm_loadu_si128((const __m128i*)(d2 + i));
+        __m128 x[2] = { _mm_cvtepi32_ps(_mm_unpacklo_epi16(v, zero)),
+                        _mm_cvtepi32_ps(_mm_unpackhi_epi16(v, zero)) };
+        __m128i c[2];
+        for (int h = 0; h < 2; ++h) {
+            x[h] = _mm_mul_ps(x[h], k_norm);
+            const __m128 pos = _mm_cmpgt_ps(x[h], _mm_setzero_ps());
+            // r starts at x (1 where x == 0, masked out below: no 0/0)
+            __m128 r = _mm_or_ps(_mm_and_ps(pos, x[h]), _mm_andnot_ps(pos, k_one));
+            for (int k = 0; k < 5; ++k)
+                r = _mm_mul_ps(k_half, _mm_add_ps(r, _mm_div_ps(x[h], r)));
+            r = _mm_and_ps(pos, r);
+            c[h] = _mm_cvttps_epi32(_mm_add_ps(_mm_mul_ps(r, k_127), k_half));
+        }
+        _mm_storeu_si128((__m128i*)(d2 + i), _mm_packs_epi32(c[0], c[1])); // codes <= 127
+    }
+#endif
+    for (; i < n; ++i) d2[i] = df_code_u16(d2[i]);
+}
+// code + inside flag -> stored byte (128 -/+ code)
+static inline uint8_t df_code_byte(uint16_t code, uint8_t inside) noexcept {
+    return (uint8_t)(inside ? 128 - (int)code : 128 + (int)code);
+}
 static constexpr uint32_t isqrt_u32(uint32_t x) noexcept {
     // integer sqrt floor
     uint32_t r = 0;
@@ -455,6 +905,457 @@ static constexpr uint16_t next_pow2_u16(uint32_t v) noexcept {
 }
 static constexpr uint16_t u16_max(uint16_t a, uint16_t b) noexcept { return a > b ? a : b; }
 static constexpr uint16_t u16_min(uint16_t a, uint16_t b) noexcept { return a < b ? a : b; }
+static inline uint64_t fnv1a64(const void* data, size_t n,
+                               uint64_t h = 1469598103934665603ull) noexcept {
+    const uint8_t* p = (const uint8_t*)data;
+    for (size_t i = 0; i < n; ++i) { h ^= p[i]; h *= 1099511628211ull; }
+    return h;
+}
+// Chooses the page side and packs `count` cells, visited in `order` (tallest first).
+// rect(k) is the GlyphRect of cell k: w/h are read, x/y/page written.
+// max_w/max_h/total_area describe the packed extents (pack_dim); total_area
+// is 64-bit since many large cells can sum past 2^32 pixels.
+template<class RectF>
+static inline bool pack_cells_(AtlasPacker& packer, RectF rect,
+                               const uint32_t* order, uint32_t count,
+                               AtlasFormat format, uint16_t max_page_side,
+                               uint64_t total_area, uint16_t max_w, uint16_t max_h,
+                               uint16_t& out_side, uint16_t& out_page_count) noexcept {
+    // only the square root is used, and any side it gives is clamped to 32768
+    // (2^30 pixels): saturating keeps the estimate exact where it matters
+    const uint32_t area_u32 = total_area > 0xFFFFFFFFu ? 0xFFFFFFFFu : (uint32_t)total_area;
+    auto pack_all = [&](uint16_t side_px) noexcept -> bool {
+        packer.init(side_px);
+        for (uint32_t i=0; i<count; ++i) {
+            const uint32_t k = order[i];
+            uint16_t x = 0, y = 0;
+            if (!packer.insert(pack_dim(rect(k).w, format),
+                               pack_dim(rect(k).h, format), x, y)) return false;
+            rect(k).x = x;
+            rect(k).y = y;
+            rect(k).page = 0;
+        }
+        return true;
+    };
+
+    // the packer's coordinates are 16-bit: one page can be at most 32768 wide
+    if (max_page_side > 32768u) return false;
+    const uint16_t side_cap = max_page_side ? max_page_side : (uint16_t)32768;
+    uint16_t side = 0;
+    uint16_t page_count = 1;
+    bool packed = false;
+
+    if (packer.mode == PackMode::MaxRects) {
+        // smallest side (multiple of 4) that packs: grow ~12.5% until it fits,
+        // then bisect between the last failure and the first success
+        auto align4 = [side_cap](uint32_t v) noexcept -> uint16_t {
+            v = (v + 3u) & ~3u;
+            return (uint16_t)(v < side_cap ? v : side_cap);
+        };
+        uint32_t lo_v = ceil_sqrt_u32(area_u32);
+        if (lo_v < max_w) lo_v = max_w;
+        if (lo_v < max_h) lo_v = max_h;
+        uint16_t lo = align4(lo_v);           // candidate
+        uint16_t fail = lo >= 4 ? (uint16_t)(lo - 4) : 0; // largest side known to fail
+        uint16_t hi = 0;                      // smallest side known to pack
+        while (lo >= max_w && lo >= max_h) {
+            if (pack_all(lo)) { hi = lo; break; }
+            fail = lo;
+            if (lo >= side_cap) break;
+            lo = align4((uint32_t)lo + (lo >> 3) + 4u);
+        }
+        if (hi) {
+            while ((uint32_t)fail + 4u < hi) {
+                const uint16_t mid = align4(((uint32_t)fail + hi) >> 1);
+                if (mid <= fail || mid >= hi) break;
+                if (pack_all(mid)) hi = mid; else fail = mid;
+            }
+            side = hi;
+            packed = pack_all(side); // last probe may have been a failure
+        }
+    }
+    else {
+        side = next_pow2_u16(ceil_sqrt_u32(area_u32));
+        if (side < max_w) side = next_pow2_u16(max_w);
+        if (side < max_h) side = next_pow2_u16(max_h);
+        if (side < 64) side = 64;
+
+        for (int attempt=0; attempt<10 && side <= side_cap; ++attempt) {
+            if (pack_all(side)) { packed = true; break; }
+            const uint32_t next = (uint32_t)side * 2u;
+            if (next > side_cap) break;
+            side = (uint16_t)next;
+        }
+    }
+
+    // square would outgrow max_page_side: fill fixed-size pages one after another
+    // (next-fit; cells arrive tallest first, so each page closes nearly full)
+    if (!packed && max_page_side) {
+        side = max_page_side;
+        if (max_w > side || max_h > side) return false;
+
+        packer.init(side);
+        page_count = 1;
+        for (uint32_t i=0; i<count; ++i) {
+            const uint32_t k = order[i];
+            const uint16_t pw = pack_dim(rect(k).w, format);
+            const uint16_t ph = pack_dim(rect(k).h, format);
+            uint16_t x = 0, y = 0;
+            if (!packer.insert(pw, ph, x, y)) {
+                if (page_count == 0xFFFF) return false;
+                ++page_count;
+                packer.init(side);
+                if (!packer.insert(pw, ph, x, y)) return false;
+            }
+            rect(k).x = x;
+            rect(k).y = y;
+            rect(k).page = (uint16_t)(page_count - 1);
+        }
+        packed = true;
+    }
+    if (!packed) return false;
+
+    out_side = side;
+    out_page_count = page_count;
+    return true;
+}
+
+// Shared body of Font::Plan and MultiFont::Plan.
+// resolve(i, gp) fills font/glyph_index/bbox/num_points for input codepoint i and
+// returns false when it has no outline; scales/spreads_fu are indexed by gp.font.
+// Pass out_plan == nullptr to only size the plan block (PlanBytes).
+template<class ResolveF>
+static inline size_t plan_cells_(const PlanInput& in, ResolveF resolve,
+                                 const float* scales, const float* spreads_fu,
+                                 void* plan_mem, size_t plan_bytes,
+                                 FontPlan* out_plan) noexcept {
+    if (!in.codepoints || in.codepoint_count == 0) return 0;
+    if (in.format == AtlasFormat::BC && (in.max_page_side & 3u)) return 0;
+
+    auto cell_rect = [&](GlyphPlan& gp) noexcept {
+        const float scale = scales[gp.font], spread_fu = spreads_fu[gp.font];
+        const float span_x = (float)(gp.x_max - gp.x_min) + 2.f * spread_fu;
+        const float span_y = (float)(gp.y_max - gp.y_min) + 2.f * spread_fu;
+        gp.rect.w = ceil_to_u16(span_x * scale);
+        gp.rect.h = ceil_to_u16(span_y * scale);
+        gp.rect.x = 0;
+        gp.rect.y = 0;
+        gp.rect.page = 0;
+    };
+
+    // --------- First: count ----------
+    uint32_t glyph_count = 0;
+    uint16_t max_points = 0;
+    uint32_t max_area = 0;
+    uint32_t max_block_area = 0;
+    uint16_t max_w = 0, max_h = 0; // packed extents
+
+    for (uint32_t i = 0; i < in.codepoint_count; ++i) {
+        GlyphPlan gp{};
+        if (!resolve(i, gp)) continue;
+        cell_rect(gp);
+
+        const uint32_t area = (uint32_t)gp.rect.w * (uint32_t)gp.rect.h;
+        if (area > max_area) max_area = area;
+
+        const uint16_t pw = pack_dim(gp.rect.w, in.format);
+        const uint16_t ph = pack_dim(gp.rect.h, in.format);
+        if ((uint32_t)pw * ph > max_block_area) max_block_area = (uint32_t)pw * ph;
+        if (pw > max_w) max_w = pw;
+        if (ph > max_h) max_h = ph;
+
+        if (gp.num_points > max_points) max_points = gp.num_points;
+
+        ++glyph_count;
+    }
+
+    if (!glyph_count) return 0;
+
+    const size_t pack_bytes = pack_region_bytes(glyph_count, in.pack_mode);
+    const uint32_t node_cap = (uint32_t)(pack_bytes / sizeof(SkylineNode));
+
+    const size_t stage_bytes = in.format == AtlasFormat::BC
+                             ? (size_t)max_block_area * (uint32_t)in.mode : 0;
+
+    const size_t need_bytes = plan_block_bytes(glyph_count, pack_bytes, max_points, max_area,
+                                               in.mode, stage_bytes);
+    if (!out_plan) return need_bytes;
+    if (!plan_mem || plan_bytes < need_bytes) return 0;
+
+    // --------- Bind plan block ----------
+    MemArena a{};
+    a.init(plan_mem, plan_bytes);
+
+    GlyphPlan* glyphs = (GlyphPlan*)a.take((size_t)glyph_count * sizeof(GlyphPlan), 16);
+    uint32_t* order = (uint32_t*)a.take(glyph_count * sizeof(uint32_t), 16);
+    uint32_t* map_cp   = (uint32_t*)a.take(glyph_count * sizeof(uint32_t), 16);
+    uint32_t* map_slot = (uint32_t*)a.take(glyph_count * sizeof(uint32_t), 16);
+    SkylineNode* nodes = (SkylineNode*)a.take(pack_bytes, 16);
+
+    const size_t scratch_bytes = glyph_scratch_bytes(max_points, max_area, in.mode);
+    void* scratch_mem = a.take(scratch_bytes, 16);
+    uint8_t* stage = stage_bytes ? (uint8_t*)a.take(stage_bytes, 16) : nullptr;
+
+    if (!glyphs || !order || !map_cp || !map_slot || !nodes || !scratch_mem) return 0;
+    if (stage_bytes && !stage) return 0;
+
+    // --------- Fill glyph array (second pass) ----------
+    uint32_t at = 0;
+    for (uint32_t i = 0; i < in.codepoint_count && at < glyph_count; ++i) {
+        GlyphPlan& gp = glyphs[at];
+        gp = GlyphPlan{};
+        if (!resolve(i, gp)) continue;
+        gp.codepoint = in.codepoints[i];
+        cell_rect(gp);
+        map_cp[at++] = gp.codepoint;
+    }
+
+    // defensive: should match glyph_count
+    if (at != glyph_count) return 0;
+
+    // pack region (>= 2*N+16 nodes of 6 bytes) doubles as the radix ping-pong buffer
+    uint32_t* tmp = (uint32_t*)nodes;
+
+    // --------- collapse codepoints sharing a glyph ---------
+    // stable sort by (font, glyph index): the first entry of each run (lowest input
+    // position) owns the cell, the others only get a codepoint -> slot entry
+    auto glyph_key = [glyphs](uint32_t k) noexcept -> uint32_t {
+        return ((uint32_t)glyphs[k].font << 16) | glyphs[k].glyph_index;
+    };
+    const uint32_t mapped_count = glyph_count;
+    radix_sort_order_(glyph_key, order, tmp, mapped_count);
+    for (uint32_t i = 0; i < mapped_count; ++i) {
+        const uint32_t k = order[i];
+        map_slot[k] = (i && glyph_key(order[i-1]) == glyph_key(k)) ? map_slot[order[i-1]] : k;
+    }
+    // compact owners in input order (order[] now maps input position -> slot)
+    glyph_count = 0;
+    uint64_t total_area = 0; // summed over unique glyphs after dedup
+    for (uint32_t k = 0; k < mapped_count; ++k) {
+        if (map_slot[k] != k) continue;
+        order[k] = glyph_count;
+        glyphs[glyph_count++] = glyphs[k];
+        total_area += (uint64_t)pack_dim(glyphs[k].rect.w, in.format)
+                    * pack_dim(glyphs[k].rect.h, in.format);
+    }
+    for (uint32_t k = 0; k < mapped_count; ++k) map_slot[k] = order[map_slot[k]];
+
+    // codepoint map sorted by codepoint; repeated codepoints collapse too
+    radix_sort_order_([map_cp](uint32_t k) noexcept -> uint32_t { return map_cp[k]; },
+                      order, tmp, mapped_count);
+    for (uint32_t i = 0; i < mapped_count; ++i) tmp[i] = map_cp[order[i]];
+    for (uint32_t i = 0; i < mapped_count; ++i) map_cp[i] = tmp[i];
+    for (uint32_t i = 0; i < mapped_count; ++i) tmp[i] = map_slot[order[i]];
+    uint32_t codepoint_count = 0;
+    for (uint32_t i = 0; i < mapped_count; ++i) {
+        if (codepoint_count && map_cp[codepoint_count-1] == map_cp[i]) continue;
+        map_cp[codepoint_count] = map_cp[i];
+        map_slot[codepoint_count++] = tmp[i];
+    }
+
+    // --------- sort glyphs by height/area ---------
+    radix_sort_order_hw_desc(glyphs, order, tmp, glyph_count);
+
+    // --------- Choose atlas side and pack ----------
+    AtlasPacker packer{};
+    packer.mode = in.pack_mode;
+    packer.mem = nodes;
+    packer.bytes = pack_bytes;
+
+    uint16_t side = 0;
+    uint16_t page_count = 1;
+    if (!pack_cells_(packer, [glyphs](uint32_t k) noexcept -> GlyphRect& { return glyphs[k].rect; },
+                     order, glyph_count, in.format, in.max_page_side,
+                     total_area, max_w, max_h, side, page_count))
+        return 0;
+
+    // --------- Fill out_plan (scale/spread_fu are the caller's) ----------
+    FontPlan& p = *out_plan;
+    p.mode = in.mode;
+    p.format = in.format;
+    p.pixel_height = in.pixel_height;
+
+    p.atlas_side = side;
+    p.page_count = page_count;
+    p.glyph_count = glyph_count;
+    p.codepoint_count = codepoint_count;
+    p.max_points = max_points;
+    p.max_area = max_area;
+
+    p._mem = plan_mem;
+    p._mem_bytes = plan_bytes;
+
+    p._glyphs = glyphs;
+    p._map_cp = map_cp;
+    p._map_slot = map_slot;
+    p._nodes = nodes;
+    p._node_cap = node_cap;
+
+    p._scratch_mem = scratch_mem;
+    p._scratch_bytes = scratch_bytes;
+    p._stage = stage;
+    p._stage_bytes = stage_bytes;
+
+    return need_bytes;
+}
+
+// Plan/stride checks shared by every Build flavour.
+static inline bool build_plan_ok_(const FontPlan& plan, uint32_t stride_bytes) noexcept {
+    if (!plan._glyphs || !plan._scratch_mem) return false;
+    if (!plan.atlas_side || !plan.page_count || !plan.glyph_count) return false;
+    if (stride_bytes < AtlasStrideBytes(plan))
+        return false;
+    if (plan.format == AtlasFormat::BC && (!plan._stage || (plan.atlas_side & 3u))) return false;
+    return true;
+}
+
+// One cell of `plan` into its page: bounds checks, BC staging.
+// render(gp, atlas, stride, scratch) writes the distance field at gp.rect.
+template<class RenderF>
+static inline bool build_cell_(const FontPlan& plan, const GlyphPlan& gp,
+                               uint8_t* page, uint32_t stride_bytes,
+                               GlyphScratch& scratch, RenderF& render) noexcept {
+    if (gp.rect.page >= plan.page_count) return false;
+
+    // bounds check (each page is square side x side)
+    if ((uint32_t)gp.rect.x + gp.rect.w > plan.atlas_side)
+        return false;
+    if ((uint32_t)gp.rect.y + gp.rect.h > plan.atlas_side)
+        return false;
+
+    // IMPORTANT: reset recursion guard per glyph
+    scratch.visit_n = 0;
+
+    if (plan.format == AtlasFormat::BC) {
+        // render the cell into staging at (0,0), then encode its blocks in place
+        if ((gp.rect.x | gp.rect.y) & 3u) return false;
+        const uint32_t comp = (uint32_t)plan.mode;
+        GlyphPlan cell = gp;
+        cell.rect.x = 0;
+        cell.rect.y = 0;
+        const uint32_t bw = (gp.rect.w + 3u) >> 2, bh = (gp.rect.h + 3u) >> 2;
+        const uint32_t cell_stride = bw * 4u * comp;
+        if ((size_t)cell_stride * bh * 4u > plan._stage_bytes) return false;
+        if (!render(cell, plan._stage, cell_stride, scratch))
+            return false;
+        bc_pad_cell(plan._stage, cell_stride, gp.rect.w, gp.rect.h, comp);
+        bc_encode_cell(plan._stage, cell_stride, comp, bw, bh, page, plan.atlas_side,
+                       gp.rect.x >> 2, gp.rect.y >> 2, stride_bytes);
+        return true;
+    }
+    // NOTE: stride is BYTES, not width in pixels
+    return render(gp, page, stride_bytes, scratch);
+}
+
+// Shared body of Font::Build and MultiFont::Build.
+// Page p is pages[p] when given, else base + p * page_bytes.
+template<class RenderF>
+static inline bool build_cells_(const FontPlan& plan, uint8_t* const* pages,
+                                uint8_t* base, size_t page_bytes,
+                                uint32_t stride_bytes, RenderF render) noexcept {
+    if (!build_plan_ok_(plan, stride_bytes)) return false;
+
+    // bind scratch views (also sets visit_n=0, etc.)
+    GlyphScratch scratch = bind_glyph_scratch(plan._scratch_mem,
+        plan.max_points,
+        plan.max_area,
+        plan.mode);
+
+    for (uint32_t i = 0; i < plan.glyph_count; ++i) {
+        const GlyphPlan& gp = plan._glyphs[i];
+        uint8_t* page = pages ? pages[gp.rect.page < plan.page_count ? gp.rect.page : 0]
+                              : base + (size_t)gp.rect.page * page_bytes;
+        if (!build_cell_(plan, gp, page, stride_bytes, scratch, render))
+            return false;
+    }
+    return true;
+}
+
+// Bytes for the GlyphMetricsTable of `plan` (0 if it has no codepoints).
+static inline size_t metrics_table_bytes_(const FontPlan& plan, uint32_t* out_top_count = nullptr,
+                                          uint32_t* out_page_count = nullptr) noexcept {
+    if (!plan._map_cp || !plan.codepoint_count || plan.glyph_count >= GlyphMetricsTable::NO_SLOT)
+        return 0;
+    uint32_t pages = 0;
+    for (uint32_t i = 0; i < plan.codepoint_count; ++i) // _map_cp is ascending
+        if (!i || (plan._map_cp[i] >> 8) != (plan._map_cp[i-1] >> 8)) ++pages;
+    const uint32_t top = (plan._map_cp[plan.codepoint_count - 1] >> 8) + 1u;
+    if (out_top_count) *out_top_count = top;
+    if (out_page_count) *out_page_count = pages;
+
+    size_t off = 0;
+    off = align_up(off, 16); off += (size_t)top * sizeof(uint16_t);
+    off = align_up(off, 16); off += (size_t)pages * 256u * sizeof(uint16_t);
+    for (int a = 0; a < 11; ++a) { // u0 v0 u1 v1 layer plane_l/b/r/t advance bearing
+        off = align_up(off, 16); off += (size_t)plan.glyph_count * sizeof(uint16_t);
+    }
+    return off;
+}
+
+// Shared body of Font/MultiFont::BuildMetricsTable.
+// cell(gp, advance_em, bearing_em, origin_x_em, origin_y_em) gives the glyph's
+// horizontal metrics and the em position of its cell's bottom-left corner.
+template<class CellF>
+static inline bool metrics_table_(const FontPlan& plan, void* mem, size_t bytes,
+                                  GlyphMetricsTable& out, CellF cell) noexcept {
+    uint32_t top_count = 0, page_count = 0;
+    const size_t need = metrics_table_bytes_(plan, &top_count, &page_count);
+    if (!need || !mem || bytes < need || !plan._glyphs || !plan.atlas_side || !plan.pixel_height)
+        return false;
+
+    MemArena a{};
+    a.init(mem, bytes);
+    GlyphMetricsTable t{};
+    t.glyph_count = plan.glyph_count;
+    t.top_count = top_count;
+    t.page_count = page_count;
+    t.atlas_side = plan.atlas_side;
+    t.mem = mem;
+    t.bytes = need;
+
+    t.top = (uint16_t*)a.take((size_t)top_count * sizeof(uint16_t), 16);
+    t.pages = (uint16_t*)a.take((size_t)page_count * 256u * sizeof(uint16_t), 16);
+    uint16_t** arrays[11] = { &t.u0, &t.v0, &t.u1, &t.v1, &t.layer,
+                              &t.plane_l, &t.plane_b, &t.plane_r, &t.plane_t,
+                              &t.advance, &t.bearing };
+    for (uint16_t** p : arrays) *p = (uint16_t*)a.take((size_t)plan.glyph_count * sizeof(uint16_t), 16);
+    if (!t.top || !t.pages || !t.bearing) return false;
+
+    // two-level map from the sorted codepoint map
+    for (uint32_t i = 0; i < top_count; ++i) t.top[i] = GlyphMetricsTable::NO_SLOT;
+    for (uint32_t i = 0; i < page_count * 256u; ++i) t.pages[i] = GlyphMetricsTable::NO_SLOT;
+    uint32_t page = 0;
+    for (uint32_t i = 0; i < plan.codepoint_count; ++i) {
+        const uint32_t cp = plan._map_cp[i];
+        if (i && (cp >> 8) != (plan._map_cp[i-1] >> 8)) ++page;
+        t.top[cp >> 8] = (uint16_t)page;
+        t.pages[page * 256u + (cp & 255u)] = (uint16_t)plan._map_slot[i];
+    }
+
+    const float side = (float)plan.atlas_side;
+    const float inv_px = 1.f / (float)plan.pixel_height;
+    auto unorm16 = [side](uint32_t v) noexcept { return (uint16_t)((float)v / side * 65535.f + .5f); };
+    for (uint32_t i = 0; i < plan.glyph_count; ++i) {
+        const GlyphPlan& gp = plan._glyphs[i];
+        float adv = 0.f, lsb = 0.f, ox = 0.f, oy = 0.f;
+        if (!cell(gp, adv, lsb, ox, oy)) return false;
+
+        t.u0[i] = unorm16(gp.rect.x);
+        t.v0[i] = unorm16(gp.rect.y);
+        t.u1[i] = unorm16((uint32_t)gp.rect.x + gp.rect.w);
+        t.v1[i] = unorm16((uint32_t)gp.rect.y + gp.rect.h);
+        t.layer[i] = gp.rect.page;
+        t.plane_l[i] = half_from_float(ox);
+        t.plane_b[i] = half_from_float(oy);
+        t.plane_r[i] = half_from_float(ox + (float)gp.rect.w * inv_px);
+        t.plane_t[i] = half_from_float(oy + (float)gp.rect.h * inv_px);
+        t.advance[i] = half_from_float(adv);
+        t.bearing[i] = half_from_float(lsb);
+    }
+    out = t;
+    return true;
+}
+
 static inline float fminf(float a, float b) noexcept { return a < b ? a : b; }
 static inline float fmaxf(float a, float b) noexcept { return a > b ? a : b; }
 static inline float fabsf_i(float v) noexcept { return v < 0.f ? -v : v; }
@@ -551,7 +1452,11 @@ struct DfGridFast {
     uint8_t  out_comp;     // 1 for SDF, 3 for MSDF
     int shift_x, shift_y;  // cell top-left in atlas
 
-    int w, h;              // cell_size
+    int w, h;              // tile size
+    int full_w, full_h;    // cell size
+    int tile_x, tile_y;    // tile top-left inside the cell
+    float tile_fy_min;     // font-space y of the tile's bottom / top pixel rows
+    float tile_fy_max;
     float scale;           // pixels per font unit
     float inv_scale;       // font units per pixel
     float spread;          // in font units
@@ -567,10 +1472,31 @@ struct DfGridFast {
 
     uint8_t* inside;       // [w*h]
 };
+// x, y are tile-local; the math runs on cell coordinates so tiling does not change results
 static inline void pixel_center_to_font(float& fx, float& fy, const DfGridFast& g,
                                         int x, int y) noexcept {
-    fx = g.origin_x + (x+.5f) * g.inv_scale;
-    fy = g.origin_y + ((g.h-1 - y) + .5f) * g.inv_scale;
+    fx = g.origin_x + ((x + g.tile_x) + .5f) * g.inv_scale;
+    fy = g.origin_y + ((g.full_h-1 - (y + g.tile_y)) + .5f) * g.inv_scale;
+}
+static inline void df_grid_set_tile(DfGridFast& g, int tx, int ty, int tw, int th) noexcept {
+    g.tile_x = tx; g.tile_y = ty;
+    g.w = tw;      g.h = th;
+    float fx_dummy;
+    pixel_center_to_font(fx_dummy, g.tile_fy_max, g, 0, 0);
+    pixel_center_to_font(fx_dummy, g.tile_fy_min, g, 0, th - 1);
+}
+// Clips a font-space segment bbox (already expanded by spread) to the tile.
+// Returns false when the segment cannot touch any pixel of the tile.
+static inline bool df_tile_cull(const DfGridFast& g, float minx, float maxx,
+                                float miny, float maxy, int& px0, int& px1) noexcept {
+    if (maxy < g.tile_fy_min || miny > g.tile_fy_max) return false;
+
+    px0 = (int)((minx - g.origin_x) * g.scale) - g.tile_x;
+    px1 = (int)((maxx - g.origin_x) * g.scale) - g.tile_x;
+    if (px0 > px1) { int t = px0; px0 = px1; px1 = t; }
+    if (px0 < 0) px0 = 0;
+    if (px1 >= g.w) px1 = g.w - 1;
+    return px0 <= px1;
 }
 
 struct DfWindingPass {
@@ -651,11 +1577,8 @@ struct SdfDistanceBBoxPass {
         float miny = (y0<y1 ? y0:y1) - g.spread;
         float maxy = (y0>y1 ? y0:y1) + g.spread;
 
-        int px0 = (int)((minx - g.origin_x) * g.scale);
-        int px1 = (int)((maxx - g.origin_x) * g.scale);
-        if (px0 > px1) { int t = px0; px0 = px1; px1 = t; }
-        if (px0 < 0) px0 = 0;
-        if (px1 >= g.w) px1 = g.w - 1;
+        int px0, px1;
+        if (!df_tile_cull(g, minx, maxx, miny, maxy, px0, px1)) return;
 
         // y is flipped, so we clamp by scanning all y but skip rows outside miny/maxy
         for (int y=0; y<g.h; ++y) {
@@ -698,11 +1621,8 @@ struct MsdfDistanceBBoxPass {
         float miny = (y0 < y1 ? y0 : y1) - g.spread;
         float maxy = (y0 > y1 ? y0 : y1) + g.spread;
 
-        int px0 = (int)((minx - g.origin_x) * g.scale);
-        int px1 = (int)((maxx - g.origin_x) * g.scale);
-        if (px0 > px1) { int t = px0; px0 = px1; px1 = t; }
-        if (px0 < 0) px0 = 0;
-        if (px1 >= g.w) px1 = g.w - 1;
+        int px0, px1;
+        if (!df_tile_cull(g, minx, maxx, miny, maxy, px0, px1)) return;
 
         for (int y = 0; y < g.h; ++y) {
             float fx_dummy, fy;
@@ -806,8 +1726,8 @@ struct DfSignScanlinePass {
             float a = (x0 - g.origin_x) * g.scale - 0.5f;
             float b = (x1 - g.origin_x) * g.scale - 0.5f;
 
-            int px0 = iceil(a);
-            int px1 = iceil(b);   // exclusive end
+            int px0 = iceil(a) - g.tile_x;
+            int px1 = iceil(b) - g.tile_x;   // exclusive end
 
             if (px0 < 0) px0 = 0;
             if (px1 > w) px1 = w;
@@ -916,50 +1836,282 @@ struct DfSink {
 
 }; // struct DfSink
 
-struct Font {
-    explicit Font() noexcept = default;
-    ~Font() noexcept = default;
+// One flattened outline segment (font units), as DfSink hands it to a pass.
+struct OutlineSeg {
+    float   x0, y0, x1, y1;
+    uint8_t color;
+};
+// Segments kept per glyph by Font::BuildMany: every point yields at most one
+// flattened quad (8 lines) plus the closing lines, with room for composites.
+static constexpr uint32_t outline_seg_cap(uint16_t max_points) noexcept {
+    return 16u * max_points + 64u;
+}
+// DfSink pass that records the flattened outline instead of rasterizing it.
+// `count` keeps counting past `cap`, so overflow is visible afterwards.
+struct OutlineRecordPass {
+    OutlineSeg* segs;
+    uint32_t    cap;
+    uint32_t    count;
 
-    inline bool ReadBytes(uint8_t* font_buffer) noexcept;
-    inline float ScaleForPixelHeight(float height) const noexcept;
-    inline int FindGlyphIndex(int unicode_codepoint) const noexcept;
-    inline GlyphHorMetrics GetGlyphHorMetrics(int glyph_index) const noexcept;
+    inline void begin() noexcept {}
+    inline void set_origin(float, float) noexcept {}
+    inline void line(float x0, float y0, float x1, float y1, uint8_t color) noexcept {
+        if (count < cap) segs[count] = OutlineSeg{ x0, y0, x1, y1, color };
+        ++count;
+    }
+};
 
-    // INIT
-    inline size_t PlanBytes(const PlanInput& in) const noexcept;
+// Distance field of one outline into `rect` (all of StreamDF but the outline source).
+// emit(sink) streams the outline into a DfSink and returns false on bad data;
+// it runs once per pass and once per pixel row of each tile.
+// origin_x/origin_y: outline-space position of the cell's bottom-left corner.
+template<class EmitF>
+static inline bool stream_df_cell(const GlyphRect& rect, float origin_x, float origin_y,
+                                  unsigned char* atlas, uint32_t atlas_stride_bytes,
+                                  DfMode mode, float scale, float spread,
+                                  GlyphScratch& scratch, uint32_t max_area,
+                                  EmitF&& emit) noexcept {
+    if (!atlas) return false;
+    if (rect.w == 0 || rect.h == 0) return false;
 
-    // PASS 1
-    inline bool Plan(const PlanInput& in,
-                     void* plan_mem, size_t plan_bytes,
-                     FontPlan& out_plan) noexcept;
-    // PASS 2
-    inline bool Build(const FontPlan& plan,
-                      uint8_t* atlas,
-                      uint32_t atlas_stride_bytes) noexcept;
+    const int w = (int)rect.w;
+    const int h = (int)rect.h;
+    const uint32_t tile_area = scratch_tile_area(max_area);
+    if (!tile_area) return false;
 
-    // 1 glyph, independent: unrelated to passes, streams glyph
-    inline bool StreamDF(const GlyphPlan& gp,
-        unsigned char* atlas,
-        uint32_t atlas_stride_bytes, // atlas stride
-        DfMode mode,          // SDF or MSDF
-        float scale,          // pixels per font unit
-        float spread,         // font units
-        GlyphScratch& scratch,
-        uint16_t max_points,  // from plan
-        uint32_t max_area     // from plan
-    ) noexcept;
+    DfGridFast gg{};
+    gg.out = (uint8_t*)atlas;
+    gg.out_comp = (mode == DfMode::SDF) ? 1 : (mode == DfMode::MSDF) ? 3 : 4;
+    gg.out_stride = atlas_stride_bytes;
+    gg.shift_x = (int)rect.x;
+    gg.shift_y = (int)rect.y;
 
-    
-    // public helper (tiny, no skyline, no passes)
-    inline bool GetGlyphPlanInfo(int glyph_index, GlyphPlanInfo& out) const noexcept {
-        return parse_glyph_plan_info_(_data, _loca, _glyf, _index_to_loc_format, _num_glyphs, glyph_index, out);
-    }
+    gg.full_w = w;
+    gg.full_h = h;
 
-public:
-    static inline int GetFontOffsetForIndex(uint8_t* font_buffer, int index) noexcept;
-    static inline int GetNumberOfFonts(const uint8_t* font_buffer) noexcept;
+    gg.scale = scale;
+    gg.inv_scale = scale>0.f ? 1.f/scale : 0.f;
+    gg.spread = spread;
+
+    gg.origin_x = origin_x;
+    gg.origin_y = origin_y;
+
+    gg.inside = scratch.inside;
+
+    // --------- bind distance buffers ----------
+    if (mode == DfMode::SDF) {
+        gg.d2 = scratch.min_d2;
+        gg.d2r = gg.d2g = gg.d2b = nullptr;
+    }
+    else if (mode == DfMode::MSDF) {
+        gg.d2 = nullptr;
+        gg.d2r = scratch_d2_r(scratch);
+        gg.d2g = scratch_d2_g(scratch, max_area);
+        gg.d2b = scratch_d2_b(scratch, max_area);
+    }
+    else { // MTSDF
+        gg.d2  = scratch_d2_a(scratch, max_area);
+        gg.d2r = scratch_d2_r(scratch);
+        gg.d2g = scratch_d2_g(scratch, max_area);
+        gg.d2b = scratch_d2_b(scratch, max_area);
+    }
+
+    // Tiles are full-width bands (split in x only for cells wider than a tile),
+    // so the sign pass still streams the outline once per pixel row.
+    // A cell that fits one tile is processed exactly as before.
+    const int tile_w = (uint32_t)w < tile_area ? w : (int)tile_area;
+    int tile_h = (int)(tile_area / (uint32_t)tile_w);
+    if (tile_h > h) tile_h = h;
+
+    for (int ty = 0; ty < h; ty += tile_h) {
+    for (int tx = 0; tx < w; tx += tile_w) {
+        const int tw = (w - tx) < tile_w ? (w - tx) : tile_w;
+        const int th = (h - ty) < tile_h ? (h - ty) : tile_h;
+        df_grid_set_tile(gg, tx, ty, tw, th);
+
+        // =====================================================================
+        // 1) distance pass (segments outside the tile are culled per segment)
+        // =====================================================================
+        STBTT_STREAM_STAGE_BEGIN(DfStage::Distance);
+        if (mode == DfMode::SDF) {
+            SdfDistanceBBoxPass pass(gg);
+            DfSink<SdfDistanceBBoxPass> sink(pass);
+
+            if (!emit(sink))
+                return false;
+        }
+        else if (mode == DfMode::MSDF) {
+            MsdfDistanceBBoxPass pass(gg);
+            DfSink<MsdfDistanceBBoxPass> sink(pass);
+
+            if (!emit(sink))
+                return false;
+        }
+        else { // MTSDF: RGB from MSDF + A from true SDF
+            {
+                MsdfDistanceBBoxPass pass(gg);
+                DfSink<MsdfDistanceBBoxPass> sink(pass);
+    
+                if (!emit(sink))
+                    return false;
+            }
+            {
+                SdfDistanceBBoxPass pass(gg);
+                DfSink<SdfDistanceBBoxPass> sink(pass);
+    
+                if (!emit(sink))
+                    return false;
+            }
+        }
+
+        STBTT_STREAM_STAGE_END(DfStage::Distance);
+
+        // =====================================================================
+        // 2) sign pass (same for both)
+        // =====================================================================
+        STBTT_STREAM_STAGE_BEGIN(DfStage::Sign);
+        {
+            DfSignScanlinePass pass(gg, scratch.xs);
+            DfSink<DfSignScanlinePass> sink(pass);
+
+            for (int y=0; y<th; ++y) {
+                pass.begin_row(y);
+                if (!emit(sink))
+                    return false;
+                pass.finalize_row(y);
+            }
+        }
+
+        STBTT_STREAM_STAGE_END(DfStage::Sign);
+
+        // 3) finalize tile to atlas: distances -> codes over the whole tile, then sign + store
+        STBTT_STREAM_STAGE_BEGIN(DfStage::Finalize);
+        const uint32_t tile_n = (uint32_t)(tw * th);
+        if (mode != DfMode::MSDF) df_codes_u16(gg.d2, tile_n);
+        if (mode != DfMode::SDF) {
+            df_codes_u16(gg.d2r, tile_n);
+            df_codes_u16(gg.d2g, tile_n);
+            df_codes_u16(gg.d2b, tile_n);
+        }
+        const uint32_t comp = (uint32_t)gg.out_comp;
+        for (int y=0; y<th; ++y) {
+            uint8_t* row = gg.out + (uint32_t)(gg.shift_y + ty + y) * gg.out_stride
+                         + (uint32_t)(gg.shift_x + tx) * comp;
+            const uint8_t* in = gg.inside + y*tw;
+            if (mode == DfMode::SDF) {
+                const uint16_t* d = gg.d2 + y*tw;
+                for (int x=0; x<tw; ++x) row[x] = df_code_byte(d[x], in[x]);
+            }
+            else {
+                const uint16_t* r = gg.d2r + y*tw;
+                const uint16_t* g = gg.d2g + y*tw;
+                const uint16_t* b = gg.d2b + y*tw;
+                const uint16_t* a = gg.d2 ? gg.d2 + y*tw : nullptr;
+                for (int x=0; x<tw; ++x) {
+                    uint8_t* p = row + (uint32_t)x * comp;
+                    p[0] = df_code_byte(r[x], in[x]);
+                    p[1] = df_code_byte(g[x], in[x]);
+                    p[2] = df_code_byte(b[x], in[x]);
+                    if (a) p[3] = df_code_byte(a[x], in[x]);
+                }
+            }
+        }
+        STBTT_STREAM_STAGE_END(DfStage::Finalize);
+    } // tx
+    } // ty
+    return true;
+}
+
+
+struct Font {
+    explicit Font() noexcept = default;
+    ~Font() noexcept = default;
+
+    inline bool ReadBytes(uint8_t* font_buffer) noexcept;
+    inline float ScaleForPixelHeight(float height) const noexcept;
+    inline int FindGlyphIndex(int unicode_codepoint) const noexcept;
+    // Calls sink(codepoint, glyph_index) for every mapped codepoint in [first, last],
+    // ascending. Walks the cmap segments/groups directly: O(segments + hits).
+    template<class SinkT>
+    inline uint32_t ForEachMappedCodepoint(uint32_t first, uint32_t last, SinkT& sink) const noexcept;
+    inline GlyphHorMetrics GetGlyphHorMetrics(int glyph_index) const noexcept;
+
+    // INIT
+    inline size_t PlanBytes(const PlanInput& in) const noexcept;
+
+    // PASS 1
+    inline bool Plan(const PlanInput& in,
+                     void* plan_mem, size_t plan_bytes,
+                     FontPlan& out_plan) noexcept;
+    // PASS 2
+    // pages are stored back to back: page p starts at atlas + p * AtlasPageBytes(plan, stride)
+    inline bool Build(const FontPlan& plan,
+                      uint8_t* atlas,
+                      uint32_t atlas_stride_bytes) noexcept;
+    // one pointer per page (plan.page_count entries), e.g. mapped texture array layers
+    inline bool Build(const FontPlan& plan,
+                      uint8_t* const* pages,
+                      uint32_t page_stride_bytes) noexcept;
+
+    // PASS 2 for several plans of the same codepoints (other sizes/modes/formats):
+    // each outline is decoded once into outline_mem and rendered into every plan.
+    // atlases[k]/strides[k] as in Build(plans[k], atlas, stride).
+    static inline size_t BuildManyBytes(const FontPlan* plans, uint32_t plan_count) noexcept;
+    inline bool BuildMany(const FontPlan* plans, uint32_t plan_count,
+                          uint8_t* const* atlases, const uint32_t* strides,
+                          void* outline_mem, size_t outline_bytes) noexcept;
+
+    // GPU-ready metrics (UVs, plane bounds, advance/bearing) + codepoint map for a plan
+    static inline size_t MetricsTableBytes(const FontPlan& plan) noexcept;
+    inline bool BuildMetricsTable(const FontPlan& plan, void* mem, size_t bytes,
+                                  GlyphMetricsTable& out_table) const noexcept;
+
+    // 1 glyph, independent: unrelated to passes, streams glyph
+    inline bool StreamDF(const GlyphPlan& gp,
+        unsigned char* atlas,
+        uint32_t atlas_stride_bytes, // atlas stride
+        DfMode mode,          // SDF or MSDF
+        float scale,          // pixels per font unit
+        float spread,         // font units
+        GlyphScratch& scratch,
+        uint16_t max_points,  // from plan
+        uint32_t max_area     // from plan
+    ) noexcept;
+
+    
+    // public helper (tiny, no skyline, no passes)
+    inline bool GetGlyphPlanInfo(int glyph_index, GlyphPlanInfo& out) const noexcept {
+        return parse_glyph_plan_info_(_data, _loca, _glyf, _index_to_loc_format, _num_glyphs, glyph_index, out);
+    }
+    // GetGlyphPlanInfo for `count` glyph indices, cached for PlanInput::glyph_infos;
+    // unmapped or unreadable glyphs come out is_empty
+    inline void GetGlyphPlanInfos(const uint16_t* glyph_indices, uint32_t count,
+                                  GlyphPlanInfo* out) const noexcept {
+        for (uint32_t i = 0; i < count; ++i) {
+            out[i] = GlyphPlanInfo{};
+            if (!glyph_indices[i] || !GetGlyphPlanInfo(glyph_indices[i], out[i])) out[i].is_empty = true;
+            out[i].glyph_index = glyph_indices[i];
+        }
+    }
+    // font-wide upper bounds: 'head' bbox + 'maxp' point counts (for glyph sets unknown up front)
+    inline bool GetFontPlanInfo(GlyphPlanInfo& out) const noexcept;
+    // FNV-1a over the table directory (tags, checksums, offsets, lengths) and 'head'
+    inline uint64_t ContentHash() const noexcept;
+
+public:
+    static inline int GetFontOffsetForIndex(uint8_t* font_buffer, int index) noexcept;
+    static inline int GetNumberOfFonts(const uint8_t* font_buffer) noexcept;
+
+private:
+    inline int plan_glyph_index_(const PlanInput& in, uint32_t i) const noexcept {
+        return in.glyph_indices ? (int)in.glyph_indices[i] : FindGlyphIndex((int)in.codepoints[i]);
+    }
+    // glyph index, bbox and point count of input codepoint i; false if it has no outline
+    inline bool plan_glyph_(const PlanInput& in, uint32_t i, GlyphPlan& gp) const noexcept;
+    inline bool build_pages_(const FontPlan& plan, uint8_t* const* pages,
+                             uint8_t* base, size_t page_bytes,
+                             uint32_t stride_bytes) noexcept;
 
-private:
     template<class SinkT>
     bool RunGlyfStream(int glyph_index, SinkT& sink, const Xform& xf, float spread,
                         GlyphScratch& scratch, uint16_t max_points) noexcept;
@@ -1035,241 +2187,28 @@ inline bool Font::StreamDF(const GlyphPlan& gp,
                             float spread,         // font units
                             GlyphScratch& scratch,
                             uint16_t max_points, uint32_t max_area) noexcept {
-    if (!atlas) return false;
-    if (gp.rect.w == 0 || gp.rect.h == 0) return false;
-
-    const int w = (int)gp.rect.w;
-    const int h = (int)gp.rect.h;
-    const uint32_t area = (uint32_t)w * (uint32_t)h;
-    if (area > (uint32_t)max_area) return false;
-
-    DfGridFast gg{};
-    gg.out = (uint8_t*)atlas;
-    gg.out_comp = (mode == DfMode::SDF) ? 1 : (mode == DfMode::MSDF) ? 3 : 4;
-    gg.out_stride = atlas_stride_bytes;
-    gg.shift_x = (int)gp.rect.x;
-    gg.shift_y = (int)gp.rect.y;
-
-    gg.w = w;
-    gg.h = h;
-
-    gg.scale = scale;
-    gg.inv_scale = scale>0.f ? 1.f/scale : 0.f;
-    gg.spread = spread;
-
     // rect origin in font space: bbox expanded by spread on both sides
-    gg.origin_x = (float)gp.x_min - spread;
-    gg.origin_y = (float)gp.y_min - spread;
-
-    gg.inside = scratch.inside;
-
-    // --------- bind distance buffers ----------
-    if (mode == DfMode::SDF) {
-        gg.d2 = scratch.min_d2;
-        gg.d2r = gg.d2g = gg.d2b = nullptr;
-    }
-    else if (mode == DfMode::MSDF) {
-        gg.d2 = nullptr;
-        gg.d2r = scratch_d2_r(scratch);
-        gg.d2g = scratch_d2_g(scratch, max_area);
-        gg.d2b = scratch_d2_b(scratch, max_area);
-    }
-    else { // MTSDF
-        gg.d2  = scratch_d2_a(scratch, max_area);
-        gg.d2r = scratch_d2_r(scratch);
-        gg.d2g = scratch_d2_g(scratch, max_area);
-        gg.d2b = scratch_d2_b(scratch, max_area);
-    }
-
-    // =====================================================================
-    // 1) distance pass
-    // =====================================================================
-    if (mode == DfMode::SDF) {
-        SdfDistanceBBoxPass pass(gg);
-        DfSink<SdfDistanceBBoxPass> sink(pass);
-        const Xform id = Xform::identity();
-
-        if (!RunGlyfStream(gp.glyph_index, sink, id, spread, scratch, max_points))
-            return false;
-    }
-    else if (mode == DfMode::MSDF) {
-        MsdfDistanceBBoxPass pass(gg);
-        DfSink<MsdfDistanceBBoxPass> sink(pass);
-        const Xform id = Xform::identity();
-
-        if (!RunGlyfStream(gp.glyph_index, sink, id, spread, scratch, max_points))
-            return false;
-    }
-    else { // MTSDF: RGB from MSDF + A from true SDF
-        {
-            MsdfDistanceBBoxPass pass(gg);
-            DfSink<MsdfDistanceBBoxPass> sink(pass);
-            const Xform id = Xform::identity();
-
-            if (!RunGlyfStream(gp.glyph_index, sink, id, spread, scratch, max_points))
-                return false;
-        }
-        {
-            SdfDistanceBBoxPass pass(gg);
-            DfSink<SdfDistanceBBoxPass> sink(pass);
-            const Xform id = Xform::identity();
-
-            if (!RunGlyfStream(gp.glyph_index, sink, id, spread, scratch, max_points))
-                return false;
-        }
-    }
-
-    // =====================================================================
-    // 2) sign pass (same for both)
-    // =====================================================================
-    {
-        DfSignScanlinePass pass(gg, scratch.xs);
-        DfSink<DfSignScanlinePass> sink(pass);
-        const Xform id = Xform::identity();
-
-        for (int y=0; y<h; ++y) {
-            pass.begin_row(y);
-            if (!RunGlyfStream(gp.glyph_index, sink, id, spread, scratch, max_points))
-                return false;
-            pass.finalize_row(y);
-        }
-    }
-
-    // 3) finalize to atlas
-    if (mode == DfMode::MSDF) {
-        for (int y=0; y<h; ++y) {
-            uint8_t* row = gg.out + (uint32_t)(gg.shift_y + y) * gg.out_stride
-                         + (uint32_t)gg.shift_x * 3u;
-
-            for (int x=0; x<w; ++x) {
-                const int idx = y*w + x;
-
-                const float nr = sqrt((float)gg.d2r[idx] * (1.f / 65535.f));
-                const float ng = sqrt((float)gg.d2g[idx] * (1.f / 65535.f));
-                const float nb = sqrt((float)gg.d2b[idx] * (1.f / 65535.f));
-
-                int sr = (int)(nr * 127.f + .5f);
-                int sg = (int)(ng * 127.f + .5f);
-                int sb = (int)(nb * 127.f + .5f);
-
-                if (gg.inside[idx]) {
-                    sr = -sr;
-                    sg = -sg;
-                    sb = -sb;
-                }
-
-                uint8_t* p = row + (uint32_t)x * 3u;
-                p[0] = (uint8_t)(128 + sr);
-                p[1] = (uint8_t)(128 + sg);
-                p[2] = (uint8_t)(128 + sb);
-            }
-        }
-    }
-    else if (mode == DfMode::MTSDF) {
-        for (int y=0; y<h; ++y) {
-            uint8_t* row = gg.out + (uint32_t)(gg.shift_y + y) * gg.out_stride
-                                  + (uint32_t)gg.shift_x * 4u;
-
-            for (int x=0; x<w; ++x) {
-                const int idx = y*w + x;
-
-                const float nr = sqrt((float)gg.d2r[idx] * (1.f / 65535.f));
-                const float ng = sqrt((float)gg.d2g[idx] * (1.f / 65535.f));
-                const float nb = sqrt((float)gg.d2b[idx] * (1.f / 65535.f));
-
-                float na = sqrt((float)gg.d2[idx] * (1.f / 65535.f));
-                if (na > 1.f) na = 1.f;
-
-                int sr = (int)(nr * 127.f + .5f);
-                int sg = (int)(ng * 127.f + .5f);
-                int sb = (int)(nb * 127.f + .5f);
-                int sa = (int)(na * 127.f + .5f);
-
-                if (gg.inside[idx]) {
-                    sr = -sr;
-                    sg = -sg;
-                    sb = -sb;
-                    sa = -sa;
-                }
-
-                uint8_t* p = row + (uint32_t)x * 4u;
-                p[0] = (uint8_t)(128 + sr);
-                p[1] = (uint8_t)(128 + sg);
-                p[2] = (uint8_t)(128 + sb);
-                p[3] = (uint8_t)(128 + sa);
-            }
-        }
-    }
-    else /* SDF */ {
-        for (int y=0; y<h; ++y) {
-            uint8_t* row = gg.out + (uint32_t)(gg.shift_y + y) * gg.out_stride
-                         + (uint32_t)gg.shift_x;
-
-            for (int x=0; x<w; ++x) {
-                const int idx = y*w + x;
-
-                float nd = sqrt((float)gg.d2[idx] * (1.f / 65535.f));
-                if (nd > 1.f) nd = 1.f;
-
-                int sd = (int)(nd * 127.f + 0.5f);
-                if (gg.inside[idx]) sd = -sd;
-
-                row[x] = (uint8_t)(128 + sd);
-            }
-        }
-    }
-return true;
+    return stream_df_cell(gp.rect, (float)gp.x_min - spread, (float)gp.y_min - spread,
+                          atlas, atlas_stride_bytes, mode, scale, spread, scratch, max_area,
+                          [&](auto& sink) noexcept {
+                              return RunGlyfStream(gp.glyph_index, sink, Xform::identity(),
+                                                   spread, scratch, max_points);
+                          });
 }
 
 inline size_t Font::PlanBytes(const PlanInput& in) const noexcept {
-    if (!in.codepoints || in.codepoint_count == 0) return 0;
-
     // compute scale/spread in font units
     const float scale = ScaleForPixelHeight((float)in.pixel_height);
     const float spread_fu = (scale > 0.f) ? (in.spread_px / scale) : 0.f;
-
-    uint32_t glyph_count = 0;
-    uint16_t max_points = 0;
-    uint32_t max_area = 0;
-
-    for (uint32_t i = 0; i < in.codepoint_count; ++i) {
-        const uint32_t cp = in.codepoints[i];
-        const int gi = FindGlyphIndex((int)cp);
-        if (gi <= 0) continue;
-
-        GlyphPlanInfo gpi{};
-        if (!GetGlyphPlanInfo(gi, gpi)) continue;
-        if (gpi.is_empty) continue;
-
-        // bbox+spread -> pixel rect
-        const float span_x = (float)(gpi.x_max - gpi.x_min) + 2.f * spread_fu;
-        const float span_y = (float)(gpi.y_max - gpi.y_min) + 2.f * spread_fu;
-
-        const uint16_t rw = ceil_to_u16(span_x * scale);
-        const uint16_t rh = ceil_to_u16(span_y * scale);
-
-        const uint32_t area = (uint32_t)rw * (uint32_t)rh;
-        if (area > max_area) max_area = area;
-
-        if (gpi.max_points_in_tree > max_points) max_points = gpi.max_points_in_tree;
-
-        ++glyph_count;
-    }
-
-    if (!glyph_count) return 0;
-
-    // skyline needs ~2*N+16 nodes
-    const uint32_t node_cap = 2u * glyph_count + 16u;
-
-    // final bytes for one plan block
-    return plan_block_bytes(glyph_count, node_cap, max_points, max_area, in.mode);
+    return plan_cells_(in, [this, &in](uint32_t i, GlyphPlan& gp) noexcept {
+                           return plan_glyph_(in, i, gp);
+                       }, &scale, &spread_fu, nullptr, 0, nullptr);
 }
 
 inline bool Font::Plan(const PlanInput& in,
                        void* plan_mem, size_t plan_bytes,
                        FontPlan& out_plan) noexcept {
     if (!plan_mem || plan_bytes == 0) return false;
-    if (!in.codepoints || in.codepoint_count == 0) return false;
 
     // compute scale/spread in font units
     const float scale = ScaleForPixelHeight((float)in.pixel_height);
@@ -1277,206 +2216,154 @@ inline bool Font::Plan(const PlanInput& in,
 
     const float spread_fu = in.spread_px / scale;
 
-    // --------- First: count again (must match plan_bytes logic) ----------
-    uint32_t glyph_count = 0;
-    uint16_t max_points = 0;
-    uint32_t max_area = 0;
-    uint32_t total_area = 0;
-    uint16_t max_w = 0, max_h = 0;
+    if (!plan_cells_(in, [this, &in](uint32_t i, GlyphPlan& gp) noexcept {
+                         return plan_glyph_(in, i, gp);
+                     }, &scale, &spread_fu, plan_mem, plan_bytes, &out_plan))
+        return false;
+    out_plan.scale = scale;
+    out_plan.spread_fu = spread_fu;
+    return true;
+}
 
-    for (uint32_t i = 0; i < in.codepoint_count; ++i) {
-        const int gi = FindGlyphIndex((int)in.codepoints[i]);
-        if (gi <= 0) continue;
+inline bool Font::plan_glyph_(const PlanInput& in, uint32_t i, GlyphPlan& gp) const noexcept {
+    const int gi = plan_glyph_index_(in, i);
+    if (gi <= 0) return false;
 
-        GlyphPlanInfo gpi{};
-        if (!GetGlyphPlanInfo(gi, gpi)) continue;
-        if (gpi.is_empty) continue;
+    GlyphPlanInfo gpi{};
+    if (in.glyph_indices && in.glyph_infos && in.glyph_infos[i].glyph_index == (uint16_t)gi) {
+        gpi = in.glyph_infos[i];
+    }
+    else if (!GetGlyphPlanInfo(gi, gpi)) return false; // no cache, or not built for this glyph
+    if (gpi.is_empty) return false;
+
+    gp.glyph_index = (uint16_t)gi;
+    gp.x_min = gpi.x_min;
+    gp.y_min = gpi.y_min;
+    gp.x_max = gpi.x_max;
+    gp.y_max = gpi.y_max;
+    gp.num_points = gpi.max_points_in_tree;
+    return true;
+}
 
-        const float span_x = (float)(gpi.x_max - gpi.x_min) + 2.f * spread_fu;
-        const float span_y = (float)(gpi.y_max - gpi.y_min) + 2.f * spread_fu;
 
-        const uint16_t rw = ceil_to_u16(span_x * scale);
-        const uint16_t rh = ceil_to_u16(span_y * scale);
 
-        const uint32_t area = (uint32_t)rw * (uint32_t)rh;
-        total_area += area;
-        if (area > max_area) max_area = area;
+inline bool Font::Build(const FontPlan& plan,
+                        uint8_t* atlas,
+                        uint32_t atlas_stride_bytes) noexcept {
+    if (!atlas) return false;
+    return build_pages_(plan, nullptr, atlas,
+                        AtlasPageBytes(plan, atlas_stride_bytes), atlas_stride_bytes);
+}
 
-        if (rw > max_w) max_w = rw;
-        if (rh > max_h) max_h = rh;
+inline bool Font::Build(const FontPlan& plan,
+                        uint8_t* const* pages,
+                        uint32_t page_stride_bytes) noexcept {
+    if (!pages) return false;
+    for (uint16_t p = 0; p < plan.page_count; ++p) if (!pages[p]) return false;
+    return build_pages_(plan, pages, nullptr, 0, page_stride_bytes);
+}
 
-        if (gpi.max_points_in_tree > max_points) max_points = gpi.max_points_in_tree;
+// page p is pages[p] when given, else base + p * page_bytes
+inline bool Font::build_pages_(const FontPlan& plan,
+                               uint8_t* const* pages,
+                               uint8_t* base, size_t page_bytes,
+                               uint32_t stride_bytes) noexcept {
+    return build_cells_(plan, pages, base, page_bytes, stride_bytes,
+        [this, &plan](const GlyphPlan& gp, uint8_t* atlas, uint32_t stride,
+                      GlyphScratch& scratch) noexcept {
+            // cells of other fonts belong to a MultiFontPlan
+            return gp.font == 0 &&
+                   StreamDF(gp, atlas, stride, plan.mode, plan.scale, plan.spread_fu,
+                            scratch, plan.max_points, plan.max_area);
+        });
+}
 
-        ++glyph_count;
+inline size_t Font::BuildManyBytes(const FontPlan* plans, uint32_t plan_count) noexcept {
+    if (!plans) return 0;
+    uint16_t max_points = 0;
+    for (uint32_t k = 0; k < plan_count; ++k)
+        if (plans[k].max_points > max_points) max_points = plans[k].max_points;
+    return plan_count ? (size_t)outline_seg_cap(max_points) * sizeof(OutlineSeg) : 0;
+}
+
+// Glyph-major: plans[0] drives the glyph order, the other plans find the same
+// glyph through its owning codepoint. Outlines that overflow outline_mem are
+// streamed from glyf per pass instead (same output, just slower).
+inline bool Font::BuildMany(const FontPlan* plans, uint32_t plan_count,
+                            uint8_t* const* atlases, const uint32_t* strides,
+                            void* outline_mem, size_t outline_bytes) noexcept {
+    if (!plans || !plan_count || !atlases || !strides) return false;
+    if (!outline_mem || outline_bytes < sizeof(OutlineSeg)) return false;
+    for (uint32_t k = 0; k < plan_count; ++k) {
+        if (!atlases[k] || !build_plan_ok_(plans[k], strides[k])) return false;
+        if (plans[k].glyph_count != plans[0].glyph_count) return false;
     }
 
-    if (!glyph_count) return false;
+    OutlineRecordPass rec{ (OutlineSeg*)outline_mem,
+                           (uint32_t)(outline_bytes / sizeof(OutlineSeg)), 0 };
+    auto replay = [&rec](auto& sink) noexcept {
+        sink.begin();
+        for (uint32_t i = 0; i < rec.count; ++i) {
+            const OutlineSeg& e = rec.segs[i];
+            sink.pass.line(e.x0, e.y0, e.x1, e.y1, e.color);
+        }
+        return true;
+    };
 
-    const uint32_t node_cap = 2u * glyph_count + 16u;
+    for (uint32_t i = 0; i < plans[0].glyph_count; ++i) {
+        const GlyphPlan& g0 = plans[0]._glyphs[i];
 
-    // verify plan_bytes big enough
-    const size_t need_bytes = plan_block_bytes(glyph_count, node_cap, max_points, max_area, in.mode);
-    if (plan_bytes < need_bytes) return false;
+        GlyphScratch scratch = bind_glyph_scratch(plans[0]._scratch_mem, plans[0].max_points,
+                                                  plans[0].max_area, plans[0].mode);
+        rec.count = 0;
+        DfSink<OutlineRecordPass> sink(rec);
+        if (!RunGlyfStream(g0.glyph_index, sink, Xform::identity(), 0.f,
+                           scratch, plans[0].max_points))
+            return false;
+        const bool recorded = rec.count <= rec.cap;
+
+        for (uint32_t k = 0; k < plan_count; ++k) {
+            const FontPlan& p = plans[k];
+            const GlyphPlan* gp = k ? p.Find(g0.codepoint) : &g0;
+            // cells of other fonts belong to a MultiFontPlan, as in build_pages_
+            if (!gp || gp->font || gp->glyph_index != g0.glyph_index) return false;
+
+            auto render = [&](const GlyphPlan& cell, uint8_t* atlas, uint32_t stride,
+                              GlyphScratch& s) noexcept {
+                if (!recorded)
+                    return StreamDF(cell, atlas, stride, p.mode, p.scale, p.spread_fu,
+                                    s, p.max_points, p.max_area);
+                return stream_df_cell(cell.rect, (float)cell.x_min - p.spread_fu,
+                                      (float)cell.y_min - p.spread_fu, atlas, stride,
+                                      p.mode, p.scale, p.spread_fu, s, p.max_area, replay);
+            };
+            scratch = bind_glyph_scratch(p._scratch_mem, p.max_points, p.max_area, p.mode);
+            uint8_t* page = atlases[k] + (size_t)gp->rect.page * AtlasPageBytes(p, strides[k]);
+            if (!build_cell_(p, *gp, page, strides[k], scratch, render))
+                return false;
+        }
+    }
+    return true;
+}
 
-    // --------- Bind plan block ----------
-    MemArena a{};
-    a.init(plan_mem, plan_bytes);
-
-    GlyphPlan* glyphs = (GlyphPlan*)a.take((size_t)glyph_count * sizeof(GlyphPlan), 16);
-    uint32_t* order = (uint32_t*)a.take(glyph_count * sizeof(uint32_t), 16);
-    SkylineNode* nodes = (SkylineNode*)a.take((size_t)node_cap * sizeof(SkylineNode), 16);
-
-    const size_t scratch_bytes = glyph_scratch_bytes(max_points, max_area, in.mode);
-    void* scratch_mem = a.take(scratch_bytes, 16);
-
-    if (!glyphs || !order || !nodes || !scratch_mem) return false;
-
-    // --------- Fill glyph array (second pass) ----------
-    uint32_t at = 0;
-    for (uint32_t i = 0; i < in.codepoint_count; ++i) {
-        const uint32_t cp = in.codepoints[i];
-        const int gi = FindGlyphIndex((int)cp);
-        if (gi <= 0) continue;
-
-        GlyphPlanInfo gpi{};
-        if (!GetGlyphPlanInfo(gi, gpi)) continue;
-        if (gpi.is_empty) continue;
-
-        GlyphPlan& gp = glyphs[at++];
-        gp.codepoint = cp;
-        gp.glyph_index = (uint16_t)gi;
-        gp.x_min = gpi.x_min;
-        gp.y_min = gpi.y_min;
-        gp.x_max = gpi.x_max;
-        gp.y_max = gpi.y_max;
-        gp.num_points = gpi.max_points_in_tree;
-
-        const float span_x = (float)(gp.x_max - gp.x_min) + 2.f * spread_fu;
-        const float span_y = (float)(gp.y_max - gp.y_min) + 2.f * spread_fu;
-
-        gp.rect.w = ceil_to_u16(span_x * scale);
-        gp.rect.h = ceil_to_u16(span_y * scale);
-        gp.rect.x = 0;
-        gp.rect.y = 0;
-    }
-
-    // defensive: should match glyph_count
-    if (at != glyph_count) return false;
-
-    // --------- sort glyphs by height/area ---------
-    auto keyhw = [&](uint32_t k) -> uint32_t {
-        const auto& r = glyphs[k].rect;
-        return (uint32_t)r.h * 65536u + (uint32_t)r.w; // h major, w minor
-    };
-
-    for (uint32_t i=0; i<glyph_count; ++i) order[i]=i;
-    for (uint32_t i=1; i<glyph_count; ++i) {
-        uint32_t v = order[i];
-        uint32_t j = i;
-        while (j > 0 && keyhw(order[j-1]) < keyhw(v)) {
-            order[j] = order[j-1];
-            --j;
-        }
-        order[j] = v;
-    }
-
-    // --------- Choose atlas side and skyline-pack ----------
-    uint16_t side = next_pow2_u16(ceil_sqrt_u32(total_area));
-    if (side < max_w) side = next_pow2_u16(max_w);
-    if (side < max_h) side = next_pow2_u16(max_h);
-    if (side < 64) side = 64;
-
-    bool packed = false;
-    for (int attempt=0; attempt<10; ++attempt) {
-        Skyline sk{};
-        skyline_init(sk, side, nodes, (int)node_cap);
-
-        bool ok = true;
-        for (uint32_t i=0; i<glyph_count; ++i) {
-            const uint32_t k = order[i];
-            uint16_t x = 0, y = 0;
-            if (!skyline_insert(sk, glyphs[k].rect.w, glyphs[k].rect.h, x, y)) {
-                ok = false;
-                break;
-            }
-            glyphs[k].rect.x = x;
-            glyphs[k].rect.y = y;
-        }
-
-        if (ok) { packed = true; break; }
-        if (side >= 32768) break;
-        side = (uint16_t)(side * 2);
-    }
-    if (!packed) return false;
-
-    // --------- Fill out_plan ----------
-    out_plan.mode = in.mode;
-    out_plan.pixel_height = in.pixel_height;
-    out_plan.scale = scale;
-    out_plan.spread_fu = spread_fu;
-
-    out_plan.atlas_side = side;
-    out_plan.glyph_count = glyph_count;
-    out_plan.max_points = max_points;
-    out_plan.max_area = max_area;
-
-    out_plan._mem = plan_mem;
-    out_plan._mem_bytes = plan_bytes;
-
-    out_plan._glyphs = glyphs;
-    out_plan._nodes = nodes;
-    out_plan._node_cap = node_cap;
-
-    out_plan._scratch_mem = scratch_mem;
-    out_plan._scratch_bytes = scratch_bytes;
-
-    return true;
+inline size_t Font::MetricsTableBytes(const FontPlan& plan) noexcept {
+    return metrics_table_bytes_(plan);
 }
 
-
-
-inline bool Font::Build(const FontPlan& plan,
-                        uint8_t* atlas,
-                        uint32_t atlas_stride_bytes) noexcept {
-    if (!atlas) return false;
-    if (!plan._glyphs || !plan._scratch_mem) return false;
-    if (!plan.atlas_side || !plan.glyph_count) return false;
-
-    const uint32_t comp = plan.mode==DfMode::SDF ? 1u :
-                          plan.mode==DfMode::MSDF ? 3u : 4u;
-    if (atlas_stride_bytes < (uint32_t)plan.atlas_side * comp)
-        return false;
-
-    // bind scratch views (also sets visit_n=0, etc.)
-    GlyphScratch scratch = bind_glyph_scratch(plan._scratch_mem,
-        plan.max_points,
-        plan.max_area,
-        plan.mode);
-
-    for (uint32_t i = 0; i < plan.glyph_count; ++i) {
-        const GlyphPlan& gp = plan._glyphs[i];
-
-        // bounds check (atlas is square side x side)
-        if ((uint32_t)gp.rect.x + gp.rect.w > plan.atlas_side)
-            return false;
-        if ((uint32_t)gp.rect.y + gp.rect.h > plan.atlas_side)
-            return false;
-
-        // IMPORTANT: reset recursion guard per glyph
-        scratch.visit_n = 0;
-
-        if (!StreamDF(gp,
-            (unsigned char*)atlas,
-            atlas_stride_bytes,   // NOTE: stride is BYTES, not width in pixels
-            plan.mode,
-            plan.scale,
-            plan.spread_fu,
-            scratch,
-            plan.max_points,
-            plan.max_area))
-            return false;
-    }
-    return true;
+inline bool Font::BuildMetricsTable(const FontPlan& plan, void* mem, size_t bytes,
+                                    GlyphMetricsTable& out_table) const noexcept {
+    const float em = plan.scale / (float)(plan.pixel_height ? plan.pixel_height : 1);
+    return metrics_table_(plan, mem, bytes, out_table,
+        [this, &plan, em](const GlyphPlan& gp, float& adv, float& lsb,
+                          float& ox, float& oy) noexcept {
+            if (gp.font) return false; // MultiFont cell
+            const GlyphHorMetrics hm = GetGlyphHorMetrics(gp.glyph_index);
+            adv = (float)hm.advance * em;
+            lsb = (float)hm.lsb * em;
+            ox = ((float)gp.x_min - plan.spread_fu) * em;
+            oy = ((float)gp.y_min - plan.spread_fu) * em;
+            return true;
+        });
 }
 
 // ============================================================================
@@ -1507,7 +2394,7 @@ struct VisitGuard {
 
 
 template<class SinkT>
-static void Font::EmitContour(SinkT& sink, const Xform& xf,
+void Font::EmitContour(SinkT& sink, const Xform& xf,
                         const uint8_t* flags, const int16_t* px, const int16_t* py,
                         uint16_t s, uint16_t end, uint8_t& col) noexcept {
     // store start position to close correctly
@@ -1619,12 +2506,6 @@ bool Font::RunGlyfStream(int glyph_index,
     if (scratch.visit_n == 1)
         sink.begin();
 
-    auto glyph_offset = [&](int g) -> uint32_t {
-        return _index_to_loc_format == 0 ?
-              _glyf + 2u * (uint32_t)ushort_(_data+_loca + 2*g)
-            : _glyf +      (uint32_t)ulong_ (_data+_loca + 4*g);
-    };
-
     const uint8_t* g = _data + (_index_to_loc_format == 0 ?
               _glyf + 2u * (uint32_t)ushort_(_data+_loca + glyph_index * 2)
             : _glyf +      (uint32_t)ulong_ (_data+_loca + glyph_index * 4));
@@ -1881,6 +2762,36 @@ inline bool Font::ReadBytes(uint8_t* font_buffer) noexcept {
     return true;
 }
 
+inline bool Font::GetFontPlanInfo(GlyphPlanInfo& out) const noexcept {
+    out.is_empty = true;
+    out.max_points_in_tree = 0;
+    out.glyph_index = 0;
+    out.x_min = out.y_min = out.x_max = out.y_max = 0;
+    if (!_data || !_head) return false;
+
+    out.x_min = short_(_data + _head + 36);
+    out.y_min = short_(_data + _head + 38);
+    out.x_max = short_(_data + _head + 40);
+    out.y_max = short_(_data + _head + 42);
+    out.is_empty = (out.x_max <= out.x_min || out.y_max <= out.y_min);
+
+    // maxp v1.0 only; v0.5 (CFF) has no point counts
+    const uint32_t maxp = FindTable("maxp");
+    if (!maxp || ulong_(_data + maxp) != 0x00010000) return false;
+    const uint16_t simple_pts    = ushort_(_data + maxp + 6);
+    const uint16_t composite_pts = ushort_(_data + maxp + 10);
+    out.max_points_in_tree = u16_max(simple_pts, composite_pts);
+    return true;
+}
+
+inline uint64_t Font::ContentHash() const noexcept {
+    if (!_data) return 0;
+    const uint32_t num_tables = ushort_(_data + 4);
+    uint64_t h = fnv1a64(_data, 12u + 16u * num_tables);
+    if (_head) h = fnv1a64(_data + _head, 54, h);
+    return h;
+}
+
 inline float Font::ScaleForPixelHeight(float height) const noexcept {
     int h = short_(_data + _hhea+4) - short_(_data + _hhea+6);
     return height / static_cast<float>(h);
@@ -1986,6 +2897,76 @@ inline int Font::FindGlyphIndex(int unicode_codepoint) const noexcept {
     return 0;
 }
 
+template<class SinkT>
+inline uint32_t Font::ForEachMappedCodepoint(uint32_t first, uint32_t last, SinkT& sink) const noexcept {
+    const uint8_t* data = _data;
+    const uint32_t index_map = _index_map;
+    if (!data || !index_map || first > last) return 0;
+
+    uint32_t hits = 0;
+    auto emit = [&](uint32_t cp, int g) noexcept { if (g) { sink(cp, g); ++hits; } };
+
+    const uint16_t format = ushort_(data + index_map+0);
+    if (format == 0) { // Apple byte encoding
+        const uint32_t bytes = ushort_(data + index_map+2);
+        const uint32_t n = bytes > 6 ? bytes - 6 : 0;
+        for (uint32_t cp = first; cp <= last && cp < n; ++cp)
+            emit(cp, byte_(data + index_map+6 + cp));
+    }
+    else if (format == 6) {
+        const uint32_t start = ushort_(data + index_map+6);
+        const uint32_t count = ushort_(data + index_map+8);
+        const uint32_t lo = first > start ? first : start;
+        for (uint32_t cp = lo; cp <= last && cp < start+count; ++cp)
+            emit(cp, ushort_(data + index_map+10 + 2*(cp-start)));
+    }
+    else if (format == 4) {
+        // segments are sorted by end code; same glyph math as FindGlyphIndex
+        const uint32_t seg_count = ushort_(data + index_map+6) >> 1;
+        const uint32_t end_count = index_map + 14;
+        const uint32_t start_count = end_count + seg_count*2 + 2;
+        const uint32_t delta_at    = end_count + seg_count*4 + 2;
+        const uint32_t offset_at   = end_count + seg_count*6 + 2;
+
+        for (uint32_t item = 0; item < seg_count; ++item) {
+            const uint32_t end   = ushort_(data + end_count + 2*item);
+            if (end < first) continue;
+            const uint32_t start = ushort_(data + start_count + 2*item);
+            if (start > last) break;
+            if (start == 0xFFFF && end == 0xFFFF) break; // terminating segment, maps nothing
+
+            const uint32_t lo = first > start ? first : start;
+            const uint32_t hi = last < end ? last : end;
+            const uint16_t offset = ushort_(data + offset_at + 2*item);
+            const int16_t  delta  = short_(data + delta_at + 2*item);
+            for (uint32_t cp = lo; cp <= hi; ++cp) {
+                if (offset == 0) emit(cp, (uint16_t)(cp + delta));
+                else             emit(cp, ushort_(data + offset + (cp - start)*2 + offset_at + 2*item));
+            }
+        }
+    }
+    else if (format==12 || format==13) {
+        const uint32_t n_groups = ulong_(data + index_map + 12);
+        for (uint32_t i = 0; i < n_groups; ++i) {
+            const uint8_t* grp = data + index_map + 16 + i*12;
+            const uint32_t start_char = ulong_(grp);
+            const uint32_t end_char   = ulong_(grp + 4);
+            if (end_char < first) continue;
+            if (start_char > last) break;
+
+            const uint32_t start_glyph = ulong_(grp + 8);
+            const uint32_t lo = first > start_char ? first : start_char;
+            const uint32_t hi = last < end_char ? last : end_char;
+            for (uint32_t cp = lo; ; ++cp) { // hi may be 0xFFFFFFFF
+                emit(cp, (int)(format==12 ? start_glyph + (cp - start_char) : start_glyph));
+                if (cp == hi) break;
+            }
+        }
+    }
+    // format 2: unsupported, as in FindGlyphIndex
+    return hits;
+}
+
 inline GlyphHorMetrics Font::GetGlyphHorMetrics(int glyph_index) const noexcept {
     // num of long hor metrics
     uint16_t num = ushort_(_data + _hhea + 34);
@@ -2055,6 +3036,7 @@ inline bool Font::parse_glyph_plan_info_(const uint8_t* data,
                                          GlyphPlanInfo& out) noexcept {
     out.is_empty = true;
     out.max_points_in_tree = 0;
+    out.glyph_index = (uint16_t)glyph_index;
 
     if (glyph_index < 0 || glyph_index >= num_glyphs) return false;
 
@@ -2156,6 +3138,1289 @@ inline bool Font::parse_glyph_plan_info_(const uint8_t* data,
     out.max_points_in_tree = maxp;
     return true;
 }
+// ============================================================================
+//                         MULTI FONT
+// ============================================================================
+//
+// One atlas for a fallback chain (e.g. Latin UI font, then CJK, then symbols).
+// Each codepoint goes to the first font that maps it to a non-empty outline;
+// all cells share one packer, and every font is scaled so that its ascent -
+// descent equals pixel_height, as Font::Plan does for a single font.
+
+struct MultiFontPlan {
+    FontPlan plan;        // cells of every font; GlyphPlan::font indexes the font list
+    uint8_t  font_count{};
+    float    scale[STBTT_STREAM_MAX_FONTS]{};     // per font: pixels per font unit
+    float    spread_fu[STBTT_STREAM_MAX_FONTS]{}; // per font: spread in its font units
+
+    inline const GlyphPlan* Find(uint32_t codepoint) const noexcept { return plan.Find(codepoint); }
+};
+
+struct MultiFont {
+    Font* const* fonts{};   // fallback order, read again by Build
+    uint8_t      font_count{};
+
+    // INIT: PlanInput::glyph_indices / glyph_infos are per font and ignored here
+    inline size_t PlanBytes(const PlanInput& in) const noexcept;
+    // PASS 1
+    inline bool Plan(const PlanInput& in,
+                     void* plan_mem, size_t plan_bytes,
+                     MultiFontPlan& out_plan) const noexcept;
+    // PASS 2: same layouts as Font::Build (AtlasStrideBytes/AtlasPageBytes of out_plan.plan)
+    inline bool Build(const MultiFontPlan& plan, uint8_t* atlas,
+                      uint32_t atlas_stride_bytes) const noexcept;
+    inline bool Build(const MultiFontPlan& plan, uint8_t* const* pages,
+                      uint32_t page_stride_bytes) const noexcept;
+    // as Font::BuildMetricsTable; bytes from Font::MetricsTableBytes(plan.plan)
+    inline bool BuildMetricsTable(const MultiFontPlan& plan, void* mem, size_t bytes,
+                                  GlyphMetricsTable& out_table) const noexcept;
+
+private:
+    // per-font scale/spread; false if the chain is empty, too long or a font has no scale
+    inline bool scales_(const PlanInput& in, float* scale, float* spread_fu) const noexcept;
+    inline bool resolve_(const PlanInput& in, uint32_t i, GlyphPlan& gp) const noexcept;
+    inline bool build_pages_(const MultiFontPlan& plan, uint8_t* const* pages,
+                             uint8_t* base, size_t page_bytes,
+                             uint32_t stride_bytes) const noexcept;
+}; // struct MultiFont
+
+inline bool MultiFont::scales_(const PlanInput& in, float* scale, float* spread_fu) const noexcept {
+    if (!fonts || font_count == 0 || font_count > STBTT_STREAM_MAX_FONTS) return false;
+    for (uint8_t f = 0; f < font_count; ++f) {
+        if (!fonts[f]) return false;
+        scale[f] = fonts[f]->ScaleForPixelHeight((float)in.pixel_height);
+        if (scale[f] <= 0.f) return false;
+        spread_fu[f] = in.spread_px / scale[f];
+    }
+    return true;
+}
+
+inline bool MultiFont::resolve_(const PlanInput& in, uint32_t i, GlyphPlan& gp) const noexcept {
+    const int cp = (int)in.codepoints[i];
+    for (uint8_t f = 0; f < font_count; ++f) {
+        const int gi = fonts[f]->FindGlyphIndex(cp);
+        if (gi <= 0) continue;
+
+        GlyphPlanInfo gpi{};
+        if (!fonts[f]->GetGlyphPlanInfo(gi, gpi) || gpi.is_empty) continue;
+
+        gp.font = f;
+        gp.glyph_index = (uint16_t)gi;
+        gp.x_min = gpi.x_min;
+        gp.y_min = gpi.y_min;
+        gp.x_max = gpi.x_max;
+        gp.y_max = gpi.y_max;
+        gp.num_points = gpi.max_points_in_tree;
+        return true;
+    }
+    return false;
+}
+
+inline size_t MultiFont::PlanBytes(const PlanInput& in) const noexcept {
+    float scale[STBTT_STREAM_MAX_FONTS], spread_fu[STBTT_STREAM_MAX_FONTS];
+    if (!scales_(in, scale, spread_fu)) return 0;
+    return plan_cells_(in, [this, &in](uint32_t i, GlyphPlan& gp) noexcept {
+                           return resolve_(in, i, gp);
+                       }, scale, spread_fu, nullptr, 0, nullptr);
+}
+
+inline bool MultiFont::Plan(const PlanInput& in,
+                            void* plan_mem, size_t plan_bytes,
+                            MultiFontPlan& out_plan) const noexcept {
+    if (!plan_mem || plan_bytes == 0) return false;
+    MultiFontPlan mp{};
+    if (!scales_(in, mp.scale, mp.spread_fu)) return false;
+    if (!plan_cells_(in, [this, &in](uint32_t i, GlyphPlan& gp) noexcept {
+                         return resolve_(in, i, gp);
+                     }, mp.scale, mp.spread_fu, plan_mem, plan_bytes, &mp.plan))
+        return false;
+    // FontPlan::scale/spread_fu describe the primary font
+    mp.plan.scale = mp.scale[0];
+    mp.plan.spread_fu = mp.spread_fu[0];
+    mp.font_count = font_count;
+    out_plan = mp;
+    return true;
+}
+
+inline bool MultiFont::Build(const MultiFontPlan& plan, uint8_t* atlas,
+                             uint32_t atlas_stride_bytes) const noexcept {
+    if (!atlas) return false;
+    return build_pages_(plan, nullptr, atlas,
+                        AtlasPageBytes(plan.plan, atlas_stride_bytes), atlas_stride_bytes);
+}
+
+inline bool MultiFont::Build(const MultiFontPlan& plan, uint8_t* const* pages,
+                             uint32_t page_stride_bytes) const noexcept {
+    if (!pages) return false;
+    for (uint16_t p = 0; p < plan.plan.page_count; ++p) if (!pages[p]) return false;
+    return build_pages_(plan, pages, nullptr, 0, page_stride_bytes);
+}
+
+inline bool MultiFont::BuildMetricsTable(const MultiFontPlan& plan, void* mem, size_t bytes,
+                                         GlyphMetricsTable& out_table) const noexcept {
+    if (!fonts || plan.font_count != font_count) return false;
+    const float inv_px = 1.f / (float)(plan.plan.pixel_height ? plan.plan.pixel_height : 1);
+    return metrics_table_(plan.plan, mem, bytes, out_table,
+        [this, &plan, inv_px](const GlyphPlan& gp, float& adv, float& lsb,
+                              float& ox, float& oy) noexcept {
+            if (gp.font >= font_count || !fonts[gp.font]) return false;
+            const float em = plan.scale[gp.font] * inv_px;
+            const float spread_fu = plan.spread_fu[gp.font];
+            const GlyphHorMetrics hm = fonts[gp.font]->GetGlyphHorMetrics(gp.glyph_index);
+            adv = (float)hm.advance * em;
+            lsb = (float)hm.lsb * em;
+            ox = ((float)gp.x_min - spread_fu) * em;
+            oy = ((float)gp.y_min - spread_fu) * em;
+            return true;
+        });
+}
+
+inline bool MultiFont::build_pages_(const MultiFontPlan& plan, uint8_t* const* pages,
+                                    uint8_t* base, size_t page_bytes,
+                                    uint32_t stride_bytes) const noexcept {
+    if (!fonts || plan.font_count != font_count) return false;
+    const FontPlan& fp = plan.plan;
+    return build_cells_(fp, pages, base, page_bytes, stride_bytes,
+        [this, &plan, &fp](const GlyphPlan& gp, uint8_t* atlas, uint32_t stride,
+                           GlyphScratch& scratch) noexcept {
+            if (gp.font >= font_count || !fonts[gp.font]) return false;
+            return fonts[gp.font]->StreamDF(gp, atlas, stride, fp.mode,
+                                            plan.scale[gp.font], plan.spread_fu[gp.font],
+                                            scratch, fp.max_points, fp.max_area);
+        });
+}
+
+// ============================================================================
+//                         PATH SDF
+// ============================================================================
+//
+// Distance fields from caller outlines (icons, UI shapes) instead of glyf data.
+// Same two passes as Font: PlanBytes/Plan give every shape a packed cell,
+// Build renders each shape into its cell with the StreamDF passes.
+//
+// Contours use the DfSink vocabulary (move/line/quad/cubic/close); an open
+// contour is closed by the next Move or by the end of the shape. Coordinates
+// are y-up like font units; set PathShape::y_down for SVG/screen input.
+// Inside is decided by crossing parity (even-odd), as for glyphs.
+
+enum class PathVerb : uint8_t { Move, Line, Quad, Cubic, Close };
+
+struct PathShape {
+    const PathVerb* verbs;
+    uint32_t        verb_count;
+    const float*    points;      // x,y pairs: Move/Line 1, Quad 2, Cubic 3, Close 0
+    uint32_t        point_count; // pairs
+    bool            y_down;      // flip y (SVG / screen coordinates)
+};
+struct PathPlanInput {
+    DfMode           mode;
+    float            scale;         // pixels per path unit
+    float            spread_px;
+    const PathShape* shapes;        // read again by Build: keep alive until then
+    uint32_t         shape_count;
+    uint16_t         max_page_side; // as PlanInput::max_page_side
+    PackMode         pack_mode;
+};
+struct PathCell {
+    float     x_min, y_min, x_max, y_max; // shape bounds in path units (y-up)
+    GlyphRect rect;                       // w == 0: empty shape, no cell
+};
+struct PathPlan {
+    // results (filled by Plan)
+    DfMode   mode{};
+    float    scale{};        // pixels per path unit
+    float    spread{};       // spread in path units
+    uint16_t atlas_side{};
+    uint16_t page_count{};
+    uint32_t shape_count{};  // cells, one per input shape (same order)
+    uint32_t max_area{};
+
+    inline const PathCell& Cell(uint32_t shape) const noexcept { return _cells[shape]; }
+
+    // ---- internal pointers into the same plan memory block ----
+    const PathShape* _shapes{};
+    PathCell*        _cells{};
+    void*            _scratch_mem{};
+    size_t           _scratch_bytes{};
+};
+
+struct PathSDF {
+    // INIT
+    static inline size_t PlanBytes(const PathPlanInput& in) noexcept;
+    // PASS 1
+    static inline bool Plan(const PathPlanInput& in,
+                            void* plan_mem, size_t plan_bytes,
+                            PathPlan& out_plan) noexcept;
+    // PASS 2: pages back to back, page p at atlas + p * atlas_side * stride
+    static inline bool Build(const PathPlan& plan, uint8_t* atlas,
+                             uint32_t atlas_stride_bytes) noexcept;
+    // one pointer per page (plan.page_count entries)
+    static inline bool Build(const PathPlan& plan, uint8_t* const* pages,
+                             uint32_t page_stride_bytes) noexcept;
+
+    // 1 shape, independent (the path counterpart of Font::StreamDF):
+    // renders into cell.rect; spread in path units, scratch for max_area pixels
+    static inline bool Render(const PathShape& shape, const PathCell& cell,
+                              unsigned char* atlas, uint32_t atlas_stride_bytes,
+                              DfMode mode, float scale, float spread,
+                              GlyphScratch& scratch, uint32_t max_area) noexcept;
+    // bounds in path units (y-up); false for a malformed or empty shape
+    static inline bool Bounds(const PathShape& shape, float& x_min, float& y_min,
+                              float& x_max, float& y_max) noexcept;
+
+private:
+    struct BoundsSink {
+        float x_min{}, y_min{}, x_max{}, y_max{};
+        uint32_t n{};
+        inline void add(float x, float y) noexcept {
+            if (!n++) { x_min = x_max = x; y_min = y_max = y; return; }
+            x_min = fminf(x_min, x); x_max = fmaxf(x_max, x);
+            y_min = fminf(y_min, y); y_max = fmaxf(y_max, y);
+        }
+        inline void begin() noexcept {}
+        inline void set_edge_color(uint8_t) noexcept {}
+        inline void move(float x, float y) noexcept { add(x, y); }
+        inline void line(float x, float y) noexcept { add(x, y); }
+        // control points too: the hull bounds the curve
+        inline void quad(float cx, float cy, float x, float y) noexcept { add(cx, cy); add(x, y); }
+        inline void cubic(float cx1, float cy1, float cx2, float cy2, float x, float y) noexcept {
+            add(cx1, cy1); add(cx2, cy2); add(x, y);
+        }
+        inline void close() noexcept {}
+    };
+    template<class SinkT>
+    static inline bool emit_(const PathShape& shape, SinkT& sink) noexcept;
+    static inline bool build_pages_(const PathPlan& plan, uint8_t* const* pages,
+                                    uint8_t* base, size_t page_bytes,
+                                    uint32_t stride_bytes) noexcept;
+    static inline size_t block_bytes_(uint32_t shape_count, uint32_t max_area,
+                                      DfMode mode, PackMode pack_mode) noexcept {
+        size_t off = 0;
+        off = align_up(off, 16); off += (size_t)shape_count * sizeof(PathCell);  // cells
+        off = align_up(off, 16); off += (size_t)shape_count * sizeof(uint32_t);  // order
+        off = align_up(off, 16); off += pack_region_bytes(shape_count, pack_mode);
+        off = align_up(off, 16); off += glyph_scratch_bytes(0, max_area, mode);
+        return align_up(off, 16);
+    }
+    // cell size of a shape with the given bounds
+    static inline void cell_size_(float w_units, float h_units, float scale, float spread,
+                                  uint16_t& w, uint16_t& h) noexcept {
+        w = ceil_to_u16((w_units + 2.f * spread) * scale);
+        h = ceil_to_u16((h_units + 2.f * spread) * scale);
+    }
+}; // struct PathSDF
+
+// Edge colors cycle per segment across contours, like glyf contours (EmitContour).
+template<class SinkT>
+inline bool PathSDF::emit_(const PathShape& shape, SinkT& sink) noexcept {
+    if (shape.verb_count && (!shape.verbs || !shape.points)) return false;
+    const Xform xf = shape.y_down ? Xform{ 1.f, 0.f, 0.f, -1.f, 0.f, 0.f } : Xform::identity();
+
+    sink.begin();
+    uint32_t at = 0;   // next point pair
+    uint8_t col = 0;
+    bool open = false;
+    for (uint32_t i = 0; i < shape.verb_count; ++i) {
+        const PathVerb v = shape.verbs[i];
+        const uint32_t need = (v == PathVerb::Move || v == PathVerb::Line) ? 1u :
+                              v == PathVerb::Quad ? 2u : v == PathVerb::Cubic ? 3u : 0u;
+        if (need > shape.point_count - at) return false;
+        const float* p = shape.points + 2u * at;
+        at += need;
+
+        if (v == PathVerb::Move || v == PathVerb::Close) {
+            if (open) {
+                sink.set_edge_color(col);
+                sink.close();
+                col = (uint8_t)((col + 1) % 3);
+                open = false;
+            }
+            if (v == PathVerb::Move) { xf.emit_move(sink, p[0], p[1]); open = true; }
+            continue;
+        }
+        if (!open) return false; // segment without a current point
+
+        sink.set_edge_color(col);
+        if (v == PathVerb::Line)      xf.emit_line(sink, p[0], p[1]);
+        else if (v == PathVerb::Quad) xf.emit_quad(sink, p[0], p[1], p[2], p[3]);
+        else if (v == PathVerb::Cubic) xf.emit_cubic(sink, p[0], p[1], p[2], p[3], p[4], p[5]);
+        else return false;
+        col = (uint8_t)((col + 1) % 3);
+    }
+    if (open) {
+        sink.set_edge_color(col);
+        sink.close();
+    }
+    return true;
+}
+
+inline bool PathSDF::Bounds(const PathShape& shape, float& x_min, float& y_min,
+                            float& x_max, float& y_max) noexcept {
+    BoundsSink b{};
+    if (!emit_(shape, b) || !b.n) return false;
+    x_min = b.x_min; y_min = b.y_min;
+    x_max = b.x_max; y_max = b.y_max;
+    return true;
+}
+
+inline bool PathSDF::Render(const PathShape& shape, const PathCell& cell,
+                            unsigned char* atlas, uint32_t atlas_stride_bytes,
+                            DfMode mode, float scale, float spread,
+                            GlyphScratch& scratch, uint32_t max_area) noexcept {
+    // cell origin: bounds expanded by spread, as for glyphs
+    return stream_df_cell(cell.rect, cell.x_min - spread, cell.y_min - spread,
+                          atlas, atlas_stride_bytes, mode, scale, spread, scratch, max_area,
+                          [&shape](auto& sink) noexcept { return emit_(shape, sink); });
+}
+
+inline size_t PathSDF::PlanBytes(const PathPlanInput& in) noexcept {
+    if (!in.shapes || !in.shape_count || !(in.scale > 0.f)) return 0;
+    const float spread = in.spread_px / in.scale;
+
+    uint32_t max_area = 0, packed = 0;
+    for (uint32_t i = 0; i < in.shape_count; ++i) {
+        BoundsSink b{};
+        if (!emit_(in.shapes[i], b)) return 0;
+        if (!b.n) continue;
+        uint16_t w, h;
+        cell_size_(b.x_max - b.x_min, b.y_max - b.y_min, in.scale, spread, w, h);
+        if ((uint32_t)w * h > max_area) max_area = (uint32_t)w * h;
+        ++packed;
+    }
+    if (!packed) return 0;
+    return block_bytes_(in.shape_count, max_area, in.mode, in.pack_mode);
+}
+
+inline bool PathSDF::Plan(const PathPlanInput& in,
+                          void* plan_mem, size_t plan_bytes,
+                          PathPlan& out_plan) noexcept {
+    if (!plan_mem || plan_bytes == 0) return false;
+    if (!in.shapes || !in.shape_count || !(in.scale > 0.f)) return false;
+    const float spread = in.spread_px / in.scale;
+
+    // --------- First: measure (must match PlanBytes) ----------
+    uint32_t max_area = 0, packed = 0;
+    uint64_t total_area = 0;
+    uint16_t max_w = 0, max_h = 0;
+    for (uint32_t i = 0; i < in.shape_count; ++i) {
+        BoundsSink b{};
+        if (!emit_(in.shapes[i], b)) return false;
+        if (!b.n) continue;
+        uint16_t w, h;
+        cell_size_(b.x_max - b.x_min, b.y_max - b.y_min, in.scale, spread, w, h);
+        const uint32_t area = (uint32_t)w * h;
+        if (area > max_area) max_area = area;
+        total_area += area;
+        if (w > max_w) max_w = w;
+        if (h > max_h) max_h = h;
+        ++packed;
+    }
+    if (!packed) return false;
+    if (plan_bytes < block_bytes_(in.shape_count, max_area, in.mode, in.pack_mode)) return false;
+
+    // --------- Bind plan block ----------
+    MemArena a{};
+    a.init(plan_mem, plan_bytes);
+    const size_t pack_bytes = pack_region_bytes(in.shape_count, in.pack_mode);
+    const size_t scratch_bytes = glyph_scratch_bytes(0, max_area, in.mode);
+    PathCell* cells = (PathCell*)a.take((size_t)in.shape_count * sizeof(PathCell), 16);
+    uint32_t* order = (uint32_t*)a.take((size_t)in.shape_count * sizeof(uint32_t), 16);
+    void* nodes = a.take(pack_bytes, 16);
+    void* scratch_mem = a.take(scratch_bytes, 16);
+    if (!cells || !order || !nodes || !scratch_mem) return false;
+
+    for (uint32_t i = 0; i < in.shape_count; ++i) {
+        PathCell& c = cells[i];
+        c = PathCell{};
+        BoundsSink b{};
+        emit_(in.shapes[i], b);
+        if (!b.n) continue;
+        c.x_min = b.x_min; c.y_min = b.y_min;
+        c.x_max = b.x_max; c.y_max = b.y_max;
+        cell_size_(b.x_max - b.x_min, b.y_max - b.y_min, in.scale, spread, c.rect.w, c.rect.h);
+    }
+
+    // tallest first; empty cells (key ~0) sort last and are not packed
+    radix_sort_order_([cells](uint32_t k) noexcept -> uint32_t {
+        const GlyphRect& r = cells[k].rect;
+        return ~((uint32_t)r.h * 65536u + (uint32_t)r.w);
+    }, order, (uint32_t*)nodes, in.shape_count);
+
+    AtlasPacker packer{};
+    packer.mode = in.pack_mode;
+    packer.mem = nodes;
+    packer.bytes = pack_bytes;
+
+    uint16_t side = 0;
+    uint16_t page_count = 1;
+    if (!pack_cells_(packer, [cells](uint32_t k) noexcept -> GlyphRect& { return cells[k].rect; },
+                     order, packed, AtlasFormat::Raw, in.max_page_side,
+                     total_area, max_w, max_h, side, page_count))
+        return false;
+
+    out_plan = PathPlan{};
+    out_plan.mode = in.mode;
+    out_plan.scale = in.scale;
+    out_plan.spread = spread;
+    out_plan.atlas_side = side;
+    out_plan.page_count = page_count;
+    out_plan.shape_count = in.shape_count;
+    out_plan.max_area = max_area;
+    out_plan._shapes = in.shapes;
+    out_plan._cells = cells;
+    out_plan._scratch_mem = scratch_mem;
+    out_plan._scratch_bytes = scratch_bytes;
+    return true;
+}
+
+inline bool PathSDF::Build(const PathPlan& plan, uint8_t* atlas,
+                           uint32_t atlas_stride_bytes) noexcept {
+    if (!atlas) return false;
+    return build_pages_(plan, nullptr, atlas,
+                        (size_t)plan.atlas_side * atlas_stride_bytes, atlas_stride_bytes);
+}
+
+inline bool PathSDF::Build(const PathPlan& plan, uint8_t* const* pages,
+                           uint32_t page_stride_bytes) noexcept {
+    if (!pages) return false;
+    for (uint16_t p = 0; p < plan.page_count; ++p) if (!pages[p]) return false;
+    return build_pages_(plan, pages, nullptr, 0, page_stride_bytes);
+}
+
+inline bool PathSDF::build_pages_(const PathPlan& plan, uint8_t* const* pages,
+                                  uint8_t* base, size_t page_bytes,
+                                  uint32_t stride_bytes) noexcept {
+    if (!plan._shapes || !plan._cells || !plan._scratch_mem) return false;
+    if (!plan.atlas_side || !plan.page_count) return false;
+    if (stride_bytes < (uint32_t)plan.atlas_side * (uint32_t)plan.mode) return false;
+
+    GlyphScratch scratch = bind_glyph_scratch(plan._scratch_mem, 0, plan.max_area, plan.mode);
+    for (uint32_t i = 0; i < plan.shape_count; ++i) {
+        const PathCell& c = plan._cells[i];
+        if (!c.rect.w) continue;
+        if (c.rect.page >= plan.page_count) return false;
+        if ((uint32_t)c.rect.x + c.rect.w > plan.atlas_side) return false;
+        if ((uint32_t)c.rect.y + c.rect.h > plan.atlas_side) return false;
+
+        uint8_t* page = pages ? pages[c.rect.page] : base + (size_t)c.rect.page * page_bytes;
+        if (!Render(plan._shapes[i], c, page, stride_bytes, plan.mode,
+                    plan.scale, plan.spread, scratch, plan.max_area))
+            return false;
+    }
+    return true;
+}
+
+// ============================================================================
+//                         BITMAP SDF
+// ============================================================================
+//
+// Distance field from a coverage mask (logos, hand-drawn UI art), e.g. a PNG
+// decoded by stbi::Decode with desired_channels = 1. Coverage is box-filtered
+// onto an EDT grid (output resolution x oversample) and thresholded at 50%.
+// An exact squared EDT (Felzenszwalb-Huttenlocher, separable) runs for both
+// sides; the edge is taken half a pixel from the nearest opposite center.
+// Each output pixel averages its oversample x oversample distances.
+//
+// With `subpixel`, partially covered grid pixels use the distance implied by
+// their coverage (0.5 - coverage) instead, so antialiased masks keep sub-pixel edges.
+// Output uses the StreamDF encoding (128 on the edge, lower inside); for MSDF
+// and MTSDF atlases the value is replicated, so median(r,g,b) is the SDF.
+
+struct BitmapSDFInput {
+    const uint8_t* coverage;   // 8-bit mask, 255 = inside
+    uint32_t src_w, src_h;
+    uint32_t src_stride;       // bytes per mask row
+    uint16_t dst_w, dst_h;     // mask size in output pixels (the cell adds the spread border)
+    float    spread_px;        // output pixels
+    uint8_t  oversample;       // EDT grid per output pixel per axis (0 or 1: none)
+    bool     subpixel;         // edge position from coverage (false: 50% threshold)
+    DfMode   mode;             // output channels
+};
+
+struct BitmapSDF {
+    // output cell: dst size plus ceil(spread_px) on every side
+    static inline bool CellSize(const BitmapSDFInput& in, uint16_t& w, uint16_t& h) noexcept;
+    static inline size_t ScratchBytes(const BitmapSDFInput& in) noexcept;
+    // writes the cell at (rect.x, rect.y); rect.w/h must equal CellSize
+    static inline bool Render(const BitmapSDFInput& in, const GlyphRect& rect,
+                              uint8_t* atlas, uint32_t atlas_stride_bytes,
+                              void* scratch, size_t scratch_bytes) noexcept;
+
+private:
+    static constexpr float INF_D2 = 1e20f; // "no seed": finite so INF_D2 - INF_D2 stays 0
+    static inline uint32_t pad_(const BitmapSDFInput& in) noexcept { return (uint32_t)iceil(in.spread_px); }
+    static inline uint32_t ss_(const BitmapSDFInput& in) noexcept { return in.oversample ? in.oversample : 1u; }
+    static inline void edt_1d_(float* grid, uint32_t offset, uint32_t step, uint32_t n,
+                               float* f, float* z, uint32_t* v) noexcept;
+    static inline void edt_2d_(float* grid, uint32_t w, uint32_t h,
+                               float* f, float* z, uint32_t* v) noexcept;
+    // sqrt accurate over the whole float range (stbtt_stream::sqrt targets [0, 1])
+    static inline float sqrt_refined_(float x) noexcept {
+        if (x <= 0.f) return 0.f;
+        float m = 1.f;
+        while (x > 1.f)   { x *= 0.25f; m *= 2.f; }
+        while (x < 0.25f) { x *= 4.f;   m *= 0.5f; }
+        float r = 0.5f + 0.5f * x; // x in [0.25, 1]
+        for (int i = 0; i < 4; ++i) r = 0.5f * (r + x / r);
+        return r * m;
+    }
+}; // struct BitmapSDF
+
+inline bool BitmapSDF::CellSize(const BitmapSDFInput& in, uint16_t& w, uint16_t& h) noexcept {
+    if (!in.dst_w || !in.dst_h || !(in.spread_px > 0.f)) return false;
+    const uint32_t cw = in.dst_w + 2u * pad_(in);
+    const uint32_t ch = in.dst_h + 2u * pad_(in);
+    if (cw > 65535u || ch > 65535u) return false;
+    w = (uint16_t)cw;
+    h = (uint16_t)ch;
+    return true;
+}
+
+inline size_t BitmapSDF::ScratchBytes(const BitmapSDFInput& in) noexcept {
+    uint16_t w = 0, h = 0;
+    if (!CellSize(in, w, h)) return 0;
+    const size_t gw = (size_t)w * ss_(in), gh = (size_t)h * ss_(in);
+    const size_t n = gw > gh ? gw : gh;
+    size_t off = 0;
+    off = align_up(off, 16); off += gw * gh * sizeof(float);      // outer: d2 to inside
+    off = align_up(off, 16); off += gw * gh * sizeof(float);      // inner: d2 to outside
+    off = align_up(off, 16); off += gw * gh * sizeof(uint8_t);    // coverage
+    off = align_up(off, 16); off += n * sizeof(float);            // f
+    off = align_up(off, 16); off += (n + 1) * sizeof(float);      // z
+    off = align_up(off, 16); off += n * sizeof(uint32_t);         // v
+    return align_up(off, 16);
+}
+
+// Lower envelope of parabolas: grid[q] = min_r (grid[r] + (q - r)^2), in place.
+inline void BitmapSDF::edt_1d_(float* grid, uint32_t offset, uint32_t step, uint32_t n,
+                               float* f, float* z, uint32_t* v) noexcept {
+    v[0] = 0;
+    z[0] = -INF_D2;
+    z[1] = INF_D2;
+    f[0] = grid[offset];
+    uint32_t k = 0;
+    for (uint32_t q = 1; q < n; ++q) {
+        f[q] = grid[offset + q * step];
+        float s;
+        for (;;) {
+            const uint32_t r = v[k];
+            s = (f[q] - f[r] + (float)q * (float)q - (float)r * (float)r) / (2.f * (float)(q - r));
+            if (s > z[k]) break;
+            --k; // z[0] = -INF_D2: never passes 0
+        }
+        ++k;
+        v[k] = q;
+        z[k] = s;
+        z[k + 1] = INF_D2;
+    }
+    k = 0;
+    for (uint32_t q = 0; q < n; ++q) {
+        while (z[k + 1] < (float)q) ++k;
+        const float d = (float)q - (float)v[k];
+        grid[offset + q * step] = f[v[k]] + d * d;
+    }
+}
+
+inline void BitmapSDF::edt_2d_(float* grid, uint32_t w, uint32_t h,
+                               float* f, float* z, uint32_t* v) noexcept {
+    for (uint32_t x = 0; x < w; ++x) edt_1d_(grid, x, w, h, f, z, v);
+    for (uint32_t y = 0; y < h; ++y) edt_1d_(grid, y * w, 1, w, f, z, v);
+}
+
+inline bool BitmapSDF::Render(const BitmapSDFInput& in, const GlyphRect& rect,
+                              uint8_t* atlas, uint32_t atlas_stride_bytes,
+                              void* scratch, size_t scratch_bytes) noexcept {
+    if (!in.coverage || !in.src_w || !in.src_h || in.src_stride < in.src_w) return false;
+    if (!atlas || !scratch) return false;
+    uint16_t cw = 0, ch = 0;
+    if (!CellSize(in, cw, ch) || rect.w != cw || rect.h != ch) return false;
+    const uint32_t comp = (uint32_t)in.mode;
+    if (atlas_stride_bytes < ((uint32_t)rect.x + cw) * comp) return false;
+    const size_t need = ScratchBytes(in);
+    if (!need || scratch_bytes < need) return false;
+
+    const uint32_t ss = ss_(in);
+    const uint32_t gw = (uint32_t)cw * ss, gh = (uint32_t)ch * ss;
+    const uint32_t n = gw > gh ? gw : gh;
+    MemArena a{};
+    a.init(scratch, scratch_bytes);
+    float*    outer = (float*)a.take((size_t)gw * gh * sizeof(float), 16);
+    float*    inner = (float*)a.take((size_t)gw * gh * sizeof(float), 16);
+    uint8_t*  cov   = (uint8_t*)a.take((size_t)gw * gh * sizeof(uint8_t), 16);
+    float*    f = (float*)a.take((size_t)n * sizeof(float), 16);
+    float*    z = (float*)a.take((size_t)(n + 1) * sizeof(float), 16);
+    uint32_t* v = (uint32_t*)a.take((size_t)n * sizeof(uint32_t), 16);
+    if (!outer || !inner || !cov || !f || !z || !v) return false;
+
+    // --------- seed: box-filtered coverage on the EDT grid, 50% threshold ----------
+    const uint32_t mx0 = pad_(in) * ss, my0 = mx0;          // mask origin on the grid
+    const uint32_t mw = (uint32_t)in.dst_w * ss, mh = (uint32_t)in.dst_h * ss;
+    for (uint32_t y = 0; y < gh; ++y) {
+        uint32_t sy0 = 0, sy1 = 0;
+        const bool in_y = y >= my0 && y < my0 + mh;
+        if (in_y) {
+            sy0 = (uint32_t)((uint64_t)(y - my0) * in.src_h / mh);
+            sy1 = (uint32_t)((uint64_t)(y - my0 + 1) * in.src_h / mh);
+            if (sy1 <= sy0) sy1 = sy0 + 1;
+        }
+        for (uint32_t x = 0; x < gw; ++x) {
+            uint32_t c = 0; // coverage 0..255
+            if (in_y && x >= mx0 && x < mx0 + mw) {
+                uint32_t sx0 = (uint32_t)((uint64_t)(x - mx0) * in.src_w / mw);
+                uint32_t sx1 = (uint32_t)((uint64_t)(x - mx0 + 1) * in.src_w / mw);
+                if (sx1 <= sx0) sx1 = sx0 + 1;
+                uint32_t sum = 0;
+                for (uint32_t sy = sy0; sy < sy1; ++sy) {
+                    const uint8_t* row = in.coverage + (size_t)sy * in.src_stride;
+                    for (uint32_t sx = sx0; sx < sx1; ++sx) sum += row[sx];
+                }
+                const uint32_t cnt = (sy1 - sy0) * (sx1 - sx0);
+                c = (sum + cnt / 2u) / cnt;
+            }
+            const size_t i = (size_t)y * gw + x;
+            cov[i] = (uint8_t)c;
+            const bool inside = c >= 128u;
+            outer[i] = inside ? 0.f : INF_D2;
+            inner[i] = inside ? INF_D2 : 0.f;
+        }
+    }
+
+    edt_2d_(outer, gw, gh, f, z, v);
+    edt_2d_(inner, gw, gh, f, z, v);
+
+    // --------- finalize: average signed distance per output pixel ----------
+    const float spread_g = in.spread_px * (float)ss;   // spread in grid pixels
+    const float cap = spread_g * spread_g * 4.f;       // beyond the clamp anyway
+    const float inv = 1.f / ((float)(ss * ss) * spread_g);
+    for (uint32_t oy = 0; oy < ch; ++oy) {
+        uint8_t* row = atlas + (size_t)(rect.y + oy) * atlas_stride_bytes + (size_t)rect.x * comp;
+        for (uint32_t ox = 0; ox < cw; ++ox) {
+            float sum = 0.f;
+            for (uint32_t sy = 0; sy < ss; ++sy) {
+                const size_t base = (size_t)(oy * ss + sy) * gw + (size_t)ox * ss;
+                for (uint32_t sx = 0; sx < ss; ++sx) {
+                    const float o = outer[base + sx], e = inner[base + sx];
+                    float d = sqrt_refined_(o < cap ? o : cap) - sqrt_refined_(e < cap ? e : cap);
+                    d += d > 0.f ? -0.5f : 0.5f; // seeds are centers, the edge is between them
+                    const uint8_t c = cov[base + sx];
+                    if (in.subpixel && c != 0u && c != 255u) d = 0.5f - (float)c * (1.f / 255.f);
+                    sum += d;
+                }
+            }
+            float nd = sum * inv; // > 0 outside
+            const bool inside = nd < 0.f;
+            if (inside) nd = -nd;
+            if (nd > 1.f) nd = 1.f;
+            int sd = (int)(nd * 127.f + .5f);
+            if (inside) sd = -sd;
+            for (uint32_t c = 0; c < comp; ++c) row[ox * comp + c] = (uint8_t)(128 + sd);
+        }
+    }
+    return true;
+}
+
+// ============================================================================
+//                         DYNAMIC ATLAS
+// ============================================================================
+//
+// On-demand counterpart of Plan/Build: glyphs are packed and rendered on first
+// use. The atlas is split into square pages, each with its own skyline; when
+// no page has room, the least-recently-used page is evicted as a whole.
+//
+// All state lives in one caller block (see PlanBytes), pixels in caller pages:
+// page p starts at `pages + p * page_side * stride_bytes`.
+
+struct DynamicAtlasInput {
+    DfMode   mode;
+    uint16_t pixel_height;
+    float    spread_px;
+
+    uint16_t page_side;   // square page side in pixels
+    uint16_t page_count;  // eviction granularity
+    uint32_t slot_cap;    // max resident glyphs across all pages
+    uint32_t dirty_cap;   // dirty rects kept between uploads (>= page_count)
+};
+struct DynamicGlyph {
+    GlyphPlan plan;       // rect.page == 0xFFFF: free slot
+};
+struct DynamicPage {
+    Skyline  sky;
+    uint32_t last_use;    // tick of the most recent hit/insert
+    uint32_t glyph_count;
+};
+
+struct DynamicAtlas {
+    static inline size_t PlanBytes(const Font& font, const DynamicAtlasInput& in) noexcept;
+
+    inline bool Init(Font& font, const DynamicAtlasInput& in,
+                     void* mem, size_t mem_bytes,
+                     uint8_t* pages, uint32_t stride_bytes) noexcept;
+
+    // lookup only: no insertion, no LRU touch
+    inline const DynamicGlyph* Find(uint32_t codepoint) const noexcept;
+    // lookup, or pack + render on miss; nullptr for missing/empty glyphs or oversized cells.
+    // A miss may evict the least-recently-used page: glyphs returned earlier
+    // for that page are gone (their rect may be reused), so look them up again.
+    // A cell larger than a page fails without evicting anything.
+    inline const DynamicGlyph* Get(uint32_t codepoint) noexcept;
+
+    // rects written since the last ClearDirty(); upload these, then clear
+    inline uint32_t DirtyCount() const noexcept { return _dirty_n; }
+    inline const GlyphRect* Dirty() const noexcept { return _dirty; }
+    inline void ClearDirty() noexcept { _dirty_n = 0; }
+
+    // drops every glyph (pixels are left as is)
+    inline void Reset() noexcept;
+
+    // results (filled by Init)
+    float    scale{};       // pixels per font unit
+    float    spread_fu{};   // spread in font units
+    uint16_t max_points{};
+    uint32_t max_area{};
+    uint32_t resident{};    // glyphs currently in the atlas
+    uint32_t evictions{};   // pages evicted so far
+
+private:
+    struct Limits {
+        uint16_t max_points;
+        uint16_t max_w, max_h;
+        uint32_t max_area;
+        uint32_t node_cap;  // per page
+        uint32_t hash_cap;  // power of two
+    };
+    static inline bool limits_(const Font& font, const DynamicAtlasInput& in,
+                               Limits& out, float& scale, float& spread_fu) noexcept;
+    static inline size_t block_bytes_(const DynamicAtlasInput& in, const Limits& l) noexcept;
+
+    inline uint32_t hash_slot_(uint32_t cp) const noexcept { return (cp * 2654435761u) & (_hash_cap - 1u); }
+    inline void hash_insert_(uint32_t cp, uint32_t slot) noexcept;
+    inline void hash_erase_(uint32_t cp) noexcept;
+    inline void evict_page_(uint16_t page) noexcept;
+    inline void mark_dirty_(const GlyphRect& r) noexcept;
+
+    Font*        _font{};
+    DfMode       _mode{};
+    uint8_t*     _pages{};
+    uint32_t     _stride{};
+    uint16_t     _side{};
+    uint16_t     _page_count{};
+    uint32_t     _tick{};
+
+    DynamicPage* _page{};
+    DynamicGlyph* _slots{};
+    uint32_t*    _free{};      // stack of free slot indices
+    uint32_t     _free_n{};
+    uint32_t     _slot_cap{};
+    uint32_t*    _hash{};      // slot+1, 0 == empty (linear probing)
+    uint32_t     _hash_cap{};
+    GlyphRect*   _dirty{};
+    uint32_t     _dirty_n{};
+    uint32_t     _dirty_cap{};
+
+    GlyphScratch _scratch{};
+}; // struct DynamicAtlas
+
+inline bool DynamicAtlas::limits_(const Font& font, const DynamicAtlasInput& in,
+                                  Limits& out, float& scale, float& spread_fu) noexcept {
+    if (!in.page_side || !in.page_count || !in.slot_cap) return false;
+    if (in.page_count == 0xFFFF) return false; // reserved as "free slot"
+    if (in.dirty_cap < in.page_count) return false;
+
+    scale = font.ScaleForPixelHeight((float)in.pixel_height);
+    if (scale <= 0.f) return false;
+    spread_fu = in.spread_px / scale;
+
+    // glyph set is unknown: size cells and scratch for the worst glyph of the font
+    GlyphPlanInfo fi{};
+    if (!font.GetFontPlanInfo(fi) || fi.is_empty) return false;
+
+    const float span_x = (float)(fi.x_max - fi.x_min) + 2.f * spread_fu;
+    const float span_y = (float)(fi.y_max - fi.y_min) + 2.f * spread_fu;
+    out.max_w = u16_min(ceil_to_u16(span_x * scale), in.page_side);
+    out.max_h = u16_min(ceil_to_u16(span_y * scale), in.page_side);
+    out.max_area = (uint32_t)out.max_w * (uint32_t)out.max_h;
+    out.max_points = fi.max_points_in_tree;
+
+    // node count never exceeds the page width (every node is >= 1px wide)
+    const uint32_t by_glyphs = 2u * in.slot_cap + 16u;
+    out.node_cap = by_glyphs < (uint32_t)in.page_side + 1u ? by_glyphs : (uint32_t)in.page_side + 1u;
+
+    uint32_t hc = 16;
+    while (hc < 2u * in.slot_cap) hc <<= 1;
+    out.hash_cap = hc;
+    return true;
+}
+
+inline size_t DynamicAtlas::block_bytes_(const DynamicAtlasInput& in, const Limits& l) noexcept {
+    size_t off = 0;
+    off = align_up(off, 16); off += (size_t)in.page_count * sizeof(DynamicPage);
+    off = align_up(off, 16); off += (size_t)in.page_count * l.node_cap * sizeof(SkylineNode);
+    off = align_up(off, 16); off += (size_t)in.slot_cap * sizeof(DynamicGlyph);
+    off = align_up(off, 16); off += (size_t)in.slot_cap * sizeof(uint32_t);   // free stack
+    off = align_up(off, 16); off += (size_t)l.hash_cap * sizeof(uint32_t);
+    off = align_up(off, 16); off += (size_t)in.dirty_cap * sizeof(GlyphRect);
+    off = align_up(off, 16); off += glyph_scratch_bytes(l.max_points, l.max_area, in.mode);
+    return align_up(off, 16);
+}
+
+inline size_t DynamicAtlas::PlanBytes(const Font& font, const DynamicAtlasInput& in) noexcept {
+    Limits l{};
+    float scale = 0.f, spread_fu = 0.f;
+    if (!limits_(font, in, l, scale, spread_fu)) return 0;
+    return block_bytes_(in, l);
+}
+
+inline bool DynamicAtlas::Init(Font& font, const DynamicAtlasInput& in,
+                               void* mem, size_t mem_bytes,
+                               uint8_t* pages, uint32_t stride_bytes) noexcept {
+    if (!mem || !pages) return false;
+
+    Limits l{};
+    float sc = 0.f, sp = 0.f;
+    if (!limits_(font, in, l, sc, sp)) return false;
+    if (mem_bytes < block_bytes_(in, l)) return false;
+
+    const uint32_t comp = in.mode==DfMode::SDF ? 1u :
+                          in.mode==DfMode::MSDF ? 3u : 4u;
+    if (stride_bytes < (uint32_t)in.page_side * comp) return false;
+
+    MemArena a{};
+    a.init(mem, mem_bytes);
+    _page  = (DynamicPage*) a.take((size_t)in.page_count * sizeof(DynamicPage), 16);
+    SkylineNode* nodes = (SkylineNode*)a.take((size_t)in.page_count * l.node_cap * sizeof(SkylineNode), 16);
+    _slots = (DynamicGlyph*)a.take((size_t)in.slot_cap * sizeof(DynamicGlyph), 16);
+    _free  = (uint32_t*)    a.take((size_t)in.slot_cap * sizeof(uint32_t), 16);
+    _hash  = (uint32_t*)    a.take((size_t)l.hash_cap * sizeof(uint32_t), 16);
+    _dirty = (GlyphRect*)   a.take((size_t)in.dirty_cap * sizeof(GlyphRect), 16);
+    const size_t scratch_bytes = glyph_scratch_bytes(l.max_points, l.max_area, in.mode);
+    void* scratch_mem = a.take(scratch_bytes, 16);
+    if (!_page || !nodes || !_slots || !_free || !_hash || !_dirty || !scratch_mem) return false;
+
+    _font = &font;
+    _mode = in.mode;
+    _pages = pages;
+    _stride = stride_bytes;
+    _side = in.page_side;
+    _page_count = in.page_count;
+    _slot_cap = in.slot_cap;
+    _hash_cap = l.hash_cap;
+    _dirty_cap = in.dirty_cap;
+
+    for (uint16_t p = 0; p < _page_count; ++p) {
+        _page[p].sky.nodes = nodes + (size_t)p * l.node_cap;
+        _page[p].sky.node_cap = (int)l.node_cap;
+    }
+
+    _scratch = bind_glyph_scratch(scratch_mem, l.max_points, l.max_area, in.mode);
+
+    scale = sc;
+    spread_fu = sp;
+    max_points = l.max_points;
+    max_area = l.max_area;
+    evictions = 0;
+
+    Reset();
+    return true;
+}
+
+inline void DynamicAtlas::Reset() noexcept {
+    for (uint16_t p = 0; p < _page_count; ++p) {
+        DynamicPage& pg = _page[p];
+        skyline_init(pg.sky, _side, pg.sky.nodes, pg.sky.node_cap);
+        pg.last_use = 0;
+        pg.glyph_count = 0;
+    }
+    // free stack pops slot 0 first
+    for (uint32_t i = 0; i < _slot_cap; ++i) {
+        _slots[i].plan.rect.page = 0xFFFF;
+        _free[i] = _slot_cap - 1u - i;
+    }
+    _free_n = _slot_cap;
+    for (uint32_t i = 0; i < _hash_cap; ++i) _hash[i] = 0;
+    _dirty_n = 0;
+    _tick = 0;
+    resident = 0;
+}
+
+inline const DynamicGlyph* DynamicAtlas::Find(uint32_t codepoint) const noexcept {
+    if (!_hash) return nullptr;
+    for (uint32_t h = hash_slot_(codepoint);; h = (h + 1u) & (_hash_cap - 1u)) {
+        const uint32_t e = _hash[h];
+        if (!e) return nullptr;
+        if (_slots[e - 1u].plan.codepoint == codepoint) return &_slots[e - 1u];
+    }
+}
+
+inline void DynamicAtlas::hash_insert_(uint32_t cp, uint32_t slot) noexcept {
+    uint32_t h = hash_slot_(cp);
+    while (_hash[h]) h = (h + 1u) & (_hash_cap - 1u);
+    _hash[h] = slot + 1u;
+}
+
+inline void DynamicAtlas::hash_erase_(uint32_t cp) noexcept {
+    const uint32_t mask = _hash_cap - 1u;
+    uint32_t h = hash_slot_(cp);
+    while (_hash[h] && _slots[_hash[h] - 1u].plan.codepoint != cp) h = (h + 1u) & mask;
+    if (!_hash[h]) return;
+
+    // backward-shift deletion: keeps probe chains intact without tombstones
+    uint32_t hole = h;
+    for (uint32_t i = (hole + 1u) & mask; _hash[i]; i = (i + 1u) & mask) {
+        const uint32_t home = hash_slot_(_slots[_hash[i] - 1u].plan.codepoint);
+        // entry may move into the hole only if the hole lies on its probe path
+        if (((i - home) & mask) >= ((i - hole) & mask)) {
+            _hash[hole] = _hash[i];
+            hole = i;
+        }
+    }
+    _hash[hole] = 0;
+}
+
+inline void DynamicAtlas::evict_page_(uint16_t page) noexcept {
+    for (uint32_t i = 0; i < _slot_cap && _page[page].glyph_count; ++i) {
+        DynamicGlyph& g = _slots[i];
+        if (g.plan.rect.page != page) continue;
+        hash_erase_(g.plan.codepoint);
+        g.plan.rect.page = 0xFFFF;
+        _free[_free_n++] = i;
+        --_page[page].glyph_count;
+        --resident;
+    }
+    DynamicPage& pg = _page[page];
+    skyline_init(pg.sky, _side, pg.sky.nodes, pg.sky.node_cap);
+    pg.glyph_count = 0;
+    ++evictions;
+}
+
+inline void DynamicAtlas::mark_dirty_(const GlyphRect& r) noexcept {
+    if (_dirty_n < _dirty_cap) {
+        _dirty[_dirty_n++] = r;
+        return;
+    }
+    // overflow: degrade to whole pages (dirty_cap >= page_count, so this always fits)
+    uint32_t n = 0;
+    for (uint16_t p = 0; p < _page_count; ++p) {
+        bool hit = (p == r.page);
+        for (uint32_t i = 0; i < _dirty_n && !hit; ++i) hit = (_dirty[i].page == p);
+        if (hit) _dirty[n++] = GlyphRect{ 0, 0, _side, _side, p };
+    }
+    _dirty_n = n;
+}
+
+inline const DynamicGlyph* DynamicAtlas::Get(uint32_t codepoint) noexcept {
+    if (!_font) return nullptr;
+    ++_tick;
+
+    if (const DynamicGlyph* hit = Find(codepoint)) {
+        _page[hit->plan.rect.page].last_use = _tick;
+        return hit->plan.rect.w ? hit : nullptr; // w==0: outline failed to stream earlier
+    }
+
+    const int gi = _font->FindGlyphIndex((int)codepoint);
+    if (gi <= 0) return nullptr;
+
+    GlyphPlanInfo gpi{};
+    if (!_font->GetGlyphPlanInfo(gi, gpi) || gpi.is_empty) return nullptr;
+    if (gpi.max_points_in_tree > max_points) return nullptr;
+
+    GlyphPlan gp{};
+    gp.codepoint = codepoint;
+    gp.glyph_index = (uint16_t)gi;
+    gp.x_min = gpi.x_min;
+    gp.y_min = gpi.y_min;
+    gp.x_max = gpi.x_max;
+    gp.y_max = gpi.y_max;
+    gp.num_points = gpi.max_points_in_tree;
+
+    const float span_x = (float)(gp.x_max - gp.x_min) + 2.f * spread_fu;
+    const float span_y = (float)(gp.y_max - gp.y_min) + 2.f * spread_fu;
+    gp.rect.w = ceil_to_u16(span_x * scale);
+    gp.rect.h = ceil_to_u16(span_y * scale);
+    // an emptied page takes any cell up to its side: check before anything is
+    // evicted, so an oversized cell never costs a page
+    if (gp.rect.w > _side || gp.rect.h > _side) return nullptr;
+    if ((uint32_t)gp.rect.w * gp.rect.h > max_area) return nullptr;
+
+    // --------- find room: first page that fits, else evict the LRU page ---------
+    uint16_t page = 0xFFFF;
+    if (_free_n) {
+        for (uint16_t p = 0; p < _page_count; ++p) {
+            if (skyline_insert(_page[p].sky, gp.rect.w, gp.rect.h, gp.rect.x, gp.rect.y)) { page = p; break; }
+        }
+    }
+    if (page == 0xFFFF) {
+        // out of slots: only a page that holds glyphs can give some back
+        uint16_t lru = 0xFFFF;
+        for (uint16_t p = 0; p < _page_count; ++p) {
+            if (!_free_n && !_page[p].glyph_count) continue;
+            if (lru == 0xFFFF || _page[p].last_use < _page[lru].last_use) lru = p;
+        }
+        if (lru == 0xFFFF) return nullptr;
+        evict_page_(lru);
+        if (!_free_n) return nullptr;
+        if (!skyline_insert(_page[lru].sky, gp.rect.w, gp.rect.h, gp.rect.x, gp.rect.y)) return nullptr;
+        page = lru;
+    }
+
+    // --------- render into the page ---------
+    uint8_t* page_px = _pages + (size_t)page * _side * _stride;
+    _scratch.visit_n = 0;
+    const bool ok = _font->StreamDF(gp, page_px, _stride, _mode, scale, spread_fu,
+                                    _scratch, max_points, max_area);
+
+    const uint32_t slot = _free[--_free_n];
+    DynamicGlyph& dg = _slots[slot];
+    gp.rect.page = page;
+    dg.plan = gp;
+    hash_insert_(codepoint, slot);
+    ++_page[page].glyph_count;
+    _page[page].last_use = _tick;
+    ++resident;
+
+    if (!ok) {
+        // keep the slot so the glyph is not re-packed every frame; the cell is
+        // reclaimed with its page
+        dg.plan.rect.w = dg.plan.rect.h = 0;
+        return nullptr;
+    }
+    mark_dirty_(gp.rect);
+    return &dg;
+}
+// ============================================================================
+//                         ATLAS CACHE
+// ============================================================================
+//
+// Versioned binary image of a finished Plan + Build, meant to be mmap'ed:
+//
+//   [AtlasCacheHeader][pad][GlyphPlan x glyph_count][codepoint map][pad to 4096][page 0 rows]...
+//
+// Data is stored in host layout; the header carries an endian tag and struct
+// sizes so a foreign or stale file is rejected instead of misread.
+// LoadCache binds a FontPlan view straight onto the mapped bytes (no copies).
+
+static constexpr uint32_t ATLAS_CACHE_MAGIC   = 0x43535453u; // "STSC"
+static constexpr uint16_t ATLAS_CACHE_VERSION = 5;
+static constexpr uint32_t ATLAS_CACHE_ENDIAN  = 0x01020304u;
+static constexpr size_t   ATLAS_CACHE_PIXEL_ALIGN = 4096;      // page-aligned pixels
+
+struct AtlasCacheKey {
+    uint64_t font_hash;       // Font::ContentHash()
+    uint64_t codepoint_hash;  // sequence hash: input order decides packing ties
+    DfMode   mode;
+    PackMode pack_mode;
+    AtlasFormat format;
+    uint16_t pixel_height;
+    uint16_t max_page_side;
+    float    spread_px;
+};
+struct AtlasCacheHeader {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t header_bytes;
+    uint32_t endian;
+    uint16_t glyph_plan_bytes; // sizeof(GlyphPlan) at write time
+    uint8_t  format;           // key
+    uint8_t  reserved0;
+
+    // key
+    uint64_t font_hash;
+    uint64_t codepoint_hash;
+    uint8_t  mode;
+    uint8_t  pack_mode;
+    uint16_t pixel_height;
+    float    spread_px;
+
+    // FontPlan results
+    float    scale;
+    float    spread_fu;
+    uint16_t atlas_side;
+    uint16_t page_count;
+    uint32_t glyph_count;
+    uint16_t max_points;
+    uint16_t max_page_side;    // key
+    uint32_t max_area;
+    uint32_t atlas_stride;     // AtlasStrideBytes: bytes per row (BC: per channel block row)
+    uint32_t codepoint_count;  // entries in the codepoint -> slot map
+
+    uint64_t glyphs_offset;
+    uint64_t atlas_offset;
+    uint64_t total_bytes;
+};
+
+static inline AtlasCacheKey MakeAtlasCacheKey(const Font& font, const PlanInput& in) noexcept {
+    AtlasCacheKey k{};
+    k.font_hash = font.ContentHash();
+    k.codepoint_hash = fnv1a64(in.codepoints, (size_t)in.codepoint_count * sizeof(uint32_t));
+    k.mode = in.mode;
+    k.pack_mode = in.pack_mode;
+    k.format = in.format;
+    k.pixel_height = in.pixel_height;
+    k.max_page_side = in.max_page_side;
+    k.spread_px = in.spread_px;
+    return k;
+}
+
+static inline bool atlas_cache_layout_(const FontPlan& plan, size_t& glyphs_off, size_t& map_off,
+                                       size_t& atlas_off, size_t& total, uint32_t& stride) noexcept {
+    if (!plan.atlas_side || !plan.page_count || !plan.glyph_count || !plan.codepoint_count) return false;
+    stride = AtlasStrideBytes(plan);
+    glyphs_off = align_up(sizeof(AtlasCacheHeader), 64);
+    map_off    = align_up(glyphs_off + (size_t)plan.glyph_count * sizeof(GlyphPlan), 16);
+    atlas_off  = align_up(map_off + (size_t)plan.codepoint_count * 2u * sizeof(uint32_t), ATLAS_CACHE_PIXEL_ALIGN);
+    total      = atlas_off + AtlasPageBytes(plan, stride) * plan.page_count;
+    return true;
+}
+
+// Size of the cache image for a planned atlas (0 if the plan is empty).
+static inline size_t AtlasCacheBytes(const FontPlan& plan) noexcept {
+    size_t g = 0, m = 0, a = 0, total = 0;
+    uint32_t stride = 0;
+    return atlas_cache_layout_(plan, g, m, a, total, stride) ? total : 0;
+}
+
+// Serializes plan + built atlas into `out` (AtlasCacheBytes(plan) bytes).
+// `atlas` holds the pages back to back, as written by Build(plan, atlas, stride).
+static inline bool WriteAtlasCache(const FontPlan& plan, const AtlasCacheKey& key,
+                                   const uint8_t* atlas, uint32_t atlas_stride_bytes,
+                                   void* out, size_t out_bytes) noexcept {
+    if (!atlas || !out || !plan._glyphs || !plan._map_cp || !plan._map_slot) return false;
+    size_t glyphs_off = 0, map_off = 0, atlas_off = 0, total = 0;
+    uint32_t stride = 0;
+    if (!atlas_cache_layout_(plan, glyphs_off, map_off, atlas_off, total, stride)) return false;
+    if (out_bytes < total || atlas_stride_bytes < stride) return false;
+    if (key.mode != plan.mode || key.pixel_height != plan.pixel_height) return false;
+    if (key.format != plan.format) return false;
+
+    uint8_t* o = (uint8_t*)out;
+    for (size_t i = 0; i < atlas_off; ++i) o[i] = 0; // deterministic padding
+
+    AtlasCacheHeader h{};
+    h.magic = ATLAS_CACHE_MAGIC;
+    h.version = ATLAS_CACHE_VERSION;
+    h.header_bytes = (uint16_t)sizeof(AtlasCacheHeader);
+    h.endian = ATLAS_CACHE_ENDIAN;
+    h.glyph_plan_bytes = (uint16_t)sizeof(GlyphPlan);
+    h.font_hash = key.font_hash;
+    h.codepoint_hash = key.codepoint_hash;
+    h.mode = (uint8_t)key.mode;
+    h.pack_mode = (uint8_t)key.pack_mode;
+    h.format = (uint8_t)key.format;
+    h.pixel_height = key.pixel_height;
+    h.max_page_side = key.max_page_side;
+    h.spread_px = key.spread_px;
+    h.scale = plan.scale;
+    h.spread_fu = plan.spread_fu;
+    h.atlas_side = plan.atlas_side;
+    h.page_count = plan.page_count;
+    h.max_points = plan.max_points;
+    h.glyph_count = plan.glyph_count;
+    h.max_area = plan.max_area;
+    h.atlas_stride = stride;
+    h.codepoint_count = plan.codepoint_count;
+    h.glyphs_offset = glyphs_off;
+    h.atlas_offset = atlas_off;
+    h.total_bytes = total;
+
+    const uint8_t* hp = (const uint8_t*)&h;
+    for (size_t i = 0; i < sizeof(h); ++i) o[i] = hp[i];
+
+    const uint8_t* gp = (const uint8_t*)plan._glyphs;
+    for (size_t i = 0; i < (size_t)plan.glyph_count * sizeof(GlyphPlan); ++i) o[glyphs_off + i] = gp[i];
+
+    uint32_t* map = (uint32_t*)(o + map_off);
+    for (uint32_t i = 0; i < plan.codepoint_count; ++i) {
+        map[i] = plan._map_cp[i];
+        map[plan.codepoint_count + i] = plan._map_slot[i];
+    }
+
+    const size_t rows = AtlasPageBytes(plan, stride) / stride * plan.page_count;
+    for (size_t y = 0; y < rows; ++y) {
+        const uint8_t* src = atlas + (size_t)y * atlas_stride_bytes;
+        uint8_t* dst = o + atlas_off + (size_t)y * stride;
+        for (uint32_t x = 0; x < stride; ++x) dst[x] = src[x];
+    }
+    return true;
+}
+
+// Validates `mem` against `key` and binds a read-only FontPlan view onto it.
+// `mem` must stay alive (mapped) while the plan is used. The view carries no
+// scratch, so Build() on it fails; the atlas is already there.
+static inline bool LoadAtlasCache(const void* mem, size_t mem_bytes, const AtlasCacheKey& key,
+                                  FontPlan& out_plan, const uint8_t*& out_atlas,
+                                  uint32_t& out_stride_bytes) noexcept {
+    if (!mem || mem_bytes < sizeof(AtlasCacheHeader)) return false;
+    if (((uintptr_t)mem & 15u) != 0) return false; // GlyphPlan table is read in place
+
+    AtlasCacheHeader h;
+    {
+        const uint8_t* src = (const uint8_t*)mem;
+        uint8_t* dst = (uint8_t*)&h;
+        for (size_t i = 0; i < sizeof(h); ++i) dst[i] = src[i];
+    }
+    if (h.magic != ATLAS_CACHE_MAGIC || h.version != ATLAS_CACHE_VERSION) return false;
+    if (h.endian != ATLAS_CACHE_ENDIAN) return false;
+    if (h.header_bytes != sizeof(AtlasCacheHeader) || h.glyph_plan_bytes != sizeof(GlyphPlan)) return false;
+
+    if (h.font_hash != key.font_hash || h.codepoint_hash != key.codepoint_hash) return false;
+    if (h.mode != (uint8_t)key.mode || h.pixel_height != key.pixel_height) return false;
+    if (h.spread_px != key.spread_px) return false;
+    if (h.pack_mode != (uint8_t)key.pack_mode || h.max_page_side != key.max_page_side) return false;
+    if (h.format != (uint8_t)key.format) return false;
+
+    FontPlan probe{};
+    probe.mode = key.mode;
+    probe.format = key.format;
+    probe.atlas_side = h.atlas_side;
+    probe.page_count = h.page_count;
+    probe.glyph_count = h.glyph_count;
+    probe.codepoint_count = h.codepoint_count;
+    size_t glyphs_off = 0, map_off = 0, atlas_off = 0, total = 0;
+    uint32_t stride = 0;
+    if (!atlas_cache_layout_(probe, glyphs_off, map_off, atlas_off, total, stride)) return false;
+    if (h.glyphs_offset != glyphs_off || h.atlas_offset != atlas_off || h.total_bytes != total) return false;
+    if (h.atlas_stride != stride || mem_bytes < total) return false;
+
+    // FontPlan::Find binary-searches the codepoints and indexes the glyph
+    // table with the slots: a damaged map must miss, not read out of bounds.
+    const uint8_t* base = (const uint8_t*)mem;
+    const uint32_t* map_cp = (const uint32_t*)(base + map_off);
+    const uint32_t* map_slot = map_cp + h.codepoint_count;
+    for (uint32_t i = 0; i < h.codepoint_count; ++i) {
+        if (map_slot[i] >= h.glyph_count) return false;
+        if (i && map_cp[i] <= map_cp[i - 1]) return false;
+    }
+    // every cell (block padded for BC) must lie on a page of the cached atlas
+    const GlyphPlan* glyphs = (const GlyphPlan*)(base + glyphs_off);
+    for (uint32_t i = 0; i < h.glyph_count; ++i) {
+        const GlyphRect& r = glyphs[i].rect;
+        if (r.page >= h.page_count) return false;
+        if ((uint32_t)r.x + pack_dim(r.w, key.format) > h.atlas_side) return false;
+        if ((uint32_t)r.y + pack_dim(r.h, key.format) > h.atlas_side) return false;
+    }
+
+    out_plan = FontPlan{};
+    out_plan.mode = key.mode;
+    out_plan.format = key.format;
+    out_plan.pixel_height = h.pixel_height;
+    out_plan.scale = h.scale;
+    out_plan.spread_fu = h.spread_fu;
+    out_plan.atlas_side = h.atlas_side;
+    out_plan.page_count = h.page_count;
+    out_plan.glyph_count = h.glyph_count;
+    out_plan.codepoint_count = h.codepoint_count;
+    out_plan.max_points = h.max_points;
+    out_plan.max_area = h.max_area;
+    out_plan._mem = const_cast<uint8_t*>(base);
+    out_plan._mem_bytes = total;
+    out_plan._glyphs = const_cast<GlyphPlan*>(glyphs);
+    out_plan._map_cp = const_cast<uint32_t*>(map_cp);
+    out_plan._map_slot = const_cast<uint32_t*>(map_slot);
+
+    out_atlas = base + atlas_off;
+    out_stride_bytes = stride;
+    return true;
+}
+
 } // namespace stb_stream
 
 
@@ -0,0 +1,274 @@
+// BUILD: Debug, Release. STD used, no freestanding.
+//
+// Compile as a single TU. Requires Catch2 single-header.
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <thread>
+#include <vector>
+
+// ---------------- Catch2 single header include ----------------
+#if __has_include(<catch2/catch_all.hpp>)
+#  define CATCH_CONFIG_MAIN
+#  include <catch2/catch_all.hpp>
+#elif __has_include(<catch.hpp>)
+#  define CATCH_CONFIG_MAIN
+#  include <catch.hpp>
+#elif __has_include("catch.hpp")
+#  define CATCH_CONFIG_MAIN
+#  include "catch.hpp"
+#else
+#  error "Catch2 single-header not found. Provide <catch2/catch_all.hpp> or catch.hpp."
+#endif
+
+#include "../stb_allocator/stb_allocator.hpp"
+#include "../stb_image/stb_image.hpp"
+#include "../stb_image_write/stb_image_write.hpp"
+
+namespace stb_alloc_test {
+
+static bool aligned(const void* p, size_t a) {
+    return ((uintptr_t)p & (a - 1)) == 0;
+}
+
+static void fill(void* p, size_t n, uint8_t seed) {
+    uint8_t* b = (uint8_t*)p;
+    for (size_t i = 0; i < n; ++i) b[i] = (uint8_t)(seed + i * 7);
+}
+
+static bool check(const void* p, size_t n, uint8_t seed) {
+    const uint8_t* b = (const uint8_t*)p;
+    for (size_t i = 0; i < n; ++i) if (b[i] != (uint8_t)(seed + i * 7)) return false;
+    return true;
+}
+
+static void sink(void* ctx, const void* data, int size) {
+    std::vector<uint8_t>& out = *(std::vector<uint8_t>*)ctx;
+    out.insert(out.end(), (const uint8_t*)data, (const uint8_t*)data + size);
+}
+
+// Noisy RGBA image so the PNG encoder and decoder both do real work.
+static std::vector<uint8_t> make_image(uint32_t w, uint32_t h) {
+    std::vector<uint8_t> px((size_t)w * h * 4);
+    uint32_t s = 0x1234567u;
+    for (size_t i = 0; i < px.size(); ++i) {
+        s = s * 1664525u + 1013904223u;
+        px[i] = (uint8_t)((i & 3) == 3 ? 255 : ((i / 4) % w * 3 + (s >> 29)));
+    }
+    return px;
+}
+
+static std::vector<uint8_t> encode_png(const std::vector<uint8_t>& px, uint32_t w, uint32_t h) {
+    std::vector<uint8_t> png;
+    stbiw::Writer wr;
+    wr.start_callbacks(sink, &png);
+    if (!wr.write_png((int)w, (int)h, 4, px.data(), 0)) png.clear();
+    wr.flush();
+    return png;
+}
+
+static bool decode_png(const std::vector<uint8_t>& png, const stb::Allocator* a, std::vector<uint8_t>& out) {
+    stbi::DecodeOptions opt;
+    opt.allocator = a;
+    stbi::ImagePlan plan;
+    if (!stbi::Plan(png.data(), png.size(), opt, plan)) return false;
+    out.assign(plan.pixel_bytes, 0);
+    return stbi::Decode(png.data(), png.size(), plan, nullptr, 0, out.data(), out.size());
+}
+
+} // namespace stb_alloc_test
+
+using namespace stb_alloc_test;
+
+TEST_CASE("BumpArena - aligned bumps, last block grows in place, Reset", "[stb_allocator][bump]") {
+    alignas(64) static uint8_t mem[1024];
+    stb::BumpArena arena(mem, sizeof(mem));
+    const stb::Allocator a = arena.AsAllocator();
+
+    void* p = stb::Alloc(a, 10);
+    void* q = stb::Alloc(a, 100, 64);
+    REQUIRE(p == mem);
+    REQUIRE(aligned(q, 64));
+    fill(q, 100, 3);
+
+    // q is the last block: grows in place, p cannot
+    REQUIRE(stb::Realloc(a, q, 100, 300) == q);
+    REQUIRE(check(q, 100, 3));
+    REQUIRE_FALSE(stb::Resize(a, p, 10, 20));
+    REQUIRE(stb::Resize(a, p, 10, 5));
+
+    // giving back the last block rolls the top back
+    const size_t used = arena.Used();
+    stb::Free(a, q);
+    REQUIRE(arena.Used() < used);
+    REQUIRE(arena.Peak() == used);
+
+    REQUIRE(stb::Alloc(a, 2000) == nullptr);
+    arena.Reset();
+    REQUIRE(arena.Used() == 0);
+    REQUIRE(stb::Alloc(a, 1024) == mem);
+}
+
+TEST_CASE("SlabAllocator - size classes reuse freed blocks, large blocks go upstream", "[stb_allocator][slab]") {
+    stb::StatsAllocator upstream;
+    const stb::Allocator up = upstream.AsAllocator();
+    {
+        stb::SlabAllocator slab(up, 4096);
+        const stb::Allocator a = slab.AsAllocator();
+
+        void* p = stb::Alloc(a, 40);
+        REQUIRE(aligned(p, 16));
+        stb::Free(a, p);
+        REQUIRE(stb::Alloc(a, 33) == p);            // same 64-byte class
+        REQUIRE(stb::Resize(a, p, 33, 64));         // still fits the class
+        REQUIRE_FALSE(stb::Resize(a, p, 64, 65));
+
+        std::vector<void*> small;
+        for (int i = 0; i < 200; ++i) {
+            void* s = stb::Alloc(a, (size_t)(i % 100) + 1);
+            REQUIRE(s != nullptr);
+            fill(s, (size_t)(i % 100) + 1, (uint8_t)i);
+            small.push_back(s);
+        }
+        for (int i = 0; i < 200; ++i) REQUIRE(check(small[(size_t)i], (size_t)(i % 100) + 1, (uint8_t)i));
+        const size_t chunks = upstream.Stats().alloc_count;
+        REQUIRE(chunks > 1);
+
+        void* big = stb::Alloc(a, 10000, 64);
+        REQUIRE(aligned(big, 64));
+        REQUIRE(upstream.Stats().alloc_count == chunks + 1);
+        fill(big, 10000, 9);
+        void* moved = stb::Realloc(a, big, 10000, 20000);
+        REQUIRE(check(moved, 10000, 9));
+        stb::Free(a, moved);
+
+        // grow a small block across classes
+        void* g = stb::Realloc(a, small[5], 6, 3000);
+        REQUIRE(check(g, 6, 5));
+        stb::Free(a, g);
+        for (size_t i = 0; i < small.size(); ++i) if (i != 5) stb::Free(a, small[i]);
+    }
+    // chunks go back on destruction
+    REQUIRE(upstream.Stats().live_bytes == 0);
+    REQUIRE(upstream.Stats().alloc_count == upstream.Stats().free_count);
+}
+
+TEST_CASE("StatsAllocator - counts calls and tracks live and peak bytes", "[stb_allocator][stats]") {
+    alignas(16) static uint8_t mem[4096];
+    stb::BumpArena arena(mem, sizeof(mem));
+    stb::StatsAllocator stats(arena.AsAllocator());
+    const stb::Allocator a = stats.AsAllocator();
+
+    void* p = stb::Alloc(a, 100);
+    void* q = stb::Alloc(a, 200, 64);
+    REQUIRE(aligned(q, 64));
+    REQUIRE(stb::Resize(a, q, 200, 500));       // last arena block
+    stb::Free(a, p);
+    REQUIRE(stb::Alloc(a, 8000) == nullptr);
+
+    const stb::AllocStats& s = stats.Stats();
+    REQUIRE(s.alloc_count == 2);
+    REQUIRE(s.free_count == 1);
+    REQUIRE(s.resize_count == 1);
+    REQUIRE(s.failed_count == 1);
+    REQUIRE(s.total_bytes == 300);
+    REQUIRE(s.live_bytes == 500);
+    REQUIRE(s.peak_bytes == 600);
+
+    stats.ResetStats();
+    REQUIRE(stats.Stats().alloc_count == 0);
+    REQUIRE(stats.Stats().peak_bytes == 500);
+    stb::Free(a, q);
+    REQUIRE(stats.Stats().live_bytes == 0);
+}
+
+TEST_CASE("Blocks - scopes nest and a block returns to the allocator that made it", "[stb_allocator][block]") {
+    stb::StatsAllocator outer, inner;
+    const stb::Allocator ao = outer.AsAllocator();
+    const stb::Allocator ai = inner.AsAllocator();
+
+    void* p = nullptr;
+    {
+        stb::ScopedAllocator s1(&ao);
+        p = stb::BlockAlloc(24);
+        {
+            stb::ScopedAllocator s2(&ai);
+            REQUIRE(&stb::GetAllocator() == &ai);
+            stb::ScopedAllocator keep(nullptr);
+            REQUIRE(&stb::GetAllocator() == &ai);
+            fill(p, 24, 1);
+            p = stb::BlockRealloc(p, 4000);         // stays with `outer`
+            REQUIRE(stb::BlockSize(p) == 4000);
+            REQUIRE(check(p, 24, 1));
+        }
+        REQUIRE(&stb::GetAllocator() == &ao);
+    }
+    REQUIRE(&stb::GetAllocator() == &stb::DefaultAllocator());
+    REQUIRE(inner.Stats().alloc_count == 0);
+    REQUIRE(outer.Stats().live_bytes >= 4000);
+    stb::BlockFree(p);
+    REQUIRE(outer.Stats().live_bytes == 0);
+}
+
+TEST_CASE("Libraries - stbiw and stbi allocate only through the installed allocator", "[stb_allocator][stbi][stbiw]") {
+    const uint32_t w = 96, h = 64;
+    const std::vector<uint8_t> px = make_image(w, h);
+
+    SECTION("process-wide stats allocator") {
+        stb::StatsAllocator stats;
+        const stb::Allocator a = stats.AsAllocator();
+        stb::SetAllocator(&a);
+        const std::vector<uint8_t> png = encode_png(px, w, h);
+        const size_t writes = stats.Stats().alloc_count;
+        std::vector<uint8_t> out;
+        const bool ok = decode_png(png, nullptr, out);
+        stb::SetAllocator(nullptr);
+
+        REQUIRE(!png.empty());
+        REQUIRE(ok);
+        REQUIRE(out == px);
+        REQUIRE(writes > 0);
+        REQUIRE(stats.Stats().alloc_count > writes);
+        REQUIRE(stats.Stats().live_bytes == 0);
+        REQUIRE(stats.Stats().alloc_count == stats.Stats().free_count);
+    }
+
+    SECTION("bump arena passed through DecodeOptions") {
+        const std::vector<uint8_t> png = encode_png(px, w, h);
+        std::vector<uint8_t> mem(1u << 20);
+        stb::BumpArena arena(mem.data(), mem.size());
+        const stb::Allocator a = arena.AsAllocator();
+        std::vector<uint8_t> out;
+        REQUIRE(decode_png(png, &a, out));
+        REQUIRE(out == px);
+        REQUIRE(arena.Peak() > (size_t)w * h * 4);
+
+        // too small an arena fails cleanly
+        std::vector<uint8_t> tiny(256);
+        stb::BumpArena small(tiny.data(), tiny.size());
+        const stb::Allocator as = small.AsAllocator();
+        REQUIRE_FALSE(decode_png(png, &as, out));
+    }
+
+    SECTION("one slab per thread") {
+        const std::vector<uint8_t> png = encode_png(px, w, h);
+        bool ok[4] = {};
+        std::vector<std::thread> threads;
+        for (int t = 0; t < 4; ++t) {
+            threads.emplace_back([&, t] {
+                stb::SlabAllocator slab;
+                const stb::Allocator a = slab.AsAllocator();
+                stb::ScopedAllocator scope(&a);
+                bool good = true;
+                for (int i = 0; i < 3; ++i) {
+                    std::vector<uint8_t> out;
+                    good = good && decode_png(png, nullptr, out) && out == px;
+                }
+                ok[t] = good;
+            });
+        }
+        for (std::thread& th : threads) th.join();
+        for (int t = 0; t < 4; ++t) REQUIRE(ok[t]);
+    }
+}
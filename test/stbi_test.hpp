@@ -11,6 +11,7 @@
 #include "catch.hpp"
 
 #include "../stb_image/stb_image.hpp"
+#include "../stb_image_resize2/stb_image_resize2.hpp"
 
 extern "C" {
 unsigned char* stbi_ref_load_u8_from_memory(const unsigned char* bytes, int byte_count,
@@ -161,3 +162,106 @@ TEST_CASE("stbi byte diff: fork matches original stb_image.h on cat.*", "[stbi][
     }
 }
 
+
+TEST_CASE("stbi rows: DecodeRows matches Decode and feeds a ResizeStream", "[stbi][rows]") {
+    std::vector<uint8_t> file;
+    std::string used_path;
+    REQUIRE(read_cat_image("jpg", file, used_path));
+
+    DecodedCpp cpp{};
+    std::string cpp_fail;
+    REQUIRE(decode_cpp_rgba_u8(file, cpp, cpp_fail));
+
+    stbi::DecodeOptions opt{};
+    opt.desired_channels = 4;
+    stbi::ImagePlan plan{};
+    REQUIRE(stbi::Plan(file.data(), file.size(), opt, plan));
+
+    struct Rows { uint8_t* out; size_t row; uint32_t next; bool ordered; };
+    std::vector<uint8_t> rows(plan.pixel_bytes);
+    Rows r{ rows.data(), (size_t)plan.width * 4u, 0, true };
+    auto sink = [](void* user, uint32_t y, const void* row) {
+        Rows& s = *(Rows*)user;
+        s.ordered = s.ordered && y == s.next++;
+        std::memcpy(s.out + (size_t)y * s.row, row, s.row);
+    };
+    REQUIRE(stbi::DecodeRows(file.data(), file.size(), plan, nullptr, 0, sink, &r));
+    REQUIRE(r.ordered);
+    REQUIRE(r.next == plan.height);
+    REQUIRE(rows == cpp.pixels_rgba);
+
+    // Decode -> Resize and DecodeRows -> ResizeStream give the same thumbnail.
+    stbir::ResizeInput in;
+    in.in_w = plan.width; in.in_h = plan.height;
+    in.out_w = 64; in.out_h = 43;
+    std::vector<uint8_t> plan_mem(stbir::PlanBytes(in));
+    stbir::ResizePlan rp;
+    REQUIRE(stbir::Plan(in, plan_mem.data(), plan_mem.size(), rp));
+    std::vector<uint8_t> ref(64 * 43 * 4), thumb(ref.size());
+    std::vector<uint8_t> scratch(stbir::ScratchBytes(rp));
+    REQUIRE(stbir::Resize(rp, cpp.pixels_rgba.data(), plan.width * 4, ref.data(), 64 * 4,
+                          scratch.data(), scratch.size()));
+
+    std::vector<uint8_t> stream_mem(stbir::StreamBytes(rp));
+    stbir::ResizeStream stream;
+    REQUIRE(stream.Begin(rp, thumb.data(), 64 * 4, stream_mem.data(), stream_mem.size()));
+    auto push = [](void* user, uint32_t, const void* row) { ((stbir::ResizeStream*)user)->PushRow(row); };
+    REQUIRE(stbi::DecodeRows(file.data(), file.size(), plan, nullptr, 0, push, &stream));
+    REQUIRE(stream.Done());
+    REQUIRE(thumb == ref);
+}
+
+TEST_CASE("stbi rows: JPEG DCT scaling shrinks the decode by powers of two", "[stbi][rows]") {
+    std::vector<uint8_t> file;
+    std::string used_path;
+    REQUIRE(read_cat_image("jpg", file, used_path));
+
+    DecodedCpp cpp{};
+    std::string cpp_fail;
+    REQUIRE(decode_cpp_rgba_u8(file, cpp, cpp_fail));
+
+    stbi::DecodeOptions opt{};
+    opt.desired_channels = 4;
+    stbi::ImagePlan full{};
+    REQUIRE(stbi::Plan(file.data(), file.size(), opt, full));
+    REQUIRE(stbi::JpegScaleFor(full, full.width, full.height) == 0);
+    REQUIRE(stbi::JpegScaleFor(full, full.width / 2, full.height / 2) == 1);
+    REQUIRE(stbi::JpegScaleFor(full, 1, 1) == 3);
+
+    for (uint8_t s = 1; s <= 3; ++s) {
+        opt.jpeg_scale_log2 = s;
+        stbi::ImagePlan plan{};
+        REQUIRE(stbi::Plan(file.data(), file.size(), opt, plan));
+        const uint32_t d = 1u << s;
+        REQUIRE(plan.width == (full.width + d - 1) / d);
+        REQUIRE(plan.height == (full.height + d - 1) / d);
+
+        std::vector<uint8_t> px(plan.pixel_bytes);
+        REQUIRE(stbi::Decode(file.data(), file.size(), plan, nullptr, 0, px.data(), px.size()));
+
+        // close to a box average of the full decode
+        double err = 0.0;
+        for (uint32_t y = 0; y < plan.height; ++y) {
+            for (uint32_t x = 0; x < plan.width; ++x) {
+                for (uint32_t c = 0; c < 3; ++c) {
+                    uint32_t sum = 0, n = 0;
+                    for (uint32_t v = y * d; v < std::min((y + 1) * d, full.height); ++v) {
+                        for (uint32_t u = x * d; u < std::min((x + 1) * d, full.width); ++u) {
+                            sum += cpp.pixels_rgba[((size_t)v * full.width + u) * 4 + c];
+                            ++n;
+                        }
+                    }
+                    const double box = (double)sum / n;
+                    const double got = px[((size_t)y * plan.width + x) * 4 + c];
+                    err += box > got ? box - got : got - box;
+                }
+            }
+        }
+        INFO("scale 1/" << d);
+        REQUIRE(err / ((double)plan.width * plan.height * 3) < 4.0);
+    }
+
+    opt.jpeg_scale_log2 = 4;
+    stbi::ImagePlan bad{};
+    REQUIRE_FALSE(stbi::Plan(file.data(), file.size(), opt, bad));
+}
@@ -0,0 +1,407 @@
+// BUILD: Debug, Release. STD used, no freestanding.
+
+// stbir bench: Resize over a corpus x filter x ratio x channels x sample type,
+// printed as JSON. Per case: best-of-N output megapixels/s single-threaded and
+// through ResizeSplit + StdThreads, plan and scratch bytes, heap allocations
+// inside the timed loop, and upstream stbir_resize on the same pixels (speed,
+// allocations and the largest per-sample deviation from the port).
+//
+// Corpus: img/cat.png (decoded with the stb_image port, when found) plus
+// synthetic noise, gradient and checker images.
+//
+// ENV:
+//  - STBIR_BENCH_ITERS   : measured repetitions per case (default 3)
+//  - STBIR_BENCH_SIZE    : side of the synthetic images (default 512)
+//  - STBIR_BENCH_THREADS : bands for the threaded run (default: hardware threads)
+//
+// Define STBIR_BENCH_NO_REFERENCE to build without 3rd_party/stb
+// (test/stbir_ref_original.cpp wraps the upstream header).
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <cmath>
+#include <new>
+#include <vector>
+#include <string>
+#include <fstream>
+#include <algorithm>
+#include <iostream>
+#include <chrono>
+#include <thread>
+
+#if defined(_WIN32)
+#   include <windows.h>
+#   include <mmsystem.h>
+#   pragma comment(lib, "winmm.lib")
+#   undef max
+#   undef min
+static void set_high_perf_timer() { timeBeginPeriod(1); }
+#else
+static void set_high_perf_timer() {}
+#endif
+
+#define STBIR_STD_THREADS
+#include "../stb_image_resize2/stb_image_resize2.hpp"
+#include "../stb_image/stb_image.hpp"
+
+#ifndef STBIR_BENCH_NO_REFERENCE
+extern "C" {
+int stbir_ref_resize(const void* in, int in_w, int in_h, int in_stride,
+                     void* out, int out_w, int out_h, int out_stride,
+                     int channels, int type, int filter, int edge);
+std::size_t stbir_ref_alloc_count();
+std::size_t stbir_ref_alloc_bytes();
+}
+#endif
+
+// ---------------- Heap counter ----------------
+// Every operator new in the process is counted, so a timed loop that
+// allocates shows up in "allocs" (the port itself never allocates).
+namespace stbir_bench {
+    static std::size_t g_news = 0;
+}
+
+void* operator new(std::size_t n) {
+    ++stbir_bench::g_news;
+    if (void* p = std::malloc(n ? n : 1)) return p;
+    throw std::bad_alloc();
+}
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete(void* p, std::size_t) noexcept { std::free(p); }
+
+namespace stbir_bench {
+
+    using clock = std::chrono::steady_clock;
+
+    static std::string getenv_str(const char* name) {
+        const char* v = std::getenv(name);
+        return v ? std::string(v) : std::string{};
+    }
+
+    static int getenv_int(const char* name, int def) {
+        auto s = getenv_str(name);
+        if (s.empty()) return def;
+        try { return std::max(1, std::stoi(s)); }
+        catch (...) { return def; }
+    }
+
+    static bool read_file(const std::string& path, std::vector<std::uint8_t>& out) {
+        std::ifstream f(path, std::ios::binary);
+        if (!f) return false;
+        f.seekg(0, std::ios::end);
+        std::streamoff n = f.tellg();
+        if (n <= 0) return false;
+        f.seekg(0, std::ios::beg);
+        out.resize((std::size_t)n);
+        f.read((char*)out.data(), n);
+        return f.good();
+    }
+
+    static double ms_since(clock::time_point t0) {
+        return std::chrono::duration<double, std::milli>(clock::now() - t0).count();
+    }
+
+    // RGBA u8 source image.
+    struct Image {
+        std::string name;
+        std::uint32_t w = 0, h = 0;
+        std::vector<std::uint8_t> rgba;
+    };
+
+    static bool load_cat(Image& out) {
+        const char* candidates[] = { "img/cat.png", "../img/cat.png", "../../img/cat.png" };
+        std::vector<std::uint8_t> file;
+        for (const char* path : candidates) {
+            if (!read_file(path, file)) continue;
+            stbi::Decoder dec;
+            if (!dec.ReadBytes(file.data(), file.size())) return false;
+            stbi::DecodeOptions opt{};
+            opt.desired_channels = 4;
+            opt.sample_type = stbi::SampleType::U8;
+            stbi::ImagePlan plan{};
+            if (!dec.Plan(opt, plan)) return false;
+            std::vector<std::uint8_t> scratch(plan.scratch_bytes ? plan.scratch_bytes : 1u);
+            out.rgba.resize(plan.pixel_bytes);
+            if (!dec.Decode(plan, scratch.data(), scratch.size(), out.rgba.data(), out.rgba.size())) return false;
+            out.name = "cat";
+            out.w = plan.width;
+            out.h = plan.height;
+            return true;
+        }
+        return false;
+    }
+
+    static Image synthetic(const char* name, std::uint32_t side) {
+        Image im;
+        im.name = name;
+        im.w = im.h = side;
+        im.rgba.resize((std::size_t)side * side * 4);
+        std::uint32_t rng = 0x12345678u;
+        for (std::uint32_t y = 0; y < side; ++y) {
+            for (std::uint32_t x = 0; x < side; ++x) {
+                std::uint8_t* p = &im.rgba[((std::size_t)y * side + x) * 4];
+                for (std::uint32_t c = 0; c < 4; ++c) {
+                    std::uint32_t v;
+                    if (name[0] == 'n') { rng = rng * 1664525u + 1013904223u; v = rng >> 24; }
+                    else if (name[0] == 'g') v = (x * 255u / side + y * 128u / side + c * 40u) & 0xFF;
+                    else v = (((x >> 3) ^ (y >> 3)) & 1u) ? 255u - c * 30u : c * 30u;
+                    p[c] = (std::uint8_t)v;
+                }
+            }
+        }
+        return im;
+    }
+
+    // First `ch` channels of `im` as `type` samples.
+    static std::vector<std::uint8_t> convert(const Image& im, std::uint32_t ch, stbir::Sample type) {
+        const std::size_t n = (std::size_t)im.w * im.h;
+        std::vector<std::uint8_t> out(n * ch * stbir::sample_bytes(type));
+        for (std::size_t i = 0; i < n; ++i) {
+            for (std::uint32_t c = 0; c < ch; ++c) {
+                const std::uint8_t v = im.rgba[i * 4 + c];
+                const std::size_t k = i * ch + c;
+                switch (type) {
+                case stbir::Sample::U8:  out[k] = v; break;
+                case stbir::Sample::U16: { const std::uint16_t s = (std::uint16_t)(v * 257u); std::memcpy(&out[k * 2], &s, 2); } break;
+                case stbir::Sample::F32: { const float s = v / 255.f; std::memcpy(&out[k * 4], &s, 4); } break;
+                case stbir::Sample::F16: { const std::uint16_t s = stbir::half_from_float(v / 255.f); std::memcpy(&out[k * 2], &s, 2); } break;
+                }
+            }
+        }
+        return out;
+    }
+
+    static const char* filter_name(stbir::Filter f) {
+        static const char* names[] = { "Box", "Triangle", "Cubic", "Mitchell", "CatmullRom", "Lanczos3", "Kaiser" };
+        return names[(int)f];
+    }
+
+    static const char* type_name(stbir::Sample s) {
+        static const char* names[] = { "u8", "u16", "f32", "f16" };
+        return names[(int)s];
+    }
+
+#ifndef STBIR_BENCH_NO_REFERENCE
+    // Sample k of a buffer as double, in steps for integer types.
+    static double sample_at(const std::vector<std::uint8_t>& b, std::size_t k, stbir::Sample type) {
+        switch (type) {
+        case stbir::Sample::U8:  return b[k];
+        case stbir::Sample::U16: { std::uint16_t s; std::memcpy(&s, &b[k * 2], 2); return s; }
+        case stbir::Sample::F32: { float s; std::memcpy(&s, &b[k * 4], 4); return s; }
+        default:                 { std::uint16_t s; std::memcpy(&s, &b[k * 2], 2); return stbir::float_from_half(s); }
+        }
+    }
+
+    // stbir_ref_resize filter code, 0 when upstream has no such kernel.
+    static int ref_filter(stbir::Filter f) {
+        switch (f) {
+        case stbir::Filter::Box:        return 1;
+        case stbir::Filter::Triangle:   return 2;
+        case stbir::Filter::Cubic:      return 3;
+        case stbir::Filter::CatmullRom: return 4;
+        case stbir::Filter::Mitchell:   return 5;
+        default:                        return 0;
+        }
+    }
+#endif
+
+    // best-of-iters timings, in milliseconds
+    struct CaseResult {
+        bool ok = true;
+        std::uint32_t out_w = 0, out_h = 0;
+        std::size_t plan_bytes = 0;
+        std::size_t scratch_bytes = 0;
+        std::size_t split_scratch_bytes = 0;
+        bool fixed = false;
+        double plan_ms = 0.0;
+        double resize_ms = 0.0;
+        double split_ms = 0.0;
+        std::size_t allocs = 0;       // per Resize
+        std::size_t split_allocs = 0; // per ResizeSplit (thread start-up)
+
+        bool ref = false;
+        double ref_ms = 0.0;
+        double ref_allocs = 0.0;      // per call
+        double ref_alloc_bytes = 0.0; // per call
+        double max_dev = 0.0;         // steps for u8/u16, absolute for floats
+        double mean_dev = 0.0;
+    };
+
+    static CaseResult bench_case(const Image& im, const std::vector<std::uint8_t>& src,
+                                 stbir::Filter filter, double ratio, std::uint32_t ch,
+                                 stbir::Sample type, int iters, std::uint32_t threads) {
+        CaseResult r{};
+        const std::size_t bps = stbir::sample_bytes(type);
+        stbir::ResizeInput in;
+        in.in_w = im.w; in.in_h = im.h;
+        in.out_w = std::max<std::uint32_t>(1, (std::uint32_t)std::lround(im.w * ratio));
+        in.out_h = std::max<std::uint32_t>(1, (std::uint32_t)std::lround(im.h * ratio));
+        in.channels = ch;
+        in.in_type = in.out_type = type;
+        in.filter_x = in.filter_y = filter;
+        r.out_w = in.out_w; r.out_h = in.out_h;
+        const std::ptrdiff_t in_stride = (std::ptrdiff_t)(im.w * ch * bps);
+        const std::ptrdiff_t out_stride = (std::ptrdiff_t)(in.out_w * ch * bps);
+
+        r.plan_bytes = stbir::PlanBytes(in);
+        std::vector<std::uint8_t> plan_mem(r.plan_bytes);
+        stbir::ResizePlan plan;
+        for (int it = 0; it < iters; ++it) {
+            auto t0 = clock::now();
+            const bool ok = stbir::Plan(in, plan_mem.data(), plan_mem.size(), plan);
+            const double ms = ms_since(t0);
+            if (!ok) { r.ok = false; return r; }
+            if (it == 0 || ms < r.plan_ms) r.plan_ms = ms;
+        }
+        r.fixed = plan.fixed.on;
+        r.scratch_bytes = stbir::ScratchBytes(plan);
+        std::vector<std::uint8_t> scratch(r.scratch_bytes);
+        std::vector<std::uint8_t> out((std::size_t)in.out_h * out_stride);
+
+        std::size_t news = g_news;
+        for (int it = 0; it < iters; ++it) {
+            auto t0 = clock::now();
+            if (!stbir::Resize(plan, src.data(), in_stride, out.data(), out_stride, scratch.data(), scratch.size()))
+                r.ok = false;
+            const double ms = ms_since(t0);
+            if (it == 0 || ms < r.resize_ms) r.resize_ms = ms;
+        }
+        r.allocs = (g_news - news) / (std::size_t)iters;
+
+        r.split_scratch_bytes = stbir::SplitScratchBytes(plan, threads);
+        std::vector<std::uint8_t> split_scratch(r.split_scratch_bytes);
+        std::vector<std::uint8_t> split_out(out.size());
+        news = g_news;
+        for (int it = 0; it < iters; ++it) {
+            auto t0 = clock::now();
+            if (!stbir::ResizeSplit(plan, threads, src.data(), in_stride, split_out.data(), out_stride,
+                                    split_scratch.data(), split_scratch.size(), stbir::StdThreads()))
+                r.ok = false;
+            const double ms = ms_since(t0);
+            if (it == 0 || ms < r.split_ms) r.split_ms = ms;
+        }
+        r.split_allocs = (g_news - news) / (std::size_t)iters;
+        if (split_out != out) r.ok = false;
+
+#ifndef STBIR_BENCH_NO_REFERENCE
+        const int rf = ref_filter(filter);
+        if (rf) {
+            std::vector<std::uint8_t> ref(out.size());
+            const std::size_t allocs0 = stbir_ref_alloc_count(), bytes0 = stbir_ref_alloc_bytes();
+            for (int it = 0; it < iters; ++it) {
+                auto t0 = clock::now();
+                if (!stbir_ref_resize(src.data(), (int)im.w, (int)im.h, (int)in_stride,
+                                      ref.data(), (int)in.out_w, (int)in.out_h, (int)out_stride,
+                                      (int)ch, (int)type, rf, 0))
+                    r.ok = false;
+                const double ms = ms_since(t0);
+                if (it == 0 || ms < r.ref_ms) r.ref_ms = ms;
+            }
+            r.ref = true;
+            r.ref_allocs = (double)(stbir_ref_alloc_count() - allocs0) / iters;
+            r.ref_alloc_bytes = (double)(stbir_ref_alloc_bytes() - bytes0) / iters;
+
+            const std::size_t n = (std::size_t)in.out_w * in.out_h * ch;
+            double sum = 0.0;
+            for (std::size_t k = 0; k < n; ++k) {
+                const double d = std::fabs(sample_at(out, k, type) - sample_at(ref, k, type));
+                r.max_dev = std::max(r.max_dev, d);
+                sum += d;
+            }
+            r.mean_dev = n ? sum / (double)n : 0.0;
+        }
+#endif
+        return r;
+    }
+
+    static double mps(std::uint32_t w, std::uint32_t h, double ms) {
+        return ms > 0.0 ? (double)w * h / (ms * 1000.0) : 0.0;
+    }
+
+} // namespace stbir_bench
+
+int main() {
+    using namespace stbir_bench;
+    set_high_perf_timer();
+
+    const int iters = getenv_int("STBIR_BENCH_ITERS", 3);
+    const std::uint32_t side = (std::uint32_t)getenv_int("STBIR_BENCH_SIZE", 512);
+    const std::uint32_t hw = std::max(1u, std::thread::hardware_concurrency());
+    const std::uint32_t threads = (std::uint32_t)getenv_int("STBIR_BENCH_THREADS", (int)hw);
+
+    std::vector<Image> corpus;
+    Image cat;
+    if (load_cat(cat)) corpus.push_back(std::move(cat));
+    corpus.push_back(synthetic("noise", side));
+    corpus.push_back(synthetic("gradient", side));
+    corpus.push_back(synthetic("checker", side));
+
+    const stbir::Filter filters[] = {
+        stbir::Filter::Box, stbir::Filter::Triangle, stbir::Filter::Cubic, stbir::Filter::Mitchell,
+        stbir::Filter::CatmullRom, stbir::Filter::Lanczos3, stbir::Filter::Kaiser
+    };
+    const double ratios[] = { 0.25, 0.5, 0.75, 1.5 };
+    const stbir::Sample types[] = { stbir::Sample::U8, stbir::Sample::U16, stbir::Sample::F32, stbir::Sample::F16 };
+
+    std::cout.setf(std::ios::fixed);
+    std::cout.precision(4);
+    std::cout << "{\n"
+              << "  \"iters\": " << iters << ",\n"
+              << "  \"threads\": " << threads << ",\n"
+#ifndef STBIR_BENCH_NO_REFERENCE
+              << "  \"reference\": true,\n"
+#else
+              << "  \"reference\": false,\n"
+#endif
+              << "  \"cases\": [";
+
+    bool first = true;
+    for (const Image& im : corpus) {
+        for (std::uint32_t ch = 1; ch <= 4; ++ch) {
+            for (stbir::Sample type : types) {
+                const std::vector<std::uint8_t> src = convert(im, ch, type);
+                for (stbir::Filter filter : filters) {
+                    for (double ratio : ratios) {
+                        const CaseResult r = bench_case(im, src, filter, ratio, ch, type, iters, threads);
+
+                        std::cout << (first ? "\n" : ",\n");
+                        first = false;
+                        std::cout << "    { \"image\": \"" << im.name << "\""
+                                  << ", \"filter\": \"" << filter_name(filter) << "\""
+                                  << ", \"ratio\": " << ratio
+                                  << ", \"channels\": " << ch
+                                  << ", \"type\": \"" << type_name(type) << "\""
+                                  << ", \"ok\": " << (r.ok ? "true" : "false")
+                                  << ", \"in\": [" << im.w << ", " << im.h << "]"
+                                  << ", \"out\": [" << r.out_w << ", " << r.out_h << "]"
+                                  << ", \"fixed_point\": " << (r.fixed ? "true" : "false")
+                                  << ", \"plan_ms\": " << r.plan_ms
+                                  << ", \"resize_ms\": " << r.resize_ms
+                                  << ", \"out_mps\": " << mps(r.out_w, r.out_h, r.resize_ms)
+                                  << ", \"split_ms\": " << r.split_ms
+                                  << ", \"split_out_mps\": " << mps(r.out_w, r.out_h, r.split_ms)
+                                  << ", \"plan_bytes\": " << r.plan_bytes
+                                  << ", \"scratch_bytes\": " << r.scratch_bytes
+                                  << ", \"split_scratch_bytes\": " << r.split_scratch_bytes
+                                  << ", \"allocs\": " << r.allocs
+                                  << ", \"split_allocs\": " << r.split_allocs;
+                        if (r.ref) {
+                            std::cout << ", \"ref_ms\": " << r.ref_ms
+                                      << ", \"ref_out_mps\": " << mps(r.out_w, r.out_h, r.ref_ms)
+                                      << ", \"speedup_vs_ref\": " << (r.resize_ms > 0.0 ? r.ref_ms / r.resize_ms : 0.0)
+                                      << ", \"ref_allocs\": " << r.ref_allocs
+                                      << ", \"ref_alloc_bytes\": " << r.ref_alloc_bytes
+                                      << ", \"max_dev_vs_ref\": " << r.max_dev
+                                      << ", \"mean_dev_vs_ref\": " << r.mean_dev;
+                        }
+                        std::cout << " }";
+                    }
+                }
+            }
+        }
+    }
+    std::cout << "\n  ]\n}\n";
+    return 0;
+}
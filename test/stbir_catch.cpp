@@ -0,0 +1,870 @@
+// BUILD: Debug, Release. STD used, no freestanding.
+//
+// Compile as a single TU. Requires Catch2 single-header.
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+// ---------------- Catch2 single header include ----------------
+#if __has_include(<catch2/catch_all.hpp>)
+#  define CATCH_CONFIG_MAIN
+#  include <catch2/catch_all.hpp>
+#elif __has_include(<catch.hpp>)
+#  define CATCH_CONFIG_MAIN
+#  include <catch.hpp>
+#elif __has_include("catch.hpp")
+#  define CATCH_CONFIG_MAIN
+#  include "catch.hpp"
+#else
+#  error "Catch2 single-header not found. Provide <catch2/catch_all.hpp> or catch.hpp."
+#endif
+
+#define STBIR_STD_THREADS
+#include "../stb_image_resize2/stb_image_resize2.hpp"
+
+namespace stbir_test {
+
+    // Plans `in` and runs one Resize with exactly ScratchBytes() of scratch.
+    static bool resize(const stbir::ResizeInput& in,
+                       const void* src, std::ptrdiff_t src_stride,
+                       void* dst, std::ptrdiff_t dst_stride) {
+        const std::size_t pb = stbir::PlanBytes(in);
+        if (!pb) return false;
+        std::vector<std::uint8_t> plan_mem(pb);
+        stbir::ResizePlan plan;
+        if (!stbir::Plan(in, plan_mem.data(), plan_mem.size(), plan)) return false;
+        std::vector<std::uint8_t> scratch(stbir::ScratchBytes(plan));
+        return stbir::Resize(plan, src, src_stride, dst, dst_stride, scratch.data(), scratch.size());
+    }
+
+    static std::vector<std::uint8_t> pattern_u8(std::uint32_t w, std::uint32_t h, std::uint32_t ch) {
+        std::vector<std::uint8_t> v((std::size_t)w * h * ch);
+        for (std::size_t i = 0; i < v.size(); ++i) v[i] = (std::uint8_t)(i * 131u + 7u);
+        return v;
+    }
+
+} // namespace stbir_test
+
+using namespace stbir_test;
+
+TEST_CASE("Plan - contributor rows sum to one and repeat per phase", "[stbir][plan]") {
+    const stbir::Filter filters[] = { stbir::Filter::Box, stbir::Filter::Triangle, stbir::Filter::Cubic,
+                                      stbir::Filter::Mitchell, stbir::Filter::CatmullRom, stbir::Filter::Lanczos3,
+                                      stbir::Filter::Kaiser };
+    const std::uint32_t sizes[][2] = { {640, 480}, {480, 640}, {7, 3}, {3, 7}, {100, 100} };
+    for (stbir::Filter f : filters) {
+        for (const auto& s : sizes) {
+            stbir::ResizeInput in;
+            in.in_w = s[0]; in.out_w = s[1];
+            in.in_h = 1; in.out_h = 1;
+            in.filter_x = in.filter_y = f;
+            std::vector<std::uint8_t> mem(stbir::PlanBytes(in));
+            stbir::ResizePlan plan;
+            REQUIRE(stbir::Plan(in, mem.data(), mem.size(), plan));
+
+            const stbir::AxisPlan& ax = plan.x;
+            std::uint32_t g = s[0], r = s[1];
+            while (r) { const std::uint32_t t = g % r; g = r; r = t; }
+            REQUIRE(ax.phases == s[1] / g);
+            for (std::uint32_t o = 0; o < ax.out_size; ++o) {
+                const float* w = ax.Weights(o);
+                float sum = 0.f;
+                for (std::uint32_t k = 0; k < ax.taps; ++k) sum += w[k];
+                REQUIRE(std::fabs(sum - 1.f) < 1e-5f);
+                REQUIRE(ax.First(o) >= -(std::int32_t)ax.pad_lo);
+                REQUIRE(ax.First(o) + (std::int32_t)ax.taps <= (std::int32_t)(ax.in_size + ax.pad_hi));
+            }
+        }
+    }
+
+    // 2:1 box reads exactly the two covered samples
+    stbir::ResizeInput in;
+    in.in_w = 64; in.out_w = 32; in.in_h = in.out_h = 1;
+    in.filter_x = stbir::Filter::Box;
+    std::vector<std::uint8_t> mem(stbir::PlanBytes(in));
+    stbir::ResizePlan plan;
+    REQUIRE(stbir::Plan(in, mem.data(), mem.size(), plan));
+    REQUIRE(plan.x.taps == 2);
+    REQUIRE(plan.x.phases == 1);
+    REQUIRE(plan.x.First(5) == 10);
+    REQUIRE(plan.x.Weights(5)[0] == 0.5f);
+
+    REQUIRE(stbir::Plan(in, mem.data(), mem.size() - 1, plan) == false);
+    in.channels = 5;
+    REQUIRE(stbir::PlanBytes(in) == 0);
+}
+
+TEST_CASE("Resize - identity for interpolating filters", "[stbir][resize]") {
+    const stbir::Filter filters[] = { stbir::Filter::Box, stbir::Filter::Triangle,
+                                      stbir::Filter::CatmullRom, stbir::Filter::Lanczos3, stbir::Filter::Kaiser };
+    const std::uint32_t w = 37, h = 23, ch = 3;
+    const std::vector<std::uint8_t> src = pattern_u8(w, h, ch);
+    for (stbir::Filter f : filters) {
+        stbir::ResizeInput in;
+        in.in_w = in.out_w = w;
+        in.in_h = in.out_h = h;
+        in.channels = ch;
+        in.filter_x = in.filter_y = f;
+        std::vector<std::uint8_t> dst(src.size());
+        REQUIRE(resize(in, src.data(), w * ch, dst.data(), w * ch));
+        REQUIRE(dst == src);
+    }
+}
+
+TEST_CASE("Resize - box 2:1 is the 2x2 mean", "[stbir][resize]") {
+    const std::uint32_t w = 16, h = 10;
+    std::vector<float> src(w * h);
+    for (std::size_t i = 0; i < src.size(); ++i) src[i] = (float)((i * 37u) % 101u);
+
+    stbir::ResizeInput in;
+    in.in_w = w; in.in_h = h;
+    in.out_w = w / 2; in.out_h = h / 2;
+    in.channels = 1;
+    in.in_type = in.out_type = stbir::Sample::F32;
+    in.filter_x = in.filter_y = stbir::Filter::Box;
+    std::vector<float> dst(in.out_w * in.out_h);
+    REQUIRE(resize(in, src.data(), w * 4, dst.data(), in.out_w * 4));
+
+    for (std::uint32_t y = 0; y < in.out_h; ++y) {
+        for (std::uint32_t x = 0; x < in.out_w; ++x) {
+            const float* s = &src[(2 * y) * w + 2 * x];
+            const float mean = (s[0] + s[1] + s[w] + s[w + 1]) * 0.25f;
+            REQUIRE(std::fabs(dst[y * in.out_w + x] - mean) < 1e-4f);
+        }
+    }
+}
+
+TEST_CASE("Resize - flat images stay flat for every filter, edge and sample type", "[stbir][resize]") {
+    const std::uint32_t sizes[][4] = { {17, 13, 5, 4}, {17, 13, 40, 33}, {100, 3, 7, 9}, {1, 1, 5, 5}, {640, 480, 333, 201} };
+    for (const auto& s : sizes) {
+        for (int f = 0; f <= (int)stbir::Filter::Kaiser; ++f) {
+            for (int e = 0; e <= (int)stbir::Edge::Wrap; ++e) { // Zero darkens the border by design
+                for (int t = 0; t <= (int)stbir::Sample::F16; ++t) {
+                    stbir::ResizeInput in;
+                    in.in_w = s[0]; in.in_h = s[1];
+                    in.out_w = s[2]; in.out_h = s[3];
+                    in.channels = 1u + (std::uint32_t)(f % 4);
+                    in.filter_x = in.filter_y = (stbir::Filter)f;
+                    in.edge_x = in.edge_y = (stbir::Edge)e;
+                    in.in_type = in.out_type = (stbir::Sample)t;
+
+                    const std::size_t bps = stbir::sample_bytes(in.in_type);
+                    const std::size_t n_in = (std::size_t)s[0] * s[1] * in.channels;
+                    const std::size_t n_out = (std::size_t)s[2] * s[3] * in.channels;
+                    std::vector<std::uint8_t> src(n_in * bps), dst(n_out * bps);
+                    for (std::size_t i = 0; i < n_in; ++i) {
+                        switch (in.in_type) {
+                        case stbir::Sample::U8:  src[i] = 200; break;
+                        case stbir::Sample::U16: ((std::uint16_t*)src.data())[i] = 50000; break;
+                        case stbir::Sample::F32: ((float*)src.data())[i] = 0.75f; break;
+                        case stbir::Sample::F16: ((std::uint16_t*)src.data())[i] = stbir::half_from_float(0.75f); break;
+                        }
+                    }
+                    REQUIRE(resize(in, src.data(), (std::ptrdiff_t)(s[0] * in.channels * bps),
+                                   dst.data(), (std::ptrdiff_t)(s[2] * in.channels * bps)));
+                    std::size_t bad = 0;
+                    for (std::size_t i = 0; i < n_out; ++i) {
+                        switch (in.out_type) {
+                        case stbir::Sample::U8:  bad += dst[i] != 200; break;
+                        case stbir::Sample::U16: bad += std::abs(((std::uint16_t*)dst.data())[i] - 50000) > 1; break;
+                        case stbir::Sample::F32: bad += std::fabs(((float*)dst.data())[i] - 0.75f) >= 1e-5f; break;
+                        case stbir::Sample::F16: bad += stbir::float_from_half(((std::uint16_t*)dst.data())[i]) != 0.75f; break;
+                        }
+                    }
+                    REQUIRE(bad == 0);
+                }
+            }
+        }
+    }
+}
+
+TEST_CASE("Resize - strides: padded rows, bottom-up rows and mixed sample types", "[stbir][resize][stride]") {
+    const std::uint32_t w = 19, h = 11, ch = 2;
+    const std::vector<std::uint8_t> tight = pattern_u8(w, h, ch);
+
+    stbir::ResizeInput in;
+    in.in_w = w; in.in_h = h;
+    in.out_w = 31; in.out_h = 7;
+    in.channels = ch;
+    in.filter_x = stbir::Filter::Mitchell;
+    in.filter_y = stbir::Filter::Lanczos3;
+    in.edge_x = stbir::Edge::Reflect;
+    in.edge_y = stbir::Edge::Wrap;
+
+    std::vector<std::uint8_t> ref(in.out_w * in.out_h * ch);
+    REQUIRE(resize(in, tight.data(), w * ch, ref.data(), in.out_w * ch));
+
+    // the same pixels behind a 9-byte row pad, read and written bottom-up
+    const std::ptrdiff_t in_pitch = w * ch + 9, out_pitch = in.out_w * ch + 5;
+    std::vector<std::uint8_t> padded(in_pitch * h, 0xCD), flipped(out_pitch * in.out_h, 0xEE);
+    for (std::uint32_t y = 0; y < h; ++y)
+        std::memcpy(&padded[(h - 1 - y) * in_pitch], &tight[y * w * ch], w * ch);
+    REQUIRE(resize(in, &padded[(h - 1) * in_pitch], -in_pitch,
+                   &flipped[(in.out_h - 1) * out_pitch], -out_pitch));
+    for (std::uint32_t y = 0; y < in.out_h; ++y) {
+        const std::uint8_t* row = &flipped[(in.out_h - 1 - y) * out_pitch];
+        REQUIRE(std::memcmp(row, &ref[y * in.out_w * ch], in.out_w * ch) == 0);
+        REQUIRE(row[in.out_w * ch] == 0xEE); // row pad untouched
+    }
+
+    // u8 in, f32 out keeps the unrounded result within half a step of u8 out
+    in.out_type = stbir::Sample::F32;
+    std::vector<float> f(ref.size());
+    REQUIRE(resize(in, tight.data(), w * ch, f.data(), in.out_w * ch * 4));
+    for (std::size_t i = 0; i < ref.size(); ++i) {
+        const float clamped = std::min(std::max(f[i], 0.f), 1.f);
+        REQUIRE(std::fabs(clamped * 255.f - (float)ref[i]) <= 0.5f + 1e-3f);
+    }
+}
+
+TEST_CASE("Resize - scratch is exact and undersized buffers are rejected", "[stbir][resize]") {
+    stbir::ResizeInput in;
+    in.in_w = 300; in.in_h = 200;
+    in.out_w = 97; in.out_h = 61;
+    in.channels = 4;
+    std::vector<std::uint8_t> plan_mem(stbir::PlanBytes(in));
+    stbir::ResizePlan plan;
+    REQUIRE(stbir::Plan(in, plan_mem.data(), plan_mem.size(), plan));
+
+    const std::vector<std::uint8_t> src = pattern_u8(in.in_w, in.in_h, 4);
+    std::vector<std::uint8_t> a(in.out_w * in.out_h * 4), b(a.size());
+    // scratch is used from a guarded block; nothing past ScratchBytes() is touched
+    const std::size_t sb = stbir::ScratchBytes(plan);
+    std::vector<std::uint8_t> scratch(sb + 64, 0x5A);
+    REQUIRE(stbir::Resize(plan, src.data(), in.in_w * 4, a.data(), in.out_w * 4, scratch.data(), sb));
+    for (std::size_t i = sb; i < scratch.size(); ++i) REQUIRE(scratch[i] == 0x5A);
+    // scratch contents do not leak into the next run
+    REQUIRE(stbir::Resize(plan, src.data(), in.in_w * 4, b.data(), in.out_w * 4, scratch.data(), sb));
+    REQUIRE(a == b);
+
+    REQUIRE(stbir::Resize(plan, src.data(), in.in_w * 4, b.data(), in.out_w * 4, scratch.data(), sb - 1) == false);
+}
+
+TEST_CASE("Resize - SIMD kernels match Scalar within one step", "[stbir][resize][simd]") {
+    // Summation order differs between kernels (expanded weights, lane sums),
+    // so results may differ by float rounding: <= 1e-5 for f32, <= 1 for u8.
+    const stbir::Isa isas[] = { stbir::Isa::SSE2, stbir::Isa::AVX2, stbir::Isa::NEON, stbir::Isa::Auto };
+    const std::uint32_t sizes[][4] = { {64, 48, 32, 24}, {33, 17, 99, 51}, {300, 200, 97, 61}, {5, 400, 7, 9}, {128, 1, 48, 1} };
+    for (const auto& s : sizes) {
+        for (std::uint32_t ch = 1; ch <= 4; ++ch) {
+            for (int f = 0; f <= (int)stbir::Filter::Kaiser; ++f) {
+                for (int t = 0; t < 2; ++t) {
+                    stbir::ResizeInput in;
+                    in.in_w = s[0]; in.in_h = s[1];
+                    in.out_w = s[2]; in.out_h = s[3];
+                    in.channels = ch;
+                    in.filter_x = in.filter_y = (stbir::Filter)f;
+                    in.edge_x = (stbir::Edge)(f % 4);
+                    in.in_type = in.out_type = t ? stbir::Sample::F32 : stbir::Sample::U8;
+                    const std::size_t bps = stbir::sample_bytes(in.in_type);
+                    const std::size_t n_out = (std::size_t)s[2] * s[3] * ch;
+
+                    std::vector<std::uint8_t> src = pattern_u8(s[0], s[1], ch * (std::uint32_t)bps);
+                    if (t) {
+                        float* fs = (float*)src.data();
+                        for (std::size_t i = 0; i < src.size() / 4; ++i) fs[i] = (float)((i * 7919u) % 1000u) / 999.f;
+                    }
+                    in.isa = stbir::Isa::Scalar;
+                    std::vector<std::uint8_t> ref(n_out * bps);
+                    REQUIRE(resize(in, src.data(), s[0] * ch * bps, ref.data(), s[2] * ch * bps));
+
+                    for (stbir::Isa isa : isas) {
+                        in.isa = isa;
+                        std::vector<std::uint8_t> got(ref.size());
+                        REQUIRE(resize(in, src.data(), s[0] * ch * bps, got.data(), s[2] * ch * bps));
+                        double worst = 0.0;
+                        for (std::size_t i = 0; i < n_out; ++i) {
+                            const double d = t ? std::fabs(((float*)got.data())[i] - ((float*)ref.data())[i])
+                                               : std::abs((int)got[i] - (int)ref[i]);
+                            worst = std::max(worst, d);
+                        }
+                        REQUIRE(worst <= (t ? 1e-5 : 1.0));
+                    }
+                }
+            }
+        }
+    }
+}
+
+TEST_CASE("Resize - u8 Box and Triangle N:1 downscales run in fixed point", "[stbir][resize][fixed]") {
+    const stbir::Filter filters[] = { stbir::Filter::Box, stbir::Filter::Triangle };
+    const stbir::Isa isas[] = { stbir::Isa::Scalar, stbir::Isa::Auto };
+    const std::uint32_t ow = 37, oh = 7;
+    for (stbir::Filter f : filters) {
+        for (std::uint32_t nx = 1; nx <= 4; ++nx) {
+            for (std::uint32_t ny = 1; ny <= 4; ++ny) {
+                for (std::uint32_t ch = 1; ch <= 4; ++ch) {
+                    stbir::ResizeInput in;
+                    in.in_w = ow * nx; in.in_h = oh * ny;
+                    in.out_w = ow; in.out_h = oh;
+                    in.channels = ch;
+                    in.filter_x = in.filter_y = f;
+                    in.edge_x = (stbir::Edge)((nx + ch) % 4);
+                    in.edge_y = (stbir::Edge)((ny + ch) % 4);
+                    const std::vector<std::uint8_t> src = pattern_u8(in.in_w, in.in_h, ch);
+                    const std::size_t n = (std::size_t)ow * oh * ch;
+
+                    // float path reference: F32 output is never fixed point
+                    in.out_type = stbir::Sample::F32;
+                    std::vector<float> ref(n);
+                    REQUIRE(resize(in, src.data(), in.in_w * ch, ref.data(), ow * ch * 4));
+                    in.out_type = stbir::Sample::U8;
+
+                    for (stbir::Isa isa : isas) {
+                        in.isa = isa;
+                        std::vector<std::uint8_t> plan_mem(stbir::PlanBytes(in));
+                        stbir::ResizePlan plan;
+                        REQUIRE(stbir::Plan(in, plan_mem.data(), plan_mem.size(), plan));
+                        REQUIRE(plan.fixed.on);
+                        std::vector<std::uint8_t> got(n);
+                        REQUIRE(resize(in, src.data(), in.in_w * ch, got.data(), ow * ch));
+                        int worst = 0;
+                        for (std::size_t i = 0; i < n; ++i)
+                            worst = std::max(worst, std::abs((int)got[i] - (int)(ref[i] * 255.f + 0.5f)));
+                        REQUIRE(worst <= 1); // ties may round either way in float
+                        if (f == stbir::Filter::Box && nx == 2 && ny == 2) {
+                            for (std::uint32_t y = 0; y < oh; ++y)
+                                for (std::uint32_t x = 0; x < ow * ch; ++x) {
+                                    const std::uint8_t* s = &src[(2 * y) * in.in_w * ch + (x / ch) * 2 * ch + x % ch];
+                                    const int sum = s[0] + s[ch] + s[in.in_w * ch] + s[in.in_w * ch + ch];
+                                    REQUIRE((int)got[y * ow * ch + x] == (sum + 2) / 4);
+                                }
+                        }
+                    }
+                }
+            }
+        }
+    }
+
+    // anything with a float stage or fractional weights stays on the float path
+    stbir::ResizeInput in;
+    in.in_w = 64; in.in_h = 64; in.out_w = 32; in.out_h = 32;
+    in.filter_x = in.filter_y = stbir::Filter::Box;
+    auto fixed = [](const stbir::ResizeInput& r) {
+        std::vector<std::uint8_t> plan_mem(stbir::PlanBytes(r));
+        stbir::ResizePlan plan;
+        return stbir::Plan(r, plan_mem.data(), plan_mem.size(), plan) && plan.fixed.on;
+    };
+    REQUIRE(fixed(in));
+    stbir::ResizeInput t = in; t.color = stbir::Color::SRGB;         REQUIRE_FALSE(fixed(t));
+    t = in; t.alpha = stbir::Alpha::Straight;                         REQUIRE_FALSE(fixed(t));
+    t = in; t.in_type = stbir::Sample::U16;                           REQUIRE_FALSE(fixed(t));
+    t = in; t.filter_y = stbir::Filter::CatmullRom;                   REQUIRE_FALSE(fixed(t));
+    t = in; t.out_w = 48;                                             REQUIRE_FALSE(fixed(t));
+    t = in; t.in_w = 160;                                             REQUIRE_FALSE(fixed(t)); // 5:1
+    t = in; t.alpha = stbir::Alpha::Premultiplied;                    REQUIRE(fixed(t));
+}
+
+TEST_CASE("ResizeSplit - row bands give the same pixels for any split count", "[stbir][resize][split]") {
+    stbir::ResizeInput in;
+    in.in_w = 211; in.in_h = 157;
+    in.out_w = 90; in.out_h = 301;
+    in.channels = 3;
+    in.filter_x = stbir::Filter::Lanczos3;
+    in.filter_y = stbir::Filter::Mitchell;
+    in.edge_y = stbir::Edge::Reflect;
+    std::vector<std::uint8_t> plan_mem(stbir::PlanBytes(in));
+    stbir::ResizePlan plan;
+    REQUIRE(stbir::Plan(in, plan_mem.data(), plan_mem.size(), plan));
+
+    const std::vector<std::uint8_t> src = pattern_u8(in.in_w, in.in_h, 3);
+    std::vector<std::uint8_t> ref(in.out_w * in.out_h * 3);
+    std::vector<std::uint8_t> scratch(stbir::ScratchBytes(plan));
+    REQUIRE(stbir::Resize(plan, src.data(), in.in_w * 3, ref.data(), in.out_w * 3, scratch.data(), scratch.size()));
+
+    // serial parallel_for, jobs in reverse order
+    auto reverse_for = [](std::uint32_t count, const auto& job) {
+        for (std::uint32_t i = count; i-- > 0;) job(i);
+    };
+    const std::uint32_t counts[] = { 1, 2, 3, 7, 64, 301, 1000 };
+    for (std::uint32_t n : counts) {
+        stbir::RowSplit splits[1000];
+        const std::uint32_t got = stbir::SplitRows(plan, n, splits);
+        REQUIRE(got == std::min(n, in.out_h));
+        REQUIRE(splits[0].out_y0 == 0);
+        REQUIRE(splits[got - 1].out_y1 == in.out_h);
+        for (std::uint32_t i = 0; i < got; ++i) {
+            REQUIRE(splits[i].out_y0 < splits[i].out_y1);
+            if (i) REQUIRE(splits[i].out_y0 == splits[i - 1].out_y1);
+            REQUIRE(splits[i].in_y0 < splits[i].in_y1);
+            REQUIRE(splits[i].in_y1 <= in.in_h);
+        }
+
+        std::vector<std::uint8_t> split_scratch(stbir::SplitScratchBytes(plan, got));
+        std::vector<std::uint8_t> a(ref.size()), b(ref.size());
+        REQUIRE(stbir::ResizeSplit(plan, n, src.data(), in.in_w * 3, a.data(), in.out_w * 3,
+                                   split_scratch.data(), split_scratch.size(), reverse_for));
+        REQUIRE(a == ref);
+        REQUIRE(stbir::ResizeSplit(plan, n, src.data(), in.in_w * 3, b.data(), in.out_w * 3,
+                                   split_scratch.data(), split_scratch.size(), stbir::StdThreads()));
+        REQUIRE(b == ref);
+        REQUIRE(stbir::ResizeSplit(plan, n, src.data(), in.in_w * 3, b.data(), in.out_w * 3,
+                                   split_scratch.data(), split_scratch.size() - 1, reverse_for) == false);
+    }
+
+    // a failed or skipped band fails the whole call
+    std::vector<std::uint8_t> split_scratch(stbir::SplitScratchBytes(plan, 4)), out(ref.size());
+    auto skip_last = [](std::uint32_t count, const auto& job) {
+        for (std::uint32_t i = 0; i + 1 < count; ++i) job(i);
+    };
+    REQUIRE(stbir::ResizeSplit(plan, 4, src.data(), in.in_w * 3, out.data(), in.out_w * 3,
+                               split_scratch.data(), split_scratch.size(), skip_last) == false);
+    stbir::ResizePlan broken = plan;
+    broken.y.weights = nullptr;
+    REQUIRE(stbir::ResizeSplit(broken, 4, src.data(), in.in_w * 3, out.data(), in.out_w * 3,
+                               split_scratch.data(), split_scratch.size(), reverse_for) == false);
+}
+
+TEST_CASE("ResizeSplit - SIMD bands on threads stay within tolerance of Scalar for every sample type", "[stbir][resize][split][simd]") {
+    // u8 / u16 in steps, f32 absolute, f16 in half ulps (ordered bit patterns)
+    auto diff = [](const std::vector<std::uint8_t>& a, const std::vector<std::uint8_t>& b,
+                   std::size_t i, stbir::Sample t) -> double {
+        switch (t) {
+        case stbir::Sample::U8:  return std::abs((int)a[i] - (int)b[i]);
+        case stbir::Sample::U16: return std::abs((int)((const std::uint16_t*)a.data())[i] - (int)((const std::uint16_t*)b.data())[i]);
+        case stbir::Sample::F32: return std::fabs(((const float*)a.data())[i] - ((const float*)b.data())[i]);
+        default: {
+            auto ord = [](std::uint16_t h) { return (h & 0x8000u) ? -(int)(h & 0x7FFFu) : (int)h; };
+            return std::abs(ord(((const std::uint16_t*)a.data())[i]) - ord(((const std::uint16_t*)b.data())[i]));
+        }
+        }
+    };
+    const double tolerance[] = { 1.0, 2.0, 1e-5, 1.0 };
+
+    struct Case { std::uint32_t in_w, in_h, out_w, out_h, ch; stbir::Filter fx, fy; stbir::Color color; stbir::Alpha alpha; };
+    const Case cases[] = {
+        { 211, 157,  90, 301, 3, stbir::Filter::Lanczos3, stbir::Filter::Mitchell,   stbir::Color::Linear, stbir::Alpha::None },
+        { 128,  96,  64,  48, 1, stbir::Filter::Box,      stbir::Filter::Box,        stbir::Color::Linear, stbir::Alpha::None }, // fixed point for u8
+        { 150, 120,  50,  40, 4, stbir::Filter::Triangle, stbir::Filter::Triangle,   stbir::Color::Linear, stbir::Alpha::Premultiplied },
+        {  77,  31, 160,  90, 4, stbir::Filter::Kaiser,   stbir::Filter::CatmullRom, stbir::Color::SRGB,   stbir::Alpha::Straight },
+        {  99,  65,  33,  70, 2, stbir::Filter::Cubic,    stbir::Filter::Lanczos3,   stbir::Color::Linear, stbir::Alpha::Straight },
+    };
+    const std::uint32_t split_counts[] = { 3, 8 };
+    for (const Case& c : cases) {
+        for (int t = 0; t <= (int)stbir::Sample::F16; ++t) {
+            stbir::ResizeInput in;
+            in.in_w = c.in_w; in.in_h = c.in_h;
+            in.out_w = c.out_w; in.out_h = c.out_h;
+            in.channels = c.ch;
+            in.filter_x = c.fx; in.filter_y = c.fy;
+            in.color = c.color; in.alpha = c.alpha;
+            in.in_type = in.out_type = (stbir::Sample)t;
+            const std::size_t bps = stbir::sample_bytes(in.in_type);
+
+            const std::vector<std::uint8_t> base = pattern_u8(c.in_w, c.in_h, c.ch);
+            std::vector<std::uint8_t> src(base.size() * bps);
+            for (std::size_t i = 0; i < base.size(); ++i) {
+                switch (in.in_type) {
+                case stbir::Sample::U8:  src[i] = base[i]; break;
+                case stbir::Sample::U16: ((std::uint16_t*)src.data())[i] = (std::uint16_t)(base[i] * 257u); break;
+                case stbir::Sample::F32: ((float*)src.data())[i] = base[i] / 255.f; break;
+                case stbir::Sample::F16: ((std::uint16_t*)src.data())[i] = stbir::half_from_float(base[i] / 255.f); break;
+                }
+            }
+            const std::ptrdiff_t in_stride = (std::ptrdiff_t)(c.in_w * c.ch * bps);
+            const std::ptrdiff_t out_stride = (std::ptrdiff_t)(c.out_w * c.ch * bps);
+            const std::size_t n = (std::size_t)c.out_w * c.out_h * c.ch;
+
+            in.isa = stbir::Isa::Scalar;
+            std::vector<std::uint8_t> ref(n * bps);
+            REQUIRE(resize(in, src.data(), in_stride, ref.data(), out_stride));
+
+            in.isa = stbir::Isa::Auto;
+            std::vector<std::uint8_t> plan_mem(stbir::PlanBytes(in));
+            stbir::ResizePlan plan;
+            REQUIRE(stbir::Plan(in, plan_mem.data(), plan_mem.size(), plan));
+            for (std::uint32_t splits : split_counts) {
+                std::vector<std::uint8_t> scratch(stbir::SplitScratchBytes(plan, splits));
+                std::vector<std::uint8_t> got(ref.size());
+                REQUIRE(stbir::ResizeSplit(plan, splits, src.data(), in_stride, got.data(), out_stride,
+                                           scratch.data(), scratch.size(), stbir::StdThreads()));
+                double worst = 0.0;
+                for (std::size_t i = 0; i < n; ++i) {
+                    double d = diff(got, ref, i, in.out_type);
+                    // straight float colors are divided by alpha: compare them premultiplied
+                    if (c.alpha == stbir::Alpha::Straight && t == (int)stbir::Sample::F32 && i % c.ch != c.ch - 1)
+                        d *= std::fabs(((const float*)ref.data())[i - i % c.ch + c.ch - 1]);
+                    worst = std::max(worst, d);
+                }
+                REQUIRE(worst <= tolerance[t]);
+            }
+        }
+    }
+}
+
+TEST_CASE("ResizeStream - pushed rows give the same pixels as Resize", "[stbir][resize][stream]") {
+    const stbir::Filter filters[] = { stbir::Filter::Box, stbir::Filter::Triangle,
+                                      stbir::Filter::CatmullRom, stbir::Filter::Lanczos3 };
+    const stbir::Edge edges[] = { stbir::Edge::Clamp, stbir::Edge::Reflect, stbir::Edge::Zero };
+    const std::uint32_t sizes[][4] = { {300, 200, 32, 21}, {17, 13, 64, 48}, {33, 47, 32, 23},
+                                       {7, 3, 3, 7}, {5, 5, 1, 1}, {1, 1, 4, 4},
+                                       {64, 48, 32, 24}, {96, 96, 32, 32}, {128, 64, 32, 16} };
+    for (stbir::Filter f : filters) {
+        for (stbir::Edge e : edges) {
+            for (const auto& s : sizes) {
+                // whole-factor Box / Triangle downscales run the u8 fixed-point
+                // kernels: try every channel count there
+                const bool whole = s[0] % s[2] == 0 && s[1] % s[3] == 0;
+                for (std::uint32_t ch = whole ? 1 : 3; ch <= (whole ? 4u : 3u); ++ch) {
+                    stbir::ResizeInput in;
+                    in.in_w = s[0]; in.in_h = s[1];
+                    in.out_w = s[2]; in.out_h = s[3];
+                    in.channels = ch;
+                    in.filter_x = in.filter_y = f;
+                    in.edge_x = in.edge_y = e;
+                    std::vector<std::uint8_t> plan_mem(stbir::PlanBytes(in));
+                    stbir::ResizePlan plan;
+                    REQUIRE(stbir::Plan(in, plan_mem.data(), plan_mem.size(), plan));
+
+                    const std::uint32_t in_row = in.in_w * ch, out_row = in.out_w * ch;
+                    const std::vector<std::uint8_t> src = pattern_u8(in.in_w, in.in_h, ch);
+                    std::vector<std::uint8_t> ref(out_row * in.out_h), a(ref.size()), b(ref.size());
+                    REQUIRE(resize(in, src.data(), in_row, ref.data(), out_row));
+
+                    std::vector<std::uint8_t> scratch(stbir::StreamBytes(plan));
+                    stbir::ResizeStream stream;
+                    REQUIRE(stream.Begin(plan, a.data(), out_row, scratch.data(), scratch.size()));
+                    for (std::uint32_t y = 0; y < in.in_h; ++y) REQUIRE(stream.PushRow(src.data() + y * in_row));
+                    REQUIRE(stream.Done());
+                    REQUIRE(stream.PushRow(src.data()) == false);
+                    REQUIRE(a == ref);
+
+                    // sink mode: rows arrive in order, each exactly once
+                    struct Sink { std::uint8_t* out; std::uint32_t row, next; bool ordered; };
+                    Sink sink{ b.data(), out_row, 0, true };
+                    auto emit = [](void* user, std::uint32_t y, const void* row) {
+                        Sink& s = *(Sink*)user;
+                        s.ordered = s.ordered && y == s.next++;
+                        std::memcpy(s.out + (std::size_t)y * s.row, row, s.row);
+                    };
+                    REQUIRE(stream.Begin(plan, emit, &sink, scratch.data(), scratch.size()));
+                    for (std::uint32_t y = 0; y < in.in_h; ++y) REQUIRE(stream.PushRow(src.data() + y * in_row));
+                    REQUIRE(sink.ordered);
+                    REQUIRE(sink.next == in.out_h);
+                    REQUIRE(b == ref);
+                }
+            }
+        }
+    }
+}
+
+TEST_CASE("ResizeStream - memory does not grow with the input height", "[stbir][resize][stream]") {
+    stbir::ResizeInput in;
+    in.in_w = 640; in.out_w = 64; in.out_h = 48;
+    in.in_h = 480;
+    std::vector<std::uint8_t> plan_mem(stbir::PlanBytes(in));
+    stbir::ResizePlan plan;
+    REQUIRE(stbir::Plan(in, plan_mem.data(), plan_mem.size(), plan));
+    const std::size_t small = stbir::StreamBytes(plan);
+    REQUIRE(small < (std::size_t)in.in_w * in.in_h);
+
+    in.in_h = 4800;
+    plan_mem.resize(stbir::PlanBytes(in));
+    REQUIRE(stbir::Plan(in, plan_mem.data(), plan_mem.size(), plan));
+    // 10x the rows only widens the vertical kernel, by the ratio
+    REQUIRE(stbir::StreamBytes(plan) < small * 12);
+
+    std::vector<std::uint8_t> scratch(stbir::StreamBytes(plan));
+    std::vector<std::uint8_t> out(64 * 48 * 4);
+    stbir::ResizeStream stream;
+    REQUIRE(stream.Begin(plan, out.data(), 64 * 4, scratch.data(), scratch.size() - 1) == false);
+    REQUIRE(stream.PushRow(out.data()) == false);
+
+    in.edge_y = stbir::Edge::Wrap;
+    REQUIRE(stbir::Plan(in, plan_mem.data(), plan_mem.size(), plan));
+    REQUIRE(stream.Begin(plan, out.data(), 64 * 4, scratch.data(), scratch.size()) == false);
+}
+
+TEST_CASE("Color - sRGB transfer functions track the exact curves", "[stbir][color]") {
+    double to_lin = 0.0, to_srgb = 0.0;
+    for (int i = 0; i <= 100000; ++i) {
+        const float x = (float)i / 100000.f;
+        const double lin = x <= 0.04045f ? x / 12.92 : std::pow((x + 0.055) / 1.055, 2.4);
+        const double enc = x <= 0.0031308f ? x * 12.92 : 1.055 * std::pow((double)x, 1.0 / 2.4) - 0.055;
+        to_lin = std::max(to_lin, std::fabs(stbir::srgb_to_linear(x) - lin));
+        to_srgb = std::max(to_srgb, std::fabs(stbir::linear_to_srgb(x) - enc));
+    }
+    REQUIRE(to_lin < 1e-6);
+    REQUIRE(to_srgb < 1e-6);
+}
+
+TEST_CASE("Resize - sRGB averages in linear light and round-trips u8", "[stbir][resize][color]") {
+    // black/white columns, 2:1 box: linear mean 0.5 -> sRGB 188 (gamma-naive: 128)
+    const std::uint32_t w = 16, h = 4;
+    std::vector<std::uint8_t> src(w * h);
+    for (std::uint32_t i = 0; i < w * h; ++i) src[i] = (i & 1) ? 255 : 0;
+    stbir::ResizeInput in;
+    in.in_w = w; in.in_h = h;
+    in.out_w = w / 2; in.out_h = h;
+    in.channels = 1;
+    in.filter_x = in.filter_y = stbir::Filter::Box;
+    std::vector<std::uint8_t> dst(in.out_w * in.out_h);
+    for (int isa = 0; isa < 2; ++isa) {
+        in.isa = isa ? stbir::Isa::Auto : stbir::Isa::Scalar;
+        in.color = stbir::Color::Linear;
+        REQUIRE(resize(in, src.data(), w, dst.data(), in.out_w));
+        REQUIRE(dst[3] == 128);
+        in.color = stbir::Color::SRGB;
+        REQUIRE(resize(in, src.data(), w, dst.data(), in.out_w));
+        REQUIRE(dst[3] == 188);
+    }
+
+    // identity through the LUT and the vectorized encoder returns every code
+    std::vector<std::uint8_t> ramp(256 * 4);
+    for (std::uint32_t i = 0; i < ramp.size(); ++i) ramp[i] = (std::uint8_t)std::min<std::uint32_t>(255, i / 4 + (i % 4 == 3 ? 7 : 0));
+    stbir::ResizeInput id;
+    id.in_w = id.out_w = 256;
+    id.in_h = id.out_h = 1;
+    id.channels = 4;
+    id.color = stbir::Color::SRGB;
+    id.filter_x = id.filter_y = stbir::Filter::Box;
+    for (int a = 0; a < 2; ++a) {
+        id.alpha = a ? stbir::Alpha::Premultiplied : stbir::Alpha::None;
+        std::vector<std::uint8_t> out(ramp.size());
+        REQUIRE(resize(id, ramp.data(), 256 * 4, out.data(), 256 * 4));
+        int worst = 0;
+        for (std::size_t i = 0; i < ramp.size(); ++i) worst = std::max(worst, std::abs((int)out[i] - (int)ramp[i]));
+        REQUIRE(worst <= a); // premultiplied divides by alpha before the curve
+    }
+}
+
+TEST_CASE("Resize - straight alpha does not bleed transparent color", "[stbir][resize][alpha]") {
+    // opaque green next to fully transparent red
+    const std::uint8_t px[2][4] = { { 0, 255, 0, 255 }, { 255, 0, 0, 0 } };
+    const std::uint32_t w = 8, h = 2;
+    std::vector<std::uint8_t> src(w * h * 4);
+    for (std::uint32_t i = 0; i < w * h; ++i) std::memcpy(&src[i * 4], px[i & 1], 4);
+
+    stbir::ResizeInput in;
+    in.in_w = w; in.in_h = h;
+    in.out_w = w / 2; in.out_h = h;
+    in.channels = 4;
+    in.filter_x = in.filter_y = stbir::Filter::Box;
+    std::vector<std::uint8_t> dst(in.out_w * in.out_h * 4);
+    for (int c = 0; c < 2; ++c) {
+        in.color = c ? stbir::Color::SRGB : stbir::Color::Linear;
+        in.alpha = stbir::Alpha::Straight;
+        REQUIRE(resize(in, src.data(), w * 4, dst.data(), in.out_w * 4));
+        REQUIRE(dst[4] == 0);
+        REQUIRE(dst[5] == 255);
+        REQUIRE(dst[6] == 0);
+        REQUIRE(dst[7] == 128);
+
+        in.alpha = stbir::Alpha::None; // plain filtering mixes in the red
+        REQUIRE(resize(in, src.data(), w * 4, dst.data(), in.out_w * 4));
+        REQUIRE(dst[4] > 100);
+    }
+
+    in.channels = 3;
+    in.alpha = stbir::Alpha::Straight;
+    REQUIRE(stbir::PlanBytes(in) == 0);
+}
+
+TEST_CASE("Resize - sRGB and alpha stages match Scalar on SIMD kernels", "[stbir][resize][color][simd]") {
+    const std::uint32_t w = 77, h = 31;
+    const std::vector<std::uint8_t> src = pattern_u8(w, h, 4);
+    for (int a = 0; a < 3; ++a) {
+        for (int t = 0; t < 2; ++t) {
+            stbir::ResizeInput in;
+            in.in_w = w; in.in_h = h;
+            in.out_w = 40; in.out_h = 50;
+            in.channels = a ? 4 : 3;
+            in.filter_x = stbir::Filter::Lanczos3;
+            in.filter_y = stbir::Filter::CatmullRom;
+            in.color = stbir::Color::SRGB;
+            in.alpha = (stbir::Alpha)a;
+            in.out_type = t ? stbir::Sample::U16 : stbir::Sample::U8;
+            const std::size_t n = (std::size_t)in.out_w * in.out_h * in.channels;
+            const std::size_t bps = stbir::sample_bytes(in.out_type);
+            std::vector<std::uint8_t> ref(n * bps), got(n * bps);
+            in.isa = stbir::Isa::Scalar;
+            REQUIRE(resize(in, src.data(), w * in.channels, ref.data(), in.out_w * in.channels * bps));
+            in.isa = stbir::Isa::Auto;
+            REQUIRE(resize(in, src.data(), w * in.channels, got.data(), in.out_w * in.channels * bps));
+            int worst = 0;
+            for (std::size_t i = 0; i < n; ++i) {
+                const int r = t ? ((std::uint16_t*)ref.data())[i] : ref[i];
+                const int g = t ? ((std::uint16_t*)got.data())[i] : got[i];
+                worst = std::max(worst, std::abs(r - g));
+            }
+            REQUIRE(worst <= (t ? 2 : 1));
+        }
+    }
+}
+
+namespace stbir_test {
+
+    // Plans `in` and returns the chain with level 0 filled from `base`.
+    static bool mips(const stbir::MipInput& in, const void* base, stbir::MipPlan& plan,
+                     std::vector<std::uint8_t>& plan_mem, std::vector<std::uint8_t>& chain) {
+        plan_mem.resize(stbir::MipPlanBytes(in) + 1);
+        if (!stbir::PlanMips(in, plan_mem.data(), plan_mem.size(), plan)) return false;
+        chain.assign(plan.chain_bytes, 0);
+        std::memcpy(chain.data() + plan.level[0].offset, base, plan.level[0].bytes);
+        std::vector<std::uint8_t> scratch(stbir::MipScratchBytes(plan));
+        return stbir::GenerateMips(plan, chain.data(), chain.size(), scratch.data(), scratch.size());
+    }
+
+    // Fraction of pixels of a u8 level whose alpha (last channel) reaches `cutoff`.
+    static double coverage_u8(const stbir::MipPlan& plan, const std::vector<std::uint8_t>& chain,
+                              std::uint32_t k, std::uint32_t ch, float cutoff) {
+        const stbir::MipLevel& l = plan.level[k];
+        std::size_t n = 0;
+        for (std::size_t i = 0; i < (std::size_t)l.width * l.height; ++i)
+            n += chain[l.offset + i * ch + ch - 1] >= cutoff * 255.f;
+        return (double)n / ((double)l.width * l.height);
+    }
+
+} // namespace stbir_test
+
+TEST_CASE("GenerateMips - level layout and rejected inputs", "[stbir][mips]") {
+    stbir::MipInput in;
+    in.width = 37; in.height = 20; in.channels = 4;
+    std::vector<std::uint8_t> plan_mem(stbir::MipPlanBytes(in));
+    stbir::MipPlan plan;
+    REQUIRE(stbir::PlanMips(in, plan_mem.data(), plan_mem.size(), plan));
+    const std::uint32_t dims[][2] = { {37, 20}, {18, 10}, {9, 5}, {4, 2}, {2, 1}, {1, 1} };
+    REQUIRE(plan.count == 6);
+    std::size_t end = 0;
+    for (std::uint32_t k = 0; k < plan.count; ++k) {
+        const stbir::MipLevel& l = plan.level[k];
+        REQUIRE(l.width == dims[k][0]);
+        REQUIRE(l.height == dims[k][1]);
+        REQUIRE(l.stride == l.width * 4u);
+        REQUIRE(l.bytes == l.stride * l.height);
+        REQUIRE(l.offset >= end);
+        REQUIRE(l.offset % 16 == 0);
+        end = l.offset + l.bytes;
+    }
+    REQUIRE(plan.chain_bytes >= end);
+    REQUIRE(plan.chain_bytes < end + 16);
+
+    in.max_levels = 3;
+    REQUIRE(stbir::PlanMips(in, plan_mem.data(), plan_mem.size(), plan));
+    REQUIRE(plan.count == 3);
+
+    std::vector<std::uint8_t> chain(plan.chain_bytes), scratch(stbir::MipScratchBytes(plan));
+    REQUIRE(stbir::GenerateMips(plan, chain.data(), chain.size(), scratch.data(), scratch.size() - 1) == false);
+    REQUIRE(stbir::GenerateMips(plan, chain.data(), chain.size() - 1, scratch.data(), scratch.size()) == false);
+
+    in.edge = stbir::Edge::Wrap;
+    REQUIRE(stbir::MipPlanBytes(in) == 0);
+    in.edge = stbir::Edge::Clamp;
+    in.alpha_cutoff = 0.5f;
+    in.alpha = stbir::Alpha::Premultiplied;
+    REQUIRE(stbir::PlanMips(in, plan_mem.data(), plan_mem.size(), plan) == false);
+    in.alpha = stbir::Alpha::Straight;
+    in.channels = 3;
+    REQUIRE(stbir::PlanMips(in, plan_mem.data(), plan_mem.size(), plan) == false);
+}
+
+TEST_CASE("GenerateMips - levels match resizing level after level on float data", "[stbir][mips]") {
+    const stbir::Filter filters[] = { stbir::Filter::Box, stbir::Filter::Kaiser, stbir::Filter::Triangle };
+    const std::uint32_t sizes[][3] = { {64, 16, 4}, {45, 27, 3}, {128, 8, 1}, {5, 33, 2} };
+    for (stbir::Filter f : filters) {
+        for (const auto& s : sizes) {
+            stbir::MipInput in;
+            in.width = s[0]; in.height = s[1]; in.channels = s[2];
+            in.type = stbir::Sample::F32;
+            in.filter = f;
+            std::vector<float> base((std::size_t)in.width * in.height * in.channels);
+            for (std::size_t i = 0; i < base.size(); ++i) base[i] = (float)((i * 37u) % 101u) / 100.f;
+            stbir::MipPlan plan;
+            std::vector<std::uint8_t> plan_mem, chain;
+            REQUIRE(mips(in, base.data(), plan, plan_mem, chain));
+
+            std::vector<float> prev = base;
+            for (std::uint32_t k = 1; k < plan.count; ++k) {
+                const stbir::MipLevel& l = plan.level[k];
+                stbir::ResizeInput r;
+                r.in_w = plan.level[k - 1].width; r.in_h = plan.level[k - 1].height;
+                r.out_w = l.width; r.out_h = l.height;
+                r.channels = in.channels;
+                r.in_type = r.out_type = stbir::Sample::F32;
+                r.filter_x = r.filter_y = f;
+                std::vector<float> next((std::size_t)l.width * l.height * in.channels);
+                REQUIRE(resize(r, prev.data(), r.in_w * in.channels * 4, next.data(), l.stride));
+                REQUIRE(std::memcmp(chain.data() + l.offset, next.data(), l.bytes) == 0);
+                prev.swap(next);
+            }
+        }
+    }
+}
+
+TEST_CASE("GenerateMips - box levels are 2x2 means, in linear light for sRGB", "[stbir][mips][color]") {
+    // 2x2 checker of black and white: every level below is linear 0.5
+    const std::uint32_t w = 16, h = 8;
+    std::vector<std::uint8_t> base(w * h * 3);
+    for (std::uint32_t y = 0; y < h; ++y)
+        for (std::uint32_t x = 0; x < w; ++x)
+            for (std::uint32_t c = 0; c < 3; ++c) base[(y * w + x) * 3 + c] = ((x ^ y) & 1) ? 255 : 0;
+    for (int color = 0; color < 2; ++color) {
+        stbir::MipInput in;
+        in.width = w; in.height = h; in.channels = 3;
+        in.color = (stbir::Color)color;
+        stbir::MipPlan plan;
+        std::vector<std::uint8_t> plan_mem, chain;
+        REQUIRE(mips(in, base.data(), plan, plan_mem, chain));
+        REQUIRE(plan.count == 5);
+        const int want = color ? 188 : 128; // linear_to_srgb(0.5) = 0.7354
+        for (std::uint32_t k = 1; k < plan.count; ++k) {
+            const stbir::MipLevel& l = plan.level[k];
+            for (std::size_t i = 0; i < l.bytes; ++i) REQUIRE((int)chain[l.offset + i] == want);
+        }
+    }
+}
+
+TEST_CASE("GenerateMips - flat images stay flat for every filter", "[stbir][mips]") {
+    for (int f = 0; f <= (int)stbir::Filter::Kaiser; ++f) {
+        for (int e = 0; e < 2; ++e) {
+            stbir::MipInput in;
+            in.width = 41; in.height = 26; in.channels = 2;
+            in.filter = (stbir::Filter)f;
+            in.edge = e ? stbir::Edge::Reflect : stbir::Edge::Clamp;
+            in.alpha = stbir::Alpha::Straight;
+            const std::vector<std::uint8_t> base((std::size_t)in.width * in.height * 2, 77);
+            stbir::MipPlan plan;
+            std::vector<std::uint8_t> plan_mem, chain;
+            REQUIRE(mips(in, base.data(), plan, plan_mem, chain));
+            for (std::uint32_t k = 1; k < plan.count; ++k) {
+                const stbir::MipLevel& l = plan.level[k];
+                for (std::size_t i = 0; i < l.bytes; ++i) REQUIRE((int)chain[l.offset + i] == 77);
+            }
+        }
+    }
+}
+
+TEST_CASE("GenerateMips - alpha coverage is kept at the cutoff", "[stbir][mips][alpha]") {
+    // mostly translucent noise: plain averaging pulls alpha to the mean (0.35)
+    // and the texels above the cutoff vanish within two levels
+    const std::uint32_t w = 128, h = 128;
+    std::vector<std::uint8_t> base(w * h * 4);
+    std::uint32_t rng = 12345u;
+    for (std::size_t i = 0; i < (std::size_t)w * h; ++i) {
+        rng = rng * 1664525u + 1013904223u;
+        base[i * 4 + 0] = 200; base[i * 4 + 1] = 120; base[i * 4 + 2] = 40;
+        base[i * 4 + 3] = (std::uint8_t)((float)(rng >> 24) * 0.7f);
+    }
+    stbir::MipInput in;
+    in.width = w; in.height = h; in.channels = 4;
+    in.alpha = stbir::Alpha::Straight;
+    stbir::MipPlan plain, kept;
+    std::vector<std::uint8_t> plan_mem, a, b;
+    REQUIRE(mips(in, base.data(), plain, plan_mem, a));
+    in.alpha_cutoff = 0.5f;
+    REQUIRE(mips(in, base.data(), kept, plan_mem, b));
+
+    const double c0 = coverage_u8(kept, b, 0, 4, 0.5f);
+    REQUIRE(c0 > 0.25);
+    REQUIRE(c0 < 0.32);
+    for (std::uint32_t k = 1; k + 3 < kept.count; ++k) { // down to 8x8
+        REQUIRE(std::fabs(coverage_u8(kept, b, k, 4, 0.5f) - c0) < 0.05);
+        // color channels are untouched
+        REQUIRE(std::memcmp(a.data() + plain.level[k].offset, b.data() + kept.level[k].offset, 3) == 0);
+    }
+    REQUIRE(coverage_u8(plain, a, 2, 4, 0.5f) < 0.01);
+}
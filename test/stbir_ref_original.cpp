@@ -0,0 +1,46 @@
+#include <stddef.h>
+#include <stdlib.h>
+
+// Counts upstream's working-memory allocations (one or more per call).
+static size_t g_stbir_ref_allocs = 0;
+static size_t g_stbir_ref_alloc_bytes = 0;
+static void* stbir_ref_malloc(size_t size) {
+    ++g_stbir_ref_allocs;
+    g_stbir_ref_alloc_bytes += size;
+    return malloc(size);
+}
+
+#define STB_IMAGE_RESIZE_IMPLEMENTATION
+#define STB_IMAGE_RESIZE_STATIC
+#define STBIR_MALLOC(size, user_data) ((void)(user_data), stbir_ref_malloc(size))
+#define STBIR_FREE(ptr, user_data)    ((void)(user_data), free(ptr))
+#include "../3rd_party/stb/stb_image_resize2.h"
+
+extern "C" {
+
+// channels 1..4 (no alpha handling), type 0..3 = u8 / u16 / f32 / f16,
+// filter 1..5 = box / triangle / cubic B-spline / Catmull-Rom / Mitchell,
+// edge 0..3 = clamp / reflect / wrap / zero. Returns 0 on failure.
+int stbir_ref_resize(const void* in, int in_w, int in_h, int in_stride,
+                     void* out, int out_w, int out_h, int out_stride,
+                     int channels, int type, int filter, int edge) {
+    static const stbir_pixel_layout layouts[] = { STBIR_1CHANNEL, STBIR_2CHANNEL, STBIR_RGB, STBIR_4CHANNEL };
+    static const stbir_datatype types[] = { STBIR_TYPE_UINT8, STBIR_TYPE_UINT16, STBIR_TYPE_FLOAT, STBIR_TYPE_HALF_FLOAT };
+    static const stbir_filter filters[] = { STBIR_FILTER_BOX, STBIR_FILTER_TRIANGLE, STBIR_FILTER_CUBICBSPLINE,
+                                            STBIR_FILTER_CATMULLROM, STBIR_FILTER_MITCHELL };
+    static const stbir_edge edges[] = { STBIR_EDGE_CLAMP, STBIR_EDGE_REFLECT, STBIR_EDGE_WRAP, STBIR_EDGE_ZERO };
+    if (channels < 1 || channels > 4 || type < 0 || type > 3 || filter < 1 || filter > 5 || edge < 0 || edge > 3)
+        return 0;
+    return stbir_resize(in, in_w, in_h, in_stride, out, out_w, out_h, out_stride,
+                        layouts[channels - 1], types[type], edges[edge], filters[filter - 1]) != 0;
+}
+
+size_t stbir_ref_alloc_count() {
+    return g_stbir_ref_allocs;
+}
+
+size_t stbir_ref_alloc_bytes() {
+    return g_stbir_ref_alloc_bytes;
+}
+
+} // extern "C"
@@ -15,6 +15,9 @@
 #define STBI_FREESTANDING
 #include "../stb_image_write/stb_image_write.hpp"
 
+// C++ decoder, for the round-trip tests
+#include "../stb_image/stb_image.hpp"
+
 namespace {
 
 
@@ -776,3 +779,87 @@ TEST_CASE("PNG: C++ writer rejects invalid args strictly", "[png][invalid][stric
 
     REQUIRE(sink.empty());
 }
+
+
+
+// --------------------------- PNG round trip through stbi ---------------------------
+// The byte-diff tests above pin filter NONE; these decode the C++ writer's
+// output with the C++ stb_image port instead, so the adaptive filters and the
+// zlib fallbacks are checked without the C reference.
+
+namespace {
+
+    static bool decode_png(const std::vector<std::uint8_t>& png, std::vector<std::uint8_t>& out) {
+        stbi::DecodeOptions opt;
+        stbi::ImagePlan plan;
+        if (!stbi::Plan(png.data(), png.size(), opt, plan)) return false;
+        out.assign(plan.pixel_bytes, 0);
+        return stbi::Decode(png.data(), png.size(), plan, nullptr, 0, out.data(), out.size());
+    }
+
+    static std::vector<std::uint8_t> make_noise(int w, int h, int comp, std::uint32_t seed) {
+        std::vector<std::uint8_t> p((std::size_t)w * (std::size_t)h * (std::size_t)comp);
+        for (std::size_t i = 0; i < p.size(); ++i) {
+            seed = seed * 1664525u + 1013904223u;
+            p[i] = (std::uint8_t)(seed >> 24);
+        }
+        return p;
+    }
+
+} // namespace
+
+
+TEST_CASE("PNG: incompressible data falls back to stored blocks and round-trips", "[png][zlib][stored]") {
+    // below one stored block, and across three of them (32767 bytes each)
+    const int sizes[][2] = { { 16, 16 }, { 160, 128 } };
+    for (const auto& s : sizes) {
+        const int w = s[0], h = s[1], comp = 4;
+        const auto pixels = make_noise(w, h, comp, 7u);
+        const std::size_t raw = (std::size_t)h * ((std::size_t)w * comp + 1);
+
+        std::vector<std::uint8_t> png, got;
+        stbiw::Writer wr;
+        wr.start_callbacks(&cb_const, &png);
+        wr.set_force_png_filter(0);
+        REQUIRE(wr.write_png(w, h, comp, pixels.data(), 0));
+        wr.flush();
+
+        // stored: the raw rows plus 5 bytes per block and the fixed PNG framing
+        REQUIRE(png.size() < raw + (raw / 32767 + 1) * 5 + 128);
+        REQUIRE(decode_png(png, got));
+        REQUIRE(got == pixels);
+    }
+}
+
+
+TEST_CASE("PNG: adaptive and forced filters round-trip, flip off/on, comp=1..4", "[png][filter][flip]") {
+    const int w = 37, h = 23;
+    for (int comp = 1; comp <= 4; ++comp) {
+        // gradients with a little noise, so the adaptive search picks several filter types
+        auto pixels = make_noise(w, h, comp, 3u + (std::uint32_t)comp);
+        for (std::size_t i = 0; i < pixels.size(); ++i) {
+            const int x = (int)((i / comp) % w), y = (int)((i / comp) / w);
+            pixels[i] = (std::uint8_t)(x * 5 + y * 9 + (pixels[i] & 7));
+        }
+        const std::size_t row = (std::size_t)w * comp;
+
+        for (int filter = -1; filter <= 4; ++filter) {
+            for (int flip = 0; flip < 2; ++flip) {
+                std::vector<std::uint8_t> png, got;
+                stbiw::Writer wr;
+                wr.start_callbacks(&cb_const, &png);
+                wr.set_force_png_filter(filter);
+                wr.set_flip_vertically(flip != 0);
+                REQUIRE(wr.write_png(w, h, comp, pixels.data(), 0));
+                wr.flush();
+
+                REQUIRE(decode_png(png, got));
+                REQUIRE(got.size() == pixels.size());
+                for (int y = 0; y < h; ++y) {
+                    const int src = flip ? h - 1 - y : y;
+                    REQUIRE(std::memcmp(got.data() + y * row, pixels.data() + src * row, row) == 0);
+                }
+            }
+        }
+    }
+}
@@ -0,0 +1,388 @@
+// BUILD: Debug, Release. STD used, no freestanding.
+
+// stbtt_stream bench: PlanBytes / Plan / Build / per-glyph StreamDF (split into
+// distance, sign and finalize stages) per DfMode x script, printed as JSON.
+//
+// ENV:
+//  - STBTT_TEST_FONT              : primary .ttf (Latin, Cyrillic)
+//  - STBTT_TEST_CJK_FONT          : .ttf for the CJK / JouyouKanji sets (default: primary)
+//  - STBTT_STREAM_BENCH_ITERS     : measured repetitions per case (default 5)
+//  - STBTT_STREAM_BENCH_PX        : pixel height (default 32)
+//  - STBTT_STREAM_BENCH_SPREAD    : spread in pixels (default 4)
+//
+// SDF cases also time upstream stbtt_GetGlyphSDF on the same glyphs
+// (define STBTT_STREAM_BENCH_NO_REFERENCE to build without 3rd_party/stb).
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <cmath>
+#include <vector>
+#include <string>
+#include <fstream>
+#include <algorithm>
+#include <iostream>
+#include <chrono>
+
+#if defined(_WIN32)
+#   include <windows.h>
+#   include <mmsystem.h>
+#   pragma comment(lib, "winmm.lib")
+#   undef max
+#   undef min
+static void set_high_perf_timer() { timeBeginPeriod(1); }
+#else
+static void set_high_perf_timer() {}
+#endif
+
+// ---------------- StreamDF stage hooks ----------------
+namespace stbtt_stream_bench {
+
+    using clock = std::chrono::steady_clock;
+
+    struct StageTimes {
+        double ns[3] = { 0.0, 0.0, 0.0 }; // Distance, Sign, Finalize
+        clock::time_point t0[3];
+        bool enabled = false;
+    };
+    static StageTimes g_stages;
+
+    static inline void stage_begin(int s) {
+        if (g_stages.enabled) g_stages.t0[s] = clock::now();
+    }
+    static inline void stage_end(int s) {
+        if (g_stages.enabled)
+            g_stages.ns[s] += std::chrono::duration<double, std::nano>(clock::now() - g_stages.t0[s]).count();
+    }
+
+} // namespace stbtt_stream_bench
+
+#define STBTT_STREAM_STAGE_BEGIN(stage) stbtt_stream_bench::stage_begin((int)(stage))
+#define STBTT_STREAM_STAGE_END(stage)   stbtt_stream_bench::stage_end((int)(stage))
+
+#include "../stb_truetype_stream/stb_truetype_stream.hpp"
+#include "../stb_truetype_stream/codepoints/stbtt_codepoints_stream.hpp"
+
+// Reference stb (optional)
+#ifndef STBTT_STREAM_BENCH_NO_REFERENCE
+#   define STB_TRUETYPE_IMPLEMENTATION
+#   define STBTT_STATIC
+#   include "../3rd_party/stb/stb_truetype.h"
+#endif
+
+namespace stbtt_stream_bench {
+
+    static std::string getenv_str(const char* name) {
+        const char* v = std::getenv(name);
+        return v ? std::string(v) : std::string{};
+    }
+
+    static int getenv_int(const char* name, int def) {
+        auto s = getenv_str(name);
+        if (s.empty()) return def;
+        try { return std::max(1, std::stoi(s)); }
+        catch (...) { return def; }
+    }
+
+    static float getenv_float(const char* name, float def) {
+        auto s = getenv_str(name);
+        if (s.empty()) return def;
+        try { return std::max(0.5f, std::stof(s)); }
+        catch (...) { return def; }
+    }
+
+    static bool read_file(const std::string& path, std::vector<std::uint8_t>& out) {
+        std::ifstream f(path, std::ios::binary);
+        if (!f) return false;
+        f.seekg(0, std::ios::end);
+        std::streamoff n = f.tellg();
+        if (n <= 0) return false;
+        f.seekg(0, std::ios::beg);
+        out.resize((std::size_t)n);
+        f.read((char*)out.data(), n);
+        return f.good();
+    }
+
+    static std::vector<std::string> default_font_candidates() {
+        return {
+    #if defined(_WIN32)
+            "C:\\Windows\\Fonts\\arial.ttf",
+            "C:\\Windows\\Fonts\\segoeui.ttf",
+    #elif defined(__APPLE__)
+            "/System/Library/Fonts/Supplemental/Arial.ttf",
+    #else
+            "/usr/share/fonts/truetype/dejavu/DejaVuSans.ttf",
+            "/usr/share/fonts/truetype/liberation/LiberationSans-Regular.ttf",
+            "/usr/share/fonts/truetype/freefont/FreeSans.ttf",
+    #endif
+        };
+    }
+
+    struct LoadedFont {
+        std::string path;
+        std::vector<std::uint8_t> bytes;
+        stbtt_stream::Font font;
+    };
+
+    static bool load_font(const std::string& env_path, LoadedFont& out) {
+        std::vector<std::string> paths;
+        if (!env_path.empty()) paths.push_back(env_path);
+        auto defs = default_font_candidates();
+        paths.insert(paths.end(), defs.begin(), defs.end());
+        for (const auto& p : paths) {
+            if (read_file(p, out.bytes) && out.font.ReadBytes(out.bytes.data())) {
+                out.path = p;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    static double ms_since(clock::time_point t0) {
+        return std::chrono::duration<double, std::milli>(clock::now() - t0).count();
+    }
+
+    static const char* mode_name(stbtt_stream::DfMode m) {
+        return m == stbtt_stream::DfMode::SDF ? "SDF" : m == stbtt_stream::DfMode::MSDF ? "MSDF" : "MTSDF";
+    }
+
+    static std::string json_escape(const std::string& s) {
+        std::string o;
+        for (char c : s) {
+            if (c == '"' || c == '\\') o.push_back('\\');
+            o.push_back(c);
+        }
+        return o;
+    }
+
+    // best-of-iters timings, in milliseconds
+    struct CaseResult {
+        std::uint32_t codepoints = 0;
+        std::uint32_t glyphs = 0;
+        std::size_t plan_bytes = 0;
+        std::size_t scratch_bytes = 0;
+        std::size_t atlas_bytes = 0;
+        std::uint16_t atlas_side = 0;
+        std::uint16_t page_count = 0;
+        double fill_ratio = 0.0;
+
+        double plan_bytes_ms = 0.0;
+        double plan_ms = 0.0;
+        double build_ms = 0.0;
+        double stream_df_ms = 0.0;
+        double stage_ms[3] = { 0.0, 0.0, 0.0 };
+
+        bool ref = false;
+        double ref_ms = 0.0;
+        bool ok = true;
+    };
+
+#ifndef STBTT_STREAM_BENCH_NO_REFERENCE
+    // upstream SDF of the same glyphs: padding = spread, 128 on the edge, 127 codes per spread
+    static double bench_ref_sdf(const LoadedFont& lf, const stbtt_stream::FontPlan& plan,
+                                float spread_px, int iters) {
+        stbtt_fontinfo ref{};
+        const int off = stbtt_GetFontOffsetForIndex(lf.bytes.data(), 0);
+        if (off < 0 || !stbtt_InitFont(&ref, lf.bytes.data(), off)) return 0.0;
+        const float sc = stbtt_ScaleForPixelHeight(&ref, (float)plan.pixel_height);
+        const int padding = (int)std::ceil(spread_px);
+
+        double best = 0.0;
+        volatile std::uint32_t sink = 0;
+        for (int it = 0; it < iters; ++it) {
+            auto t0 = clock::now();
+            for (std::uint32_t i = 0; i < plan.glyph_count; ++i) {
+                int w = 0, h = 0, xo = 0, yo = 0;
+                unsigned char* sdf = stbtt_GetGlyphSDF(&ref, sc, plan._glyphs[i].glyph_index, padding,
+                                                       128, 127.0f / spread_px, &w, &h, &xo, &yo);
+                if (sdf) {
+                    sink = sink + sdf[(w * h) >> 1];
+                    stbtt_FreeSDF(sdf, ref.userdata);
+                }
+            }
+            const double ms = ms_since(t0);
+            if (it == 0 || ms < best) best = ms;
+        }
+        return best;
+    }
+#endif
+
+    static CaseResult bench_case(LoadedFont& lf, stbtt_stream::DfMode mode,
+                                 stbtt_codepoints::Script script,
+                                 std::uint16_t px, float spread_px, int iters) {
+        CaseResult r{};
+        stbtt_stream::Font& font = lf.font;
+
+        const std::uint32_t n = stbtt_codepoints::PlanGlyphs(font, script);
+        std::vector<std::uint32_t> cps(n);
+        std::vector<std::uint16_t> gids(n);
+        stbtt_codepoints::CodepointListSink list{ cps.data(), gids.data(), n, 0 };
+        stbtt_codepoints::CollectGlyphs(font, list, script);
+        r.codepoints = list.count;
+        if (!list.count) return r;
+
+        stbtt_stream::PlanInput in{};
+        in.mode = mode;
+        in.pixel_height = px;
+        in.spread_px = spread_px;
+        in.codepoints = cps.data();
+        in.codepoint_count = list.count;
+
+        // PlanBytes / Plan: codepoints only (cmap lookups included)
+        std::size_t plan_bytes = 0;
+        for (int it = 0; it < iters; ++it) {
+            auto t0 = clock::now();
+            plan_bytes = font.PlanBytes(in);
+            const double ms = ms_since(t0);
+            if (it == 0 || ms < r.plan_bytes_ms) r.plan_bytes_ms = ms;
+        }
+        if (!plan_bytes) { r.ok = false; return r; }
+
+        std::vector<std::uint8_t> plan_mem(plan_bytes);
+        stbtt_stream::FontPlan plan{};
+        for (int it = 0; it < iters; ++it) {
+            auto t0 = clock::now();
+            const bool ok = font.Plan(in, plan_mem.data(), plan_mem.size(), plan);
+            const double ms = ms_since(t0);
+            if (!ok) { r.ok = false; return r; }
+            if (it == 0 || ms < r.plan_ms) r.plan_ms = ms;
+        }
+
+        const std::uint32_t stride = stbtt_stream::AtlasStrideBytes(plan);
+        const std::size_t page_bytes = stbtt_stream::AtlasPageBytes(plan, stride);
+        std::vector<std::uint8_t> atlas(page_bytes * plan.page_count);
+
+        for (int it = 0; it < iters; ++it) {
+            auto t0 = clock::now();
+            const bool ok = font.Build(plan, atlas.data(), stride);
+            const double ms = ms_since(t0);
+            if (!ok) { r.ok = false; return r; }
+            if (it == 0 || ms < r.build_ms) r.build_ms = ms;
+        }
+
+        // per-glyph StreamDF with stage split (hooks add a little overhead per tile)
+        stbtt_stream::GlyphScratch scratch = stbtt_stream::bind_glyph_scratch(
+            plan._scratch_mem, plan.max_points, plan.max_area, plan.mode);
+        for (int it = 0; it < iters; ++it) {
+            g_stages = StageTimes{};
+            g_stages.enabled = true;
+            auto t0 = clock::now();
+            for (std::uint32_t i = 0; i < plan.glyph_count; ++i) {
+                const stbtt_stream::GlyphPlan& gp = plan._glyphs[i];
+                scratch.visit_n = 0;
+                std::uint8_t* page = atlas.data() + (std::size_t)gp.rect.page * page_bytes;
+                if (!font.StreamDF(gp, page, stride, plan.mode, plan.scale, plan.spread_fu,
+                                   scratch, plan.max_points, plan.max_area))
+                    r.ok = false;
+            }
+            const double ms = ms_since(t0);
+            g_stages.enabled = false;
+            if (it == 0 || ms < r.stream_df_ms) {
+                r.stream_df_ms = ms;
+                for (int s = 0; s < 3; ++s) r.stage_ms[s] = g_stages.ns[s] * 1e-6;
+            }
+        }
+
+        std::uint64_t cell_area = 0;
+        for (std::uint32_t i = 0; i < plan.glyph_count; ++i)
+            cell_area += (std::uint64_t)plan._glyphs[i].rect.w * plan._glyphs[i].rect.h;
+
+        r.glyphs = plan.glyph_count;
+        r.plan_bytes = plan_bytes;
+        r.scratch_bytes = plan._scratch_bytes;
+        r.atlas_bytes = atlas.size();
+        r.atlas_side = plan.atlas_side;
+        r.page_count = plan.page_count;
+        r.fill_ratio = (double)cell_area /
+                       ((double)plan.atlas_side * plan.atlas_side * plan.page_count);
+
+#ifndef STBTT_STREAM_BENCH_NO_REFERENCE
+        if (mode == stbtt_stream::DfMode::SDF) {
+            r.ref = true;
+            r.ref_ms = bench_ref_sdf(lf, plan, spread_px, iters);
+        }
+#endif
+        return r;
+    }
+
+    static double per_sec(std::uint32_t glyphs, double ms) {
+        return ms > 0.0 ? (double)glyphs * 1000.0 / ms : 0.0;
+    }
+
+} // namespace stbtt_stream_bench
+
+int main() {
+    using namespace stbtt_stream_bench;
+    set_high_perf_timer();
+
+    const int iters = getenv_int("STBTT_STREAM_BENCH_ITERS", 5);
+    const std::uint16_t px = (std::uint16_t)getenv_int("STBTT_STREAM_BENCH_PX", 32);
+    const float spread_px = getenv_float("STBTT_STREAM_BENCH_SPREAD", 4.0f);
+
+    LoadedFont primary, cjk;
+    if (!load_font(getenv_str("STBTT_TEST_FONT"), primary)) {
+        std::cerr << "No font found. Set STBTT_TEST_FONT=/path/to/font.ttf\n";
+        return 1;
+    }
+    const std::string cjk_path = getenv_str("STBTT_TEST_CJK_FONT");
+    const bool has_cjk = !cjk_path.empty() && load_font(cjk_path, cjk);
+
+    struct ScriptSet { const char* name; stbtt_codepoints::Script script; bool cjk; };
+    const ScriptSet scripts[] = {
+        { "Latin",       stbtt_codepoints::Script::Latin,       false },
+        { "Cyrillic",    stbtt_codepoints::Script::Cyrillic,    false },
+        { "CJK",         stbtt_codepoints::Script::CJK,         true  },
+        { "JouyouKanji", stbtt_codepoints::Script::JouyouKanji, true  },
+    };
+    const stbtt_stream::DfMode modes[] = {
+        stbtt_stream::DfMode::SDF, stbtt_stream::DfMode::MSDF, stbtt_stream::DfMode::MTSDF
+    };
+
+    std::cout.setf(std::ios::fixed);
+    std::cout.precision(4);
+    std::cout << "{\n"
+              << "  \"pixel_height\": " << px << ",\n"
+              << "  \"spread_px\": " << spread_px << ",\n"
+              << "  \"iters\": " << iters << ",\n"
+              << "  \"font\": \"" << json_escape(primary.path) << "\",\n"
+              << "  \"cjk_font\": \"" << json_escape(has_cjk ? cjk.path : primary.path) << "\",\n"
+              << "  \"cases\": [";
+
+    bool first = true;
+    for (stbtt_stream::DfMode mode : modes) {
+        for (const ScriptSet& ss : scripts) {
+            LoadedFont& lf = (ss.cjk && has_cjk) ? cjk : primary;
+            const CaseResult r = bench_case(lf, mode, ss.script, px, spread_px, iters);
+
+            std::cout << (first ? "\n" : ",\n");
+            first = false;
+            std::cout << "    { \"mode\": \"" << mode_name(mode) << "\", \"script\": \"" << ss.name << "\""
+                      << ", \"ok\": " << (r.ok ? "true" : "false")
+                      << ", \"codepoints\": " << r.codepoints
+                      << ", \"glyphs\": " << r.glyphs
+                      << ", \"plan_bytes_ms\": " << r.plan_bytes_ms
+                      << ", \"plan_ms\": " << r.plan_ms
+                      << ", \"build_ms\": " << r.build_ms
+                      << ", \"build_glyphs_per_sec\": " << per_sec(r.glyphs, r.build_ms)
+                      << ", \"stream_df_ms\": " << r.stream_df_ms
+                      << ", \"stage_ms\": { \"distance\": " << r.stage_ms[0]
+                      << ", \"sign\": " << r.stage_ms[1]
+                      << ", \"finalize\": " << r.stage_ms[2] << " }"
+                      << ", \"atlas_side\": " << r.atlas_side
+                      << ", \"page_count\": " << r.page_count
+                      << ", \"fill_ratio\": " << r.fill_ratio
+                      << ", \"plan_bytes\": " << r.plan_bytes
+                      << ", \"scratch_bytes\": " << r.scratch_bytes
+                      << ", \"atlas_bytes\": " << r.atlas_bytes;
+            if (r.ref) {
+                std::cout << ", \"ref_stbtt_sdf_ms\": " << r.ref_ms
+                          << ", \"ref_glyphs_per_sec\": " << per_sec(r.glyphs, r.ref_ms)
+                          << ", \"speedup_vs_ref\": " << (r.build_ms > 0.0 ? r.ref_ms / r.build_ms : 0.0);
+            }
+            std::cout << " }";
+        }
+    }
+    std::cout << "\n  ]\n}\n";
+    return 0;
+}
@@ -0,0 +1,1172 @@
+// BUILD: Debug, Release. STD used, no freestanding.
+//
+// Compile as a single TU. Requires Catch2 single-header.
+//
+// ENV:
+//  - STBTT_TEST_FONT   : path to a primary .ttf (glyf outlines)
+//
+// Notes:
+//  - These tests assume "trusted fonts" (same as stb). We avoid crafting malicious inputs.
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+#include <string>
+#include <fstream>
+
+// ---------------- Catch2 single header include ----------------
+#if __has_include(<catch2/catch_all.hpp>)
+#  define CATCH_CONFIG_MAIN
+#  include <catch2/catch_all.hpp>
+#elif __has_include(<catch.hpp>)
+#  define CATCH_CONFIG_MAIN
+#  include <catch.hpp>
+#elif __has_include("catch.hpp")
+#  define CATCH_CONFIG_MAIN
+#  include "catch.hpp"
+#else
+#  error "Catch2 single-header not found. Provide <catch2/catch_all.hpp> or catch.hpp."
+#endif
+
+#include "../stb_truetype_stream/stb_truetype_stream.hpp"
+#include "../stb_truetype_stream/codepoints/stbtt_codepoints_stream.hpp"
+
+namespace stbtt_stream_test {
+
+    static bool read_file(const std::string& path, std::vector<std::uint8_t>& out) {
+        std::ifstream f(path, std::ios::binary);
+        if (!f) return false;
+        f.seekg(0, std::ios::end);
+        std::streamoff n = f.tellg();
+        if (n <= 0) return false;
+        f.seekg(0, std::ios::beg);
+        out.resize(static_cast<std::size_t>(n));
+        f.read(reinterpret_cast<char*>(out.data()), n);
+        return f.good();
+    }
+
+    static std::vector<std::string> font_candidates() {
+        std::vector<std::string> out;
+        if (const char* env = std::getenv("STBTT_TEST_FONT")) out.push_back(env);
+    #if defined(_WIN32)
+        out.push_back("C:\\Windows\\Fonts\\arial.ttf");
+        out.push_back("C:\\Windows\\Fonts\\arialbd.ttf");
+    #elif defined(__APPLE__)
+        out.push_back("/System/Library/Fonts/Supplemental/Arial.ttf");
+    #else
+        out.push_back("/usr/share/fonts/truetype/dejavu/DejaVuSans.ttf");
+        out.push_back("/usr/share/fonts/truetype/liberation/LiberationSans-Regular.ttf");
+        out.push_back("/usr/share/fonts/dejavu-sans-fonts/DejaVuSans.ttf");
+    #endif
+        return out;
+    }
+
+    // Loads the first usable font; returns false if none is available.
+    static bool load_font(std::vector<std::uint8_t>& bytes, stbtt_stream::Font& font) {
+        for (const auto& p : font_candidates()) {
+            if (read_file(p, bytes) && font.ReadBytes(bytes.data())) return true;
+        }
+        return false;
+    }
+
+    static std::uint64_t fnv1a64(const void* data, std::size_t n, std::uint64_t h = 1469598103934665603ull) {
+        const std::uint8_t* p = reinterpret_cast<const std::uint8_t*>(data);
+        for (std::size_t i = 0; i < n; ++i) {
+            h ^= p[i];
+            h *= 1099511628211ull;
+        }
+        return h;
+    }
+
+    static std::uint32_t lcg(std::uint32_t& s) {
+        s = s * 1664525u + 1013904223u;
+        return s >> 8;
+    }
+
+    static std::vector<std::uint32_t> ascii_codepoints() {
+        std::vector<std::uint32_t> cps;
+        for (std::uint32_t c = 33; c < 127; ++c) cps.push_back(c);
+        return cps;
+    }
+
+    // reference BC4 (unorm) decode of one 8-byte block into 16 texels
+    static void bc4_decode(const std::uint8_t* blk, std::uint8_t out[16]) {
+        const std::uint32_t r0 = blk[0], r1 = blk[1];
+        std::uint32_t pal[8] = { r0, r1 };
+        if (r0 > r1) {
+            for (std::uint32_t i = 2; i < 8; ++i) pal[i] = ((8 - i) * r0 + (i - 1) * r1) / 7;
+        } else {
+            for (std::uint32_t i = 2; i < 6; ++i) pal[i] = ((6 - i) * r0 + (i - 1) * r1) / 5;
+            pal[6] = 0;
+            pal[7] = 255;
+        }
+        std::uint64_t bits = 0;
+        for (int i = 0; i < 6; ++i) bits |= (std::uint64_t)blk[2 + i] << (8 * i);
+        for (int i = 0; i < 16; ++i) out[i] = (std::uint8_t)pal[(bits >> (3 * i)) & 7u];
+    }
+
+    // offset of an sfnt table, 0 if missing
+    static std::uint32_t find_table(const std::vector<std::uint8_t>& f, const char* tag) {
+        auto u16 = [&](std::size_t o) { return (std::uint32_t)(f[o] << 8 | f[o + 1]); };
+        auto u32 = [&](std::size_t o) { return u16(o) << 16 | u16(o + 2); };
+        const std::uint32_t n = u16(4);
+        for (std::uint32_t i = 0; i < n; ++i) {
+            const std::size_t rec = 12 + 16 * (std::size_t)i;
+            if (std::memcmp(&f[rec], tag, 4) == 0) return u32(rec + 8);
+        }
+        return 0;
+    }
+
+} // namespace stbtt_stream_test
+
+// =====================================================================================
+//                                       TESTS
+// =====================================================================================
+
+TEST_CASE("radix_sort_order_hw_desc matches stable insertion sort", "[stbtt_stream][plan][sort]") {
+    std::uint32_t seed = 12345u;
+    for (std::uint32_t n : { 0u, 1u, 2u, 17u, 1000u, 20000u }) {
+        std::vector<stbtt_stream::GlyphPlan> glyphs(n);
+        for (auto& g : glyphs) {
+            g = stbtt_stream::GlyphPlan{};
+            // few distinct sizes -> many ties, plus an occasional huge cell
+            g.rect.w = (std::uint16_t)(8 + stbtt_stream_test::lcg(seed) % 24);
+            g.rect.h = (std::uint16_t)(8 + stbtt_stream_test::lcg(seed) % 24);
+            if (stbtt_stream_test::lcg(seed) % 97 == 0) g.rect.h = (std::uint16_t)(300 + g.rect.h);
+        }
+
+        // reference: the original insertion sort (h major, w minor, descending, stable)
+        std::vector<std::uint32_t> ref(n);
+        for (std::uint32_t i = 0; i < n; ++i) ref[i] = i;
+        auto keyhw = [&](std::uint32_t k) {
+            return (std::uint32_t)glyphs[k].rect.h * 65536u + glyphs[k].rect.w;
+        };
+        for (std::uint32_t i = 1; i < n; ++i) {
+            std::uint32_t v = ref[i], j = i;
+            while (j > 0 && keyhw(ref[j - 1]) < keyhw(v)) { ref[j] = ref[j - 1]; --j; }
+            ref[j] = v;
+        }
+
+        std::vector<std::uint32_t> order(n), tmp(n);
+        stbtt_stream::radix_sort_order_hw_desc(glyphs.data(), order.data(), tmp.data(), n);
+        REQUIRE(order == ref);
+    }
+}
+
+TEST_CASE("cmap enumeration matches per-codepoint FindGlyphIndex", "[stbtt_stream][cmap]") {
+    std::vector<std::uint8_t> bytes;
+    stbtt_stream::Font font;
+    if (!stbtt_stream_test::load_font(bytes, font)) FAIL("No font found. Set STBTT_TEST_FONT=/path/to/font.ttf");
+
+    struct Hit { std::uint32_t cp; int g; };
+    std::vector<Hit> hits;
+    auto sink = [&](std::uint32_t cp, int g) { hits.push_back({ cp, g }); };
+
+    const std::uint32_t ranges[][2] = { { 0, 0x2FFFF }, { 0x41, 0x5A }, { 0x3040, 0x30FF }, { 0x4E00, 0x9FFF }, { 0xFFF0, 0x1000F } };
+    for (const auto& r : ranges) {
+        hits.clear();
+        const std::uint32_t n = font.ForEachMappedCodepoint(r[0], r[1], sink);
+        REQUIRE(n == hits.size());
+
+        std::size_t at = 0;
+        for (std::uint32_t cp = r[0]; cp <= r[1]; ++cp) {
+            const int g = font.FindGlyphIndex((int)cp);
+            if (!g) continue;
+            REQUIRE(at < hits.size());
+            REQUIRE(hits[at].cp == cp);
+            REQUIRE(hits[at].g == g);
+            ++at;
+        }
+        REQUIRE(at == hits.size());
+    }
+}
+
+TEST_CASE("stbtt_codepoints - cached glyph indices plan the same atlas", "[stbtt_stream][cmap][plan]") {
+    std::vector<std::uint8_t> bytes;
+    stbtt_stream::Font font;
+    if (!stbtt_stream_test::load_font(bytes, font)) FAIL("No font found. Set STBTT_TEST_FONT=/path/to/font.ttf");
+
+    using stbtt_codepoints::Script;
+    const std::uint32_t n = stbtt_codepoints::PlanGlyphs(font, Script::Latin, Script::Cyrillic, Script::Greek);
+    REQUIRE(n > 0);
+
+    std::vector<std::uint32_t> cps(n);
+    std::vector<std::uint16_t> gids(n);
+    stbtt_codepoints::CodepointListSink list{ cps.data(), gids.data(), n, 0 };
+    stbtt_codepoints::CollectGlyphs(font, list, Script::Latin, Script::Cyrillic, Script::Greek);
+    REQUIRE(list.count == n);
+    for (std::uint32_t i = 0; i < n; ++i)
+        REQUIRE(font.FindGlyphIndex((int)cps[i]) == (int)gids[i]);
+
+    stbtt_stream::PlanInput in{};
+    in.mode = stbtt_stream::DfMode::SDF;
+    in.pixel_height = 24;
+    in.spread_px = 4.0f;
+    in.codepoints = cps.data();
+    in.codepoint_count = n;
+
+    const std::size_t plain_bytes = font.PlanBytes(in);
+    std::vector<std::uint8_t> plain_mem(plain_bytes);
+    stbtt_stream::FontPlan plain{};
+    REQUIRE(font.Plan(in, plain_mem.data(), plain_bytes, plain));
+
+    in.glyph_indices = gids.data();
+    REQUIRE(font.PlanBytes(in) == plain_bytes);
+    std::vector<std::uint8_t> cached_mem(plain_bytes);
+    stbtt_stream::FontPlan cached{};
+    REQUIRE(font.Plan(in, cached_mem.data(), plain_bytes, cached));
+
+    REQUIRE(cached.glyph_count == plain.glyph_count);
+    REQUIRE(cached.atlas_side == plain.atlas_side);
+    REQUIRE(std::memcmp(cached._glyphs, plain._glyphs, plain.glyph_count * sizeof(stbtt_stream::GlyphPlan)) == 0);
+
+    // cached plan infos as well: no glyf reads, same plan
+    std::vector<stbtt_stream::GlyphPlanInfo> infos(n);
+    font.GetGlyphPlanInfos(gids.data(), n, infos.data());
+    in.glyph_infos = infos.data();
+    REQUIRE(font.PlanBytes(in) == plain_bytes);
+    std::fill(cached_mem.begin(), cached_mem.end(), 0);
+    REQUIRE(font.Plan(in, cached_mem.data(), plain_bytes, cached));
+    REQUIRE(cached.glyph_count == plain.glyph_count);
+    REQUIRE(cached.atlas_side == plain.atlas_side);
+    REQUIRE(std::memcmp(cached._glyphs, plain._glyphs, plain.glyph_count * sizeof(stbtt_stream::GlyphPlan)) == 0);
+
+    // the plan reads the cache, not the font: an emptied entry drops its glyph
+    std::uint32_t k = 0;
+    while (k < n && infos[k].is_empty) ++k;
+    REQUIRE(k < n);
+    infos[k].is_empty = true;
+    REQUIRE(font.Plan(in, cached_mem.data(), plain_bytes, cached));
+    REQUIRE(cached.codepoint_count == plain.codepoint_count - 1);
+    REQUIRE(cached.Find(cps[k]) == nullptr);
+
+    // an entry built for another glyph is not trusted: the plan re-reads glyf
+    infos[k].is_empty = false;
+    infos[k].glyph_index = (std::uint16_t)(gids[k] + 1);
+    infos[k].x_max = (std::int16_t)(infos[k].x_max + 1000);
+    std::fill(cached_mem.begin(), cached_mem.end(), 0);
+    REQUIRE(font.Plan(in, cached_mem.data(), plain_bytes, cached));
+    REQUIRE(cached.glyph_count == plain.glyph_count);
+    REQUIRE(cached.atlas_side == plain.atlas_side);
+    REQUIRE(std::memcmp(cached._glyphs, plain._glyphs, plain.glyph_count * sizeof(stbtt_stream::GlyphPlan)) == 0);
+}
+
+TEST_CASE("Plan/Build - deterministic across runs", "[stbtt_stream][plan][build]") {
+    std::vector<std::uint8_t> bytes;
+    stbtt_stream::Font font;
+    if (!stbtt_stream_test::load_font(bytes, font)) FAIL("No font found. Set STBTT_TEST_FONT=/path/to/font.ttf");
+
+    const auto cps = stbtt_stream_test::ascii_codepoints();
+    for (auto mode : { stbtt_stream::DfMode::SDF, stbtt_stream::DfMode::MSDF, stbtt_stream::DfMode::MTSDF }) {
+        stbtt_stream::PlanInput in{};
+        in.mode = mode;
+        in.pixel_height = 32;
+        in.spread_px = 4.0f;
+        in.codepoints = cps.data();
+        in.codepoint_count = (std::uint32_t)cps.size();
+
+        const std::size_t plan_bytes = font.PlanBytes(in);
+        REQUIRE(plan_bytes > 0);
+
+        std::uint64_t hashes[2]{};
+        for (int run = 0; run < 2; ++run) {
+            std::vector<std::uint8_t> plan_mem(plan_bytes);
+            stbtt_stream::FontPlan plan{};
+            REQUIRE(font.Plan(in, plan_mem.data(), plan_bytes, plan));
+
+            const std::uint32_t comp = (std::uint32_t)mode;
+            const std::uint32_t stride = (std::uint32_t)plan.atlas_side * comp;
+            std::vector<std::uint8_t> atlas((std::size_t)stride * plan.atlas_side, 0);
+            REQUIRE(font.Build(plan, atlas.data(), stride));
+
+            std::uint64_t h = stbtt_stream_test::fnv1a64(atlas.data(), atlas.size());
+            for (std::uint32_t i = 0; i < plan.glyph_count; ++i)
+                h = stbtt_stream_test::fnv1a64(&plan._glyphs[i].rect, sizeof(stbtt_stream::GlyphRect), h);
+            hashes[run] = h;
+        }
+        REQUIRE(hashes[0] == hashes[1]);
+    }
+}
+
+TEST_CASE("Plan - codepoints sharing a glyph get one cell", "[stbtt_stream][plan][dedup]") {
+    std::vector<std::uint8_t> bytes;
+    stbtt_stream::Font font;
+    if (!stbtt_stream_test::load_font(bytes, font)) FAIL("No font found. Set STBTT_TEST_FONT=/path/to/font.ttf");
+
+    // ASCII twice (reversed) plus everything the BMP maps, so aliases show up
+    std::vector<std::uint32_t> cps = stbtt_stream_test::ascii_codepoints();
+    for (std::size_t i = cps.size(); i-- > 0;) cps.push_back(cps[i]);
+    auto add = [&](std::uint32_t cp, int) { cps.push_back(cp); };
+    font.ForEachMappedCodepoint(0x80, 0xFFFF, add);
+
+    stbtt_stream::PlanInput in{};
+    in.mode = stbtt_stream::DfMode::SDF;
+    in.pixel_height = 16;
+    in.spread_px = 2.0f;
+    in.codepoints = cps.data();
+    in.codepoint_count = (std::uint32_t)cps.size();
+
+    std::vector<std::uint8_t> plan_mem(font.PlanBytes(in));
+    stbtt_stream::FontPlan plan{};
+    REQUIRE(font.Plan(in, plan_mem.data(), plan_mem.size(), plan));
+    REQUIRE(plan.glyph_count <= plan.codepoint_count);
+
+    std::vector<std::uint8_t> seen(65536, 0);
+    for (std::uint32_t i = 0; i < plan.glyph_count; ++i) {
+        REQUIRE(seen[plan._glyphs[i].glyph_index] == 0);
+        seen[plan._glyphs[i].glyph_index] = 1;
+    }
+
+    std::uint32_t planned = 0;
+    for (std::uint32_t i = 0; i < plan.codepoint_count; ++i) {
+        if (i) REQUIRE(plan._map_cp[i - 1] < plan._map_cp[i]);
+    }
+    for (std::uint32_t cp : cps) {
+        const stbtt_stream::GlyphPlan* g = plan.Find(cp);
+        if (!g) continue; // empty glyph (space etc.)
+        REQUIRE((int)g->glyph_index == font.FindGlyphIndex((int)cp));
+        ++planned;
+    }
+    REQUIRE(planned > 0);
+    REQUIRE(plan.Find(0x10FFFF) == nullptr);
+}
+
+TEST_CASE("Plan - MaxRects packs tighter without overlaps", "[stbtt_stream][plan][pack]") {
+    std::vector<std::uint8_t> bytes;
+    stbtt_stream::Font font;
+    if (!stbtt_stream_test::load_font(bytes, font)) FAIL("No font found. Set STBTT_TEST_FONT=/path/to/font.ttf");
+
+    std::vector<std::uint32_t> cps;
+    auto add = [&](std::uint32_t cp, int) { cps.push_back(cp); };
+    font.ForEachMappedCodepoint(0, 0xFFFF, add);
+
+    for (std::uint16_t px : { (std::uint16_t)12, (std::uint16_t)24, (std::uint16_t)40 }) {
+        stbtt_stream::PlanInput in{};
+        in.mode = stbtt_stream::DfMode::SDF;
+        in.pixel_height = px;
+        in.spread_px = 3.0f;
+        in.codepoints = cps.data();
+        in.codepoint_count = (std::uint32_t)cps.size();
+
+        std::vector<std::uint8_t> sky_mem(font.PlanBytes(in));
+        stbtt_stream::FontPlan sky{};
+        REQUIRE(font.Plan(in, sky_mem.data(), sky_mem.size(), sky));
+
+        in.pack_mode = stbtt_stream::PackMode::MaxRects;
+        std::vector<std::uint8_t> mr_mem(font.PlanBytes(in));
+        stbtt_stream::FontPlan mr{};
+        REQUIRE(font.Plan(in, mr_mem.data(), mr_mem.size(), mr));
+
+        REQUIRE(mr.glyph_count == sky.glyph_count);
+        REQUIRE(mr.atlas_side % 4 == 0);
+        REQUIRE(mr.atlas_side <= sky.atlas_side);
+
+        std::uint32_t outside = 0, overlaps = 0;
+        for (std::uint32_t i = 0; i < mr.glyph_count; ++i) {
+            const stbtt_stream::GlyphRect& a = mr._glyphs[i].rect;
+            if ((std::uint32_t)a.x + a.w > mr.atlas_side || (std::uint32_t)a.y + a.h > mr.atlas_side) ++outside;
+            for (std::uint32_t j = i + 1; j < mr.glyph_count; ++j) {
+                const stbtt_stream::GlyphRect& b = mr._glyphs[j].rect;
+                if (a.x < b.x + b.w && b.x < a.x + a.w && a.y < b.y + b.h && b.y < a.y + a.h) ++overlaps;
+            }
+        }
+        REQUIRE(outside == 0);
+        REQUIRE(overlaps == 0);
+
+        const std::uint32_t stride = mr.atlas_side;
+        std::vector<std::uint8_t> atlas((std::size_t)stride * mr.atlas_side, 0);
+        REQUIRE(font.Build(mr, atlas.data(), stride));
+    }
+}
+
+TEST_CASE("MultiFont - fallback chain resolves per font and renders at each font's scale", "[stbtt_stream][plan][multifont]") {
+    std::vector<std::uint8_t> bytes;
+    stbtt_stream::Font fallback;
+    if (!stbtt_stream_test::load_font(bytes, fallback)) FAIL("No font found. Set STBTT_TEST_FONT=/path/to/font.ttf");
+
+    // primary: same font with ascent/descent doubled (half the scale) and 'A' emptied
+    std::vector<std::uint8_t> primary_bytes = bytes;
+    const std::uint32_t hhea = stbtt_stream_test::find_table(primary_bytes, "hhea");
+    const std::uint32_t head = stbtt_stream_test::find_table(primary_bytes, "head");
+    const std::uint32_t loca = stbtt_stream_test::find_table(primary_bytes, "loca");
+    REQUIRE((hhea && head && loca));
+    for (std::uint32_t o : { hhea + 4, hhea + 6 }) {
+        const std::int16_t v = (std::int16_t)(primary_bytes[o] << 8 | primary_bytes[o + 1]);
+        const std::uint16_t d = (std::uint16_t)(v * 2);
+        primary_bytes[o] = (std::uint8_t)(d >> 8);
+        primary_bytes[o + 1] = (std::uint8_t)d;
+    }
+    const int ga = fallback.FindGlyphIndex('A');
+    REQUIRE(ga > 0);
+    const std::size_t loca_entry = primary_bytes[head + 51] ? 4 : 2;
+    for (std::size_t b = 0; b < loca_entry; ++b) // loca[A] = loca[A+1]: zero-length glyph
+        primary_bytes[loca + ga * loca_entry + b] = primary_bytes[loca + (ga + 1) * loca_entry + b];
+    stbtt_stream::Font primary;
+    REQUIRE(primary.ReadBytes(primary_bytes.data()));
+
+    stbtt_stream::Font* chain[2] = { &primary, &fallback };
+    stbtt_stream::MultiFont multi{};
+    multi.fonts = chain;
+    multi.font_count = 2;
+
+    const std::uint32_t cps[] = { 'A', 'B', 'g', 'A', 0x10FFFD };
+    stbtt_stream::PlanInput in{};
+    in.mode = stbtt_stream::DfMode::MSDF;
+    in.pixel_height = 32;
+    in.spread_px = 3.0f;
+    in.codepoints = cps;
+    in.codepoint_count = 5;
+
+    std::vector<std::uint8_t> plan_mem(multi.PlanBytes(in));
+    REQUIRE(!plan_mem.empty());
+    stbtt_stream::MultiFontPlan mp{};
+    REQUIRE(multi.Plan(in, plan_mem.data(), plan_mem.size(), mp));
+    REQUIRE(mp.font_count == 2);
+    REQUIRE(mp.plan.glyph_count == 3);
+    REQUIRE(mp.scale[0] == Approx(mp.scale[1] * 0.5f));
+    REQUIRE(mp.spread_fu[0] == Approx(mp.spread_fu[1] * 2.0f));
+
+    const stbtt_stream::GlyphPlan* a = mp.Find('A');
+    const stbtt_stream::GlyphPlan* b = mp.Find('B');
+    REQUIRE((a && b && mp.Find('g')));
+    REQUIRE(a->font == 1);
+    REQUIRE(b->font == 0);
+    REQUIRE(mp.Find(0x10FFFD) == nullptr);
+
+    // pixel_height is each font's own line height: the primary's 'B' outline is half as tall
+    stbtt_stream::FontPlan single{};
+    std::vector<std::uint8_t> single_mem(fallback.PlanBytes(in));
+    REQUIRE(fallback.Plan(in, single_mem.data(), single_mem.size(), single));
+    const stbtt_stream::GlyphPlan* b1 = single.Find('B');
+    REQUIRE(b1 != nullptr);
+    const int pad = 2 * 3; // 2 * spread_px
+    REQUIRE(std::abs(2 * ((int)b->rect.h - pad) - ((int)b1->rect.h - pad)) <= 2);
+
+    const std::uint32_t comp = (std::uint32_t)in.mode;
+    const std::uint32_t stride = stbtt_stream::AtlasStrideBytes(mp.plan);
+    std::vector<std::uint8_t> atlas(stbtt_stream::AtlasPageBytes(mp.plan, stride) * mp.plan.page_count, 0);
+    REQUIRE(multi.Build(mp, atlas.data(), stride));
+
+    // each cell equals its own font's StreamDF at that font's scale
+    std::vector<std::uint8_t> ref(atlas.size(), 0);
+    std::vector<std::uint8_t> scratch_mem(mp.plan._scratch_bytes);
+    stbtt_stream::GlyphScratch scratch = stbtt_stream::bind_glyph_scratch(
+        scratch_mem.data(), mp.plan.max_points, mp.plan.max_area, mp.plan.mode);
+    for (std::uint32_t i = 0; i < mp.plan.glyph_count; ++i) {
+        const stbtt_stream::GlyphPlan& gp = mp.plan._glyphs[i];
+        scratch.visit_n = 0;
+        REQUIRE(chain[gp.font]->StreamDF(gp, ref.data(), stride, in.mode,
+                                         mp.scale[gp.font], mp.spread_fu[gp.font],
+                                         scratch, mp.plan.max_points, mp.plan.max_area));
+        for (std::uint32_t y = 0; y < gp.rect.h; ++y) {
+            const std::size_t row = (std::size_t)(gp.rect.y + y) * stride + (std::size_t)gp.rect.x * comp;
+            REQUIRE(std::memcmp(&atlas[row], &ref[row], (std::size_t)gp.rect.w * comp) == 0);
+        }
+    }
+
+    // a single-font Build refuses cells that belong to another font
+    REQUIRE_FALSE(primary.Build(mp.plan, atlas.data(), stride));
+}
+
+TEST_CASE("Plan - multi-page split keeps per-glyph pixels", "[stbtt_stream][pages]") {
+    std::vector<std::uint8_t> bytes;
+    stbtt_stream::Font font;
+    if (!stbtt_stream_test::load_font(bytes, font)) FAIL("No font found. Set STBTT_TEST_FONT=/path/to/font.ttf");
+
+    const auto cps = stbtt_stream_test::ascii_codepoints();
+    const std::uint32_t comp = 1;
+    stbtt_stream::PlanInput in{};
+    in.mode = stbtt_stream::DfMode::SDF;
+    in.pixel_height = 32;
+    in.spread_px = 4.0f;
+    in.codepoints = cps.data();
+    in.codepoint_count = (std::uint32_t)cps.size();
+
+    std::vector<std::uint8_t> one_mem(font.PlanBytes(in));
+    stbtt_stream::FontPlan one{};
+    REQUIRE(font.Plan(in, one_mem.data(), one_mem.size(), one));
+    REQUIRE(one.page_count == 1);
+    const std::uint32_t one_stride = (std::uint32_t)one.atlas_side * comp;
+    std::vector<std::uint8_t> one_atlas((std::size_t)one_stride * one.atlas_side, 0);
+    REQUIRE(font.Build(one, one_atlas.data(), one_stride));
+
+    in.max_page_side = 128;
+    std::vector<std::uint8_t> multi_mem(font.PlanBytes(in));
+    stbtt_stream::FontPlan multi{};
+    REQUIRE(font.Plan(in, multi_mem.data(), multi_mem.size(), multi));
+    REQUIRE(multi.atlas_side == 128);
+    REQUIRE(multi.page_count > 1);
+    REQUIRE(multi.glyph_count == one.glyph_count);
+
+    const std::uint32_t stride = (std::uint32_t)multi.atlas_side * comp;
+    const std::size_t page_bytes = (std::size_t)stride * multi.atlas_side;
+    std::vector<std::uint8_t> atlas(page_bytes * multi.page_count, 0);
+    REQUIRE(font.Build(multi, atlas.data(), stride));
+
+    // the page-pointer overload writes the same bytes
+    std::vector<std::uint8_t> split(atlas.size(), 0);
+    std::vector<std::uint8_t*> pages(multi.page_count);
+    for (std::uint32_t p = 0; p < multi.page_count; ++p) pages[p] = split.data() + p * page_bytes;
+    REQUIRE(font.Build(multi, pages.data(), stride));
+    REQUIRE(split == atlas);
+
+    for (std::uint32_t i = 0; i < multi.glyph_count; ++i) {
+        const stbtt_stream::GlyphRect& r = multi._glyphs[i].rect;
+        const stbtt_stream::GlyphRect& o = one._glyphs[i].rect;
+        REQUIRE(multi._glyphs[i].codepoint == one._glyphs[i].codepoint);
+        REQUIRE(r.page < multi.page_count);
+        REQUIRE(o.page == 0);
+        REQUIRE((r.w == o.w && r.h == o.h));
+        REQUIRE((std::uint32_t)r.x + r.w <= multi.atlas_side);
+        REQUIRE((std::uint32_t)r.y + r.h <= multi.atlas_side);
+        const std::uint8_t* page = atlas.data() + r.page * page_bytes;
+        for (std::uint32_t y = 0; y < r.h; ++y)
+            REQUIRE(std::memcmp(page + (r.y + y) * stride + r.x * comp,
+                                one_atlas.data() + (o.y + y) * one_stride + o.x * comp, r.w * comp) == 0);
+    }
+
+    // the packer's coordinates are 16-bit: wider pages are rejected, 32768 still plans
+    for (std::uint16_t side : { (std::uint16_t)32769, (std::uint16_t)40000, (std::uint16_t)65535 }) {
+        in.max_page_side = side;
+        std::vector<std::uint8_t> mem(font.PlanBytes(in) + 1);
+        stbtt_stream::FontPlan p{};
+        REQUIRE_FALSE(font.Plan(in, mem.data(), mem.size(), p));
+    }
+    in.max_page_side = 32768;
+    std::vector<std::uint8_t> big_mem(font.PlanBytes(in));
+    stbtt_stream::FontPlan big{};
+    REQUIRE(font.Plan(in, big_mem.data(), big_mem.size(), big));
+    REQUIRE(big.page_count == 1);
+    REQUIRE(big.atlas_side == one.atlas_side);
+}
+
+TEST_CASE("Build - BC4/BC5 blocks decode to the raw cells within one palette step", "[stbtt_stream][build][bc]") {
+    std::vector<std::uint8_t> bytes;
+    stbtt_stream::Font font;
+    if (!stbtt_stream_test::load_font(bytes, font)) FAIL("No font found. Set STBTT_TEST_FONT=/path/to/font.ttf");
+
+    const auto cps = stbtt_stream_test::ascii_codepoints();
+    const stbtt_stream::DfMode modes[] = { stbtt_stream::DfMode::SDF, stbtt_stream::DfMode::MSDF,
+                                           stbtt_stream::DfMode::MTSDF };
+    for (stbtt_stream::DfMode mode : modes) {
+        const std::uint32_t comp = (std::uint32_t)mode;
+        stbtt_stream::PlanInput in{};
+        in.mode = mode;
+        in.pixel_height = 32;
+        in.spread_px = 4.0f;
+        in.codepoints = cps.data();
+        in.codepoint_count = (std::uint32_t)cps.size();
+
+        std::vector<std::uint8_t> raw_mem(font.PlanBytes(in));
+        stbtt_stream::FontPlan raw{};
+        REQUIRE(font.Plan(in, raw_mem.data(), raw_mem.size(), raw));
+        const std::uint32_t raw_stride = stbtt_stream::AtlasStrideBytes(raw);
+        std::vector<std::uint8_t> raw_atlas(stbtt_stream::AtlasPageBytes(raw, raw_stride), 0);
+        REQUIRE(font.Build(raw, raw_atlas.data(), raw_stride));
+
+        in.format = stbtt_stream::AtlasFormat::BC;
+        in.max_page_side = 130; // not block aligned
+        stbtt_stream::FontPlan bc{};
+        std::vector<std::uint8_t> bc_mem(font.PlanBytes(in));
+        REQUIRE_FALSE(font.Plan(in, bc_mem.data(), bc_mem.size(), bc));
+        in.max_page_side = 0;
+        bc_mem.resize(font.PlanBytes(in));
+        REQUIRE(font.Plan(in, bc_mem.data(), bc_mem.size(), bc));
+        REQUIRE(bc.glyph_count == raw.glyph_count);
+        REQUIRE(bc.format == stbtt_stream::AtlasFormat::BC);
+
+        const std::uint32_t stride = stbtt_stream::AtlasStrideBytes(bc);
+        REQUIRE(stride == (std::uint32_t)bc.atlas_side / 4 * 8);
+        const std::size_t page_bytes = stbtt_stream::AtlasPageBytes(bc, stride);
+        REQUIRE(page_bytes * 2 == (std::size_t)bc.atlas_side * bc.atlas_side * comp);
+        REQUIRE_FALSE(font.Build(bc, std::vector<std::uint8_t>(page_bytes).data(), stride - 1));
+        std::vector<std::uint8_t> atlas(page_bytes * bc.page_count, 0);
+        REQUIRE(font.Build(bc, atlas.data(), stride));
+
+        std::uint32_t misaligned = 0, out_of_range = 0, texels = 0;
+        for (std::uint32_t i = 0; i < bc.glyph_count; ++i) {
+            const stbtt_stream::GlyphRect& r = bc._glyphs[i].rect;
+            const stbtt_stream::GlyphRect& o = raw._glyphs[i].rect;
+            REQUIRE((r.w == o.w && r.h == o.h));
+            if ((r.x | r.y) & 3u) { ++misaligned; continue; }
+            const std::uint8_t* page = atlas.data() + r.page * page_bytes;
+            for (std::uint32_t c = 0; c < comp; ++c) {
+                // plane of channel pair c/2; BC5 stores the pair's two BC4 blocks back to back
+                const std::uint32_t ch0 = c & ~1u;
+                const std::uint32_t nch = comp - ch0 < 2 ? 1 : 2;
+                const std::uint8_t* plane = page + (std::size_t)(bc.atlas_side / 4) * stride * ch0;
+                for (std::uint32_t by = 0; by < (r.h + 3u) / 4u; ++by)
+                for (std::uint32_t bx = 0; bx < (r.w + 3u) / 4u; ++bx) {
+                    const std::uint8_t* blk = plane + (r.y / 4 + by) * stride * nch
+                                            + (r.x / 4 + bx) * 8 * nch + 8 * (c - ch0);
+                    std::uint8_t px[16];
+                    stbtt_stream_test::bc4_decode(blk, px);
+                    const int range = (int)blk[0] - (int)blk[1];
+                    for (std::uint32_t t = 0; t < 16; ++t) {
+                        const std::uint32_t x = bx * 4 + (t & 3), y = by * 4 + (t >> 2);
+                        if (x >= r.w || y >= r.h) continue;
+                        const int want = raw_atlas[(o.y + y) * raw_stride + (o.x + x) * comp + c];
+                        const int err = want > px[t] ? want - px[t] : px[t] - want;
+                        if (err * 14 > range + 14) ++out_of_range;
+                        ++texels;
+                    }
+                }
+            }
+        }
+        REQUIRE(texels > 0);
+        REQUIRE(misaligned == 0);
+        REQUIRE(out_of_range == 0);
+    }
+}
+
+TEST_CASE("BuildMany - one outline decode matches separate Builds per variant", "[stbtt_stream][build][many]") {
+    std::vector<std::uint8_t> bytes;
+    stbtt_stream::Font font;
+    if (!stbtt_stream_test::load_font(bytes, font)) FAIL("No font found. Set STBTT_TEST_FONT=/path/to/font.ttf");
+
+    const std::vector<std::uint32_t> cps = stbtt_stream_test::ascii_codepoints();
+    struct Variant { stbtt_stream::DfMode mode; std::uint16_t px; stbtt_stream::AtlasFormat format; };
+    const Variant variants[] = {
+        { stbtt_stream::DfMode::SDF,   32, stbtt_stream::AtlasFormat::Raw },
+        { stbtt_stream::DfMode::MTSDF, 48, stbtt_stream::AtlasFormat::Raw },
+        { stbtt_stream::DfMode::MSDF,  24, stbtt_stream::AtlasFormat::BC  },
+        { stbtt_stream::DfMode::SDF,  160, stbtt_stream::AtlasFormat::Raw }, // tiled cells
+    };
+    const std::uint32_t n = 4;
+
+    std::vector<std::vector<std::uint8_t>> mems(n), ref(n), out(n);
+    std::vector<stbtt_stream::FontPlan> plans(n);
+    std::vector<std::uint8_t*> atlases(n);
+    std::vector<std::uint32_t> strides(n);
+    for (std::uint32_t k = 0; k < n; ++k) {
+        stbtt_stream::PlanInput in{};
+        in.mode = variants[k].mode;
+        in.pixel_height = variants[k].px;
+        in.spread_px = 4.0f;
+        in.codepoints = cps.data();
+        in.codepoint_count = (std::uint32_t)cps.size();
+        in.format = variants[k].format;
+        mems[k].resize(font.PlanBytes(in));
+        REQUIRE(font.Plan(in, mems[k].data(), mems[k].size(), plans[k]));
+
+        strides[k] = stbtt_stream::AtlasStrideBytes(plans[k]);
+        const std::size_t bytes_k = stbtt_stream::AtlasPageBytes(plans[k], strides[k]) * plans[k].page_count;
+        ref[k].assign(bytes_k, 0);
+        out[k].assign(bytes_k, 0);
+        REQUIRE(font.Build(plans[k], ref[k].data(), strides[k]));
+        atlases[k] = out[k].data();
+    }
+
+    std::vector<std::uint8_t> outline(stbtt_stream::Font::BuildManyBytes(plans.data(), n));
+    REQUIRE(!outline.empty());
+    REQUIRE(font.BuildMany(plans.data(), n, atlases.data(), strides.data(), outline.data(), outline.size()));
+    for (std::uint32_t k = 0; k < n; ++k) REQUIRE(out[k] == ref[k]);
+
+    // outlines that do not fit the buffer fall back to streaming: same bytes
+    for (std::uint32_t k = 0; k < n; ++k) std::fill(out[k].begin(), out[k].end(), 0);
+    REQUIRE(font.BuildMany(plans.data(), n, atlases.data(), strides.data(),
+                           outline.data(), 4 * sizeof(stbtt_stream::OutlineSeg)));
+    for (std::uint32_t k = 0; k < n; ++k) REQUIRE(out[k] == ref[k]);
+
+    // a cell owned by another font (MultiFontPlan) is rejected, in any plan
+    for (std::uint32_t k = 0; k < 2; ++k) {
+        plans[k]._glyphs[plans[k].glyph_count - 1].font = 1;
+        REQUIRE_FALSE(font.BuildMany(plans.data(), n, atlases.data(), strides.data(),
+                                     outline.data(), outline.size()));
+        plans[k]._glyphs[plans[k].glyph_count - 1].font = 0;
+    }
+
+    // plans over different glyph sets are rejected
+    stbtt_stream::PlanInput other{};
+    other.mode = stbtt_stream::DfMode::SDF;
+    other.pixel_height = 32;
+    other.spread_px = 4.0f;
+    other.codepoints = cps.data();
+    other.codepoint_count = 10;
+    std::vector<std::uint8_t> other_mem(font.PlanBytes(other));
+    REQUIRE(font.Plan(other, other_mem.data(), other_mem.size(), plans[1]));
+    REQUIRE_FALSE(font.BuildMany(plans.data(), 2, atlases.data(), strides.data(),
+                                 outline.data(), outline.size()));
+}
+
+TEST_CASE("GlyphMetricsTable - half floats, page map and per-slot metrics", "[stbtt_stream][metrics]") {
+    // binary16 conversion: exact values, rounding, subnormals, overflow
+    const float exact[] = { 0.f, 1.f, -2.5f, 0.333251953125f, 65504.f, 6.103515625e-05f, 5.9604644775390625e-08f };
+    for (float f : exact) REQUIRE(stbtt_stream::float_from_half(stbtt_stream::half_from_float(f)) == f);
+    REQUIRE(stbtt_stream::half_from_float(1.f) == 0x3C00);
+    REQUIRE(stbtt_stream::half_from_float(1.f + 1.f / 2048.f) == 0x3C00);     // tie -> even
+    REQUIRE(stbtt_stream::half_from_float(1.f + 3.f / 2048.f) == 0x3C02);     // tie -> even
+    REQUIRE(stbtt_stream::half_from_float(70000.f) == 0x7C00);
+    REQUIRE(stbtt_stream::half_from_float(-1e-10f) == 0x8000);
+
+    std::vector<std::uint8_t> bytes;
+    stbtt_stream::Font font;
+    if (!stbtt_stream_test::load_font(bytes, font)) FAIL("No font found. Set STBTT_TEST_FONT=/path/to/font.ttf");
+
+    std::vector<std::uint32_t> cps = stbtt_stream_test::ascii_codepoints();
+    for (std::uint32_t cp = 0x400; cp < 0x460; ++cp) cps.push_back(cp);  // Cyrillic page
+    cps.push_back(0x2122); // lone codepoint on its own page
+    stbtt_stream::PlanInput in{};
+    in.mode = stbtt_stream::DfMode::SDF;
+    in.pixel_height = 40;
+    in.spread_px = 4.0f;
+    in.codepoints = cps.data();
+    in.codepoint_count = (std::uint32_t)cps.size();
+    std::vector<std::uint8_t> plan_mem(font.PlanBytes(in));
+    stbtt_stream::FontPlan plan{};
+    REQUIRE(font.Plan(in, plan_mem.data(), plan_mem.size(), plan));
+
+    std::vector<std::uint8_t> table_mem(stbtt_stream::Font::MetricsTableBytes(plan));
+    stbtt_stream::GlyphMetricsTable table{};
+    REQUIRE_FALSE(font.BuildMetricsTable(plan, table_mem.data(), table_mem.size() - 1, table));
+    REQUIRE(font.BuildMetricsTable(plan, table_mem.data(), table_mem.size(), table));
+    REQUIRE(table.bytes == table_mem.size());
+    REQUIRE(table.Offset(table.bearing) + table.glyph_count * 2 <= table.bytes);
+    REQUIRE(table.Offset(table.u0) % 16 == 0);
+
+    const std::uint32_t no_slot = stbtt_stream::GlyphMetricsTable::NO_SLOT;
+    const float em = plan.scale / (float)in.pixel_height;
+    const float tol = 1.f / 512.f; // float16 at ~1 em
+    std::uint32_t found = 0;
+    for (std::uint32_t cp : cps) {
+        const stbtt_stream::GlyphPlan* gp = plan.Find(cp);
+        const std::uint32_t slot = table.Slot(cp);
+        if (!gp) { REQUIRE(slot == no_slot); continue; }
+        REQUIRE(slot == (std::uint32_t)(gp - plan._glyphs));
+        ++found;
+
+        const float side = (float)plan.atlas_side;
+        REQUIRE(table.u0[slot] / 65535.f == Approx(gp->rect.x / side).margin(1e-5));
+        REQUIRE(table.v1[slot] / 65535.f == Approx((gp->rect.y + gp->rect.h) / side).margin(1e-5));
+        REQUIRE(table.layer[slot] == gp->rect.page);
+
+        const stbtt_stream::GlyphHorMetrics hm = font.GetGlyphHorMetrics(gp->glyph_index);
+        REQUIRE(stbtt_stream::float_from_half(table.advance[slot]) == Approx(hm.advance * em).margin(tol));
+        REQUIRE(stbtt_stream::float_from_half(table.bearing[slot]) == Approx(hm.lsb * em).margin(tol));
+        const float l = stbtt_stream::float_from_half(table.plane_l[slot]);
+        const float r = stbtt_stream::float_from_half(table.plane_r[slot]);
+        const float b = stbtt_stream::float_from_half(table.plane_b[slot]);
+        const float t = stbtt_stream::float_from_half(table.plane_t[slot]);
+        REQUIRE(l == Approx((gp->x_min - plan.spread_fu) * em).margin(tol));
+        REQUIRE((r - l) * in.pixel_height == Approx((float)gp->rect.w).margin(0.05));
+        REQUIRE((t - b) * in.pixel_height == Approx((float)gp->rect.h).margin(0.05));
+    }
+    REQUIRE(found > 0);
+    REQUIRE(table.Slot(0x4E00) == no_slot);    // past the last page
+    REQUIRE(table.Slot(0x300) == no_slot);     // page without codepoints
+    REQUIRE(table.Slot(0x10FFFF) == no_slot);
+}
+
+TEST_CASE("StreamDF - large cells are tiled with bounded scratch", "[stbtt_stream][tiles]") {
+    std::vector<std::uint8_t> bytes;
+    stbtt_stream::Font font;
+    if (!stbtt_stream_test::load_font(bytes, font)) FAIL("No font found. Set STBTT_TEST_FONT=/path/to/font.ttf");
+
+    const std::uint32_t cps[] = { 'I', 'O', 'W' };
+    const std::uint32_t tile_area = stbtt_stream::GlyphScratch::TILE_AREA; // no ODR-use in C++14
+    for (stbtt_stream::DfMode mode : { stbtt_stream::DfMode::SDF, stbtt_stream::DfMode::MTSDF }) {
+        stbtt_stream::PlanInput in{};
+        in.mode = mode;
+        in.pixel_height = 200;
+        in.spread_px = 8.0f;
+        in.codepoints = cps;
+        in.codepoint_count = 3;
+
+        std::vector<std::uint8_t> plan_mem(font.PlanBytes(in));
+        stbtt_stream::FontPlan plan{};
+        REQUIRE(font.Plan(in, plan_mem.data(), plan_mem.size(), plan));
+        REQUIRE(plan.max_area > tile_area);
+        REQUIRE(plan._scratch_bytes ==
+                stbtt_stream::glyph_scratch_bytes(plan.max_points, tile_area, mode));
+
+        const std::uint32_t comp = (std::uint32_t)mode;
+        const std::uint32_t stride = (std::uint32_t)plan.atlas_side * comp;
+        std::vector<std::uint8_t> atlas((std::size_t)stride * plan.atlas_side, 0);
+        REQUIRE(font.Build(plan, atlas.data(), stride));
+
+        // the stem of 'I' is inside at the cell center, the spread border is outside
+        for (std::uint32_t i = 0; i < plan.glyph_count; ++i) {
+            const stbtt_stream::GlyphPlan& gp = plan._glyphs[i];
+            if (gp.codepoint != 'I') continue;
+            const std::uint8_t* cell = atlas.data() + gp.rect.y * stride + gp.rect.x * comp;
+            const std::uint8_t center = cell[(gp.rect.h / 2) * stride + (gp.rect.w / 2) * comp + (comp - 1)];
+            REQUIRE(center < 128);
+            REQUIRE(cell[comp - 1] >= 128);
+            REQUIRE(cell[(gp.rect.h - 1) * stride + (gp.rect.w - 1) * comp + (comp - 1)] >= 128);
+        }
+    }
+}
+
+TEST_CASE("PathSDF - square matches the analytic distance field", "[stbtt_stream][path]") {
+    using V = stbtt_stream::PathVerb;
+    const V verbs[] = { V::Move, V::Line, V::Line, V::Line, V::Close };
+    const float pts[] = { 0, 0,  10, 0,  10, 10,  0, 10 };
+    const stbtt_stream::PathShape square{ verbs, 5, pts, 4, false };
+
+    stbtt_stream::PathPlanInput in{};
+    in.mode = stbtt_stream::DfMode::SDF;
+    in.scale = 2.0f;     // px per unit
+    in.spread_px = 4.0f; // 2 units
+    in.shapes = &square;
+    in.shape_count = 1;
+
+    std::vector<std::uint8_t> mem(stbtt_stream::PathSDF::PlanBytes(in));
+    REQUIRE(!mem.empty());
+    stbtt_stream::PathPlan plan{};
+    REQUIRE(stbtt_stream::PathSDF::Plan(in, mem.data(), mem.size(), plan));
+    const stbtt_stream::PathCell& c = plan.Cell(0);
+    REQUIRE((c.rect.w == 28 && c.rect.h == 28));
+
+    std::vector<std::uint8_t> atlas((std::size_t)plan.atlas_side * plan.atlas_side, 0);
+    REQUIRE(stbtt_stream::PathSDF::Build(plan, atlas.data(), plan.atlas_side));
+
+    std::uint32_t off = 0;
+    for (int y = 0; y < c.rect.h; ++y)
+    for (int x = 0; x < c.rect.w; ++x) {
+        const float fx = -2.0f + (x + 0.5f) / 2.0f;
+        const float fy = -2.0f + ((c.rect.h - 1 - y) + 0.5f) / 2.0f;
+        const float dx = std::max(std::max(-fx, fx - 10.0f), 0.0f);
+        const float dy = std::max(std::max(-fy, fy - 10.0f), 0.0f);
+        const bool inside = fx > 0 && fx < 10 && fy > 0 && fy < 10;
+        const float d = inside ? std::min(std::min(fx, 10.0f - fx), std::min(fy, 10.0f - fy))
+                               : std::sqrt(dx * dx + dy * dy);
+        const int sd = (int)(std::min(d / 2.0f, 1.0f) * 127.0f + 0.5f);
+        const int want = 128 + (inside ? -sd : sd);
+        const int got = atlas[(c.rect.y + y) * plan.atlas_side + c.rect.x + x];
+        if (got - want > 1 || want - got > 1) ++off;
+    }
+    REQUIRE(off == 0);
+}
+
+TEST_CASE("PathSDF - Build matches Render per shape; y_down, empty and malformed shapes", "[stbtt_stream][path]") {
+    using V = stbtt_stream::PathVerb;
+    // triangle (y-up), the same triangle given y-down, a quad/cubic blob, an empty shape
+    const V tri_v[] = { V::Move, V::Line, V::Line };
+    const float tri_up[] = { 0, 0,  12, 0,  3, 9 };
+    const float tri_dn[] = { 0, 0,  12, 0,  3, -9 };
+    const V blob_v[] = { V::Move, V::Quad, V::Cubic, V::Close, V::Move, V::Line, V::Line };
+    const float blob[] = { 0, 5,  5, 12, 10, 5,  12, -2, 2, -4, 0, 5,  3, 3,  7, 3,  5, 6 };
+    const stbtt_stream::PathShape shapes[] = {
+        { tri_v, 3, tri_up, 3, false },
+        { tri_v, 3, tri_dn, 3, true },
+        { blob_v, 7, blob, 9, false },
+        { nullptr, 0, nullptr, 0, false },
+    };
+
+    for (stbtt_stream::DfMode mode : { stbtt_stream::DfMode::MSDF, stbtt_stream::DfMode::MTSDF }) {
+        const std::uint32_t comp = (std::uint32_t)mode;
+        for (stbtt_stream::PackMode pm : { stbtt_stream::PackMode::Skyline, stbtt_stream::PackMode::MaxRects }) {
+            stbtt_stream::PathPlanInput in{};
+            in.mode = mode;
+            in.scale = 3.0f;
+            in.spread_px = 3.0f;
+            in.shapes = shapes;
+            in.shape_count = 4;
+            in.pack_mode = pm;
+
+            std::vector<std::uint8_t> mem(stbtt_stream::PathSDF::PlanBytes(in));
+            stbtt_stream::PathPlan plan{};
+            REQUIRE(stbtt_stream::PathSDF::Plan(in, mem.data(), mem.size(), plan));
+            REQUIRE(plan.shape_count == 4);
+            REQUIRE(plan.Cell(3).rect.w == 0);
+
+            const std::uint32_t stride = (std::uint32_t)plan.atlas_side * comp;
+            std::vector<std::uint8_t> atlas((std::size_t)stride * plan.atlas_side * plan.page_count, 0);
+            REQUIRE(stbtt_stream::PathSDF::Build(plan, atlas.data(), stride));
+
+            std::vector<std::uint8_t> scratch(stbtt_stream::glyph_scratch_bytes(0, plan.max_area, mode));
+            stbtt_stream::GlyphScratch gs =
+                stbtt_stream::bind_glyph_scratch(scratch.data(), 0, plan.max_area, mode);
+            std::vector<std::vector<std::uint8_t>> cells;
+            for (std::uint32_t i = 0; i < 3; ++i) {
+                stbtt_stream::PathCell c = plan.Cell(i);
+                REQUIRE(c.rect.w > 0);
+                const std::uint32_t cell_stride = (std::uint32_t)c.rect.w * comp;
+                cells.emplace_back((std::size_t)cell_stride * c.rect.h, 0);
+                const stbtt_stream::GlyphRect placed = c.rect;
+                c.rect.x = 0;
+                c.rect.y = 0;
+                REQUIRE(stbtt_stream::PathSDF::Render(shapes[i], c, cells.back().data(), cell_stride, mode,
+                                                      plan.scale, plan.spread, gs, plan.max_area));
+                for (std::uint32_t y = 0; y < placed.h; ++y)
+                    REQUIRE(std::memcmp(atlas.data() + (placed.y + y) * stride + placed.x * comp,
+                                        cells.back().data() + y * cell_stride, cell_stride) == 0);
+            }
+            // y_down input is flipped into the y-up frame: same cell as the y-up triangle
+            REQUIRE(cells[0] == cells[1]);
+        }
+    }
+
+    // a segment before any Move is malformed
+    const V bad_v[] = { V::Line, V::Move, V::Line };
+    const stbtt_stream::PathShape bad[] = { shapes[0], { bad_v, 3, tri_up, 3, false } };
+    stbtt_stream::PathPlanInput in{};
+    in.mode = stbtt_stream::DfMode::SDF;
+    in.scale = 1.0f;
+    in.spread_px = 2.0f;
+    in.shapes = bad;
+    in.shape_count = 2;
+    REQUIRE(stbtt_stream::PathSDF::PlanBytes(in) == 0);
+    std::vector<std::uint8_t> mem(4096);
+    stbtt_stream::PathPlan plan{};
+    REQUIRE_FALSE(stbtt_stream::PathSDF::Plan(in, mem.data(), mem.size(), plan));
+}
+
+TEST_CASE("BitmapSDF - antialiased disc mask matches the analytic distance field", "[stbtt_stream][bitmap]") {
+    // 256x256 disc with 4x4 supersampled coverage, reduced to a 32x32 SDF
+    const int S = 256;
+    const float cx = S * 0.5f, cy = S * 0.5f, R = S * 0.35f;
+    std::vector<std::uint8_t> mask((std::size_t)S * S);
+    for (int y = 0; y < S; ++y)
+    for (int x = 0; x < S; ++x) {
+        int c = 0;
+        for (int j = 0; j < 4; ++j)
+        for (int i = 0; i < 4; ++i) {
+            const float px = x + (i + 0.5f) / 4.0f - cx, py = y + (j + 0.5f) / 4.0f - cy;
+            c += px * px + py * py < R * R;
+        }
+        mask[(std::size_t)y * S + x] = (std::uint8_t)(c * 255 / 16);
+    }
+
+    stbtt_stream::BitmapSDFInput in{};
+    in.coverage = mask.data();
+    in.src_w = S;
+    in.src_h = S;
+    in.src_stride = S;
+    in.dst_w = 32;
+    in.dst_h = 32;
+    in.spread_px = 4.0f;
+    in.oversample = 4;
+    in.subpixel = true;
+    in.mode = stbtt_stream::DfMode::SDF;
+
+    std::uint16_t w = 0, h = 0;
+    REQUIRE(stbtt_stream::BitmapSDF::CellSize(in, w, h));
+    REQUIRE((w == 40 && h == 40));
+    std::vector<std::uint8_t> scratch(stbtt_stream::BitmapSDF::ScratchBytes(in));
+    REQUIRE(!scratch.empty());
+
+    // placed at (8, 4) inside a larger atlas
+    const std::uint32_t stride = 64;
+    std::vector<std::uint8_t> atlas((std::size_t)stride * 48, 0);
+    const stbtt_stream::GlyphRect rect{ 8, 4, w, h, 0 };
+    REQUIRE_FALSE(stbtt_stream::BitmapSDF::Render(in, rect, atlas.data(), stride,
+                                                  scratch.data(), scratch.size() - 1));
+    REQUIRE(stbtt_stream::BitmapSDF::Render(in, rect, atlas.data(), stride, scratch.data(), scratch.size()));
+
+    // tolerance: 1/8 output pixel = 4 codes at spread 4
+    std::uint32_t off = 0, band = 0;
+    for (int y = 0; y < h; ++y)
+    for (int x = 0; x < w; ++x) {
+        const float fx = (x + 0.5f - 4.0f) * S / 32.0f, fy = (y + 0.5f - 4.0f) * S / 32.0f;
+        const float d = (std::sqrt((fx - cx) * (fx - cx) + (fy - cy) * (fy - cy)) - R) * 32.0f / S;
+        const float nd = std::max(-1.0f, std::min(1.0f, d / 4.0f));
+        const int want = 128 + (int)std::lround(nd * 127.0f);
+        const int got = atlas[(std::size_t)(rect.y + y) * stride + rect.x + x];
+        if (std::fabs(nd) < 1.0f) ++band;
+        if (got - want > 4 || want - got > 4) ++off;
+    }
+    REQUIRE(band > 200);
+    REQUIRE(off == 0);
+
+    // MSDF atlases get the value in every channel (median == SDF)
+    in.mode = stbtt_stream::DfMode::MSDF;
+    std::vector<std::uint8_t> msdf((std::size_t)w * 3 * h, 0);
+    const stbtt_stream::GlyphRect at0{ 0, 0, w, h, 0 };
+    REQUIRE(stbtt_stream::BitmapSDF::Render(in, at0, msdf.data(), w * 3u, scratch.data(), scratch.size()));
+    std::uint32_t differ = 0;
+    for (int y = 0; y < h; ++y)
+    for (int x = 0; x < w; ++x) {
+        const std::uint8_t* p = &msdf[((std::size_t)y * w + x) * 3];
+        const std::uint8_t sdf = atlas[(std::size_t)(rect.y + y) * stride + rect.x + x];
+        if (p[0] != sdf || p[1] != sdf || p[2] != sdf) ++differ;
+    }
+    REQUIRE(differ == 0);
+}
+
+TEST_CASE("DynamicAtlas - on-demand cells match Build, LRU eviction keeps lookups valid", "[stbtt_stream][dynamic]") {
+    std::vector<std::uint8_t> bytes;
+    stbtt_stream::Font font;
+    if (!stbtt_stream_test::load_font(bytes, font)) FAIL("No font found. Set STBTT_TEST_FONT=/path/to/font.ttf");
+
+    const auto cps = stbtt_stream_test::ascii_codepoints();
+    const stbtt_stream::DfMode mode = stbtt_stream::DfMode::MSDF;
+    const std::uint32_t comp = 3;
+
+    // reference: batch Plan/Build
+    stbtt_stream::PlanInput in{};
+    in.mode = mode;
+    in.pixel_height = 32;
+    in.spread_px = 4.0f;
+    in.codepoints = cps.data();
+    in.codepoint_count = (std::uint32_t)cps.size();
+    std::vector<std::uint8_t> plan_mem(font.PlanBytes(in));
+    stbtt_stream::FontPlan plan{};
+    REQUIRE(font.Plan(in, plan_mem.data(), plan_mem.size(), plan));
+    const std::uint32_t ref_stride = (std::uint32_t)plan.atlas_side * comp;
+    std::vector<std::uint8_t> ref((std::size_t)ref_stride * plan.atlas_side, 0);
+    REQUIRE(font.Build(plan, ref.data(), ref_stride));
+
+    // small pages so the ASCII set cannot stay resident
+    stbtt_stream::DynamicAtlasInput din{};
+    din.mode = mode;
+    din.pixel_height = 32;
+    din.spread_px = 4.0f;
+    din.page_side = 128;
+    din.page_count = 3;
+    din.slot_cap = 64;
+    din.dirty_cap = 8;
+
+    const std::size_t dyn_bytes = stbtt_stream::DynamicAtlas::PlanBytes(font, din);
+    REQUIRE(dyn_bytes > 0);
+    std::vector<std::uint8_t> dyn_mem(dyn_bytes);
+    const std::uint32_t stride = din.page_side * comp;
+    std::vector<std::uint8_t> pages((std::size_t)stride * din.page_side * din.page_count, 0);
+
+    stbtt_stream::DynamicAtlas atlas;
+    REQUIRE(atlas.Init(font, din, dyn_mem.data(), dyn_bytes, pages.data(), stride));
+
+    for (int round = 0; round < 2; ++round) {
+        for (std::uint32_t i = 0; i < plan.glyph_count; ++i) {
+            const stbtt_stream::GlyphPlan& gp = plan._glyphs[i];
+            const stbtt_stream::DynamicGlyph* g = atlas.Get(gp.codepoint);
+            REQUIRE(g != nullptr);
+            REQUIRE(g->plan.codepoint == gp.codepoint);
+            REQUIRE(g->plan.rect.w == gp.rect.w);
+            REQUIRE(g->plan.rect.h == gp.rect.h);
+
+            const std::uint8_t* page = pages.data() + (std::size_t)g->plan.rect.page * din.page_side * stride;
+            for (std::uint32_t y = 0; y < gp.rect.h; ++y) {
+                REQUIRE(std::memcmp(page + (g->plan.rect.y + y) * stride + g->plan.rect.x * comp,
+                                    ref.data() + (gp.rect.y + y) * ref_stride + gp.rect.x * comp,
+                                    (std::size_t)gp.rect.w * comp) == 0);
+            }
+        }
+    }
+    REQUIRE(atlas.evictions > 0);
+    REQUIRE(atlas.resident <= din.slot_cap);
+    REQUIRE(atlas.DirtyCount() <= din.dirty_cap);
+
+    // every resident glyph is reachable and cells on one page never overlap
+    for (std::uint32_t a = 0; a < plan.glyph_count; ++a) {
+        const auto* ga = atlas.Find(plan._glyphs[a].codepoint);
+        if (!ga) continue;
+        for (std::uint32_t b = a + 1; b < plan.glyph_count; ++b) {
+            const auto* gb = atlas.Find(plan._glyphs[b].codepoint);
+            if (!gb || gb->plan.rect.page != ga->plan.rect.page) continue;
+            const auto& r = ga->plan.rect;
+            const auto& s = gb->plan.rect;
+            const bool overlap = r.x < s.x + s.w && s.x < r.x + r.w && r.y < s.y + s.h && s.y < r.y + r.h;
+            REQUIRE_FALSE(overlap);
+        }
+    }
+
+    // one page smaller than the largest cells: those fail without evicting the page
+    din.page_side = 24;
+    din.page_count = 1;
+    din.dirty_cap = 1;
+    std::vector<std::uint8_t> tiny_mem(stbtt_stream::DynamicAtlas::PlanBytes(font, din));
+    REQUIRE(!tiny_mem.empty());
+    const std::uint32_t tiny_stride = din.page_side * comp;
+    std::vector<std::uint8_t> tiny_pages((std::size_t)tiny_stride * din.page_side, 0);
+    stbtt_stream::DynamicAtlas tiny;
+    REQUIRE(tiny.Init(font, din, tiny_mem.data(), tiny_mem.size(), tiny_pages.data(), tiny_stride));
+
+    std::uint32_t small_cp = 0, large_cp = 0;
+    for (std::uint32_t i = 0; i < plan.glyph_count; ++i) {
+        const stbtt_stream::GlyphRect& r = plan._glyphs[i].rect;
+        const bool fits = r.w <= din.page_side && r.h <= din.page_side;
+        if (fits && !small_cp) small_cp = plan._glyphs[i].codepoint;
+        if (!fits && !large_cp) large_cp = plan._glyphs[i].codepoint;
+    }
+    REQUIRE(small_cp != 0);
+    REQUIRE(large_cp != 0);
+
+    const stbtt_stream::DynamicGlyph* small = tiny.Get(small_cp);
+    REQUIRE(small != nullptr);
+    const stbtt_stream::GlyphRect small_rect = small->plan.rect;
+    REQUIRE(tiny.Get(large_cp) == nullptr);
+    REQUIRE(tiny.evictions == 0);
+    REQUIRE(tiny.resident == 1);
+    REQUIRE(tiny.Find(small_cp) == small);
+    REQUIRE(std::memcmp(&small->plan.rect, &small_rect, sizeof(small_rect)) == 0);
+}
+
+TEST_CASE("Atlas cache - write/load round trip binds the same plan and pixels", "[stbtt_stream][cache]") {
+    std::vector<std::uint8_t> bytes;
+    stbtt_stream::Font font;
+    if (!stbtt_stream_test::load_font(bytes, font)) FAIL("No font found. Set STBTT_TEST_FONT=/path/to/font.ttf");
+
+    const auto cps = stbtt_stream_test::ascii_codepoints();
+    stbtt_stream::PlanInput in{};
+    in.mode = stbtt_stream::DfMode::MTSDF;
+    in.pixel_height = 24;
+    in.spread_px = 3.0f;
+    in.codepoints = cps.data();
+    in.codepoint_count = (std::uint32_t)cps.size();
+
+    std::vector<std::uint8_t> plan_mem(font.PlanBytes(in));
+    stbtt_stream::FontPlan plan{};
+    REQUIRE(font.Plan(in, plan_mem.data(), plan_mem.size(), plan));
+    const std::uint32_t stride = (std::uint32_t)plan.atlas_side * 4u;
+    std::vector<std::uint8_t> atlas((std::size_t)stride * plan.atlas_side, 0);
+    REQUIRE(font.Build(plan, atlas.data(), stride));
+
+    const stbtt_stream::AtlasCacheKey key = stbtt_stream::MakeAtlasCacheKey(font, in);
+    const std::size_t cache_bytes = stbtt_stream::AtlasCacheBytes(plan);
+    REQUIRE(cache_bytes > atlas.size());
+
+    // 16-byte aligned image, like an mmap'ed file
+    std::vector<std::uint64_t> image_storage((cache_bytes + 7) / 8 + 1);
+    void* image = image_storage.data();
+    REQUIRE(stbtt_stream::WriteAtlasCache(plan, key, atlas.data(), stride, image, cache_bytes));
+
+    stbtt_stream::FontPlan view{};
+    const std::uint8_t* view_atlas = nullptr;
+    std::uint32_t view_stride = 0;
+    REQUIRE(stbtt_stream::LoadAtlasCache(image, cache_bytes, key, view, view_atlas, view_stride));
+    REQUIRE(((std::uintptr_t)view_atlas - (std::uintptr_t)image) % stbtt_stream::ATLAS_CACHE_PIXEL_ALIGN == 0);
+    REQUIRE(view.atlas_side == plan.atlas_side);
+    REQUIRE(view.glyph_count == plan.glyph_count);
+    REQUIRE(view.scale == plan.scale);
+    REQUIRE(view_stride == stride);
+    REQUIRE(std::memcmp(view._glyphs, plan._glyphs, plan.glyph_count * sizeof(stbtt_stream::GlyphPlan)) == 0);
+    REQUIRE(std::memcmp(view_atlas, atlas.data(), atlas.size()) == 0);
+
+    // any key change is a miss
+    stbtt_stream::AtlasCacheKey other = key;
+    other.pixel_height = 25;
+    REQUIRE_FALSE(stbtt_stream::LoadAtlasCache(image, cache_bytes, other, view, view_atlas, view_stride));
+    other = key;
+    other.codepoint_hash ^= 1;
+    REQUIRE_FALSE(stbtt_stream::LoadAtlasCache(image, cache_bytes, other, view, view_atlas, view_stride));
+    REQUIRE_FALSE(stbtt_stream::LoadAtlasCache(image, cache_bytes - 1, key, view, view_atlas, view_stride));
+
+    // a damaged codepoint map is a miss: slot past the glyph table, codepoints out of order
+    REQUIRE(plan.codepoint_count > 2);
+    std::uint32_t* map = view._map_cp;             // still the map inside `image`
+    std::uint32_t* slots = view._map_slot;
+    const std::uint32_t slot = slots[1];
+    slots[1] = plan.glyph_count;
+    REQUIRE_FALSE(stbtt_stream::LoadAtlasCache(image, cache_bytes, key, view, view_atlas, view_stride));
+    slots[1] = slot;
+    std::swap(map[1], map[2]);
+    REQUIRE_FALSE(stbtt_stream::LoadAtlasCache(image, cache_bytes, key, view, view_atlas, view_stride));
+    std::swap(map[1], map[2]);
+    REQUIRE(stbtt_stream::LoadAtlasCache(image, cache_bytes, key, view, view_atlas, view_stride));
+
+    // so is a cell outside the cached atlas: past the right edge, on a missing page
+    stbtt_stream::GlyphRect* rect = &view._glyphs[plan.glyph_count / 2].rect;
+    const stbtt_stream::GlyphRect saved = *rect;
+    rect->x = (std::uint16_t)(plan.atlas_side - rect->w + 1);
+    REQUIRE_FALSE(stbtt_stream::LoadAtlasCache(image, cache_bytes, key, view, view_atlas, view_stride));
+    *rect = saved;
+    rect->page = plan.page_count;
+    REQUIRE_FALSE(stbtt_stream::LoadAtlasCache(image, cache_bytes, key, view, view_atlas, view_stride));
+    *rect = saved;
+    REQUIRE(stbtt_stream::LoadAtlasCache(image, cache_bytes, key, view, view_atlas, view_stride));
+}